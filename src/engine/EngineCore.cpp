@@ -247,7 +247,16 @@ EngineCore::EngineCore(bool offlineMode)
 
     updateCrossfader(0.5f);
 
+    for (uint8_t deck = 0; deck < ngks::MAX_DECKS; ++deck) {
+        deckEventContexts_[deck] = { this, deck };
+        audioGraph.getDeckNode(deck).setDecodeListener(&EngineCore::onDeckDecode, &deckEventContexts_[deck]);
+    }
+    jobSystem.setResultListener(&EngineCore::onJobResult, this);
+
     jobSystem.start();
+    if (!offlineMode_) {
+        spectrumTap_.start();
+    }
     lastRegistryPersist = std::chrono::steady_clock::now();
 
     setRunState(EngineRunState::Ready);
@@ -267,6 +276,7 @@ EngineCore::~EngineCore()
 
     persistRegistryIfNeeded(true);
     jobSystem.stop();
+    spectrumTap_.stop();
 
     setRunState(EngineRunState::Cold);
 }
@@ -1416,9 +1426,11 @@ EngineCore::DjRecoveryResult EngineCore::attemptDjRecovery() noexcept
     djEnforcer_ = DjEnforcerState{};
     for (int slot = 0; slot < 2; ++slot) {
         snapshots[slot].flags &= ~ngks::SNAP_DJ_DEVICE_LOST;
+        ++snapshots[slot].deviceVersion;
     }
 
     ngks::audioTrace("DJ_RECOVERY_CLEAR_LOST_END", "tid=%lu djDeviceLost=0", tid);
+    events_.publish({ ngks::EngineEventType::DeviceRecovered, 0, 0u, 0.0f });
 
     // Log deck state after recovery — media binding must survive
     for (uint8_t d = 0; d < ngks::MAX_DECKS; ++d) {
@@ -1473,6 +1485,7 @@ void EngineCore::forceStopAllDecks() noexcept
                                  d, static_cast<int>(deck.transport),
                                  static_cast<int>(deck.lifecycle), slot);
                 deck.transport = ngks::TransportState::Stopped;
+                ++deck.transportVersion;
             }
             // Lifecycle must track transport — a Playing deck forced to
             // Stopped transport must move lifecycle to Stopped so the
@@ -1492,6 +1505,7 @@ void EngineCore::forceStopAllDecks() noexcept
         snapshots[slot].masterPeakR = 0.0f;
         snapshots[slot].flags &= ~ngks::SNAP_AUDIO_RUNNING;
         snapshots[slot].flags |= ngks::SNAP_DJ_DEVICE_LOST;
+        ++snapshots[slot].deviceVersion;
     }
     // Log post-stop deck state so we can verify media binding survives
     for (uint8_t d = 0; d < ngks::MAX_DECKS; ++d) {
@@ -1532,6 +1546,7 @@ void EngineCore::forceDjDeviceLost() noexcept
 
     forceStopAllDecks();
     setRunState(EngineRunState::Ready);
+    events_.publish({ ngks::EngineEventType::DeviceLost, 0, 0u, 0.0f });
     ngks::audioTrace("DJ_DEVICE_LOST",
         "source=enforcer allDecksForceStop=1 expected=\"%s\"",
         preferredAudioDeviceName_.c_str());
@@ -1891,11 +1906,87 @@ void EngineCore::publishSnapshot(const ngks::EngineSnapshot& snapshot) noexcept
 {
     const uint32_t front = frontSnapshotIndex.load(std::memory_order_acquire);
     const uint32_t back = front ^ 1u;
-    snapshots[back] = snapshot;
+    const ngks::EngineSnapshot& prev = snapshots[front];
+    ngks::EngineSnapshot& next = snapshots[back];
+    next = snapshot;
+
+    // Versions continue from the published snapshot, not from the working
+    // copy: a pending command outcome may carry older ones.
+    for (uint8_t d = 0; d < ngks::MAX_DECKS; ++d) {
+        const auto& a = prev.decks[d];
+        auto& b = next.decks[d];
+        b.transportVersion = a.transportVersion;
+        b.trackVersion = a.trackVersion;
+        b.analysisVersion = a.analysisVersion;
+        b.routingVersion = a.routingVersion;
+
+        if (a.transport != b.transport || a.lifecycle != b.lifecycle) {
+            ++b.transportVersion;
+            events_.push({ ngks::EngineEventType::TransportChanged, d,
+                           static_cast<uint32_t>(b.transport), 0.0f });
+        }
+        if (a.hasTrack != b.hasTrack || a.currentTrackId != b.currentTrackId
+            || a.trackUidHash != b.trackUidHash || a.trackLoadGen != b.trackLoadGen
+            || a.lengthSeconds != b.lengthSeconds
+            || std::strncmp(a.currentTrackLabel, b.currentTrackLabel, sizeof(a.currentTrackLabel)) != 0) {
+            ++b.trackVersion;
+        }
+        // LoadTrack applied: the deck now plays the new file.
+        if (b.hasTrack && b.lifecycle == DeckLifecycleState::Loaded && a.trackLoadGen != b.trackLoadGen) {
+            events_.push({ ngks::EngineEventType::LoadComplete, d,
+                           static_cast<uint32_t>(b.trackLoadGen), 0.0f });
+        }
+        if (a.cachedBpmFixed != b.cachedBpmFixed || a.cachedLoudnessCentiDb != b.cachedLoudnessCentiDb
+            || a.cachedDeadAirMs != b.cachedDeadAirMs || a.cachedStemsReady != b.cachedStemsReady
+            || a.cachedAnalysisStatus != b.cachedAnalysisStatus) {
+            ++b.analysisVersion;
+        }
+        bool fxChanged = false;
+        for (int slot = 0; slot < 4; ++slot) {
+            fxChanged = fxChanged || a.fxSlots[slot].enabled != b.fxSlots[slot].enabled
+                        || a.fxSlots[slot].dryWet != b.fxSlots[slot].dryWet
+                        || a.fxSlots[slot].type != b.fxSlots[slot].type;
+        }
+        if (fxChanged || a.deckGain != b.deckGain || a.muted != b.muted || a.cueEnabled != b.cueEnabled
+            || a.routingActive != b.routingActive || a.publicFacing != b.publicFacing) {
+            ++b.routingVersion;
+        }
+    }
+
+    constexpr uint32_t kDeviceFlags = ngks::SNAP_AUDIO_RUNNING | ngks::SNAP_DJ_DEVICE_LOST;
+    next.deviceVersion = prev.deviceVersion;
+    if ((prev.flags & kDeviceFlags) != (next.flags & kDeviceFlags)) {
+        ++next.deviceVersion;
+    }
+
     frontSnapshotIndex.store(back, std::memory_order_release);
     telemetry_.snapshotPublishes.fetch_add(1u, std::memory_order_relaxed);
 }
 
+void EngineCore::onDeckDecode(void* context, int64_t decodedFrames, int64_t totalFrames, bool complete)
+{
+    auto* ctx = static_cast<DeckEventContext*>(context);
+    if (ctx == nullptr || ctx->engine == nullptr) {
+        return;
+    }
+    const float fraction = totalFrames > 0
+        ? static_cast<float>(static_cast<double>(decodedFrames) / static_cast<double>(totalFrames))
+        : 0.0f;
+    ctx->engine->events_.publish({ complete ? ngks::EngineEventType::DecodeComplete
+                                            : ngks::EngineEventType::DecodeProgress,
+                                   ctx->deck, 0u, std::clamp(fraction, 0.0f, 1.0f) });
+}
+
+void EngineCore::onJobResult(void* context, const ngks::JobResult& result)
+{
+    auto* self = static_cast<EngineCore*>(context);
+    if (self == nullptr) {
+        return;
+    }
+    self->events_.publish({ ngks::EngineEventType::AnalysisResult, result.deckId, result.jobId,
+                            static_cast<float>(result.progress0_100) / 100.0f });
+}
+
 void EngineCore::pushRenderDurationSample(uint32_t durationUs) noexcept
 {
     const uint32_t writeIndex = telemetry_.renderDurationHistoryWriteIndex.load(std::memory_order_relaxed);
@@ -1918,6 +2009,7 @@ void EngineCore::prepare(double sampleRate, int)
     }
 
     audioGraph.prepare(sampleRateHz, 2048);
+    spectrumTap_.setSampleRate(sampleRateHz);
 }
 
 void EngineCore::updateCrossfader(float x)
@@ -2045,7 +2137,6 @@ ngks::CommandResult EngineCore::applySetDeckTrack(ngks::EngineSnapshot& snapshot
 
     deck.lifecycle = DeckLifecycleState::Loaded;
 
-    registryDirty = true;
     return ngks::CommandResult::Applied;
 }
 
@@ -2081,7 +2172,6 @@ void EngineCore::appendJobResults(ngks::EngineSnapshot& snapshot) noexcept
                 analysis.stemsReady = result.stemsReady;
             }
             trackRegistry.updateAnalysis(result.trackId, analysis);
-            registryDirty = true;
 
             for (uint8_t deckIndex = 0; deckIndex < ngks::MAX_DECKS; ++deckIndex) {
                 if (snapshot.decks[deckIndex].currentTrackId == result.trackId) {
@@ -2096,21 +2186,30 @@ void EngineCore::appendJobResults(ngks::EngineSnapshot& snapshot) noexcept
     }
 }
 
+void EngineCore::pollRegistryPersist()
+{
+    persistRegistryIfNeeded(false);
+}
+
 void EngineCore::persistRegistryIfNeeded(bool force)
 {
-    if (!registryDirty) {
+    const auto now = std::chrono::steady_clock::now();
+    if (!force && (now - lastRegistryPersist) < registryPersistInterval) {
         return;
     }
+    lastRegistryPersist = now;
 
-    const auto now = std::chrono::steady_clock::now();
-    if (!force && (now - lastRegistryPersist) < registryPersistInterval) {
+    trackRegistry.takeDirty(registryPending_);
+    if (!registryStore.append(registryPending_)) {
+        std::cout << "CACHE_PERSIST_FAIL path=" << registryStore.pathString()
+                  << " pending=" << registryPending_.size() << std::endl;
+        trackRegistry.restoreDirty(registryPending_);
         return;
     }
 
-    if (registryStore.save(trackRegistry)) {
-        std::cout << "CACHE_PERSIST_OK path=" << registryStore.pathString() << std::endl;
-        registryDirty = false;
-        lastRegistryPersist = now;
+    const size_t live = trackRegistry.count();
+    if (registryStore.needsCompaction(live) || (force && registryStore.logRecords() > live)) {
+        registryStore.compact(trackRegistry);
     }
 }
 
@@ -2475,6 +2574,7 @@ void EngineCore::process(float* left, float* right, int numSamples) noexcept
 
     masterBus_.setGainTrim(static_cast<float>(working.masterGain));
     const auto masterMeters = masterBus_.process(left, right, numSamples);
+    spectrumTap_.write(left, right, numSamples);
 
     // Full Mono mode (after master bus gain/limiting):
     // master summed to mono → LEFT, cue summed to mono → RIGHT (with cue volume + cue/master blend)
@@ -2693,6 +2793,8 @@ bool EngineCore::loadFileIntoDeck(ngks::DeckId deckId, const std::string& filePa
         cmd.trackLabel[copyLen] = '\0';
     }
 
+    // LoadComplete follows from publishSnapshot() once the audio thread
+    // has applied the command.
     enqueueCommand(cmd);
     ngks::audioTrace("LOAD_INTO_DECK_DONE", "deck=%d seq=%u totalMs=%lld",
                      (int)deckId, cmd.seq, elapsedMs());
@@ -2726,6 +2828,17 @@ std::vector<ngks::BandEnergy> EngineCore::getBandEnergyOverview(ngks::DeckId dec
     return audioGraph.getDeckNode(deckId).generateBandEnergyOverview(numBins);
 }
 
+bool EngineCore::tryGetSpectrum(ngks::SpectrumFrame& out) noexcept
+{
+    return spectrumTap_.latest(out);
+}
+
+std::shared_ptr<const ngks::WaveformPyramid> EngineCore::getWaveformPyramid(ngks::DeckId deckId) const
+{
+    if (deckId >= ngks::MAX_DECKS) return nullptr;
+    return audioGraph.getDeckNode(deckId).waveformPyramid();
+}
+
 bool EngineCore::isDeckFullyDecoded(ngks::DeckId deckId) const
 {
     if (deckId >= ngks::MAX_DECKS) return false;
@@ -10,10 +10,12 @@
 
 #include "engine/command/Command.h"
 #include "engine/runtime/DeckAuthorityState.h"
+#include "engine/runtime/EngineEvents.h"
 #include "engine/runtime/EngineSnapshot.h"
 #include "engine/runtime/MasterBus.h"
 #include "engine/runtime/MixMatrix.h"
 #include "engine/runtime/SPSCCommandRing.h"
+#include "engine/runtime/SpectrumTap.h"
 #include "engine/runtime/graph/AudioGraph.h"
 #include "engine/runtime/jobs/JobSystem.h"
 #include "engine/runtime/library/RegistryStore.h"
@@ -164,10 +166,15 @@ public:
     DjRecoveryResult attemptDjRecovery() noexcept;
 
     /// Periodic DJ output validity enforcer.
-    /// Call from UI/message thread (~16ms poll).  Internally throttled.
+    /// Call from UI/message thread (bridge housekeeping, ~100ms).  Internally throttled.
     /// Returns true if it just forced a device-lost event.
     bool pollDjOutputEnforcer() noexcept;
 
+    /// Appends changed track-registry entries to the on-disk log (and
+    /// compacts it when due).  Call from UI/message thread (bridge
+    /// housekeeping).  Internally throttled.
+    void pollRegistryPersist();
+
     /// Periodic DJ auto-recovery probe.  Call from UI/message thread while
     /// djDeviceLost_ is active.  Checks if the intended DJ output has
     /// reappeared and, if a stable match persists, triggers recovery via
@@ -189,9 +196,26 @@ public:
     /// Get broad frequency-band energy overview for a deck (time-domain).
     std::vector<ngks::BandEnergy> getBandEnergyOverview(ngks::DeckId deckId, int numBins);
 
+    /// Multi-resolution waveform of the loaded track (null if none).
+    std::shared_ptr<const ngks::WaveformPyramid> getWaveformPyramid(ngks::DeckId deckId) const;
+
+    /// Newest master-bus spectrum frame; false if none since the last call.
+    /// Single reader (the UI thread).
+    bool tryGetSpectrum(ngks::SpectrumFrame& out) noexcept;
+
     /// Returns true once the full file (not just preload) has been decoded.
     bool isDeckFullyDecoded(ngks::DeckId deckId) const;
 
+    // ── Engine events ──
+    using EventQueue = ngks::EngineEventQueue<256>;
+
+    /// Typed state-change events for the UI thread (the single consumer).
+    /// Loads, decode progress, analysis results and device loss/recovery
+    /// are published with the queue's wakeup; TransportChanged comes from
+    /// the audio thread, which never wakes anyone, and is picked up by the
+    /// consumer's next drain.
+    EventQueue& events() noexcept { return events_; }
+
     /// Returns the file path currently loaded in a deck (empty if none).
     std::string getDeckFilePath(ngks::DeckId deckId) const;
 
@@ -268,6 +292,8 @@ private:
     bool performRtRecoveryIfNeeded(int64_t nowMs) noexcept;
     void sanitizeSnapshot(ngks::EngineSnapshot& snapshot) const noexcept;
     void publishSnapshot(const ngks::EngineSnapshot& snapshot) noexcept;
+    static void onDeckDecode(void* context, int64_t decodedFrames, int64_t totalFrames, bool complete);
+    static void onJobResult(void* context, const ngks::JobResult& result);
     void setRunState(EngineRunState state) noexcept;
     void notifyDeviceStopped() noexcept;
 
@@ -314,11 +340,18 @@ private:
     std::atomic<float> cueVolume_ { 1.0f };
     std::atomic<float> cueMixRatio_ { 0.5f };  // 0=cue only, 0.5=balanced, 1=master only
     ngks::MasterBus masterBus_ {};
+    ngks::SpectrumTap spectrumTap_;
+    EventQueue events_;                 // outlives audioGraph's decode threads
+    struct DeckEventContext {
+        EngineCore* engine{nullptr};
+        ngks::DeckId deck{0};
+    };
+    DeckEventContext deckEventContexts_[ngks::MAX_DECKS] {};
     ngks::AudioGraph audioGraph;
     ngks::JobSystem jobSystem;
     ngks::TrackRegistry trackRegistry;
     ngks::RegistryStore registryStore;
-    bool registryDirty = false;
+    std::vector<ngks::RegistryEntrySnapshot> registryPending_;
     std::chrono::steady_clock::time_point lastRegistryPersist {};
 
     double sampleRateHz = 48000.0;
@@ -0,0 +1,175 @@
+#include "engine/dsp/CrossoverFilterbank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iterator>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NGKS_CROSSOVER_SSE 1
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace ngks {
+
+namespace {
+constexpr double kButterworthQ = 0.70710678118654752;
+
+#if defined(NGKS_CROSSOVER_SSE)
+// One TDF-II step on four lanes; state stays in registers across a block.
+struct BiquadRegs {
+    __m128 b0, b1, b2, a1, a2, z1, z2;
+
+    __m128 step(__m128 x) noexcept
+    {
+        const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+        return y;
+    }
+};
+#endif
+}
+
+void CrossoverFilterbank::designButterworth(float freqHz, double sampleRate, bool highPass,
+                                            float& b0, float& b1, float& b2,
+                                            float& a1, float& a2) noexcept
+{
+    // Keep the corner below Nyquist for low-rate files.
+    const double f = std::min(static_cast<double>(freqHz), sampleRate * 0.45);
+    const double w0 = 2.0 * M_PI * f / sampleRate;
+    const double cosW = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * kButterworthQ);
+    const double invA0 = 1.0 / (1.0 + alpha);
+
+    const double k = highPass ? (1.0 + cosW) : (1.0 - cosW);
+    b0 = static_cast<float>(0.5 * k * invA0);
+    b1 = static_cast<float>((highPass ? -k : k) * invA0);
+    b2 = b0;
+    a1 = static_cast<float>(-2.0 * cosW * invA0);
+    a2 = static_cast<float>((1.0 - alpha) * invA0);
+}
+
+void CrossoverFilterbank::setLane(Biquad4& f, int lane, float freqHz, double sampleRate,
+                                  bool highPass) noexcept
+{
+    designButterworth(freqHz, sampleRate, highPass,
+                      f.b0[lane], f.b1[lane], f.b2[lane], f.a1[lane], f.a2[lane]);
+}
+
+void CrossoverFilterbank::prepare(double sampleRate) noexcept
+{
+    if (sampleRate <= 0.0) sampleRate = 48000.0;
+    for (int s = 0; s < 2; ++s) {
+        for (int lane = 0; lane < 4; ++lane) {
+            const bool upper = lane >= 2;           // lanes 2/3: the high half
+            setLane(split1_[s], lane, kCrossoverHz[1], sampleRate, upper);
+            setLane(lp2_[s], lane, upper ? kCrossoverHz[2] : kCrossoverHz[0], sampleRate, false);
+            setLane(hp2_[s], lane, upper ? kCrossoverHz[2] : kCrossoverHz[0], sampleRate, true);
+        }
+    }
+    reset();
+}
+
+void CrossoverFilterbank::reset() noexcept
+{
+    for (Biquad4* f : { &split1_[0], &split1_[1], &lp2_[0], &lp2_[1], &hp2_[0], &hp2_[1] }) {
+        std::fill(std::begin(f->z1), std::end(f->z1), 0.0f);
+        std::fill(std::begin(f->z2), std::end(f->z2), 0.0f);
+    }
+}
+
+void CrossoverFilterbank::accumulate(const float* left, const float* right, int numFrames,
+                                     double sumSq[kBandCount]) noexcept
+{
+    if (!left || numFrames <= 0) return;
+    if (!right) right = left;
+
+    // Squares are summed in float per block of at most kBlock frames and
+    // added to the double totals between blocks.
+    constexpr int kBlock = 256;
+
+#if defined(NGKS_CROSSOVER_SSE)
+    // Decaying IIR state in silence would go denormal; flush to zero here.
+    const unsigned int savedCsr = _mm_getcsr();
+    _mm_setcsr(savedCsr | 0x8040u);                 // FTZ | DAZ
+
+    auto regs = [](const Biquad4& f) {
+        return BiquadRegs{ _mm_load_ps(f.b0), _mm_load_ps(f.b1), _mm_load_ps(f.b2),
+                           _mm_load_ps(f.a1), _mm_load_ps(f.a2),
+                           _mm_load_ps(f.z1), _mm_load_ps(f.z2) };
+    };
+    auto store = [](const BiquadRegs& r, Biquad4& f) {
+        _mm_store_ps(f.z1, r.z1);
+        _mm_store_ps(f.z2, r.z2);
+    };
+
+    BiquadRegs s1a = regs(split1_[0]), s1b = regs(split1_[1]);
+    BiquadRegs lpa = regs(lp2_[0]),    lpb = regs(lp2_[1]);
+    BiquadRegs hpa = regs(hp2_[0]),    hpb = regs(hp2_[1]);
+
+    for (int start = 0; start < numFrames; start += kBlock) {
+        const int end = std::min(numFrames, start + kBlock);
+        __m128 accLp = _mm_setzero_ps();
+        __m128 accHp = _mm_setzero_ps();
+        for (int i = start; i < end; ++i) {
+            const __m128 x  = _mm_setr_ps(left[i], right[i], left[i], right[i]);
+            const __m128 s1 = s1b.step(s1a.step(x));
+            const __m128 lp = lpb.step(lpa.step(s1));
+            const __m128 hp = hpb.step(hpa.step(s1));
+            accLp = _mm_add_ps(accLp, _mm_mul_ps(lp, lp));
+            accHp = _mm_add_ps(accHp, _mm_mul_ps(hp, hp));
+        }
+        alignas(16) float sqLp[4], sqHp[4];
+        _mm_store_ps(sqLp, accLp);
+        _mm_store_ps(sqHp, accHp);
+        sumSq[0] += 0.5 * (static_cast<double>(sqLp[0]) + sqLp[1]);
+        sumSq[1] += 0.5 * (static_cast<double>(sqHp[0]) + sqHp[1]);
+        sumSq[2] += 0.5 * (static_cast<double>(sqLp[2]) + sqLp[3]);
+        sumSq[3] += 0.5 * (static_cast<double>(sqHp[2]) + sqHp[3]);
+    }
+
+    store(s1a, split1_[0]); store(s1b, split1_[1]);
+    store(lpa, lp2_[0]);    store(lpb, lp2_[1]);
+    store(hpa, hp2_[0]);    store(hpb, hp2_[1]);
+    _mm_setcsr(savedCsr);
+#else
+    auto step = [](Biquad4& f, float x[4]) {
+        for (int l = 0; l < 4; ++l) {
+            const float y = f.b0[l] * x[l] + f.z1[l];
+            f.z1[l] = f.b1[l] * x[l] - f.a1[l] * y + f.z2[l];
+            f.z2[l] = f.b2[l] * x[l] - f.a2[l] * y;
+            x[l] = y;
+        }
+    };
+
+    for (int start = 0; start < numFrames; start += kBlock) {
+        const int end = std::min(numFrames, start + kBlock);
+        float sqLp[4] = {}, sqHp[4] = {};
+        for (int i = start; i < end; ++i) {
+            float s1[4] = { left[i], right[i], left[i], right[i] };
+            step(split1_[0], s1);
+            step(split1_[1], s1);
+            float lp[4] = { s1[0], s1[1], s1[2], s1[3] };
+            float hp[4] = { s1[0], s1[1], s1[2], s1[3] };
+            step(lp2_[0], lp); step(lp2_[1], lp);
+            step(hp2_[0], hp); step(hp2_[1], hp);
+            for (int l = 0; l < 4; ++l) {
+                sqLp[l] += lp[l] * lp[l];
+                sqHp[l] += hp[l] * hp[l];
+            }
+        }
+        sumSq[0] += 0.5 * (static_cast<double>(sqLp[0]) + sqLp[1]);
+        sumSq[1] += 0.5 * (static_cast<double>(sqHp[0]) + sqHp[1]);
+        sumSq[2] += 0.5 * (static_cast<double>(sqLp[2]) + sqLp[3]);
+        sumSq[3] += 0.5 * (static_cast<double>(sqHp[2]) + sqHp[3]);
+    }
+#endif
+}
+
+}
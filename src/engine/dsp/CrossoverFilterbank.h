@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ngks {
+
+/// 4-band Linkwitz-Riley (LR4, 24 dB/oct) crossover for band-energy
+/// measurement: 2 kHz splits low from high, then 200 Hz and 6 kHz split each
+/// half again.  Each LR4 section is two cascaded Butterworth biquads, so the
+/// bands are adjacent with -6 dB crossings and no gaps or overlaps.
+///
+/// Both channels run together: the four outputs of a stage (L/R × two
+/// filters) are one SSE vector, so the whole tree is six 4-lane biquads per
+/// frame.  Bands are only measured, never summed back, so the phase
+/// difference between them is irrelevant and no all-pass compensation is
+/// applied.
+class CrossoverFilterbank {
+public:
+    static constexpr int kBandCount = 4;
+    static constexpr float kCrossoverHz[kBandCount - 1] = { 200.0f, 2000.0f, 6000.0f };
+
+    void prepare(double sampleRate) noexcept;
+    void reset() noexcept;
+
+    /// Filters numFrames of stereo (right may be null for mono) and adds
+    /// each band's squared output, averaged over the two channels, to
+    /// sumSq[band].  Filter state carries over between calls.
+    void accumulate(const float* left, const float* right, int numFrames,
+                    double sumSq[kBandCount]) noexcept;
+
+private:
+    // 4-lane transposed direct form II biquad; lane-wise coefficients.
+    struct Biquad4 {
+        alignas(16) float b0[4]{}, b1[4]{}, b2[4]{}, a1[4]{}, a2[4]{};
+        alignas(16) float z1[4]{}, z2[4]{};
+    };
+
+    static void designButterworth(float freqHz, double sampleRate, bool highPass,
+                                  float& b0, float& b1, float& b2, float& a1, float& a2) noexcept;
+    static void setLane(Biquad4& f, int lane, float freqHz, double sampleRate, bool highPass) noexcept;
+
+    // Stage 1 lanes: [lowL, lowR, highL, highR] at 2 kHz (two cascaded).
+    // Stage 2 lanes: split the stage-1 output: lp = [band0 L/R, band2 L/R],
+    // hp = [band1 L/R, band3 L/R].
+    Biquad4 split1_[2];
+    Biquad4 lp2_[2];
+    Biquad4 hp2_[2];
+};
+
+}
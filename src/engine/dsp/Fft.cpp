@@ -0,0 +1,85 @@
+#include "engine/dsp/Fft.h"
+
+#include <cmath>
+#include <utility>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+}
+
+Fft::Fft(int size)
+    : n(nextPowerOfTwo(size))
+{
+    bitReverse.resize(static_cast<size_t>(n));
+    int bits = 0;
+    while ((1 << bits) < n) {
+        ++bits;
+    }
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[static_cast<size_t>(i)] = r;
+    }
+
+    // W_n^k = exp(-2πik/n) for k < n/2; each stage strides through this table.
+    const int half = n / 2;
+    twiddleRe.resize(static_cast<size_t>(half));
+    twiddleIm.resize(static_cast<size_t>(half));
+    for (int k = 0; k < half; ++k) {
+        const double angle = -2.0 * kPi * k / n;
+        twiddleRe[static_cast<size_t>(k)] = std::cos(angle);
+        twiddleIm[static_cast<size_t>(k)] = std::sin(angle);
+    }
+}
+
+int Fft::nextPowerOfTwo(int value) noexcept
+{
+    int p = 1;
+    while (p < value) {
+        p <<= 1;
+    }
+    return p;
+}
+
+void Fft::forward(double* data) const noexcept
+{
+    transform(data, false);
+}
+
+void Fft::inverse(double* data) const noexcept
+{
+    transform(data, true);
+}
+
+void Fft::transform(double* data, bool inverseSign) const noexcept
+{
+    for (int i = 0; i < n; ++i) {
+        const int j = bitReverse[static_cast<size_t>(i)];
+        if (i < j) {
+            std::swap(data[2 * i], data[2 * j]);
+            std::swap(data[2 * i + 1], data[2 * j + 1]);
+        }
+    }
+
+    const double sign = inverseSign ? -1.0 : 1.0;
+    for (int len = 2; len <= n; len <<= 1) {
+        const int halfLen = len / 2;
+        const int stride = n / len;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < halfLen; ++j) {
+                const double wRe = twiddleRe[static_cast<size_t>(j * stride)];
+                const double wIm = sign * twiddleIm[static_cast<size_t>(j * stride)];
+                const int a = i + j;
+                const int b = a + halfLen;
+                const double tRe = wRe * data[2 * b] - wIm * data[2 * b + 1];
+                const double tIm = wRe * data[2 * b + 1] + wIm * data[2 * b];
+                data[2 * b] = data[2 * a] - tRe;
+                data[2 * b + 1] = data[2 * a + 1] - tIm;
+                data[2 * a] += tRe;
+                data[2 * a + 1] += tIm;
+            }
+        }
+    }
+}
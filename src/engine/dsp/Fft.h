@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+// Radix-2 complex FFT with precomputed bit-reversal and twiddle tables.
+// Data is interleaved complex: [re0, im0, re1, im1, ...].  Size must be a
+// power of two.  Build once per size and reuse across frames.
+class Fft
+{
+public:
+    explicit Fft(int size);
+
+    int size() const noexcept { return n; }
+
+    void forward(double* data) const noexcept;
+
+    // Unnormalised inverse (caller divides by size() if needed).
+    void inverse(double* data) const noexcept;
+
+    static int nextPowerOfTwo(int value) noexcept;
+
+private:
+    void transform(double* data, bool inverseSign) const noexcept;
+
+    int n { 0 };
+    std::vector<int> bitReverse;
+    std::vector<double> twiddleRe;
+    std::vector<double> twiddleIm;
+};
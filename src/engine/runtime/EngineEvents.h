@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/domain/DeckId.h"
+
+namespace ngks {
+
+enum class EngineEventType : uint8_t {
+    TransportChanged = 0,   // value = TransportState
+    LoadComplete = 1,       // LoadTrack applied; value = trackLoadGen (low 32 bits)
+    DecodeProgress = 2,     // fraction = decoded / total
+    DecodeComplete = 3,     // waveform pyramid is complete
+    AnalysisResult = 4,     // value = jobId, fraction = progress
+    DeviceLost = 5,
+    DeviceRecovered = 6
+};
+
+struct EngineEvent {
+    EngineEventType type{EngineEventType::TransportChanged};
+    DeckId deck{0};
+    uint32_t value{0};
+    float fraction{0.0f};
+};
+
+/// Bounded multi-producer / single-consumer event queue.
+///
+/// push() is lock-free and allocation-free, so the audio thread may call it
+/// (from publishSnapshot); a full queue drops the event and counts it.
+/// Producers on ordinary threads use publish(), which also fires the
+/// wakeup.  The wakeup is edge-triggered: it runs once after the consumer's
+/// rearm(), however many events arrive before the next drain, so the UI
+/// sees one queued call per burst.  The consumer drains as
+/// rearm(); while (pop(e)) ... so nothing published after rearm() is missed.
+template <size_t Capacity>
+class EngineEventQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power-of-two");
+
+public:
+    using WakeFn = void (*)(void* context);
+
+    EngineEventQueue() noexcept
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(Capacity); ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const EngineEvent& event) noexcept
+    {
+        uint32_t pos = enqueueIndex.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &slots[pos & mask];
+            const uint32_t seq = slot->sequence.load(std::memory_order_acquire);
+            const int32_t diff = static_cast<int32_t>(seq - pos);
+            if (diff == 0) {
+                if (enqueueIndex.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                droppedCount.fetch_add(1u, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = enqueueIndex.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->event = event;
+        slot->sequence.store(pos + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /// Not for the audio thread: the wakeup may take locks.
+    bool publish(const EngineEvent& event) noexcept
+    {
+        const bool pushed = push(event);
+        wake();
+        return pushed;
+    }
+
+    bool pop(EngineEvent& out) noexcept
+    {
+        Slot& slot = slots[dequeueIndex & mask];
+        const uint32_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(seq - (dequeueIndex + 1u)) < 0) {
+            return false;
+        }
+
+        out = slot.event;
+        slot.sequence.store(dequeueIndex + static_cast<uint32_t>(Capacity), std::memory_order_release);
+        ++dequeueIndex;
+        return true;
+    }
+
+    void setWakeup(WakeFn fn, void* context) noexcept
+    {
+        wakeContext.store(context, std::memory_order_relaxed);
+        wakeFn.store(fn, std::memory_order_release);
+    }
+
+    void wake() noexcept
+    {
+        if (wakePending.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        const WakeFn fn = wakeFn.load(std::memory_order_acquire);
+        if (fn != nullptr) {
+            fn(wakeContext.load(std::memory_order_relaxed));
+        }
+    }
+
+    void rearm() noexcept { wakePending.store(false, std::memory_order_release); }
+
+    uint64_t dropped() const noexcept { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence { 0 };
+        EngineEvent event {};
+    };
+
+    static constexpr uint32_t mask = static_cast<uint32_t>(Capacity - 1u);
+    std::array<Slot, Capacity> slots {};
+    std::atomic<uint32_t> enqueueIndex { 0 };
+    uint32_t dequeueIndex { 0 };
+    std::atomic<bool> wakePending { false };
+    std::atomic<WakeFn> wakeFn { nullptr };
+    std::atomic<void*> wakeContext { nullptr };
+    std::atomic<uint64_t> droppedCount { 0 };
+};
+
+}
@@ -62,6 +62,14 @@ struct DeckSnapshot {
     bool cueEnabled{false};
     bool muted{false};
     FxSlotState fxSlots[4] {};
+
+    // Change versions, bumped by the engine when the published value of a
+    // field group differs from the previous snapshot.  Readers compare
+    // against the version they last rendered instead of diffing fields.
+    uint32_t transportVersion{0};   // transport, lifecycle
+    uint32_t trackVersion{0};       // hasTrack, track id/label, length, trackLoadGen
+    uint32_t analysisVersion{0};    // cached BPM / loudness / dead air / stems / status
+    uint32_t routingVersion{0};     // gain, mute, cue, routing, FX slots
 };
 
 struct EngineSnapshot {
@@ -84,6 +92,8 @@ struct EngineSnapshot {
 
     uint32_t lastProcessedCommandSeq{0};
     CommandResult lastCommandResult[MAX_DECKS] {};
+
+    uint32_t deviceVersion{0};      // SNAP_AUDIO_RUNNING / SNAP_DJ_DEVICE_LOST
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "engine/runtime/SpectrumTap.h"
+
+#include "engine/dsp/Fft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace ngks {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint64_t kRingMask = static_cast<uint64_t>(SpectrumTap::kRingSize - 1);
+constexpr int kHopFrames = SpectrumTap::kFftSize / 4;
+constexpr float kFloorDb = -72.0f;
+constexpr float kAttack = 0.6f;
+constexpr float kRelease = 0.15f;
+constexpr int kPeakHoldFrames = 30;          // ~0.5 s at the worker's rate
+constexpr float kPeakFall = 0.02f;
+constexpr auto kWorkerPeriod = std::chrono::milliseconds(16);
+
+static_assert((SpectrumTap::kRingSize & (SpectrumTap::kRingSize - 1)) == 0,
+              "ring size must be a power of two");
+static_assert(SpectrumTap::kRingSize >= 4 * SpectrumTap::kFftSize,
+              "ring must hold several analysis windows");
+}
+
+SpectrumTap::SpectrumTap() = default;
+
+SpectrumTap::~SpectrumTap()
+{
+    stop();
+}
+
+void SpectrumTap::start()
+{
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    worker_ = std::thread([this]() { workerLoop(); });
+}
+
+void SpectrumTap::stop()
+{
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void SpectrumTap::setSampleRate(double sampleRate) noexcept
+{
+    sampleRate_.store(sampleRate > 0.0 ? sampleRate : 48000.0, std::memory_order_relaxed);
+}
+
+void SpectrumTap::write(const float* left, const float* right, int numFrames) noexcept
+{
+    if (left == nullptr || numFrames <= 0) {
+        return;
+    }
+    if (right == nullptr) {
+        right = left;
+    }
+
+    const uint64_t start = written_.load(std::memory_order_relaxed);
+    uint64_t skip = 0;
+    if (numFrames > kRingSize) {
+        skip = static_cast<uint64_t>(numFrames - kRingSize);
+    }
+    const size_t count = static_cast<size_t>(numFrames) - static_cast<size_t>(skip);
+    const size_t pos = static_cast<size_t>((start + skip) & kRingMask);
+    const size_t first = std::min(count, static_cast<size_t>(kRingSize) - pos);
+
+    std::memcpy(ringL_.data() + pos, left + skip, first * sizeof(float));
+    std::memcpy(ringR_.data() + pos, right + skip, first * sizeof(float));
+    if (first < count) {
+        std::memcpy(ringL_.data(), left + skip + first, (count - first) * sizeof(float));
+        std::memcpy(ringR_.data(), right + skip + first, (count - first) * sizeof(float));
+    }
+
+    written_.store(start + static_cast<uint64_t>(numFrames), std::memory_order_release);
+}
+
+bool SpectrumTap::latest(SpectrumFrame& out) noexcept
+{
+    if ((middle_.load(std::memory_order_acquire) & kFreshBit) == 0u) {
+        return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & 3u;
+    out = frames_[front_];
+    return true;
+}
+
+bool SpectrumTap::copyNewest(float* mono) const noexcept
+{
+    const uint64_t end = written_.load(std::memory_order_acquire);
+    if (end < static_cast<uint64_t>(kFftSize)) {
+        return false;
+    }
+    const uint64_t begin = end - kFftSize;
+    for (int i = 0; i < kFftSize; ++i) {
+        const size_t idx = static_cast<size_t>((begin + static_cast<uint64_t>(i)) & kRingMask);
+        mono[i] = 0.5f * (ringL_[idx] + ringR_[idx]);
+    }
+
+    // The writer may have lapped the window while it was being copied.
+    const uint64_t after = written_.load(std::memory_order_acquire);
+    return after - begin <= static_cast<uint64_t>(kRingSize);
+}
+
+void SpectrumTap::analyze(const float* mono, double sampleRate, std::vector<double>& data,
+                          SpectrumFrame& frame)
+{
+    static const Fft fft(kFftSize);
+    static const std::vector<double> window = []() {
+        std::vector<double> w(static_cast<size_t>(kFftSize));
+        for (int i = 0; i < kFftSize; ++i) {
+            w[static_cast<size_t>(i)] = 0.5 - 0.5 * std::cos(2.0 * kPi * i / (kFftSize - 1));
+        }
+        return w;
+    }();
+    // Hann coherent gain is 1/2: a full-scale sine reads 0 dB.
+    constexpr double kAmpScale = 4.0 / kFftSize;
+
+    data.resize(static_cast<size_t>(kFftSize) * 2u);
+    for (int i = 0; i < kFftSize; ++i) {
+        data[2u * static_cast<size_t>(i)] = mono[i] * window[static_cast<size_t>(i)];
+        data[2u * static_cast<size_t>(i) + 1u] = 0.0;
+    }
+    fft.forward(data.data());
+
+    const int half = kFftSize / 2;
+    auto magnitude = [&](int k) {
+        const double re = data[2u * static_cast<size_t>(k)];
+        const double im = data[2u * static_cast<size_t>(k) + 1u];
+        return std::sqrt(re * re + im * im) * kAmpScale;
+    };
+
+    const double maxHz = std::min(kMaxHz, sampleRate * 0.5);
+    const double ratio = std::log(maxHz / kMinHz);
+    const double binHz = sampleRate / kFftSize;
+
+    for (int b = 0; b < SpectrumFrame::kBarCount; ++b) {
+        const double f0 = kMinHz * std::exp(ratio * b / SpectrumFrame::kBarCount);
+        const double f1 = kMinHz * std::exp(ratio * (b + 1) / SpectrumFrame::kBarCount);
+        const double k0 = f0 / binHz;
+        const double k1 = f1 / binHz;
+
+        double amp = 0.0;
+        if (k1 - k0 < 1.0) {
+            // Narrower than a bin (low end): interpolate at the bar centre.
+            const double kc = std::clamp(0.5 * (k0 + k1), 1.0, static_cast<double>(half - 2));
+            const int ki = static_cast<int>(kc);
+            const double t = kc - ki;
+            amp = magnitude(ki) * (1.0 - t) + magnitude(ki + 1) * t;
+        } else {
+            const int first = std::max(1, static_cast<int>(std::ceil(k0)));
+            const int last = std::min(half - 1, static_cast<int>(std::floor(k1)));
+            for (int k = first; k <= last; ++k) {
+                amp = std::max(amp, magnitude(k));
+            }
+        }
+
+        const float db = (amp > 1.0e-9) ? static_cast<float>(20.0 * std::log10(amp)) : kFloorDb;
+        const float level = std::clamp((db - kFloorDb) / -kFloorDb, 0.0f, 1.0f);
+
+        float& s = smoothed_[static_cast<size_t>(b)];
+        s += (level - s) * (level > s ? kAttack : kRelease);
+
+        float& peak = peakHold_[static_cast<size_t>(b)];
+        int& age = peakAge_[static_cast<size_t>(b)];
+        if (s >= peak) {
+            peak = s;
+            age = 0;
+        } else if (++age > kPeakHoldFrames) {
+            peak = std::max(s, peak - kPeakFall);
+        }
+
+        frame.bars[static_cast<size_t>(b)] = s;
+        frame.peaks[static_cast<size_t>(b)] = peak;
+    }
+}
+
+void SpectrumTap::workerLoop()
+{
+    std::vector<float> mono(static_cast<size_t>(kFftSize));
+    std::vector<double> scratch;
+    bool active = false;
+
+    while (running_.load(std::memory_order_acquire)) {
+        const uint64_t end = written_.load(std::memory_order_acquire);
+        const bool fresh = end >= analyzedUpTo_ + static_cast<uint64_t>(kHopFrames);
+
+        if (fresh && copyNewest(mono.data())) {
+            analyzedUpTo_ = end;
+            active = true;
+        } else if (active) {
+            // No new audio (stopped or paused): let the bars fall.
+            std::fill(mono.begin(), mono.end(), 0.0f);
+            active = std::any_of(smoothed_.begin(), smoothed_.end(), [](float v) { return v > 0.001f; })
+                  || std::any_of(peakHold_.begin(), peakHold_.end(), [](float v) { return v > 0.001f; });
+        } else {
+            std::this_thread::sleep_for(kWorkerPeriod);
+            continue;
+        }
+
+        SpectrumFrame& frame = frames_[back_];
+        analyze(mono.data(), sampleRate_.load(std::memory_order_relaxed), scratch, frame);
+        frame.seq = ++seq_;
+        back_ = middle_.exchange(back_ | kFreshBit, std::memory_order_acq_rel) & 3u;
+
+        std::this_thread::sleep_for(kWorkerPeriod);
+    }
+}
+
+}
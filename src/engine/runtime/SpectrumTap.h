@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace ngks {
+
+/// One published analyzer frame: log-frequency bars in [0, 1] plus their
+/// peak-hold markers.  seq increases with every frame.
+struct SpectrumFrame {
+    static constexpr int kBarCount = 128;
+
+    std::array<float, kBarCount> bars {};
+    std::array<float, kBarCount> peaks {};
+    uint64_t seq { 0 };
+};
+
+/// Spectrum analyzer fed from the master bus.
+///
+/// The audio thread calls write() after MasterBus::process: two memcpys into
+/// a ring of recent samples and one release store, never blocking and never
+/// waiting for a reader (old samples are simply overwritten).  A worker
+/// thread picks up the newest kFftSize samples about 60 times a second,
+/// runs a Hann-windowed FFT, folds the bins into kBarCount log-spaced bars
+/// between kMinHz and kMaxHz, applies attack/release smoothing and peak
+/// hold, and publishes the frame through a triple buffer that the UI reads
+/// with latest().
+class SpectrumTap {
+public:
+    static constexpr int    kFftSize  = 2048;
+    static constexpr int    kRingSize = 16384;       // frames per channel, power of two
+    static constexpr double kMinHz    = 30.0;
+    static constexpr double kMaxHz    = 16000.0;
+
+    SpectrumTap();
+    ~SpectrumTap();
+
+    SpectrumTap(const SpectrumTap&) = delete;
+    SpectrumTap& operator=(const SpectrumTap&) = delete;
+
+    void start();
+    void stop();
+
+    void setSampleRate(double sampleRate) noexcept;
+
+    /// Audio thread only.
+    void write(const float* left, const float* right, int numFrames) noexcept;
+
+    /// Single reader (the UI): copies the newest frame into out, or returns
+    /// false if none was published since the previous call.
+    bool latest(SpectrumFrame& out) noexcept;
+
+private:
+    void workerLoop();
+    bool copyNewest(float* mono) const noexcept;
+    void analyze(const float* mono, double sampleRate, std::vector<double>& scratch,
+                 SpectrumFrame& frame);
+
+    // ── Sample ring (single writer: the audio thread) ──
+    std::array<float, kRingSize> ringL_ {};
+    std::array<float, kRingSize> ringR_ {};
+    std::atomic<uint64_t> written_ { 0 };        // total frames written
+    std::atomic<double>   sampleRate_ { 48000.0 };
+
+    // ── Frame handoff: worker owns back_, reader owns front_, the
+    //    third slot is exchanged through middle_ (bit 2 = fresh) ──
+    static constexpr uint32_t kFreshBit = 4u;
+    std::array<SpectrumFrame, 3> frames_ {};
+    uint32_t back_ { 0 };
+    uint32_t front_ { 1 };
+    std::atomic<uint32_t> middle_ { 2 };
+
+    // Worker-side analysis state
+    std::array<float, SpectrumFrame::kBarCount> smoothed_ {};
+    std::array<float, SpectrumFrame::kBarCount> peakHold_ {};
+    std::array<int,   SpectrumFrame::kBarCount> peakAge_ {};
+    uint64_t analyzedUpTo_ { 0 };
+    uint64_t seq_ { 0 };
+
+    std::atomic<bool> running_ { false };
+    std::thread worker_;
+};
+
+}
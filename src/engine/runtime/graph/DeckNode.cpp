@@ -41,6 +41,12 @@ void DeckNode::prepare(double sampleRate)
     }
 }
 
+void DeckNode::setDecodeListener(DecodeListener listener, void* context) noexcept
+{
+    decodeListenerContext_ = context;
+    decodeListener_ = listener;
+}
+
 void DeckNode::beginStopFade(int fadeSamples) noexcept
 {
     std::unique_lock<std::shared_mutex> lock(bufferMutex_);
@@ -107,6 +113,15 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
     ngks::audioTrace("TRACK_LOAD_HEADER", "frames=%lld sr=%.0f ch=%d elapsedUs=%lld",
                      (long long)numFrames, sr, numChannels, elapsedUs());
 
+    // Waveform pyramid: straight from the cache when this file was decoded
+    // before, otherwise built from the chunks as they are decoded.
+    auto pyramid = std::make_shared<WaveformPyramid>(numFrames, sr);
+    const int64_t sourceSize = file.getSize();
+    const int64_t sourceMtimeMs = file.getLastModificationTime().toMilliseconds();
+    const bool pyramidCached = pyramid->loadCache(path, sourceSize, sourceMtimeMs);
+    ngks::audioTrace("TRACK_LOAD_WAVEFORM_CACHE", "hit=%d elapsedUs=%lld",
+                     pyramidCached ? 1 : 0, elapsedUs());
+
     // Only allocate the preload portion (~2MB) on the hot path — NOT the
     // full file (~100MB).  Background thread handles full allocation.
     constexpr int64_t kPreloadSeconds = 5;
@@ -134,6 +149,14 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
     ngks::audioTrace("TRACK_LOAD_DECODE_PRELOAD", "preloadFrames=%lld preloadMs=%lld elapsedUs=%lld",
                      (long long)preloadFrames, elapsedMs(), elapsedUs());
 
+    if (!pyramidCached) {
+        pyramid->append(newL.data(), newR.data(), preloadFrames);
+        if (preloadFrames >= numFrames) {
+            pyramid->finish();
+            pyramid->saveCache(path, sourceSize, sourceMtimeMs);
+        }
+    }
+
     const double duration = static_cast<double>(numFrames) / sr;
 
     // Swap preload-sized buffers into RT — deck becomes playable NOW
@@ -147,6 +170,7 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
         fileSampleRate_ = sr;
         fileDurationSeconds_ = duration;
         hasAudioData_ = true;
+        pyramid_ = pyramid;
         diagFirstNonzero_ = false;
         readPosition_.store(0, std::memory_order_release);
         fractionalReadPos_ = 0.0;
@@ -160,6 +184,12 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
                          swapUs, elapsedUs());
     }
 
+    const DecodeListener listener = decodeListener_;
+    void* const listenerContext = decodeListenerContext_;
+    if (listener != nullptr) {
+        listener(listenerContext, preloadFrames, numFrames, preloadFrames >= numFrames);
+    }
+
     outDurationSeconds = duration;
     ngks::audioTrace("TRACK_LOAD_PRELOAD_DONE", "path=%s frames=%lld preloadFrames=%lld "
                      "dur=%.2fs ch=%d preloadMs=%lld totalMs=%lld",
@@ -170,7 +200,9 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
     // Background thread: allocate full buffer, decode entire file, swap in
     if (preloadFrames < numFrames) {
         streamDecodeThread_ = std::thread(
-            [this, reader = std::move(reader), preloadFrames, numFrames, numChannels]() mutable {
+            [this, reader = std::move(reader), preloadFrames, numFrames, numChannels,
+             pyramid, pyramidCached, path, sourceSize, sourceMtimeMs,
+             listener, listenerContext]() mutable {
                 const auto bgT0 = Clock::now();
                 // Full allocation happens here, OFF the hot path
                 std::vector<float> fullL(static_cast<size_t>(numFrames), 0.0f);
@@ -183,6 +215,7 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
                 // Decode entire file from the beginning
                 constexpr int64_t bgChunk = 65536;
                 int64_t decodedUpTo = 0;
+                int64_t reportedPercent = preloadFrames * 100 / numFrames;
                 for (int64_t pos = 0; pos < numFrames; pos += bgChunk) {
                     if (streamCancelled_.load(std::memory_order_acquire))
                         break;
@@ -194,9 +227,26 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
                                     static_cast<size_t>(remaining) * sizeof(float));
                     }
                     decodedUpTo = pos + remaining;
+                    // The pyramid already has the preload; feed what lies past it.
+                    if (!pyramidCached && decodedUpTo > preloadFrames) {
+                        const int64_t from = std::max(pos, preloadFrames);
+                        pyramid->append(fullL.data() + from, fullR.data() + from,
+                                        decodedUpTo - from);
+                    }
+                    const int64_t percent = decodedUpTo * 100 / numFrames;
+                    if (listener != nullptr && percent >= reportedPercent + 5 && decodedUpTo < numFrames) {
+                        reportedPercent = percent;
+                        listener(listenerContext, decodedUpTo, numFrames, false);
+                    }
                 }
                 reader.reset();
 
+                if (!pyramidCached && !streamCancelled_.load(std::memory_order_acquire)) {
+                    pyramid->finish();
+                    const bool saved = pyramid->saveCache(path, sourceSize, sourceMtimeMs);
+                    ngks::audioTrace("TRACK_LOAD_WAVEFORM_SAVED", "ok=%d", saved ? 1 : 0);
+                }
+
                 if (!streamCancelled_.load(std::memory_order_acquire)) {
                     // Atomic swap: brief write-lock, just pointer moves
                     std::unique_lock<std::shared_mutex> lock(bufferMutex_);
@@ -204,6 +254,9 @@ bool DeckNode::loadFile(const std::string& path, double& outDurationSeconds)
                     decodedR_ = std::move(fullR);
                     streamDecodedFrames_.store(decodedUpTo, std::memory_order_release);
                 }
+                if (listener != nullptr && !streamCancelled_.load(std::memory_order_acquire)) {
+                    listener(listenerContext, decodedUpTo, numFrames, true);
+                }
 
                 const auto bgTotalMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                     Clock::now() - bgT0).count();
@@ -235,6 +288,7 @@ void DeckNode::unloadFile() noexcept
     fileSampleRate_ = 0.0;
     fileDurationSeconds_ = 0.0;
     hasAudioData_ = false;
+    pyramid_.reset();
     diagFirstNonzero_ = false;
     readPosition_.store(0, std::memory_order_relaxed);
     fractionalReadPos_ = 0.0;
@@ -271,144 +325,27 @@ std::string DeckNode::loadedFilePath() const
     return loadedFilePath_;
 }
 
-std::vector<WaveMinMax> DeckNode::generateWaveformOverview(int numBins) const
+std::shared_ptr<const WaveformPyramid> DeckNode::waveformPyramid() const
 {
-    if (numBins <= 0) return {};
     std::shared_lock<std::shared_mutex> lock(bufferMutex_);
-    const int64_t frames = streamDecodedFrames_.load(std::memory_order_acquire);
-    if (!hasAudioData_ || frames <= 0 || decodedL_.empty()) {
-        return std::vector<WaveMinMax>(static_cast<size_t>(numBins), {0.0f, 0.0f});
-    }
-
-    std::vector<WaveMinMax> bins(static_cast<size_t>(numBins));
-    const float* srcL = decodedL_.data();
-    const float* srcR = decodedR_.empty() ? nullptr : decodedR_.data();
-    const int64_t usableFrames = std::min(frames, static_cast<int64_t>(decodedL_.size()));
-
-    // True min/max + RMS per bucket.
-    // min/max captures transient peaks; RMS captures energy envelope.
-    // At overview zoom (~4K samples/bin), RMS shows honest loudness.
-    // At zoomed-in views (~few hundred samples/bin), min/max shows real shape.
-    for (int b = 0; b < numBins; ++b) {
-        const int64_t startF = (usableFrames * b) / numBins;
-        const int64_t endF = (usableFrames * (b + 1)) / numBins;
-        const int64_t count = endF - startF;
-        if (count <= 0) {
-            bins[static_cast<size_t>(b)] = {0.0f, 0.0f, 0.0f};
-            continue;
-        }
+    return hasAudioData_ ? pyramid_ : nullptr;
+}
 
-        float lo = srcL[startF];
-        float hi = srcL[startF];
-        double sumSq = 0.0;
-        for (int64_t f = startF; f < endF; ++f) {
-            const float vL = srcL[f];
-            lo = std::min(lo, vL);
-            hi = std::max(hi, vL);
-            float absV = std::abs(vL);
-            if (srcR) {
-                const float vR = srcR[f];
-                lo = std::min(lo, vR);
-                hi = std::max(hi, vR);
-                absV = std::max(absV, std::abs(vR));
-            }
-            sumSq += static_cast<double>(absV) * static_cast<double>(absV);
-        }
-        const float rms = static_cast<float>(std::sqrt(sumSq / static_cast<double>(count)));
-        bins[static_cast<size_t>(b)] = {lo, hi, rms};
-    }
+std::vector<WaveMinMax> DeckNode::generateWaveformOverview(int numBins) const
+{
+    if (numBins <= 0) return {};
+    std::vector<WaveMinMax> bins(static_cast<size_t>(numBins), {0.0f, 0.0f, 0.0f});
+    if (const auto pyramid = waveformPyramid())
+        pyramid->overview(numBins, &bins, nullptr);
     return bins;
 }
 
 std::vector<BandEnergy> DeckNode::generateBandEnergyOverview(int numBins) const
 {
     if (numBins <= 0) return {};
-    std::shared_lock<std::shared_mutex> lock(bufferMutex_);
-    const int64_t frames = streamDecodedFrames_.load(std::memory_order_acquire);
-    if (!hasAudioData_ || frames <= 0 || decodedL_.empty()) {
-        return std::vector<BandEnergy>(static_cast<size_t>(numBins), {0.0f, 0.0f, 0.0f, 0.0f});
-    }
-
-    std::vector<BandEnergy> bands(static_cast<size_t>(numBins));
-    const float* srcL = decodedL_.data();
-    const float* srcR = decodedR_.empty() ? nullptr : decodedR_.data();
-    const int64_t usableFrames = std::min(frames, static_cast<int64_t>(decodedL_.size()));
-
-    // Lightweight 4-band estimation via inter-sample-difference partitioning.
-    // 
-    // 1st difference (d1): sample[n] - sample[n-1]  → HF-weighted
-    // 2nd difference (d2): d1[n] - d1[n-1]          → even more HF-weighted
-    //
-    // Energy ratios from d1 and d2 vs total energy separate 4 frequency
-    // regions without FFT:
-    //   low     = slow-changing energy (bass/sub)
-    //   lowMid  = moderate-changing energy (body/warmth)
-    //   highMid = faster-changing energy (vocals/presence)
-    //   high    = rapid-changing energy (cymbals/air)
-    for (int b = 0; b < numBins; ++b) {
-        const int64_t startF = (usableFrames * b) / numBins;
-        const int64_t endF   = (usableFrames * (b + 1)) / numBins;
-        const int64_t count  = endF - startF;
-        if (count <= 2) {
-            bands[static_cast<size_t>(b)] = {0.0f, 0.0f, 0.0f, 0.0f};
-            continue;
-        }
-
-        double sumSq = 0.0;
-        double diff1SumSq = 0.0;
-        double diff2SumSq = 0.0;
-        float prevSample = srcL[startF];
-        if (srcR) prevSample = (prevSample + srcR[startF]) * 0.5f;
-        float prevDiff = 0.0f;
-
-        for (int64_t f = startF; f < endF; ++f) {
-            float v = srcL[f];
-            if (srcR) v = (v + srcR[f]) * 0.5f;
-
-            sumSq += static_cast<double>(v * v);
-
-            const float d1 = v - prevSample;
-            diff1SumSq += static_cast<double>(d1 * d1);
-
-            if (f > startF) {
-                const float d2 = d1 - prevDiff;
-                diff2SumSq += static_cast<double>(d2 * d2);
-            }
-
-            prevSample = v;
-            prevDiff = d1;
-        }
-
-        const float totalE = static_cast<float>(std::sqrt(sumSq / static_cast<double>(count)));
-        const float d1E    = static_cast<float>(std::sqrt(diff1SumSq / static_cast<double>(count)));
-        const float d2E    = static_cast<float>(std::sqrt(diff2SumSq / static_cast<double>(count - 1)));
-
-        if (totalE < 0.0001f) {
-            bands[static_cast<size_t>(b)] = {0.0f, 0.0f, 0.0f, 0.0f};
-            continue;
-        }
-
-        // d1 ratio = overall HF content, d2 ratio = very-HF content
-        const float d1Ratio = std::min(1.0f, d1E / (totalE * 2.0f));
-        const float d2Ratio = std::min(1.0f, d2E / (totalE * 3.0f));
-
-        // 4-band split:
-        //   high    = d2-weighted (very rapid changes)
-        //   highMid = d1 minus d2 (moderate-rapid changes)
-        //   lowMid  = residual mid energy
-        //   low     = slow-changing energy
-        const float highFrac   = std::min(0.5f, d2Ratio);
-        const float hMidFrac   = std::max(0.0f, std::min(0.5f, d1Ratio - highFrac));
-        const float lowFrac    = std::max(0.0f, 1.0f - d1Ratio * 2.5f);
-        const float lMidFrac   = std::max(0.0f, 1.0f - lowFrac - hMidFrac - highFrac);
-
-        bands[static_cast<size_t>(b)] = {
-            totalE * lowFrac,      // low  (bass/sub)
-            totalE * lMidFrac,     // lowMid (body/warmth)
-            totalE * hMidFrac,     // highMid (vocals/presence)
-            totalE * highFrac      // high (cymbals/air)
-        };
-    }
+    std::vector<BandEnergy> bands(static_cast<size_t>(numBins), {0.0f, 0.0f, 0.0f, 0.0f});
+    if (const auto pyramid = waveformPyramid())
+        pyramid->overview(numBins, nullptr, &bands);
     return bands;
 }
 
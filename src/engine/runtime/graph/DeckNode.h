@@ -11,33 +11,24 @@
 #include <juce_audio_formats/juce_audio_formats.h>
 
 #include "engine/runtime/EngineSnapshot.h"
+#include "engine/runtime/graph/WaveformPyramid.h"
 
 namespace ngks {
 
-/// Min/max + RMS waveform bucket — true audio shape per time slice.
-/// lo/hi preserve transient peaks; rms shows energy envelope.
-struct WaveMinMax {
-    float lo;   ///< most negative sample value in bucket
-    float hi;   ///< most positive sample value in bucket
-    float rms;  ///< root-mean-square energy of bucket
-};
-
-/// Broad frequency-band energy per time slice.
-/// Lightweight analysis — NOT stem separation. Uses time-domain
-/// inter-sample-difference technique to estimate spectral distribution.
-struct BandEnergy {
-    float low;      ///< low-frequency energy (bass / sub)
-    float lowMid;   ///< low-mid energy (body / warmth)
-    float highMid;  ///< high-mid energy (vocals / presence)
-    float high;     ///< high-frequency energy (hats / cymbals / air)
-};
-
 class DeckNode {
 public:
+    /// Decode progress of the current load: called on the loading thread for
+    /// the preload and on the stream-decode thread after that, every ~5% and
+    /// once with complete=true when the whole file and its waveform pyramid
+    /// are in place.  Not called for a load that was cancelled.
+    using DecodeListener = void (*)(void* context, int64_t decodedFrames, int64_t totalFrames,
+                                    bool complete);
+
     DeckNode();
     ~DeckNode();
 
     void prepare(double sampleRate);
+    void setDecodeListener(DecodeListener listener, void* context) noexcept;
     void beginStopFade(int fadeSamples) noexcept;
     bool isStopFadeActive() const noexcept;
 
@@ -61,16 +52,19 @@ public:
     // Returns the playhead position in seconds based on the read cursor.
     double getPlayheadSeconds() const noexcept;
 
-    /// Generate a downsampled waveform overview using true min/max buckets.
+    /// Downsampled waveform overview using true min/max buckets.
     /// Returns a vector of `numBins` WaveMinMax pairs preserving peak/valley shape.
-    /// Thread-safe: acquires shared_lock on bufferMutex_.
+    /// Read from the waveform pyramid: O(numBins), no scan of the audio.
     std::vector<WaveMinMax> generateWaveformOverview(int numBins) const;
 
-    /// Generate broad frequency-band energy overview.
-    /// Lightweight time-domain analysis: inter-sample-difference partitioning.
-    /// Thread-safe: acquires shared_lock on bufferMutex_.
+    /// Broad frequency-band energy overview, from the waveform pyramid.
     std::vector<BandEnergy> generateBandEnergyOverview(int numBins) const;
 
+    /// Multi-resolution summary of the loaded track, filled in while the
+    /// file decodes (complete at once when it came from the waveform
+    /// cache).  Null if nothing is loaded.  Thread-safe.
+    std::shared_ptr<const WaveformPyramid> waveformPyramid() const;
+
     /// Returns true once the full file (not just preload) is decoded.
     bool isFullyDecoded() const noexcept;
 
@@ -109,9 +103,15 @@ private:
     std::atomic<int64_t> streamDecodedFrames_{0};
     std::atomic<bool> streamCancelled_{false};
     std::thread streamDecodeThread_;
+    DecodeListener decodeListener_{nullptr};
+    void* decodeListenerContext_{nullptr};
 
     // Track identity: file path of currently loaded audio
     std::string loadedFilePath_;
+
+    // Waveform summary of the loaded track; replaced (never reused) per load,
+    // so a cancelled decode only ever writes to its own.
+    std::shared_ptr<WaveformPyramid> pyramid_;
 };
 
 }
\ No newline at end of file
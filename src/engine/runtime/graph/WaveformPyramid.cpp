@@ -0,0 +1,400 @@
+#include "engine/runtime/graph/WaveformPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace ngks {
+
+namespace {
+constexpr const char* kCacheRelativeDir = "data/runtime/waveform_cache";
+constexpr char        kCacheMagic[4]    = { 'N', 'G', 'W', 'P' };
+constexpr uint32_t    kCacheVersion     = 2;
+constexpr int         kPackedPerBucket  = 3 + CrossoverFilterbank::kBandCount;
+
+// Cache quantisation: extremes as int16 over ±2.0, mean squares stored as
+// their root in uint16 over 0..4.0.
+constexpr float kQuantScale = 16383.0f;
+
+int16_t quantSigned(float v)
+{
+    return static_cast<int16_t>(std::lround(std::clamp(v, -2.0f, 2.0f) * kQuantScale));
+}
+
+uint16_t quantMs(float ms)
+{
+    const float r = std::sqrt(std::max(0.0f, ms));
+    return static_cast<uint16_t>(std::lround(std::min(r, 4.0f) * kQuantScale));
+}
+
+float dequantSigned(int16_t q) { return static_cast<float>(q) / kQuantScale; }
+
+float dequantMs(uint16_t q)
+{
+    const float r = static_cast<float>(q) / kQuantScale;
+    return r * r;
+}
+
+struct CacheHeader {
+    char     magic[4];
+    uint32_t version;
+    int64_t  sourceSize;
+    int64_t  sourceMtimeMs;
+    int64_t  totalFrames;
+    double   sampleRate;
+    uint32_t baseFrames;
+    uint32_t pathBytes;     // source path follows the header
+    uint64_t bucketCount;   // then bucketCount × kPackedPerBucket 16-bit values
+};
+}
+
+WaveformPyramid::WaveformPyramid(int64_t totalFrames, double sampleRate)
+    : totalFrames_(std::max<int64_t>(0, totalFrames))
+    , sampleRate_(sampleRate)
+{
+    levels_.emplace_back();
+    levels_[0].reserve(static_cast<size_t>(totalFrames_ / kBaseFrames + 1));
+    bands_.prepare(sampleRate_);
+}
+
+// ── Build ──────────────────────────────────────────────────────────────
+
+WaveformPyramid::Bucket WaveformPyramid::combine(const Bucket& a, const Bucket& b)
+{
+    Bucket r;
+    r.lo      = std::min(a.lo, b.lo);
+    r.hi      = std::max(a.hi, b.hi);
+    r.msPeak = 0.5f * (a.msPeak + b.msPeak);
+    for (int k = 0; k < CrossoverFilterbank::kBandCount; ++k)
+        r.msBand[k] = 0.5f * (a.msBand[k] + b.msBand[k]);
+    return r;
+}
+
+void WaveformPyramid::pushBase(const Bucket& b)
+{
+    levels_[0].push_back(b);
+    // Every second bucket completes a parent, which may complete its own.
+    for (size_t k = 0; levels_[k].size() % 2 == 0; ++k) {
+        const auto& lv = levels_[k];
+        const Bucket parent = combine(lv[lv.size() - 2], lv[lv.size() - 1]);
+        if (k + 1 == levels_.size()) levels_.emplace_back();
+        levels_[k + 1].push_back(parent);
+    }
+}
+
+void WaveformPyramid::closeLevels()
+{
+    // pushBase() only forms complete pairs, so a level of n buckets has
+    // floor(n/2) parents.  Bottom-up, give each level its last ceil(n/2)
+    // parent: a lone trailing bucket becomes its parent alone, and a parent
+    // level that grew to an even count gets its final pair combined.  Then
+    // every level covers the whole track and the top is one bucket.
+    for (size_t k = 0; k < levels_.size() && levels_[k].size() > 1; ++k) {
+        if (k + 1 == levels_.size()) levels_.emplace_back();
+        const size_t n = levels_[k].size();
+        while (levels_[k + 1].size() < (n + 1) / 2) {
+            const size_t j = 2 * levels_[k + 1].size();
+            const Bucket parent = j + 1 < n ? combine(levels_[k][j], levels_[k][j + 1])
+                                            : levels_[k][j];
+            levels_[k + 1].push_back(parent);
+        }
+    }
+}
+
+bool WaveformPyramid::checkLevels(int64_t maxBuckets, int64_t* failedCount)
+{
+    // Level-0 bucket i spans [i, i]; a parent's lo/hi then give the range of
+    // base buckets under it, which must tile the track at every level.
+    for (int64_t n = 1; n <= maxBuckets; ++n) {
+        WaveformPyramid p(n * kBaseFrames, 48000.0);
+        for (int64_t i = 0; i < n; ++i) {
+            Bucket b;
+            b.lo = b.hi = static_cast<float>(i);
+            p.pushBase(b);
+        }
+        p.closeLevels();
+
+        bool ok = p.levels_.back().size() == 1;
+        for (size_t k = 0; ok && k < p.levels_.size(); ++k) {
+            const int64_t width = int64_t{1} << k;
+            const auto& lv = p.levels_[k];
+            ok = static_cast<int64_t>(lv.size()) == (n + width - 1) / width;
+            for (size_t j = 0; ok && j < lv.size(); ++j) {
+                const int64_t first = static_cast<int64_t>(j) * width;
+                const int64_t last  = std::min(n, first + width) - 1;
+                ok = lv[j].lo == static_cast<float>(first) && lv[j].hi == static_cast<float>(last);
+            }
+        }
+        if (!ok) {
+            if (failedCount) *failedCount = n;
+            return false;
+        }
+    }
+    return true;
+}
+
+WaveformPyramid::Bucket WaveformPyramid::takeAccumulated()
+{
+    const double n = static_cast<double>(accFrames_);
+    acc_.msPeak = static_cast<float>(accPeakSq_ / n);
+    for (int k = 0; k < CrossoverFilterbank::kBandCount; ++k) {
+        acc_.msBand[k] = static_cast<float>(accBandSq_[k] / n);
+        accBandSq_[k] = 0.0;
+    }
+    accPeakSq_ = 0.0;
+    accFrames_ = 0;
+    return acc_;
+}
+
+void WaveformPyramid::append(const float* left, const float* right, int64_t numFrames)
+{
+    if (!left || numFrames <= 0) return;
+
+    // Accumulate outside the lock (the accumulator and filterbank are
+    // writer-only state), then publish the finished buckets in one short
+    // critical section.
+    std::vector<Bucket> done;
+    done.reserve(static_cast<size_t>(numFrames / kBaseFrames + 1));
+
+    for (int64_t f = 0; f < numFrames; ) {
+        // Up to the end of the current level-0 bucket.
+        const int n = static_cast<int>(std::min<int64_t>(kBaseFrames - accFrames_, numFrames - f));
+        const float* l = left + f;
+        const float* r = right ? right + f : l;
+
+        for (int i = 0; i < n; ++i) {
+            const float vL = l[i];
+            const float vR = r[i];
+            if (accFrames_ == 0 && i == 0) {
+                acc_.lo = std::min(vL, vR);
+                acc_.hi = std::max(vL, vR);
+            } else {
+                acc_.lo = std::min(acc_.lo, std::min(vL, vR));
+                acc_.hi = std::max(acc_.hi, std::max(vL, vR));
+            }
+            const float absV = std::max(std::abs(vL), std::abs(vR));
+            accPeakSq_ += static_cast<double>(absV) * absV;
+        }
+        bands_.accumulate(l, right ? r : nullptr, n, accBandSq_);
+
+        accFrames_ += n;
+        f += n;
+        if (accFrames_ == kBaseFrames) done.push_back(takeAccumulated());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (complete_) return;
+    for (const Bucket& b : done) pushBase(b);
+    framesCovered_ += numFrames;
+}
+
+void WaveformPyramid::finish()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (complete_) return;
+
+    if (accFrames_ > 0) pushBase(takeAccumulated());
+    closeLevels();
+    complete_ = true;
+}
+
+bool WaveformPyramid::isComplete() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return complete_;
+}
+
+int64_t WaveformPyramid::framesCovered() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return framesCovered_;
+}
+
+// ── Query ──────────────────────────────────────────────────────────────
+
+void WaveformPyramid::query(int64_t startFrame, int64_t endFrame, int columns,
+                            std::vector<WaveMinMax>* wave,
+                            std::vector<BandEnergy>* bands) const
+{
+    if (columns <= 0) return;
+    if (wave)  wave->assign(static_cast<size_t>(columns), {0.0f, 0.0f, 0.0f});
+    if (bands) bands->assign(static_cast<size_t>(columns), {0.0f, 0.0f, 0.0f, 0.0f});
+    startFrame = std::max<int64_t>(0, startFrame);
+    if (endFrame <= startFrame) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Coarsest level whose buckets are no wider than a column.
+    const double framesPerColumn = static_cast<double>(endFrame - startFrame) / columns;
+    size_t level = 0;
+    while (level + 1 < levels_.size()
+           && static_cast<double>(int64_t{kBaseFrames} << (level + 1)) <= framesPerColumn)
+        ++level;
+
+    const std::vector<Bucket>& lv = levels_[level];
+    const int64_t bucketFrames = int64_t{kBaseFrames} << level;
+    const int64_t available    = static_cast<int64_t>(lv.size());
+    const int64_t span         = endFrame - startFrame;
+
+    for (int c = 0; c < columns; ++c) {
+        const int64_t f0 = startFrame + span * c / columns;
+        const int64_t f1 = startFrame + span * (c + 1) / columns;
+        const int64_t b0 = f0 / bucketFrames;
+        const int64_t b1 = std::min(available,
+                                    std::max(b0 + 1, (f1 + bucketFrames - 1) / bucketFrames));
+        if (b0 >= b1) continue;     // not decoded yet
+
+        Bucket agg = lv[static_cast<size_t>(b0)];
+        for (int64_t b = b0 + 1; b < b1; ++b) {
+            const Bucket& x = lv[static_cast<size_t>(b)];
+            agg.lo = std::min(agg.lo, x.lo);
+            agg.hi = std::max(agg.hi, x.hi);
+            agg.msPeak += x.msPeak;
+            for (int k = 0; k < CrossoverFilterbank::kBandCount; ++k) agg.msBand[k] += x.msBand[k];
+        }
+        const float inv = 1.0f / static_cast<float>(b1 - b0);
+
+        if (wave) {
+            (*wave)[static_cast<size_t>(c)] = { agg.lo, agg.hi, std::sqrt(agg.msPeak * inv) };
+        }
+        if (bands) {
+            (*bands)[static_cast<size_t>(c)] = { std::sqrt(agg.msBand[0] * inv),
+                                                 std::sqrt(agg.msBand[1] * inv),
+                                                 std::sqrt(agg.msBand[2] * inv),
+                                                 std::sqrt(agg.msBand[3] * inv) };
+        }
+    }
+}
+
+void WaveformPyramid::overview(int columns, std::vector<WaveMinMax>* wave,
+                               std::vector<BandEnergy>* bands) const
+{
+    query(0, totalFrames_, columns, wave, bands);
+}
+
+// ── Cache file ─────────────────────────────────────────────────────────
+
+std::string WaveformPyramid::cachePathFor(const std::string& audioPath)
+{
+    uint64_t h = 1469598103934665603ull;        // FNV-1a 64
+    for (unsigned char ch : audioPath) {
+        h ^= ch;
+        h *= 1099511628211ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.wfp", static_cast<unsigned long long>(h));
+    return std::string(kCacheRelativeDir) + "/" + name;
+}
+
+bool WaveformPyramid::saveCache(const std::string& audioPath, int64_t sourceSize,
+                                int64_t sourceMtimeMs) const
+{
+    namespace fs = std::filesystem;
+
+    std::vector<uint16_t> packed;
+    CacheHeader header{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!complete_ || framesCovered_ != totalFrames_) return false;
+        const std::vector<Bucket>& base = levels_[0];
+        packed.reserve(base.size() * kPackedPerBucket);
+        for (const Bucket& b : base) {
+            packed.push_back(static_cast<uint16_t>(quantSigned(b.lo)));
+            packed.push_back(static_cast<uint16_t>(quantSigned(b.hi)));
+            packed.push_back(quantMs(b.msPeak));
+            for (float ms : b.msBand) packed.push_back(quantMs(ms));
+        }
+        header.bucketCount = base.size();
+    }
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version       = kCacheVersion;
+    header.sourceSize    = sourceSize;
+    header.sourceMtimeMs = sourceMtimeMs;
+    header.totalFrames   = totalFrames_;
+    header.sampleRate    = sampleRate_;
+    header.baseFrames    = kBaseFrames;
+    header.pathBytes     = static_cast<uint32_t>(audioPath.size());
+
+    const std::string path = cachePathFor(audioPath);
+
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+        if (!output.is_open()) return false;
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(audioPath.data(), static_cast<std::streamsize>(audioPath.size()));
+        output.write(reinterpret_cast<const char*>(packed.data()),
+                     static_cast<std::streamsize>(packed.size() * sizeof(uint16_t)));
+        if (!output.good()) {
+            output.close();
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(path, ec);
+        ec.clear();
+        fs::rename(tempPath, path, ec);
+    }
+    return !ec;
+}
+
+bool WaveformPyramid::loadCache(const std::string& audioPath, int64_t sourceSize,
+                                int64_t sourceMtimeMs)
+{
+    std::ifstream input(cachePathFor(audioPath), std::ios::binary);
+    if (!input.is_open()) return false;
+
+    CacheHeader header{};
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0
+            || header.version != kCacheVersion
+            || header.sourceSize != sourceSize
+            || header.sourceMtimeMs != sourceMtimeMs
+            || header.totalFrames != totalFrames_
+            || header.sampleRate != sampleRate_
+            || header.baseFrames != static_cast<uint32_t>(kBaseFrames)
+            || header.bucketCount != static_cast<uint64_t>((totalFrames_ + kBaseFrames - 1) / kBaseFrames)) {
+        return false;
+    }
+
+    // The name is a hash of the source path; the stored path rules out a
+    // collision.
+    std::string sourceKey(header.pathBytes, '\0');
+    if (!input.read(sourceKey.data(), static_cast<std::streamsize>(sourceKey.size()))
+            || sourceKey != audioPath) {
+        return false;
+    }
+
+    std::vector<uint16_t> packed(static_cast<size_t>(header.bucketCount) * kPackedPerBucket);
+    if (!input.read(reinterpret_cast<char*>(packed.data()),
+                    static_cast<std::streamsize>(packed.size() * sizeof(uint16_t)))) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (framesCovered_ != 0 || complete_) return false;
+    for (size_t i = 0; i < packed.size(); i += kPackedPerBucket) {
+        Bucket b;
+        b.lo     = dequantSigned(static_cast<int16_t>(packed[i]));
+        b.hi     = dequantSigned(static_cast<int16_t>(packed[i + 1]));
+        b.msPeak = dequantMs(packed[i + 2]);
+        for (int k = 0; k < CrossoverFilterbank::kBandCount; ++k)
+            b.msBand[k] = dequantMs(packed[i + 3 + static_cast<size_t>(k)]);
+        pushBase(b);
+    }
+    closeLevels();
+    framesCovered_ = totalFrames_;
+    complete_ = true;
+    return true;
+}
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "engine/dsp/CrossoverFilterbank.h"
+
+namespace ngks {
+
+/// Min/max + RMS waveform bucket — true audio shape per time slice.
+/// lo/hi preserve transient peaks; rms shows energy envelope.
+struct WaveMinMax {
+    float lo;   ///< most negative sample value in bucket
+    float hi;   ///< most positive sample value in bucket
+    float rms;  ///< root-mean-square energy of bucket
+};
+
+/// Broad frequency-band energy per time slice: RMS of each band of a
+/// 4-band Linkwitz-Riley crossover (see CrossoverFilterbank).
+/// NOT stem separation.
+struct BandEnergy {
+    float low;      ///< low-frequency energy (bass / sub)
+    float lowMid;   ///< low-mid energy (body / warmth)
+    float highMid;  ///< high-mid energy (vocals / presence)
+    float high;     ///< high-frequency energy (hats / cymbals / air)
+};
+
+/// Multi-resolution waveform summary of one track.
+///
+/// Level 0 holds one bucket per kBaseFrames frames; each level above halves
+/// the bucket count, up to a single bucket for the whole track.  Buckets keep
+/// extremes and mean squares, so a parent is exactly the combination of its
+/// children and any zoom is answered from the level whose buckets are just
+/// narrower than a pixel: query() touches O(pixels) buckets, whatever the
+/// track length.
+///
+/// Built incrementally by the decoder (append() per decoded chunk, finish()
+/// at the end) and readable from any thread while it grows; or loaded whole
+/// from a cache file written after an earlier decode of the same file.
+class WaveformPyramid {
+public:
+    static constexpr int kBaseFrames = 64;
+
+    /// Extremes + mean squares.
+    struct Bucket {
+        float lo{0.0f};
+        float hi{0.0f};
+        float msPeak{0.0f};     ///< mean of max(|L|,|R|)²  → rms
+        float msBand[CrossoverFilterbank::kBandCount]{};   ///< per band, both channels
+    };
+
+    WaveformPyramid(int64_t totalFrames, double sampleRate);
+
+    /// Decoder side, single writer: frames in order from frame 0.
+    /// right may be null (mono).
+    void append(const float* left, const float* right, int64_t numFrames);
+    void finish();
+
+    bool    isComplete() const;
+    int64_t framesCovered() const;
+    int64_t totalFrames() const noexcept { return totalFrames_; }
+    double  sampleRate() const noexcept { return sampleRate_; }
+
+    /// `columns` buckets spanning frames [startFrame, endFrame).  Columns
+    /// beyond framesCovered() are zero.  Either output may be null.
+    void query(int64_t startFrame, int64_t endFrame, int columns,
+               std::vector<WaveMinMax>* wave, std::vector<BandEnergy>* bands) const;
+
+    /// Whole track in `columns` buckets (the overview strip).
+    void overview(int columns, std::vector<WaveMinMax>* wave,
+                  std::vector<BandEnergy>* bands) const;
+
+    // ── Cache file ──
+    // Level 0 only, quantised to 16 bits; upper levels are rebuilt on load.
+    // Stored at cachePathFor(audioPath); sourceSize / sourceMtimeMs identify
+    // the file it was built from, and a mismatch (or any other format
+    // problem) fails the load.
+    bool saveCache(const std::string& audioPath, int64_t sourceSize, int64_t sourceMtimeMs) const;
+    bool loadCache(const std::string& audioPath, int64_t sourceSize, int64_t sourceMtimeMs);
+
+    /// data/runtime/waveform_cache/<hash of audioPath>.wfp
+    static std::string cachePathFor(const std::string& audioPath);
+
+    /// Builds pyramids of 1..maxBuckets level-0 buckets and checks that each
+    /// level spans the whole track.  On failure *failedCount is the first
+    /// bucket count that did not.
+    static bool checkLevels(int64_t maxBuckets, int64_t* failedCount = nullptr);
+
+private:
+    static Bucket combine(const Bucket& a, const Bucket& b);
+    Bucket takeAccumulated();                 // writer side
+    void pushBase(const Bucket& b);           // caller holds mutex_
+    void closeLevels();                       // caller holds mutex_
+
+    const int64_t totalFrames_;
+    const double  sampleRate_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::vector<Bucket>> levels_;
+    int64_t framesCovered_{0};
+    bool    complete_{false};
+
+    // Partial level-0 bucket carried between append() calls
+    CrossoverFilterbank bands_;
+    Bucket  acc_{};
+    double  accPeakSq_{0.0};
+    double  accBandSq_[CrossoverFilterbank::kBandCount]{};
+    int     accFrames_{0};
+};
+
+}
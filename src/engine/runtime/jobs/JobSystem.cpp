@@ -42,7 +42,9 @@ void JobSystem::cancel(uint32_t jobId) noexcept
 
 void JobSystem::publishSyntheticResult(const JobResult& result) noexcept
 {
-    results.push(result);
+    if (results.push(result) && resultListener != nullptr) {
+        resultListener(resultListenerContext, result);
+    }
 }
 
 bool JobSystem::tryPopResult(JobResult& out) noexcept
@@ -50,11 +52,17 @@ bool JobSystem::tryPopResult(JobResult& out) noexcept
     return results.pop(out);
 }
 
+void JobSystem::setResultListener(ResultListener listener, void* context) noexcept
+{
+    resultListenerContext = context;
+    resultListener = listener;
+}
+
 void JobSystem::onWorkerResult(void* context, const JobResult& result)
 {
     auto* self = static_cast<JobSystem*>(context);
-    if (self != nullptr) {
-        self->results.push(result);
+    if (self != nullptr && self->results.push(result) && self->resultListener != nullptr) {
+        self->resultListener(self->resultListenerContext, result);
     }
 }
 
@@ -49,6 +49,10 @@ private:
 
 class JobSystem {
 public:
+    /// Called on the producing thread right after a result is queued
+    /// (worker thread, or the caller of publishSyntheticResult).
+    using ResultListener = void (*)(void* context, const JobResult& result);
+
     JobSystem();
     ~JobSystem();
 
@@ -61,12 +65,17 @@ public:
 
     bool tryPopResult(JobResult& out) noexcept;
 
+    /// Set before start().
+    void setResultListener(ResultListener listener, void* context) noexcept;
+
 private:
     static void onWorkerResult(void* context, const JobResult& result);
 
     JobQueue queue;
     JobResultRing<256> results;
     JobWorker worker;
+    ResultListener resultListener { nullptr };
+    void* resultListenerContext { nullptr };
     std::atomic<bool> started { false };
 };
 
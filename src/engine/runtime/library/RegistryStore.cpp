@@ -1,32 +1,346 @@
 #include "engine/runtime/library/RegistryStore.h"
 
+#include <array>
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
 #include <sstream>
 #include <string>
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace ngks {
 
 namespace {
-constexpr const char* kRegistryRelativePath = "data/runtime/track_registry_v1.txt";
+constexpr const char* kRegistryRelativePath = "data/runtime/track_registry_v2.log";
+constexpr const char* kLegacyRelativePath = "data/runtime/track_registry_v1.txt";
 constexpr const char* kRegistryTempSuffix = ".tmp";
+constexpr const char* kRegistryCorruptSuffix = ".corrupt";
+
+constexpr char kLogMagic[8] = { 'N', 'G', 'K', 'S', 'R', 'E', 'G', '2' };
+constexpr uint32_t kLogVersion = 1;
+constexpr uint32_t kRecordMagic = 0x52474552u;  // "REGR"
+constexpr uint8_t kOpPut = 1;
+constexpr size_t kCompactionSlack = 1024;
+
+// Files are written in native byte order; every target is little-endian.
+struct LogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint8_t reserved[16];
+};
+
+struct LogRecord {
+    uint32_t magic;
+    uint32_t crc;               // CRC-32 of every byte after this field
+    uint64_t trackId;
+    char label[64];
+    uint32_t durationMs;
+    uint32_t flags;
+    int32_t bpmFixed;
+    int32_t loudnessCentiDb;
+    uint32_t deadAirMs;
+    uint32_t lastJobId;
+    uint32_t status;
+    uint8_t op;
+    uint8_t stemsReady;
+    uint8_t hasAnalysis;
+    uint8_t reserved[13];
+};
+
+static_assert(sizeof(LogHeader) == 32, "registry log header layout changed");
+static_assert(sizeof(LogRecord) == 128, "registry log record layout changed");
+
+constexpr size_t kCrcOffset = offsetof(LogRecord, crc) + sizeof(uint32_t);
+
+uint32_t crc32(const uint8_t* data, size_t size) noexcept
+{
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> t {};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t recordCrc(const LogRecord& record) noexcept
+{
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&record);
+    return crc32(bytes + kCrcOffset, sizeof(LogRecord) - kCrcOffset);
+}
+
+LogHeader makeHeader() noexcept
+{
+    LogHeader header {};
+    std::memcpy(header.magic, kLogMagic, sizeof(kLogMagic));
+    header.version = kLogVersion;
+    header.recordSize = static_cast<uint32_t>(sizeof(LogRecord));
+    return header;
+}
+
+LogRecord encodeRecord(const RegistryEntrySnapshot& entry) noexcept
+{
+    LogRecord record {};
+    record.magic = kRecordMagic;
+    record.trackId = entry.track.trackId;
+    std::memcpy(record.label, entry.track.label, sizeof(record.label));
+    record.label[sizeof(record.label) - 1] = '\0';
+    record.durationMs = entry.track.durationMs;
+    record.flags = entry.track.flags;
+    record.bpmFixed = entry.analysis.bpmFixed;
+    record.loudnessCentiDb = entry.analysis.loudnessCentiDb;
+    record.deadAirMs = entry.analysis.deadAirMs;
+    record.lastJobId = entry.analysis.lastJobId;
+    record.status = entry.analysis.status;
+    record.op = kOpPut;
+    record.stemsReady = entry.analysis.stemsReady;
+    record.hasAnalysis = entry.hasAnalysis;
+    record.crc = recordCrc(record);
+    return record;
+}
+
+bool decodeRecord(const LogRecord& record, RegistryEntrySnapshot& entry) noexcept
+{
+    if (record.magic != kRecordMagic || record.crc != recordCrc(record) || record.op != kOpPut) {
+        return false;
+    }
+
+    entry = {};
+    entry.track.trackId = record.trackId;
+    std::memcpy(entry.track.label, record.label, sizeof(entry.track.label));
+    entry.track.label[sizeof(entry.track.label) - 1] = '\0';
+    entry.track.durationMs = record.durationMs;
+    entry.track.flags = record.flags;
+    entry.analysis.bpmFixed = record.bpmFixed;
+    entry.analysis.loudnessCentiDb = record.loudnessCentiDb;
+    entry.analysis.deadAirMs = record.deadAirMs;
+    entry.analysis.stemsReady = record.stemsReady;
+    entry.analysis.lastJobId = record.lastJobId;
+    entry.analysis.status = record.status;
+    entry.hasAnalysis = record.hasAnalysis;
+    return true;
+}
+
+// Read-only view of a whole file; empty if it cannot be mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER fileSize {};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+            return;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            return;
+        }
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+            return;
+        }
+        bytes = static_cast<const uint8_t*>(view);
+        length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            return;
+        }
+        void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            return;
+        }
+        ::madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        bytes = static_cast<const uint8_t*>(view);
+        length = static_cast<size_t>(st.st_size);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (bytes != nullptr) {
+            UnmapViewOfFile(bytes);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+#else
+        if (bytes != nullptr) {
+            ::munmap(const_cast<uint8_t*>(bytes), length);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const noexcept { return bytes; }
+    size_t size() const noexcept { return length; }
+
+private:
+    const uint8_t* bytes{nullptr};
+    size_t length{0};
+#ifdef _WIN32
+    HANDLE file{INVALID_HANDLE_VALUE};
+    HANDLE mapping{nullptr};
+#else
+    int fd{-1};
+#endif
+};
+
+bool replaceFile(const std::string& tempPath, const std::string& targetPath)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    fs::rename(tempPath, targetPath, ec);
+    if (ec) {
+        fs::remove(targetPath, ec);
+        ec.clear();
+        fs::rename(tempPath, targetPath, ec);
+    }
+    return !ec;
+}
 }
 
 RegistryStore::RegistryStore()
     : storePath(kRegistryRelativePath)
+    , legacyPath(kLegacyRelativePath)
 {
 }
 
-size_t RegistryStore::load(TrackRegistry& registry) const
+RegistryStore::~RegistryStore()
+{
+    closeLog();
+}
+
+size_t RegistryStore::load(TrackRegistry& registry)
 {
     namespace fs = std::filesystem;
 
+    closeLog();
+    recordCount = 0;
+
+    std::vector<RegistryEntrySnapshot> replayed;
     std::error_code ec;
-    if (!fs::exists(storePath, ec)) {
+    bool rewrite = false;
+
+    if (fs::exists(storePath, ec)) {
+        uint64_t validBytes = 0;
+        recordCount = replayLog(replayed, validBytes);
+        if (validBytes == 0) {
+            // Unreadable header: keep the file for inspection and start over.
+            fs::rename(storePath, storePath + kRegistryCorruptSuffix, ec);
+            std::cout << "CACHE_LOG_REJECTED path=" << storePath << std::endl;
+            rewrite = true;
+        } else if (validBytes < fs::file_size(storePath, ec)) {
+            std::cout << "CACHE_LOG_TRUNCATED path=" << storePath
+                      << " records=" << recordCount << std::endl;
+        }
+    } else {
+        loadLegacyText(replayed);
+        rewrite = true;
+    }
+
+    registry.importEntries(replayed);
+
+    if (rewrite) {
+        compact(registry);
+    } else {
+        openForAppend();
+    }
+
+    return registry.count();
+}
+
+size_t RegistryStore::replayLog(std::vector<RegistryEntrySnapshot>& out, uint64_t& validBytes) const
+{
+    validBytes = 0;
+
+    const MappedFile map(storePath);
+    if (map.data() == nullptr || map.size() < sizeof(LogHeader)) {
         return 0;
     }
 
-    std::ifstream input(storePath);
+    LogHeader header {};
+    std::memcpy(&header, map.data(), sizeof(header));
+    if (std::memcmp(header.magic, kLogMagic, sizeof(kLogMagic)) != 0
+        || header.version != kLogVersion
+        || header.recordSize != sizeof(LogRecord)) {
+        return 0;
+    }
+
+    const size_t available = (map.size() - sizeof(LogHeader)) / sizeof(LogRecord);
+    out.reserve(out.size() + available);
+
+    size_t valid = 0;
+    const uint8_t* cursor = map.data() + sizeof(LogHeader);
+    for (; valid < available; ++valid, cursor += sizeof(LogRecord)) {
+        LogRecord record;
+        std::memcpy(&record, cursor, sizeof(record));
+
+        RegistryEntrySnapshot entry;
+        if (!decodeRecord(record, entry)) {
+            break;
+        }
+        out.push_back(entry);
+    }
+
+    validBytes = sizeof(LogHeader) + static_cast<uint64_t>(valid) * sizeof(LogRecord);
+    return valid;
+}
+
+size_t RegistryStore::loadLegacyText(std::vector<RegistryEntrySnapshot>& out) const
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    if (!fs::exists(legacyPath, ec)) {
+        return 0;
+    }
+
+    std::ifstream input(legacyPath);
     if (!input.is_open()) {
         return 0;
     }
@@ -100,53 +414,128 @@ size_t RegistryStore::load(TrackRegistry& registry) const
         }
         entry.hasAnalysis = static_cast<uint8_t>(std::stoul(token));
 
-        registry.importEntry(entry);
+        out.push_back(entry);
         ++imported;
     }
 
+    if (imported > 0) {
+        std::cout << "CACHE_LEGACY_IMPORT path=" << legacyPath << " count=" << imported << std::endl;
+    }
     return imported;
 }
 
-bool RegistryStore::save(const TrackRegistry& registry) const
+bool RegistryStore::append(const std::vector<RegistryEntrySnapshot>& changed)
+{
+    if (changed.empty()) {
+        return true;
+    }
+    if (logFile == nullptr && !openForAppend()) {
+        return false;
+    }
+
+    bool ok = true;
+    for (const auto& entry : changed) {
+        const LogRecord record = encodeRecord(entry);
+        if (std::fwrite(&record, sizeof(record), 1, logFile) != 1) {
+            ok = false;
+            break;
+        }
+    }
+    ok = (std::fflush(logFile) == 0) && ok;
+
+    if (!ok) {
+        // Part of the batch may be on disk; openForAppend() cuts the file
+        // back to the last record counted here before the next attempt.
+        closeLog();
+        return false;
+    }
+
+    recordCount += changed.size();
+    return true;
+}
+
+bool RegistryStore::compact(const TrackRegistry& registry)
+{
+    const auto entries = registry.exportEntries();
+    const std::string tempPath = storePath + kRegistryTempSuffix;
+
+    if (!writeLog(tempPath, entries)) {
+        return false;
+    }
+
+    // The log must be closed before it can be replaced on Windows.
+    closeLog();
+    if (!replaceFile(tempPath, storePath)) {
+        return false;
+    }
+
+    recordCount = entries.size();
+    std::cout << "CACHE_COMPACT_OK path=" << storePath << " count=" << recordCount << std::endl;
+    return openForAppend();
+}
+
+bool RegistryStore::writeLog(const std::string& path, const std::vector<RegistryEntrySnapshot>& entries) const
 {
     namespace fs = std::filesystem;
 
     std::error_code ec;
-    fs::create_directories(fs::path(storePath).parent_path(), ec);
+    fs::create_directories(fs::path(path).parent_path(), ec);
 
-    const std::string tempPath = storePath + kRegistryTempSuffix;
-    std::ofstream output(tempPath, std::ios::trunc);
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
     if (!output.is_open()) {
         return false;
     }
 
-    const auto entries = registry.exportEntries();
+    const LogHeader header = makeHeader();
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
     for (const auto& entry : entries) {
-        output
-            << entry.track.trackId << '|'
-            << entry.track.label << '|'
-            << entry.track.durationMs << '|'
-            << entry.track.flags << '|'
-            << entry.analysis.bpmFixed << '|'
-            << entry.analysis.loudnessCentiDb << '|'
-            << entry.analysis.deadAirMs << '|'
-            << static_cast<uint32_t>(entry.analysis.stemsReady) << '|'
-            << entry.analysis.lastJobId << '|'
-            << entry.analysis.status << '|'
-            << static_cast<uint32_t>(entry.hasAnalysis)
-            << '\n';
+        const LogRecord record = encodeRecord(entry);
+        output.write(reinterpret_cast<const char*>(&record), sizeof(record));
     }
 
     output.close();
+    return !output.fail();
+}
 
-    fs::rename(tempPath, storePath, ec);
-    if (ec) {
-        fs::remove(storePath, ec);
-        ec.clear();
-        fs::rename(tempPath, storePath, ec);
+bool RegistryStore::openForAppend()
+{
+    namespace fs = std::filesystem;
+
+    closeLog();
+
+    std::error_code ec;
+    if (!fs::exists(storePath, ec)) {
+        if (!writeLog(storePath, {})) {
+            return false;
+        }
+        recordCount = 0;
     }
 
-    return !ec;
+    // Drop anything past the last good record (a torn write or a failed
+    // append) so new records follow it directly.
+    const uint64_t validBytes = sizeof(LogHeader) + static_cast<uint64_t>(recordCount) * sizeof(LogRecord);
+    if (fs::file_size(storePath, ec) != validBytes && !ec) {
+        fs::resize_file(storePath, validBytes, ec);
+        if (ec) {
+            return false;
+        }
+    }
+
+    logFile = std::fopen(storePath.c_str(), "ab");
+    return logFile != nullptr;
+}
+
+void RegistryStore::closeLog() noexcept
+{
+    if (logFile != nullptr) {
+        std::fclose(logFile);
+        logFile = nullptr;
+    }
+}
+
+bool RegistryStore::needsCompaction(size_t liveEntries) const noexcept
+{
+    return recordCount > 2 * liveEntries + kCompactionSlack;
 }
 
 const std::string& RegistryStore::pathString() const noexcept
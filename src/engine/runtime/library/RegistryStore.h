@@ -1,22 +1,57 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <vector>
 
 #include "engine/runtime/library/TrackRegistry.h"
 
 namespace ngks {
 
+/// On-disk track registry: an append-only log of fixed-size records.
+///
+/// Each record is the full state of one track after a change, guarded by a
+/// CRC-32, so persisting an analysis update is one 128-byte append and
+/// replaying the log (last record per track wins) restores the registry.
+/// load() maps the file and walks it in place; a torn or corrupt tail from
+/// a crash ends the replay and is cut off before the next append.  When
+/// superseded records outnumber live ones the log is compacted: rewritten
+/// with one record per track to a temp file and renamed over the old one.
+///
+/// A registry saved by older builds as track_registry_v1.txt is imported
+/// the first time no log exists.  Not thread-safe; the engine calls it
+/// from one non-audio thread at a time.
 class RegistryStore {
 public:
     RegistryStore();
+    ~RegistryStore();
 
-    size_t load(TrackRegistry& registry) const;
-    bool save(const TrackRegistry& registry) const;
+    RegistryStore(const RegistryStore&) = delete;
+    RegistryStore& operator=(const RegistryStore&) = delete;
+
+    size_t load(TrackRegistry& registry);
+    bool append(const std::vector<RegistryEntrySnapshot>& changed);
+    bool compact(const TrackRegistry& registry);
+
+    /// True once the log holds enough superseded records to be worth
+    /// rewriting for liveEntries tracks.
+    bool needsCompaction(size_t liveEntries) const noexcept;
+    size_t logRecords() const noexcept { return recordCount; }
     const std::string& pathString() const noexcept;
 
 private:
+    size_t replayLog(std::vector<RegistryEntrySnapshot>& out, uint64_t& validBytes) const;
+    size_t loadLegacyText(std::vector<RegistryEntrySnapshot>& out) const;
+    bool writeLog(const std::string& path, const std::vector<RegistryEntrySnapshot>& entries) const;
+    bool openForAppend();
+    void closeLog() noexcept;
+
     std::string storePath;
+    std::string legacyPath;
+    std::FILE* logFile{nullptr};
+    size_t recordCount{0};
 };
 
 }
@@ -1,57 +1,240 @@
 #include "engine/runtime/library/TrackRegistry.h"
 
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
 namespace ngks {
 
-void TrackRegistry::upsertTrackMeta(uint64_t trackId, const TrackMeta& meta)
+namespace {
+constexpr size_t kInitialSlots = 16;        // per shard, power of two
+constexpr size_t kDirtyReserve = 16;        // per shard
+
+static_assert(std::is_trivially_copyable<RegistryEntrySnapshot>::value,
+              "registry payload is copied word by word");
+static_assert((TrackRegistry::kShardCount & (TrackRegistry::kShardCount - 1)) == 0,
+              "shard count must be a power of two");
+
+constexpr unsigned kShardShift = 64u - 6u;
+static_assert((size_t{1} << (64u - kShardShift)) == TrackRegistry::kShardCount,
+              "kShardShift must match kShardCount");
+}
+
+TrackRegistry::Table::Table(size_t slotCount)
+    : mask(slotCount - 1)
+    , slots(new Slot[slotCount])
+{
+}
+
+TrackRegistry::TrackRegistry()
+{
+    // Mutations also come from the audio thread (job results); keep the
+    // dirty lists from reallocating there under normal load.
+    for (auto& shard : shards) {
+        shard.tables.push_back(std::make_unique<Table>(kInitialSlots));
+        shard.table.store(shard.tables.back().get(), std::memory_order_release);
+        shard.dirtyIds.reserve(kDirtyReserve);
+    }
+}
+
+TrackRegistry::~TrackRegistry() = default;
+
+uint64_t TrackRegistry::mix(uint64_t trackId) noexcept
+{
+    // splitmix64 finalizer: track ids are hashes already, but not
+    // necessarily well spread in both the high and the low bits.
+    uint64_t z = trackId + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+TrackRegistry::Shard& TrackRegistry::shardFor(uint64_t hash) const noexcept
+{
+    return shards[static_cast<size_t>(hash >> kShardShift)];
+}
+
+bool TrackRegistry::readSlot(const Slot& slot, RegistryEntrySnapshot& out) noexcept
+{
+    uint64_t words[kPayloadWords];
+    for (;;) {
+        const uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if ((before & 1u) != 0u) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < kPayloadWords; ++i) {
+            words[i] = slot.payload[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+    std::memcpy(&out, words, sizeof(out));
+    return true;
+}
+
+void TrackRegistry::writeSlot(Slot& slot, const RegistryEntrySnapshot& entry) noexcept
+{
+    uint64_t words[kPayloadWords] {};
+    std::memcpy(words, &entry, sizeof(entry));
+
+    const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kPayloadWords; ++i) {
+        slot.payload[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(seq + 2u, std::memory_order_release);
+}
+
+bool TrackRegistry::find(const Table& table, uint64_t trackId, uint64_t hash,
+                         RegistryEntrySnapshot& out) noexcept
+{
+    for (size_t i = static_cast<size_t>(hash) & table.mask;; i = (i + 1) & table.mask) {
+        const Slot& slot = table.slots[i];
+        if (slot.used.load(std::memory_order_acquire) == 0u) {
+            return false;
+        }
+        if (slot.trackId == trackId) {
+            return readSlot(slot, out);
+        }
+    }
+}
+
+TrackRegistry::Slot& TrackRegistry::findOrInsert(Shard& shard, uint64_t trackId, uint64_t hash)
+{
+    // Keep the load factor at or below 1/2 so probes stay short.
+    if ((shard.size.load(std::memory_order_relaxed) + 1) * 2 > shard.tables.back()->mask + 1) {
+        grow(shard);
+    }
+
+    Table& table = *shard.tables.back();
+    for (size_t i = static_cast<size_t>(hash) & table.mask;; i = (i + 1) & table.mask) {
+        Slot& slot = table.slots[i];
+        if (slot.used.load(std::memory_order_relaxed) == 0u) {
+            RegistryEntrySnapshot blank {};
+            blank.track.trackId = trackId;
+            slot.trackId = trackId;
+            writeSlot(slot, blank);
+            slot.used.store(1u, std::memory_order_release);
+            shard.size.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+        if (slot.trackId == trackId) {
+            return slot;
+        }
+    }
+}
+
+void TrackRegistry::grow(Shard& shard)
+{
+    const Table& old = *shard.tables.back();
+    auto bigger = std::make_unique<Table>((old.mask + 1) * 2);
+
+    for (size_t i = 0; i <= old.mask; ++i) {
+        const Slot& from = old.slots[i];
+        if (from.used.load(std::memory_order_relaxed) == 0u) {
+            continue;
+        }
+        // Writers hold the shard mutex, so the payload is stable here.
+        size_t j = static_cast<size_t>(mix(from.trackId)) & bigger->mask;
+        while (bigger->slots[j].used.load(std::memory_order_relaxed) != 0u) {
+            j = (j + 1) & bigger->mask;
+        }
+        Slot& to = bigger->slots[j];
+        to.trackId = from.trackId;
+        to.dirty = from.dirty;
+        for (size_t w = 0; w < kPayloadWords; ++w) {
+            to.payload[w].store(from.payload[w].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        to.used.store(1u, std::memory_order_relaxed);
+    }
+
+    shard.table.store(bigger.get(), std::memory_order_release);
+    shard.tables.push_back(std::move(bigger));
+}
+
+void TrackRegistry::mutate(uint64_t trackId, bool markDirty, Mutator fn, const void* arg)
 {
-    std::lock_guard<std::mutex> guard(mutex);
-    auto& entry = entries[trackId];
-    entry.track = meta;
+    const uint64_t hash = mix(trackId);
+    Shard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> guard(shard.writeMutex);
+
+    Slot& slot = findOrInsert(shard, trackId, hash);
+    RegistryEntrySnapshot entry {};
+    readSlot(slot, entry);
+    fn(entry, arg);
     entry.track.trackId = trackId;
+    writeSlot(slot, entry);
+
+    if (markDirty && !slot.dirty) {
+        slot.dirty = true;
+        shard.dirtyIds.push_back(trackId);
+    }
+}
+
+void TrackRegistry::upsertTrackMeta(uint64_t trackId, const TrackMeta& meta)
+{
+    mutate(trackId, true, [](RegistryEntrySnapshot& entry, const void* arg) {
+        entry.track = *static_cast<const TrackMeta*>(arg);
+    }, &meta);
 }
 
 void TrackRegistry::updateAnalysis(uint64_t trackId, const AnalysisMeta& analysis)
 {
-    std::lock_guard<std::mutex> guard(mutex);
-    auto& entry = entries[trackId];
-    entry.track.trackId = trackId;
-    entry.analysis = analysis;
-    entry.hasAnalysis = true;
+    mutate(trackId, true, [](RegistryEntrySnapshot& entry, const void* arg) {
+        entry.analysis = *static_cast<const AnalysisMeta*>(arg);
+        entry.hasAnalysis = 1;
+    }, &analysis);
 }
 
 bool TrackRegistry::getAnalysis(uint64_t trackId, AnalysisMeta& out) const
 {
-    std::lock_guard<std::mutex> guard(mutex);
-    const auto it = entries.find(trackId);
-    if (it == entries.end() || !it->second.hasAnalysis) {
+    const uint64_t hash = mix(trackId);
+    const Table* table = shardFor(hash).table.load(std::memory_order_acquire);
+
+    RegistryEntrySnapshot entry {};
+    if (!find(*table, trackId, hash, entry) || entry.hasAnalysis == 0) {
         return false;
     }
 
-    out = it->second.analysis;
+    out = entry.analysis;
     return true;
 }
 
 void TrackRegistry::importEntry(const RegistryEntrySnapshot& entry)
 {
-    std::lock_guard<std::mutex> guard(mutex);
-    auto& target = entries[entry.track.trackId];
-    target.track = entry.track;
-    target.analysis = entry.analysis;
-    target.hasAnalysis = (entry.hasAnalysis != 0);
+    mutate(entry.track.trackId, false, [](RegistryEntrySnapshot& target, const void* arg) {
+        target = *static_cast<const RegistryEntrySnapshot*>(arg);
+    }, &entry);
+}
+
+void TrackRegistry::importEntries(const std::vector<RegistryEntrySnapshot>& batch)
+{
+    // Later snapshots of the same track overwrite earlier ones.
+    for (const auto& entry : batch) {
+        importEntry(entry);
+    }
 }
 
 std::vector<RegistryEntrySnapshot> TrackRegistry::exportEntries() const
 {
     std::vector<RegistryEntrySnapshot> out;
-    std::lock_guard<std::mutex> guard(mutex);
-    out.reserve(entries.size());
-
-    for (const auto& pair : entries) {
-        RegistryEntrySnapshot snapshot {};
-        snapshot.track = pair.second.track;
-        snapshot.analysis = pair.second.analysis;
-        snapshot.hasAnalysis = pair.second.hasAnalysis ? 1 : 0;
-        out.push_back(snapshot);
+    out.reserve(count());
+
+    for (const auto& shard : shards) {
+        const Table* table = shard.table.load(std::memory_order_acquire);
+        for (size_t i = 0; i <= table->mask; ++i) {
+            const Slot& slot = table->slots[i];
+            if (slot.used.load(std::memory_order_acquire) == 0u) {
+                continue;
+            }
+            RegistryEntrySnapshot snapshot {};
+            readSlot(slot, snapshot);
+            out.push_back(snapshot);
+        }
     }
 
     return out;
@@ -59,8 +242,58 @@ std::vector<RegistryEntrySnapshot> TrackRegistry::exportEntries() const
 
 size_t TrackRegistry::count() const
 {
-    std::lock_guard<std::mutex> guard(mutex);
-    return entries.size();
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard.size.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void TrackRegistry::takeDirty(std::vector<RegistryEntrySnapshot>& out)
+{
+    out.clear();
+
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> guard(shard.writeMutex);
+        if (shard.dirtyIds.empty()) {
+            continue;
+        }
+
+        Table& table = *shard.tables.back();
+        for (const uint64_t trackId : shard.dirtyIds) {
+            const uint64_t hash = mix(trackId);
+            for (size_t i = static_cast<size_t>(hash) & table.mask;; i = (i + 1) & table.mask) {
+                Slot& slot = table.slots[i];
+                if (slot.used.load(std::memory_order_relaxed) == 0u) {
+                    break;
+                }
+                if (slot.trackId == trackId) {
+                    slot.dirty = false;
+                    RegistryEntrySnapshot snapshot {};
+                    readSlot(slot, snapshot);
+                    out.push_back(snapshot);
+                    break;
+                }
+            }
+        }
+        shard.dirtyIds.clear();
+    }
+}
+
+void TrackRegistry::restoreDirty(const std::vector<RegistryEntrySnapshot>& restored)
+{
+    for (const auto& snapshot : restored) {
+        const uint64_t trackId = snapshot.track.trackId;
+        const uint64_t hash = mix(trackId);
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> guard(shard.writeMutex);
+
+        Slot& slot = findOrInsert(shard, trackId, hash);
+        if (!slot.dirty) {
+            slot.dirty = true;
+            shard.dirtyIds.push_back(trackId);
+        }
+    }
 }
 
 }
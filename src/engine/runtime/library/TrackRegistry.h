@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
 #include <vector>
 
 #include "engine/runtime/library/AnalysisMeta.h"
@@ -16,25 +18,86 @@ struct RegistryEntrySnapshot {
     uint8_t hasAnalysis{0};
 };
 
+/// Track id -> metadata/analysis map shared by the UI, the job workers and
+/// the audio thread.
+///
+/// Entries are spread over kShardCount shards by a mix of the track id.
+/// Each shard is an open-addressing table whose slots are guarded by
+/// per-slot sequence counters: writers take the shard mutex, readers take
+/// no lock at all and simply retry if a writer was mid-update.  Growing a
+/// shard publishes a doubled table and retires the old one without
+/// freeing it (readers may still be walking it); retired tables are freed
+/// with the registry.  There is no erase, so probes never meet tombstones.
+///
+/// getAnalysis() and exportEntries() therefore never block, and
+/// exportEntries() never blocks writers: each slot is copied consistently,
+/// the set as a whole is whatever was visible while walking the shards.
 class TrackRegistry {
 public:
+    static constexpr size_t kShardCount = 64;
+
+    TrackRegistry();
+    ~TrackRegistry();
+
+    TrackRegistry(const TrackRegistry&) = delete;
+    TrackRegistry& operator=(const TrackRegistry&) = delete;
+
     void upsertTrackMeta(uint64_t trackId, const TrackMeta& meta);
     void updateAnalysis(uint64_t trackId, const AnalysisMeta& analysis);
     bool getAnalysis(uint64_t trackId, AnalysisMeta& out) const;
 
     void importEntry(const RegistryEntrySnapshot& entry);
+    void importEntries(const std::vector<RegistryEntrySnapshot>& batch);
     std::vector<RegistryEntrySnapshot> exportEntries() const;
     size_t count() const;
 
+    /// Entries changed by upsertTrackMeta/updateAnalysis since the last call,
+    /// one snapshot per track however often it changed.  Imports are not
+    /// reported: they came from the store.
+    void takeDirty(std::vector<RegistryEntrySnapshot>& out);
+    /// Marks the given entries dirty again after a failed write.
+    void restoreDirty(const std::vector<RegistryEntrySnapshot>& entries);
+
 private:
-    struct Entry {
-        TrackMeta track{};
-        AnalysisMeta analysis{};
-        bool hasAnalysis{false};
+    static constexpr size_t kPayloadWords =
+        (sizeof(RegistryEntrySnapshot) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        std::atomic<uint32_t> seq { 0 };            // odd while a write is in progress
+        std::atomic<uint8_t> used { 0 };            // set once, after trackId and payload
+        bool dirty { false };                       // shard mutex
+        uint64_t trackId { 0 };                     // immutable once used
+        std::array<std::atomic<uint64_t>, kPayloadWords> payload {};
+    };
+
+    struct Table {
+        explicit Table(size_t slotCount);
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<Table*> table { nullptr };
+        std::atomic<size_t> size { 0 };
+        std::mutex writeMutex;
+        std::vector<std::unique_ptr<Table>> tables;     // current is back(); older ones retired
+        std::vector<uint64_t> dirtyIds;
     };
 
-    mutable std::mutex mutex;
-    std::unordered_map<uint64_t, Entry> entries;
+    using Mutator = void (*)(RegistryEntrySnapshot& entry, const void* arg);
+
+    static uint64_t mix(uint64_t trackId) noexcept;
+    Shard& shardFor(uint64_t hash) const noexcept;
+    static bool readSlot(const Slot& slot, RegistryEntrySnapshot& out) noexcept;
+    static void writeSlot(Slot& slot, const RegistryEntrySnapshot& entry) noexcept;
+    static bool find(const Table& table, uint64_t trackId, uint64_t hash, RegistryEntrySnapshot& out) noexcept;
+
+    // Caller holds shard.writeMutex.
+    Slot& findOrInsert(Shard& shard, uint64_t trackId, uint64_t hash);
+    void grow(Shard& shard);
+    void mutate(uint64_t trackId, bool markDirty, Mutator fn, const void* arg);
+
+    mutable std::array<Shard, kShardCount> shards;
 };
 
 }
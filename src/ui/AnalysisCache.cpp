@@ -0,0 +1,412 @@
+#include "AnalysisCache.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+constexpr char     kMagic[4]       = { 'N', 'G', 'A', 'C' };
+constexpr quint16  kFormatVersion  = 2;     // 2: keyed by audioContentHash()
+constexpr qint64   kHeaderBytes    = 8;
+constexpr qint64   kRecordHeader   = 8;
+constexpr uint32_t kMaxPayload     = 16u * 1024u * 1024u;
+
+uint32_t fnv1a32(const char* data, qsizetype n)
+{
+    uint32_t h = 2166136261u;
+    for (qsizetype i = 0; i < n; ++i) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void setupStream(QDataStream& ds)
+{
+    ds.setByteOrder(QDataStream::LittleEndian);
+    ds.setVersion(QDataStream::Qt_6_0);
+    ds.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+// ── AnalysisResult ↔ payload ───────────────────────────────────────
+// Field order is the format.  Append-only; bump kFormatVersion on any
+// reorder or removal.
+
+QByteArray encodeRecord(uint64_t hash, const AnalysisStageVersions& versions,
+                        uint32_t validStages, const AnalysisResult& r)
+{
+    QByteArray buf;
+    QDataStream ds(&buf, QIODevice::WriteOnly);
+    setupStream(ds);
+
+    ds << quint64(hash);
+    ds << quint8(versions.size());
+    for (uint32_t v : versions) ds << quint32(v);
+    ds << quint32(validStages);
+
+    ds << r.bpm << r.loudnessLUFS << r.peakDBFS << r.energy;
+
+    ds << r.rawBpm << r.resolvedBpm << r.bpmConfidence << r.bpmFamily
+       << r.onsetDensity << r.hfPercussiveScore;
+    ds << quint32(r.bpmCandidates.size());
+    for (const auto& c : r.bpmCandidates)
+        ds << c.bpm << c.family << c.score << c.reason;
+
+    ds << r.cueInSeconds << r.cueOutSeconds << r.dynamicRangeLU;
+    ds << r.danceability << r.acousticness << r.instrumentalness << r.liveness;
+    ds << r.camelotKey << r.lra << r.transitionDifficulty;
+    ds << r.keyConfidence << r.keyAmbiguous << r.keyRunnerUp << r.keyCorrectionReason;
+
+    const std::vector<uint8_t> grid = r.beatGrid.encode();
+    ds << r.beatGridConfidence
+       << QByteArray(reinterpret_cast<const char*>(grid.data()),
+                     static_cast<qsizetype>(grid.size()));
+    ds << r.spectralCentroid << r.introDuration << r.outroDuration
+       << r.durationSeconds << r.sampleRate << r.chromaRate << r.onsetRate;
+
+    const std::vector<uint8_t> fp = r.fingerprint.encode();
+    const std::vector<uint8_t> sketch = AudioFingerprint::encodeSketch(r.fingerprint.sketch);
+    ds << QByteArray(reinterpret_cast<const char*>(fp.data()),
+                     static_cast<qsizetype>(fp.size()))
+       << QByteArray(reinterpret_cast<const char*>(sketch.data()),
+                     static_cast<qsizetype>(sketch.size()));
+    return buf;
+}
+
+bool decodeRecord(const QByteArray& payload, uint64_t& hash, AnalysisCache::Entry& e)
+{
+    QDataStream ds(payload);
+    setupStream(ds);
+
+    quint64 h = 0;
+    quint8  stageCount = 0;
+    ds >> h >> stageCount;
+    e.versions.fill(0);
+    for (quint8 i = 0; i < stageCount; ++i) {
+        quint32 v = 0;
+        ds >> v;
+        if (i < e.versions.size()) e.versions[i] = v;
+    }
+    quint32 valid = 0;
+    ds >> valid;
+    // Stages this build knows about but the record predates are invalid.
+    if (stageCount < e.versions.size())
+        valid &= (1u << stageCount) - 1u;
+    e.validStages = valid;
+
+    AnalysisResult& r = e.result;
+    r = AnalysisResult{};
+    ds >> r.bpm >> r.loudnessLUFS >> r.peakDBFS >> r.energy;
+
+    ds >> r.rawBpm >> r.resolvedBpm >> r.bpmConfidence >> r.bpmFamily
+       >> r.onsetDensity >> r.hfPercussiveScore;
+    quint32 nCand = 0;
+    ds >> nCand;
+    if (nCand > 64) return false;
+    r.bpmCandidates.resize(nCand);
+    for (auto& c : r.bpmCandidates)
+        ds >> c.bpm >> c.family >> c.score >> c.reason;
+
+    ds >> r.cueInSeconds >> r.cueOutSeconds >> r.dynamicRangeLU;
+    ds >> r.danceability >> r.acousticness >> r.instrumentalness >> r.liveness;
+    ds >> r.camelotKey >> r.lra >> r.transitionDifficulty;
+    ds >> r.keyConfidence >> r.keyAmbiguous >> r.keyRunnerUp >> r.keyCorrectionReason;
+
+    QByteArray grid;
+    ds >> r.beatGridConfidence >> grid;
+    if (!grid.isEmpty()) {
+        BeatGrid::decode(reinterpret_cast<const uint8_t*>(grid.constData()),
+                         static_cast<size_t>(grid.size()), r.beatGrid);
+    }
+    ds >> r.spectralCentroid >> r.introDuration >> r.outroDuration
+       >> r.durationSeconds >> r.sampleRate >> r.chromaRate >> r.onsetRate;
+
+    // Records written before the fingerprint stage end here; the stage
+    // count already marks it invalid for them.
+    if (!ds.atEnd()) {
+        QByteArray fp, sketch;
+        ds >> fp >> sketch;
+        const auto* fpData     = reinterpret_cast<const uint8_t*>(fp.constData());
+        const auto* sketchData = reinterpret_cast<const uint8_t*>(sketch.constData());
+        if (!AudioFingerprint::decodeSketch(sketchData, static_cast<size_t>(sketch.size()),
+                                            r.fingerprint.sketch)
+            || !AudioFingerprint::decode(fpData, static_cast<size_t>(fp.size()), r.fingerprint)) {
+            // Older fingerprint version: re-run just that stage.
+            r.fingerprint = AudioFingerprint{};
+            e.validStages &= ~static_cast<uint32_t>(AnalysisStage::Fingerprint);
+        }
+    }
+
+    if (ds.status() != QDataStream::Ok) return false;
+    r.valid = true;
+    hash = h;
+    return true;
+}
+
+uint64_t peekHash(const QByteArray& payload)
+{
+    if (payload.size() < 8) return 0;
+    return qFromLittleEndian<quint64>(payload.constData());
+}
+
+QByteArray fileHeader()
+{
+    QByteArray h(kMagic, 4);
+    char tail[4];
+    qToLittleEndian<quint16>(kFormatVersion, tail);
+    qToLittleEndian<quint16>(static_cast<quint16>(AnalysisStage::kCount), tail + 2);
+    h.append(tail, 4);
+    return h;
+}
+
+QByteArray recordHeader(const QByteArray& payload)
+{
+    char hdr[kRecordHeader];
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), hdr);
+    qToLittleEndian<quint32>(fnv1a32(payload.constData(), payload.size()), hdr + 4);
+    return QByteArray(hdr, kRecordHeader);
+}
+
+} // namespace
+
+// ════════════════════════════════════════════════════════════════════
+//  Open / scan
+// ════════════════════════════════════════════════════════════════════
+
+AnalysisCache::~AnalysisCache()
+{
+    close();
+}
+
+bool AnalysisCache::open(const QString& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_.isOpen()) file_.close();
+    index_.clear();
+    liveBytes_ = 0;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // Held for the whole session; only a dead owner makes it stale.
+    lock_ = std::make_unique<QLockFile>(path + QStringLiteral(".lock"));
+    lock_->setStaleLockTime(0);
+    writable_ = lock_->tryLock(0);
+    if (!writable_) {
+        lock_.reset();
+        if (!QFileInfo::exists(path)) {
+            qDebug() << "[ANALYSIS_CACHE] OPEN_FAIL locked, no file" << path;
+            return false;
+        }
+    }
+
+    file_.setFileName(path);
+    if (!file_.open(writable_ ? QIODevice::ReadWrite : QIODevice::ReadOnly)) {
+        qDebug() << "[ANALYSIS_CACHE] OPEN_FAIL" << path << file_.errorString();
+        lock_.reset();
+        writable_ = false;
+        return false;
+    }
+
+    if (!scanLocked()) return false;
+
+    const qint64 dead = file_.size() - kHeaderBytes - liveBytes_;
+    if (writable_ && dead > liveBytes_ && dead > (1 << 20)) compactLocked();
+
+    qDebug() << "[ANALYSIS_CACHE] OPEN" << path
+             << "entries=" << index_.size()
+             << "bytes=" << file_.size()
+             << (writable_ ? "writable" : "read-only (locked by another process)");
+    return true;
+}
+
+void AnalysisCache::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_.isOpen()) file_.close();
+    index_.clear();
+    liveBytes_ = 0;
+    lock_.reset();
+    writable_ = false;
+}
+
+bool AnalysisCache::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_.isOpen();
+}
+
+bool AnalysisCache::isWritable() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_.isOpen() && writable_;
+}
+
+size_t AnalysisCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
+
+bool AnalysisCache::scanLocked()
+{
+    const QByteArray expected = fileHeader();
+
+    file_.seek(0);
+    const QByteArray header = file_.read(kHeaderBytes);
+    if (header.left(6) != expected.left(6)) {
+        // Empty, foreign or older format: start over.  (Stage count may
+        // differ — records with fewer stages decode with those invalid.)
+        if (!writable_) return true;    // the writer resets it
+        if (!header.isEmpty())
+            qDebug() << "[ANALYSIS_CACHE] FORMAT_RESET" << file_.fileName();
+        file_.resize(0);
+        file_.seek(0);
+        return file_.write(expected) == kHeaderBytes && file_.flush();
+    }
+
+    qint64 pos = kHeaderBytes;
+    const qint64 end = file_.size();
+    while (pos + kRecordHeader <= end) {
+        QByteArray payload;
+        if (!readRecordLocked(pos, payload)) break;
+
+        const uint32_t bytes = static_cast<uint32_t>(kRecordHeader + payload.size());
+        const uint64_t hash  = peekHash(payload);
+        auto it = index_.find(hash);
+        if (it != index_.end()) liveBytes_ -= it->second.bytes;
+        index_[hash] = Slot{ pos, bytes };
+        liveBytes_ += bytes;
+        pos += bytes;
+    }
+
+    // Read-only: the tail may be the writer's append in progress.
+    if (pos < end && writable_) {
+        qDebug() << "[ANALYSIS_CACHE] TRUNCATE_TORN_TAIL at" << pos << "of" << end;
+        file_.resize(pos);
+    }
+    return true;
+}
+
+bool AnalysisCache::readRecordLocked(qint64 offset, QByteArray& payload) const
+{
+    if (!file_.seek(offset)) return false;
+    const QByteArray hdr = file_.read(kRecordHeader);
+    if (hdr.size() != kRecordHeader) return false;
+
+    const quint32 len = qFromLittleEndian<quint32>(hdr.constData());
+    const quint32 sum = qFromLittleEndian<quint32>(hdr.constData() + 4);
+    if (len < 8 || len > kMaxPayload) return false;
+
+    payload = file_.read(len);
+    if (payload.size() != static_cast<qsizetype>(len)) return false;
+    return fnv1a32(payload.constData(), payload.size()) == sum;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  Lookup / store
+// ════════════════════════════════════════════════════════════════════
+
+bool AnalysisCache::lookup(uint64_t contentHash, Entry& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.isOpen()) return false;
+
+    auto it = index_.find(contentHash);
+    if (it == index_.end()) return false;
+
+    QByteArray payload;
+    uint64_t   hash = 0;
+    if (!readRecordLocked(it->second.offset, payload)
+        || !decodeRecord(payload, hash, out)
+        || hash != contentHash) {
+        qDebug() << "[ANALYSIS_CACHE] RECORD_BAD offset=" << it->second.offset;
+        return false;
+    }
+    return true;
+}
+
+bool AnalysisCache::store(uint64_t contentHash, const AnalysisStageVersions& versions,
+                          uint32_t validStages, const AnalysisResult& result)
+{
+    const QByteArray payload = encodeRecord(contentHash, versions, validStages, result);
+    const QByteArray record  = recordHeader(payload) + payload;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.isOpen() || !writable_) return false;
+
+    const qint64 offset = file_.size();
+    if (!file_.seek(offset)
+        || file_.write(record) != record.size()
+        || !file_.flush()) {
+        qDebug() << "[ANALYSIS_CACHE] STORE_FAIL" << file_.errorString();
+        file_.resize(offset);
+        return false;
+    }
+
+    auto it = index_.find(contentHash);
+    if (it != index_.end()) liveBytes_ -= it->second.bytes;
+    index_[contentHash] = Slot{ offset, static_cast<uint32_t>(record.size()) };
+    liveBytes_ += record.size();
+    return true;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  Compaction
+// ════════════════════════════════════════════════════════════════════
+
+bool AnalysisCache::compact()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_.isOpen() && writable_ && compactLocked();
+}
+
+bool AnalysisCache::compactLocked()
+{
+    const QString path = file_.fileName();
+    const qint64  before = file_.size();
+
+    // Copy live records in file order so reads stay roughly sequential.
+    std::vector<std::pair<uint64_t, Slot>> live(index_.begin(), index_.end());
+    std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) {
+        return a.second.offset < b.second.offset;
+    });
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) return false;
+    out.write(fileHeader());
+
+    std::unordered_map<uint64_t, Slot> newIndex;
+    newIndex.reserve(live.size());
+    qint64 pos = kHeaderBytes;
+    for (const auto& [hash, slot] : live) {
+        if (!file_.seek(slot.offset)) return false;
+        const QByteArray rec = file_.read(slot.bytes);
+        if (rec.size() != static_cast<qsizetype>(slot.bytes)) return false;
+        out.write(rec);
+        newIndex[hash] = Slot{ pos, slot.bytes };
+        pos += slot.bytes;
+    }
+
+    file_.close();
+    if (!out.commit()) {
+        file_.open(QIODevice::ReadWrite);
+        return false;
+    }
+    if (!file_.open(QIODevice::ReadWrite)) {
+        index_.clear();
+        liveBytes_ = 0;
+        return false;
+    }
+
+    index_.swap(newIndex);
+    liveBytes_ = pos - kHeaderBytes;
+    qDebug() << "[ANALYSIS_CACHE] COMPACT bytes=" << before << "->" << pos;
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <QFile>
+#include <QLockFile>
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "AnalysisResult.h"
+
+// ── Binary analysis cache ──────────────────────────────────────────
+//
+// One append-only file holding every analysed track, keyed by
+// audioContentHash() — the same audio identity as library_tracks.content_hash
+// (tags excluded, so tag edits do not invalidate it).
+// Each record carries the per-stage versions that produced it, so a
+// version bump re-runs only the affected stages.
+//
+//   file   = header  record*
+//   header = "NGAC" u16 formatVersion u16 stageCount
+//   record = u32 payloadBytes  u32 fnv1a32(payload)  payload
+//
+// The payload is a QDataStream (little-endian) of the content hash,
+// stage versions, valid-stage mask and the AnalysisResult fields.
+// open() scans record headers once into a hash → offset index; lookup()
+// is one index probe plus one read.  A torn tail (crash mid-append) is
+// truncated on open.  Superseded records are dropped by compact(),
+// which open() runs when more than half the file is dead.
+//
+// Thread-safe.  One writer process at a time: open() takes an advisory
+// lock (<path>.lock, released on close or process death).  A process that
+// finds it held — the GUI and a --batch-analyze run side by side — opens
+// the cache read-only: lookups see the records present at open, store()
+// and compact() do nothing, and a partial tail is left for its writer.
+
+class AnalysisCache
+{
+public:
+    struct Entry
+    {
+        AnalysisStageVersions versions{};
+        uint32_t              validStages{0};
+        AnalysisResult        result;
+    };
+
+    AnalysisCache() = default;
+    ~AnalysisCache();
+    AnalysisCache(const AnalysisCache&) = delete;
+    AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const;
+    bool isWritable() const;
+
+    bool lookup(uint64_t contentHash, Entry& out) const;
+    bool store(uint64_t contentHash, const AnalysisStageVersions& versions,
+               uint32_t validStages, const AnalysisResult& result);
+
+    size_t size() const;
+    bool compact();
+
+private:
+    bool scanLocked();
+    bool compactLocked();
+    bool readRecordLocked(qint64 offset, QByteArray& payload) const;
+
+    struct Slot
+    {
+        qint64   offset{0};     // of the record header
+        uint32_t bytes{0};      // header + payload
+    };
+
+    mutable std::mutex mutex_;
+    mutable QFile      file_;
+    std::unique_ptr<QLockFile> lock_;
+    bool               writable_{false};
+    std::unordered_map<uint64_t, Slot> index_;
+    qint64             liveBytes_{0};
+};
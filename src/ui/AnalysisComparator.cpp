@@ -360,6 +360,10 @@ void AnalysisComparator::computeSummary()
     summary_ = {};
     double totalBpmDelta = 0.0;
     int compared = 0;
+    double totalMs = 0.0;
+    double totalNativeMs = 0.0;
+    double totalCrossDelta = 0.0;
+    int timed = 0;
 
     for (const auto& r : rows_) {
         summary_.total++;
@@ -385,10 +389,32 @@ void AnalysisComparator::computeSummary()
         }
         totalBpmDelta += r.bpmDelta;
         compared++;
+
+        if (r.current.valid) {
+            totalMs += r.current.analysisMs;
+            timed++;
+        }
+        if (r.crossChecked) {
+            summary_.crossChecked++;
+            totalNativeMs += r.nativeAnalysisMs;
+            const double crossDelta = std::abs(r.nativeBpm - r.current.bpm);
+            totalCrossDelta += crossDelta;
+            summary_.crossBpmDeltaMax = std::max(summary_.crossBpmDeltaMax, crossDelta);
+            if (crossDelta > 0.1)
+                summary_.crossBpmMismatch++;
+            if (r.nativeCamelot != r.current.camelotKey)
+                summary_.crossKeyMismatch++;
+        }
     }
 
     if (compared > 0)
         summary_.avgBpmDelta = totalBpmDelta / compared;
+    if (timed > 0)
+        summary_.avgAnalysisMs = totalMs / timed;
+    if (summary_.crossChecked > 0) {
+        summary_.avgNativeAnalysisMs = totalNativeMs / summary_.crossChecked;
+        summary_.crossBpmDeltaAvg = totalCrossDelta / summary_.crossChecked;
+    }
 }
 
 // ════════════════════════════════════════════════════════════════════
@@ -446,7 +472,19 @@ void AnalysisComparator::writeProofArtifacts(const QString& proofDir)
         f << "RELATIVE:           " << summary_.keyRelative   << "\n";
         f << "ADJACENT:           " << summary_.keyAdjacent   << "\n";
         f << "MODE_WRONG:         " << summary_.keyModeWrong  << "\n";
-        f << "ROOT_WRONG:         " << summary_.keyRootWrong  << "\n";
+        f << "ROOT_WRONG:         " << summary_.keyRootWrong  << "\n\n";
+        f << "── ANALYSIS RATE ──\n";
+        f << "Chroma Rate Target: " << rateConfig_.chromaRateHz << " Hz\n";
+        f << "Onset Rate Target:  " << rateConfig_.onsetRateHz  << " Hz\n";
+        f << "Avg Analysis ms:    " << summary_.avgAnalysisMs   << "\n";
+        if (summary_.crossChecked > 0) {
+            f << "Native Cross-Check: " << summary_.crossChecked        << "\n";
+            f << "Native Avg ms:      " << summary_.avgNativeAnalysisMs << "\n";
+            f << "BPM Mismatch:       " << summary_.crossBpmMismatch    << "\n";
+            f << "BPM Delta avg/max:  " << summary_.crossBpmDeltaAvg
+              << " / " << summary_.crossBpmDeltaMax << "\n";
+            f << "Key Mismatch:       " << summary_.crossKeyMismatch    << "\n";
+        }
         f << "════════════════════════════════════════════════════════════════\n";
     }
 
@@ -470,6 +508,13 @@ void AnalysisComparator::writeProofArtifacts(const QString& proofDir)
               << "  RunnerUp: " << r.current.keyRunnerUp.toStdString() << "\n";
             f << "  BPM Conf:     " << r.current.bpmConfidence
               << "  Family: " << r.current.bpmFamily.toStdString() << "\n";
+            f << "  Analysis ms:  " << r.current.analysisMs
+              << "  ChromaSR: " << r.current.chromaRate
+              << "  OnsetSR: " << r.current.onsetRate << "\n";
+            if (r.crossChecked)
+                f << "  Native:       BPM " << r.nativeBpm
+                  << "  Key " << r.nativeCamelot.toStdString()
+                  << "  ms " << r.nativeAnalysisMs << "\n";
             f << "  Track Verdict: " << trackVerdictStr(r.trackVerdict).toStdString() << "\n";
             if (!r.notes.isEmpty())
                 f << "  Notes:        " << r.notes.toStdString() << "\n";
@@ -498,6 +543,9 @@ bool AnalysisComparator::run(const QString& csvPath,
         return false;
 
     AudioAnalysisService analysisSvc;
+    analysisSvc.setRateConfig(rateConfig_);
+    AudioAnalysisService nativeSvc;
+    nativeSvc.setRateConfig(AnalysisRateConfig{0.0, 0.0});
     rows_.clear();
 
     for (size_t i = 0; i < baseline_.size(); ++i) {
@@ -534,6 +582,16 @@ bool AnalysisComparator::run(const QString& csvPath,
             continue;
         }
 
+        if (nativeCrossCheck_) {
+            const AnalysisResult native = nativeSvc.analyzeFile(cr.resolvedPath, b.genre);
+            if (native.valid) {
+                cr.crossChecked     = true;
+                cr.nativeBpm        = native.bpm;
+                cr.nativeCamelot    = native.camelotKey;
+                cr.nativeAnalysisMs = native.analysisMs;
+            }
+        }
+
         // Score
         cr.bpmDelta     = std::abs(b.bpm - cr.current.bpm);
         cr.bpmVerdict   = judgeBpm(b.bpm, cr.current.bpm);
@@ -568,6 +626,17 @@ bool AnalysisComparator::run(const QString& csvPath,
         .arg(summary_.keyExact).arg(summary_.keyEnharmonic)
         .arg(summary_.keyRelative).arg(summary_.keyAdjacent)
         .arg(summary_.keyModeWrong).arg(summary_.keyRootWrong);
+    qInfo().noquote() << QString("RATE: chroma=%1Hz onset=%2Hz avgMs=%3")
+        .arg(rateConfig_.chromaRateHz).arg(rateConfig_.onsetRateHz)
+        .arg(summary_.avgAnalysisMs, 0, 'f', 1);
+    if (summary_.crossChecked > 0) {
+        qInfo().noquote() << QString("NATIVE_CROSS_CHECK: n=%1 bpmMismatch=%2 keyMismatch=%3 bpmDeltaAvg=%4 bpmDeltaMax=%5 nativeAvgMs=%6")
+            .arg(summary_.crossChecked).arg(summary_.crossBpmMismatch)
+            .arg(summary_.crossKeyMismatch)
+            .arg(summary_.crossBpmDeltaAvg, 0, 'f', 3)
+            .arg(summary_.crossBpmDeltaMax, 0, 'f', 3)
+            .arg(summary_.avgNativeAnalysisMs, 0, 'f', 1);
+    }
     qInfo().noquote() << "COMPARATOR=DONE";
     qInfo().noquote() << "════════════════════════════════════════════════════════════════";
 
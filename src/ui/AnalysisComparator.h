@@ -3,6 +3,7 @@
 #include <QStringList>
 #include <vector>
 #include "AnalysisResult.h"
+#include "AnalysisDecimator.h"
 
 // ── BPM comparison verdict ─────────────────────────────────────────
 enum class BpmVerdict { EXACT, CLOSE, FAMILY_MATCH, WRONG };
@@ -42,6 +43,12 @@ struct ComparisonRow
     KeyVerdict      keyVerdict;
     TrackVerdict    trackVerdict;
     QString         notes;
+
+    // Native-rate cross-check (only when enabled)
+    bool            crossChecked{false};
+    double          nativeBpm{0.0};
+    QString         nativeCamelot;
+    double          nativeAnalysisMs{0.0};
 };
 
 // ── Aggregate summary ──────────────────────────────────────────────
@@ -65,6 +72,15 @@ struct ComparatorSummary
     int keyAdjacent{0};
     int keyModeWrong{0};
     int keyRootWrong{0};
+
+    // ── Analysis rate / timing ──
+    double avgAnalysisMs{0.0};
+    int    crossChecked{0};
+    int    crossBpmMismatch{0};   // |decimated − native| > 0.1 BPM
+    int    crossKeyMismatch{0};   // Camelot differs
+    double crossBpmDeltaAvg{0.0}; // |decimated − native|
+    double crossBpmDeltaMax{0.0};
+    double avgNativeAnalysisMs{0.0};
 };
 
 // ── Comparator engine ──────────────────────────────────────────────
@@ -78,6 +94,13 @@ public:
              const QString& libRoot,
              const QString& proofDir);
 
+    // Analysis-rate front end used for the scored run.
+    void setRateConfig(const AnalysisRateConfig& cfg) { rateConfig_ = cfg; }
+
+    // Also analyse every track at the native rate and count BPM/key
+    // disagreements — proof that decimation does not move results.
+    void setNativeCrossCheck(bool enabled) { nativeCrossCheck_ = enabled; }
+
     const std::vector<ComparisonRow>& rows() const { return rows_; }
     const ComparatorSummary& summary()       const { return summary_; }
 
@@ -100,6 +123,9 @@ private:
     static QString camelotFromRootMode(const QString& root, const QString& mode);
     static QString relativeKey(const QString& camelot);
 
+    AnalysisRateConfig          rateConfig_;
+    bool                        nativeCrossCheck_{false};
+
     std::vector<BaselineRow>    baseline_;
     std::vector<ComparisonRow>  rows_;
     ComparatorSummary           summary_;
@@ -0,0 +1,129 @@
+#include "AnalysisDecimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NGKS_ANALYSIS_SSE 1
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// Single-precision dot product — the decimator's entire inner loop.
+inline float dotProduct(const float* a, const float* b, int n)
+{
+    int i = 0;
+    float sum = 0.0f;
+#if defined(NGKS_ANALYSIS_SSE)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+} // namespace
+
+// ════════════════════════════════════════════════════════════════════
+//  Filter design
+// ════════════════════════════════════════════════════════════════════
+
+PolyphaseDecimator::PolyphaseDecimator(int factor, int tapsPerPhase)
+    : factor_(std::max(1, factor))
+{
+    if (factor_ == 1) return;
+
+    // Odd length so the filter has an integer centre tap (zero-phase).
+    const int numTaps = factor_ * std::max(4, tapsPerPhase) + 1;
+    const double cutoff = 0.45 / static_cast<double>(factor_);  // cycles/sample
+    const double centre = (numTaps - 1) * 0.5;
+
+    taps_.resize(static_cast<size_t>(numTaps));
+    double sum = 0.0;
+    for (int i = 0; i < numTaps; ++i) {
+        const double t = static_cast<double>(i) - centre;
+        const double sinc = (t == 0.0)
+            ? 2.0 * cutoff
+            : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        const double phase = 2.0 * M_PI * i / (numTaps - 1);
+        const double blackman = 0.42 - 0.5 * std::cos(phase)
+                              + 0.08 * std::cos(2.0 * phase);
+        const double h = sinc * blackman;
+        taps_[static_cast<size_t>(i)] = static_cast<float>(h);
+        sum += h;
+    }
+    // Unity DC gain
+    if (sum > 0.0) {
+        for (auto& h : taps_) h = static_cast<float>(h / sum);
+    }
+}
+
+int PolyphaseDecimator::factorFor(double sourceRate, double targetRate)
+{
+    if (sourceRate <= 0.0 || targetRate <= 0.0) return 1;
+    return std::max(1, static_cast<int>(std::floor(sourceRate / targetRate + 1e-6)));
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  Decimation
+// ════════════════════════════════════════════════════════════════════
+
+std::vector<float> PolyphaseDecimator::process(const float* input,
+                                               int64_t numSamples) const
+{
+    if (numSamples <= 0) return {};
+    if (factor_ == 1) return std::vector<float>(input, input + numSamples);
+
+    const int numTaps = static_cast<int>(taps_.size());
+    const int64_t half = numTaps / 2;
+    const int64_t numOut = (numSamples + factor_ - 1) / factor_;
+
+    // Zero-pad both ends so every output is a contiguous dot product.
+    // (Symmetric taps — no reversal needed.)
+    std::vector<float> padded(static_cast<size_t>(numSamples + 2 * half), 0.0f);
+    std::copy(input, input + numSamples, padded.begin() + half);
+
+    std::vector<float> out(static_cast<size_t>(numOut));
+    const float* h = taps_.data();
+    for (int64_t k = 0; k < numOut; ++k) {
+        out[static_cast<size_t>(k)] =
+            dotProduct(h, padded.data() + k * factor_, numTaps);
+    }
+    return out;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  Rate-scaled frame sizes
+// ════════════════════════════════════════════════════════════════════
+
+int analysisHopForRate(double sampleRate, int hopAt44k)
+{
+    if (sampleRate <= 0.0) return hopAt44k;
+    const int hop = static_cast<int>(std::lround(hopAt44k * sampleRate / 44100.0));
+    return std::max(16, hop);
+}
+
+int analysisFftSizeForRate(double sampleRate, int fftAt44k)
+{
+    if (sampleRate <= 0.0) return fftAt44k;
+    // Nearest power of two to the time-equivalent length
+    const double ideal = fftAt44k * sampleRate / 44100.0;
+    int n = 256;
+    while (n * 2 <= 65536 && std::fabs(n * 2 - ideal) <= std::fabs(n - ideal))
+        n *= 2;
+    return n;
+}
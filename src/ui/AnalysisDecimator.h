@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ── Analysis-rate front end ────────────────────────────────────────
+//
+// BPM, key and envelope features need far less bandwidth than the
+// file's native 44.1/48/96 kHz.  The analysis pipeline decimates the
+// mono mixdown once into two reduced-rate buffers and feeds each stage
+// the lowest rate it can tolerate:
+//
+//   chroma rate (~22 kHz)  → key detection, BPM resolver (HF score)
+//   onset rate  (~11 kHz)  → onset-envelope BPM, cue/section envelopes
+//
+// LUFS, true peak, spectral centroid and ZCR-based features stay at
+// the native rate — they depend on the full spectrum.
+
+struct AnalysisRateConfig
+{
+    double chromaRateHz{22050.0};   // 0 = run at native rate
+    double onsetRateHz{11025.0};    // 0 = run at native rate
+};
+
+// ── Integer-factor polyphase FIR decimator ─────────────────────────
+//
+// Windowed-sinc (Blackman) low-pass with cutoff at 0.45 × output rate.
+// Only every factor-th output is computed, so the cost per output
+// sample is one tapsPerPhase × factor dot product (SSE on x86/x64).
+// The filter is applied zero-phase (centred), so event timings in the
+// decimated buffer line up with the source.
+
+class PolyphaseDecimator
+{
+public:
+    explicit PolyphaseDecimator(int factor, int tapsPerPhase = 24);
+
+    int factor() const { return factor_; }
+
+    // Decimate numSamples of input.  Output length = ceil(n / factor).
+    // factor 1 returns a straight copy.
+    std::vector<float> process(const float* input, int64_t numSamples) const;
+
+    // Largest integer factor that keeps the output rate >= targetRate.
+    // Returns 1 when targetRate <= 0 or already at/below the target.
+    static int factorFor(double sourceRate, double targetRate);
+
+private:
+    int factor_{1};
+    std::vector<float> taps_;
+};
+
+// Analysis hop/frame sizes were tuned at 44.1 kHz.  These keep the same
+// time resolution at any (decimated) rate.
+int analysisHopForRate(double sampleRate, int hopAt44k);
+int analysisFftSizeForRate(double sampleRate, int fftAt44k);
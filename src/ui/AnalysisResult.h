@@ -1,6 +1,33 @@
 #pragma once
 #include <QString>
+#include <array>
+#include <cstdint>
 #include <vector>
+#include "AudioFingerprint.h"
+#include "BeatTracker.h"
+
+// ── Analysis stages ────────────────────────────────────────────────
+//
+// Bit flags.  Each stage owns a disjoint group of AnalysisResult fields
+// and carries its own algorithm version, so a version bump re-runs only
+// that stage (plus the stages that consume its output).
+
+namespace AnalysisStage {
+    enum : uint32_t {
+        Tempo    = 1u << 0,     // bpm, resolver detail, beat grid
+        Loudness = 1u << 1,     // LUFS, peak, dynamic range
+        Spectral = 1u << 2,     // energy, spectral centroid
+        Cues     = 1u << 3,     // cue in/out, intro/outro
+        Key      = 1u << 4,     // Camelot + detail      (reads Spectral)
+        Derived  = 1u << 5,     // danceability … transition difficulty
+                                //                        (reads all above)
+        Fingerprint = 1u << 6,  // acoustic fingerprint (landmarks + sketch)
+        All      = (1u << 7) - 1
+    };
+    constexpr int kCount = 7;
+}
+
+using AnalysisStageVersions = std::array<uint32_t, AnalysisStage::kCount>;
 
 // ── Analysis output from AudioAnalysisService ──────────────────────
 
@@ -56,9 +83,70 @@ struct AnalysisResult
 
     // ── EXTRA ──
     double  beatGridConfidence{0.0};  // [0..1]
+    BeatGrid beatGrid;                // tracked beats + downbeat phase
     double  spectralCentroid{0.0};    // Hz — brightness proxy
     double  introDuration{0.0};       // seconds
     double  outroDuration{0.0};       // seconds
     double  durationSeconds{0.0};     // total file duration
     double  sampleRate{0.0};          // file sample rate
+    double  chromaRate{0.0};          // key/resolver analysis rate (Hz)
+    double  onsetRate{0.0};           // onset/envelope analysis rate (Hz)
+    double  analysisMs{0.0};          // wall time of analyzeFile
+    uint32_t cachedStages{0};         // AnalysisStage bits reused from cache
+
+    // ── FINGERPRINT ──
+    AudioFingerprint fingerprint;     // near-duplicate / version detection
 };
+
+// Copy the fields owned by the AnalysisStage bits in `stages` from src
+// into dst.  Used to merge stages that ran separately.
+inline void mergeAnalysisStages(AnalysisResult& dst, const AnalysisResult& src,
+                                uint32_t stages)
+{
+    using namespace AnalysisStage;
+    if (stages & Tempo) {
+        dst.bpm                = src.bpm;
+        dst.rawBpm             = src.rawBpm;
+        dst.resolvedBpm        = src.resolvedBpm;
+        dst.bpmConfidence      = src.bpmConfidence;
+        dst.bpmFamily          = src.bpmFamily;
+        dst.onsetDensity       = src.onsetDensity;
+        dst.hfPercussiveScore  = src.hfPercussiveScore;
+        dst.bpmCandidates      = src.bpmCandidates;
+        dst.beatGrid           = src.beatGrid;
+        dst.beatGridConfidence = src.beatGridConfidence;
+    }
+    if (stages & Loudness) {
+        dst.loudnessLUFS   = src.loudnessLUFS;
+        dst.peakDBFS       = src.peakDBFS;
+        dst.dynamicRangeLU = src.dynamicRangeLU;
+        dst.lra            = src.lra;
+    }
+    if (stages & Spectral) {
+        dst.energy           = src.energy;
+        dst.spectralCentroid = src.spectralCentroid;
+    }
+    if (stages & Cues) {
+        dst.cueInSeconds  = src.cueInSeconds;
+        dst.cueOutSeconds = src.cueOutSeconds;
+        dst.introDuration = src.introDuration;
+        dst.outroDuration = src.outroDuration;
+    }
+    if (stages & Key) {
+        dst.camelotKey          = src.camelotKey;
+        dst.keyConfidence       = src.keyConfidence;
+        dst.keyAmbiguous        = src.keyAmbiguous;
+        dst.keyRunnerUp         = src.keyRunnerUp;
+        dst.keyCorrectionReason = src.keyCorrectionReason;
+    }
+    if (stages & Derived) {
+        dst.danceability         = src.danceability;
+        dst.acousticness         = src.acousticness;
+        dst.instrumentalness     = src.instrumentalness;
+        dst.liveness             = src.liveness;
+        dst.transitionDifficulty = src.transitionDifficulty;
+    }
+    if (stages & Fingerprint) {
+        dst.fingerprint = src.fingerprint;
+    }
+}
@@ -0,0 +1,90 @@
+#include "AnalysisSession.h"
+#include "AudioAnalysisService.h"
+
+#include <QDebug>
+#include <QMetaObject>
+
+AnalysisSession::AnalysisSession(QObject* parent)
+    : QObject(parent)
+{
+}
+
+AnalysisSession::~AnalysisSession()
+{
+    for (auto& job : jobs_) job->cancel.store(true, std::memory_order_relaxed);
+    for (auto& job : jobs_) {
+        if (job->thread.joinable()) job->thread.join();
+    }
+}
+
+quint64 AnalysisSession::start(const QString& filePath, const QString& genreHint)
+{
+    cancel();
+    reapFinished();
+
+    auto job = std::make_unique<Job>();
+    job->id = nextId_++;
+    currentId_ = job->id;
+    Job* raw = job.get();
+
+    qDebug() << "[ANALYSIS_SESSION] START id=" << raw->id << filePath;
+
+    // Deliveries are queued onto this object's thread and dropped there if
+    // the job has been superseded in the meantime.  The destructor joins
+    // every worker, so `this` outlives all posts.
+    raw->thread = std::thread([this, raw, filePath, genreHint]() {
+        const quint64 id = raw->id;
+
+        AudioAnalysisService service;
+        service.setCache(cache_);
+        service.setParallelStages(true);
+
+        auto onStage = [this, id](uint32_t stages, const AnalysisResult& partial) {
+            QMetaObject::invokeMethod(this, [this, id, stages, partial]() {
+                if (id == currentId_) emit stageReady(id, stages, partial);
+            }, Qt::QueuedConnection);
+        };
+
+        AnalysisResult result = service.analyzeFile(filePath, genreHint,
+                                                    onStage, &raw->cancel);
+        const bool cancelled = raw->cancel.load(std::memory_order_relaxed);
+        raw->done.store(true, std::memory_order_release);
+
+        if (cancelled) {
+            qDebug() << "[ANALYSIS_SESSION] CANCELLED id=" << id;
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, id, result]() {
+            reapFinished();
+            if (id != currentId_) return;
+            currentId_ = 0;
+            emit finished(id, result);
+        }, Qt::QueuedConnection);
+    });
+
+    jobs_.push_back(std::move(job));
+    return currentId_;
+}
+
+void AnalysisSession::cancel()
+{
+    if (currentId_ == 0) return;
+    for (auto& job : jobs_) {
+        if (job->id == currentId_) job->cancel.store(true, std::memory_order_relaxed);
+    }
+    qDebug() << "[ANALYSIS_SESSION] CANCEL id=" << currentId_;
+    currentId_ = 0;
+}
+
+void AnalysisSession::reapFinished()
+{
+    for (auto it = jobs_.begin(); it != jobs_.end();) {
+        Job& job = **it;
+        if (job.done.load(std::memory_order_acquire)) {
+            if (job.thread.joinable()) job.thread.join();
+            it = jobs_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "AnalysisResult.h"
+
+class AnalysisCache;
+
+// ── Asynchronous single-track analysis ─────────────────────────────
+//
+// Runs AudioAnalysisService on a worker thread with parallel stages and
+// streams partial results back to the owning (UI) thread as each stage
+// completes.  Only the most recent job reports: start() and cancel()
+// retire the running job, which stops at its next decode chunk or stage
+// boundary and is never cached.  Signals are always emitted on the
+// thread that owns the session.
+
+class AnalysisSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AnalysisSession(QObject* parent = nullptr);
+    ~AnalysisSession() override;
+
+    // Optional, not owned.  Must outlive the session.
+    void setCache(AnalysisCache* cache) { cache_ = cache; }
+
+    // Cancels any running job.  Returns the new job id (never 0).
+    quint64 start(const QString& filePath, const QString& genreHint);
+    void cancel();
+
+    bool isRunning() const { return currentId_ != 0; }
+    quint64 currentId() const { return currentId_; }
+
+signals:
+    // `stages` is the AnalysisStage mask finished so far
+    // (0 = decoded, duration known).
+    void stageReady(quint64 id, uint32_t stages, const AnalysisResult& partial);
+    void finished(quint64 id, const AnalysisResult& result);
+
+private:
+    struct Job
+    {
+        quint64           id{0};
+        std::atomic<bool> cancel{false};
+        std::atomic<bool> done{false};
+        std::thread       thread;
+    };
+
+    void reapFinished();
+
+    AnalysisCache* cache_{nullptr};
+    quint64        nextId_{1};
+    quint64        currentId_{0};
+    std::vector<std::unique_ptr<Job>> jobs_;
+};
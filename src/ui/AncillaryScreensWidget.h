@@ -112,6 +112,9 @@ public:
             QObject::connect(bridge_, &EngineBridge::djSnapshotUpdated, this, [this]() {
                 onDeckSnapshotUpdated();
             });
+            QObject::connect(bridge_, &EngineBridge::deckDecodeComplete, this, [this](int) {
+                processPendingHandoffVerifications(false);
+            });
             QObject::connect(bridge_, &EngineBridge::deviceSwitchFinished, this,
                 [this](bool ok, const QString& device, long long ms) {
                     if (hardwareSwitchStatusLabel_) {
@@ -1,14 +1,19 @@
 #include "AudioAnalysisService.h"
+#include "AnalysisCache.h"
 #include "KeyDetectionService.h"
 #include "BpmResolverService.h"
+#include "ui/library/AudioContentHash.h"
 
 #include <juce_audio_formats/juce_audio_formats.h>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
 
 #include <algorithm>
 #include <cmath>
+#include <future>
+#include <mutex>
 #include <numeric>
 #include <vector>
 
@@ -26,10 +31,140 @@ AudioAnalysisService::AudioAnalysisService(QObject* parent)
 // ════════════════════════════════════════════════════════════════════
 
 AnalysisResult AudioAnalysisService::analyzeFile(const QString& filePath,
-                                                   const QString& genreHint)
+                                                   const QString& genreHint,
+                                                   const StageCallback& onStage,
+                                                   const std::atomic<bool>* cancel)
 {
-    AnalysisResult r;
-    qDebug() << "[ANALYSIS] ANALYSIS_START" << filePath;
+    if (!cache_) {
+        return runStages(filePath, genreHint, AnalysisStage::All, AnalysisResult{},
+                         onStage, cancel);
+    }
+
+    // ── Cache: reuse every stage whose version still matches ──
+    const AnalysisStageVersions versions = stageVersions();
+    const uint64_t contentHash = audioContentHash(filePath);
+
+    uint32_t       stale = AnalysisStage::All;
+    AnalysisResult seed;
+    if (contentHash != 0) {
+        AnalysisCache::Entry cached;
+        if (cache_->lookup(contentHash, cached)) {
+            uint32_t changed = AnalysisStage::All & ~cached.validStages;
+            for (int i = 0; i < AnalysisStage::kCount; ++i) {
+                if (cached.versions[static_cast<size_t>(i)] != versions[static_cast<size_t>(i)])
+                    changed |= 1u << i;
+            }
+            stale = withDependents(changed);
+            seed  = std::move(cached.result);
+        }
+    }
+
+    if (stale == 0) {
+        seed.cachedStages = AnalysisStage::All;
+        seed.analysisMs   = 0.0;
+        qDebug() << "[ANALYSIS] ANALYSIS_CACHE_HIT" << filePath
+                 << "hash=" << Qt::hex << contentHash;
+        seed.valid = true;
+        if (onStage) onStage(AnalysisStage::All, seed);
+        return seed;
+    }
+
+    AnalysisResult r = runStages(filePath, genreHint, stale, std::move(seed),
+                                 onStage, cancel);
+    if (r.valid && contentHash != 0) {
+        cache_->store(contentHash, versions, AnalysisStage::All, r);
+    }
+    qDebug() << "[ANALYSIS] ANALYSIS_CACHE_STORE" << filePath
+             << "recomputed=" << Qt::hex << stale
+             << "reused=" << r.cachedStages;
+    return r;
+}
+
+uint32_t AudioAnalysisService::withDependents(uint32_t stages)
+{
+    using namespace AnalysisStage;
+    if (stages & Spectral) stages |= Key;
+    if (stages & (Tempo | Loudness | Spectral | Cues)) stages |= Derived;
+    return stages & All;
+}
+
+AnalysisStageVersions AudioAnalysisService::stageVersions() const
+{
+    // Bump a stage's algorithm version whenever its output changes.
+    // Stages fed from decimated buffers also depend on the rate config.
+    constexpr uint32_t kTempoVersion    = 2;   // FFT ACF + comb, DP beat tracker
+    constexpr uint32_t kLoudnessVersion = 1;
+    constexpr uint32_t kSpectralVersion = 1;
+    constexpr uint32_t kCuesVersion     = 1;
+    constexpr uint32_t kKeyVersion      = 2;   // rate-scaled FFT size
+    constexpr uint32_t kDerivedVersion  = 2;   // tracked beat-grid confidence
+
+    auto mix = [this](uint32_t algo) {
+        uint32_t h = 2166136261u;
+        auto feed = [&h](uint32_t v) {
+            for (int b = 0; b < 4; ++b) { h ^= (v >> (8 * b)) & 0xFFu; h *= 16777619u; }
+        };
+        feed(algo);
+        feed(static_cast<uint32_t>(std::lround(rateConfig_.chromaRateHz)));
+        feed(static_cast<uint32_t>(std::lround(rateConfig_.onsetRateHz)));
+        return h;
+    };
+
+    AnalysisStageVersions v{};
+    v[0] = mix(kTempoVersion);
+    v[1] = mix(kLoudnessVersion);
+    v[2] = kSpectralVersion;                  // native rate only
+    v[3] = mix(kCuesVersion);
+    v[4] = mix(kKeyVersion);
+    v[5] = mix(kDerivedVersion);
+    v[6] = mix(AudioFingerprint::kVersion);
+    return v;
+}
+
+AnalysisResult AudioAnalysisService::runStages(const QString& filePath,
+                                                const QString& genreHint,
+                                                uint32_t stages,
+                                                AnalysisResult seed,
+                                                const StageCallback& onStage,
+                                                const std::atomic<bool>* cancel)
+{
+    using namespace AnalysisStage;
+
+    AnalysisResult r = std::move(seed);
+    r.valid        = false;
+    r.errorMsg.clear();
+    r.cachedStages = All & ~stages;
+
+    // Stages may finish on different threads; `r` and `done` are only
+    // touched under mergeMutex until every stage has been joined.
+    std::mutex mergeMutex;
+    uint32_t   done = r.cachedStages;
+    auto publish = [&](uint32_t bit, const AnalysisResult& part) {
+        AnalysisResult snapshot;
+        uint32_t       doneNow = 0;
+        {
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            if (bit != 0) mergeAnalysisStages(r, part, bit);
+            done |= bit;
+            if (!onStage) return;
+            snapshot = r;
+            doneNow  = done & All;
+        }
+        onStage(doneNow, snapshot);
+    };
+    auto isCancelled = [cancel]() {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    };
+    auto cancelledResult = [&]() {
+        AnalysisResult c;
+        c.errorMsg = QStringLiteral("Cancelled");
+        qDebug() << "[ANALYSIS] ANALYSIS_CANCELLED" << filePath;
+        return c;
+    };
+    qDebug() << "[ANALYSIS] ANALYSIS_START" << filePath
+             << "stages=" << Qt::hex << stages;
+    QElapsedTimer wallTimer;
+    wallTimer.start();
 
     // ── 1. Validate file ──
     QFileInfo fi(filePath);
@@ -82,6 +217,7 @@ AnalysisResult AudioAnalysisService::analyzeFile(const QString& filePath,
     // Read in chunks to limit stack-frame pointer arrays
     constexpr int64_t kChunk = 65536;
     for (int64_t pos = 0; pos < maxFrames; pos += kChunk) {
+        if (isCancelled()) return cancelledResult();
         const int64_t count = std::min(kChunk, maxFrames - pos);
         float* dest[2] = { left.data() + pos, right.data() + pos };
         reader->read(dest, (channels >= 2 ? 2 : 1),
@@ -102,100 +238,174 @@ AnalysisResult AudioAnalysisService::analyzeFile(const QString& filePath,
 
     qDebug() << "[ANALYSIS] BUFFERS_READY mono_samples=" << maxFrames;
 
-    // ── 4. Run analysis stages ──
-
-    r.bpm = detectBPM(mono.data(), maxFrames, sr);
-    qDebug() << "[ANALYSIS] ANALYSIS_BPM" << r.bpm;
-
-    // ── BPM Resolver: choose best tempo family ──
+    // ── 3b. Decimate to analysis rates ──
+    // chroma = mono ↓ M1, onset = chroma ↓ M2 (cascade is cheaper than
+    // decimating twice from native).  Factor 1 aliases the source buffer.
+    std::vector<float> chromaBuf;
+    std::vector<float> onsetBuf;
+    const float* chromaData = mono.data();
+    int64_t      chromaLen  = maxFrames;
+    double       chromaSr   = sr;
     {
-        BpmResolverService bpmResolver;
-        auto bpmResult = bpmResolver.resolve(r.bpm, mono.data(), maxFrames, sr,
-                                              genreHint);
-        r.rawBpm          = bpmResult.rawBpm;
-        r.resolvedBpm     = bpmResult.resolvedBpm;
-        r.bpmConfidence   = bpmResult.confidence;
-        r.bpmFamily       = bpmResult.selectedFamily;
-        r.onsetDensity    = bpmResult.onsetDensity;
-        r.hfPercussiveScore = bpmResult.hfPercussiveScore;
-        r.bpmCandidates   = bpmResult.candidates;
-        r.bpm             = bpmResult.resolvedBpm;  // overwrite with resolved
-        qDebug() << "[ANALYSIS] ANALYSIS_BPM_RESOLVED raw=" << r.rawBpm
-                 << "resolved=" << r.resolvedBpm
-                 << "family=" << r.bpmFamily
-                 << "confidence=" << r.bpmConfidence;
-    }
-
-    r.loudnessLUFS = detectLoudnessLUFS(left.data(), right.data(), maxFrames, sr);
-    qDebug() << "[ANALYSIS] ANALYSIS_LOUDNESS" << r.loudnessLUFS;
-
-    r.peakDBFS = detectPeakDBFS(mono.data(), maxFrames);
-    qDebug() << "[ANALYSIS] ANALYSIS_PEAK" << r.peakDBFS;
-
-    r.energy = detectEnergy(mono.data(), maxFrames);
-    qDebug() << "[ANALYSIS] ANALYSIS_ENERGY" << r.energy;
-
-    r.cueInSeconds = detectCueIn(mono.data(), maxFrames, sr);
-    qDebug() << "[ANALYSIS] ANALYSIS_CUE_IN" << r.cueInSeconds;
-
-    r.cueOutSeconds = detectCueOut(mono.data(), maxFrames, sr);
-    qDebug() << "[ANALYSIS] ANALYSIS_CUE_OUT" << r.cueOutSeconds;
-
-    r.dynamicRangeLU = detectDynamicRange(mono.data(), maxFrames, sr);
-    r.lra = r.dynamicRangeLU;  // alias
-    qDebug() << "[ANALYSIS] ANALYSIS_DYNAMIC_RANGE" << r.dynamicRangeLU;
-
-    r.spectralCentroid = detectSpectralCentroid(mono.data(), maxFrames, sr);
-    qDebug() << "[ANALYSIS] ANALYSIS_SPECTRAL_CENTROID" << r.spectralCentroid;
-
-    // ── 5. Beat grid confidence (from BPM detection) ──
-    // Re-measure with finer grain — ratio of autocorrelation peak to noise floor
+        const int m1 = PolyphaseDecimator::factorFor(sr, rateConfig_.chromaRateHz);
+        if (m1 > 1) {
+            chromaBuf  = PolyphaseDecimator(m1).process(mono.data(), maxFrames);
+            chromaData = chromaBuf.data();
+            chromaLen  = static_cast<int64_t>(chromaBuf.size());
+            chromaSr   = sr / m1;
+        }
+    }
+    const float* onsetData = chromaData;
+    int64_t      onsetLen  = chromaLen;
+    double       onsetSr   = chromaSr;
     {
-        // Simple estimate: if BPM is in typical range, confidence is higher
-        if (r.bpm >= 60.0 && r.bpm <= 200.0) {
-            r.beatGridConfidence = 0.8;
-        } else if (r.bpm > 0.0) {
-            r.beatGridConfidence = 0.4;
+        const int m2 = PolyphaseDecimator::factorFor(chromaSr, rateConfig_.onsetRateHz);
+        if (m2 > 1) {
+            onsetBuf  = PolyphaseDecimator(m2).process(chromaData, chromaLen);
+            onsetData = onsetBuf.data();
+            onsetLen  = static_cast<int64_t>(onsetBuf.size());
+            onsetSr   = chromaSr / m2;
         }
     }
+    r.chromaRate = chromaSr;
+    r.onsetRate  = onsetSr;
 
-    // ── 6. Derived features ──
+    qDebug() << "[ANALYSIS] DECIMATED chroma_sr=" << chromaSr
+             << "onset_sr=" << onsetSr
+             << "ms=" << wallTimer.elapsed();
 
-    r.danceability = computeDanceability(r.bpm, r.energy, r.beatGridConfidence);
-    r.acousticness = computeAcousticness(r.spectralCentroid, r.dynamicRangeLU,
-                                          r.energy);
-    r.instrumentalness = computeInstrumentalness(mono.data(), maxFrames, sr);
-    r.liveness = computeLiveness(mono.data(), maxFrames, sr);
+    if (isCancelled()) return cancelledResult();
 
-    qDebug() << "[ANALYSIS] ANALYSIS_FEATURES"
-             << "danceability=" << r.danceability
-             << "acousticness=" << r.acousticness
-             << "instrumentalness=" << r.instrumentalness
-             << "liveness=" << r.liveness;
+    // Duration / rates are known now — first progressive update.
+    publish(0, r);
 
-    // ── 7. Pro analysis ──
+    // ── 4. Run analysis stages ──
+    //    Stages not in `stages` keep the values carried in from the cache.
+    //    Each stage fills a private AnalysisResult and publishes only its
+    //    own fields, so independent stages can run on separate cores.
+
+    const double durationSeconds = r.durationSeconds;
+    const double seedCentroid    = r.spectralCentroid;
+
+    auto runTempo = [&]() {
+        if (!(stages & Tempo) || isCancelled()) return;
+        AnalysisResult t;
+        QElapsedTimer stageTimer;
+        stageTimer.start();
+        const BeatTracker::OnsetEnvelope onsetEnv =
+            BeatTracker::onsetEnvelope(onsetData, onsetLen, onsetSr);
+        t.bpm = detectBPM(onsetEnv);
+        qDebug() << "[ANALYSIS] ANALYSIS_BPM" << t.bpm
+                 << "ms=" << stageTimer.elapsed();
+
+        // ── BPM Resolver: choose best tempo family ──
+        {
+            BpmResolverService bpmResolver;
+            auto bpmResult = bpmResolver.resolve(t.bpm, chromaData, chromaLen, chromaSr,
+                                                  genreHint);
+            t.rawBpm          = bpmResult.rawBpm;
+            t.resolvedBpm     = bpmResult.resolvedBpm;
+            t.bpmConfidence   = bpmResult.confidence;
+            t.bpmFamily       = bpmResult.selectedFamily;
+            t.onsetDensity    = bpmResult.onsetDensity;
+            t.hfPercussiveScore = bpmResult.hfPercussiveScore;
+            t.bpmCandidates   = bpmResult.candidates;
+            t.bpm             = bpmResult.resolvedBpm;  // overwrite with resolved
+            qDebug() << "[ANALYSIS] ANALYSIS_BPM_RESOLVED raw=" << t.rawBpm
+                     << "resolved=" << t.resolvedBpm
+                     << "family=" << t.bpmFamily
+                     << "confidence=" << t.bpmConfidence;
+        }
+        if (isCancelled()) return;
+
+        // ── Beat grid: track beats at the resolved tempo ──
+        // The tracker's regression over all beats refines the tempo well
+        // below the envelope's lag quantisation; adopt it as the final BPM.
+        stageTimer.restart();
+        t.beatGrid = BeatTracker::track(onsetEnv, t.bpm);
+        if (!t.beatGrid.empty()) {
+            t.bpm = std::round(t.beatGrid.bpm * 10.0) / 10.0;
+        }
+        qDebug() << "[ANALYSIS] ANALYSIS_BEATGRID beats=" << t.beatGrid.beats.size()
+                 << "bpm=" << t.beatGrid.bpm
+                 << "downbeatPhase=" << t.beatGrid.downbeatPhase
+                 << "confidence=" << t.beatGrid.confidence
+                 << "ms=" << stageTimer.elapsed();
+
+        // Beat grid confidence: onset support at the tracked beats; fall
+        // back to a range heuristic when the tracker could not lock (very
+        // short or beatless audio).
+        if (!t.beatGrid.empty()) {
+            t.beatGridConfidence = t.beatGrid.confidence;
+        } else if (t.bpm >= 60.0 && t.bpm <= 200.0) {
+            t.beatGridConfidence = 0.8;
+        } else if (t.bpm > 0.0) {
+            t.beatGridConfidence = 0.4;
+        }
+        publish(Tempo, t);
+    };
+
+    auto runLoudness = [&]() {
+        if (!(stages & Loudness) || isCancelled()) return;
+        AnalysisResult l;
+        l.loudnessLUFS = detectLoudnessLUFS(left.data(), right.data(), maxFrames, sr);
+        qDebug() << "[ANALYSIS] ANALYSIS_LOUDNESS" << l.loudnessLUFS;
+
+        l.peakDBFS = detectPeakDBFS(mono.data(), maxFrames);
+        qDebug() << "[ANALYSIS] ANALYSIS_PEAK" << l.peakDBFS;
+
+        l.dynamicRangeLU = detectDynamicRange(onsetData, onsetLen, onsetSr);
+        l.lra = l.dynamicRangeLU;  // alias
+        qDebug() << "[ANALYSIS] ANALYSIS_DYNAMIC_RANGE" << l.dynamicRangeLU;
+        publish(Loudness, l);
+    };
+
+    // Key reads the spectral centroid as a brightness hint, so the two
+    // run back to back on the same core.
+    auto runSpectralAndKey = [&]() {
+        double centroid = seedCentroid;
+        if ((stages & Spectral) && !isCancelled()) {
+            AnalysisResult sp;
+            sp.energy = detectEnergy(mono.data(), maxFrames);
+            qDebug() << "[ANALYSIS] ANALYSIS_ENERGY" << sp.energy;
+
+            sp.spectralCentroid = detectSpectralCentroid(mono.data(), maxFrames, sr);
+            qDebug() << "[ANALYSIS] ANALYSIS_SPECTRAL_CENTROID" << sp.spectralCentroid;
+            centroid = sp.spectralCentroid;
+            publish(Spectral, sp);
+        }
 
-    {
-        KeyDetectionService keyDetector;
-        auto keyResult = keyDetector.detect(mono.data(), maxFrames, sr,
-                                            r.spectralCentroid);
-        r.camelotKey          = keyResult.finalCamelot;
-        r.keyConfidence       = keyResult.confidence;
-        r.keyAmbiguous        = keyResult.ambiguous;
-        r.keyRunnerUp         = keyResult.runnerUpKey;
-        r.keyCorrectionReason = keyResult.correctionReason;
-    }
-    qDebug() << "[ANALYSIS] ANALYSIS_CAMELOT" << r.camelotKey
-             << "confidence=" << r.keyConfidence
-             << "ambiguous=" << r.keyAmbiguous;
-
-    // Section detection: rough intro/outro
-    {
+        if ((stages & Key) && !isCancelled()) {
+            AnalysisResult k;
+            KeyDetectionService keyDetector;
+            auto keyResult = keyDetector.detect(chromaData, chromaLen, chromaSr, centroid);
+            k.camelotKey          = keyResult.finalCamelot;
+            k.keyConfidence       = keyResult.confidence;
+            k.keyAmbiguous        = keyResult.ambiguous;
+            k.keyRunnerUp         = keyResult.runnerUpKey;
+            k.keyCorrectionReason = keyResult.correctionReason;
+            qDebug() << "[ANALYSIS] ANALYSIS_CAMELOT" << k.camelotKey
+                     << "confidence=" << k.keyConfidence
+                     << "ambiguous=" << k.keyAmbiguous;
+            publish(Key, k);
+        }
+    };
+
+    auto runCues = [&]() {
+        if (!(stages & Cues) || isCancelled()) return;
+        AnalysisResult c;
+        c.cueInSeconds = detectCueIn(onsetData, onsetLen, onsetSr);
+        qDebug() << "[ANALYSIS] ANALYSIS_CUE_IN" << c.cueInSeconds;
+
+        c.cueOutSeconds = detectCueOut(onsetData, onsetLen, onsetSr);
+        qDebug() << "[ANALYSIS] ANALYSIS_CUE_OUT" << c.cueOutSeconds;
+
+        // Section detection: rough intro/outro
         // Intro = time until energy first exceeds 30% of peak sustained energy
         // Outro = time after energy drops below 30% of peak for the last time
         double peakRMS = 0.0;
-        const int64_t windowSamples = static_cast<int64_t>(sr * 0.5); // 500ms windows
-        const int64_t numWindows = maxFrames / windowSamples;
+        const int64_t windowSamples = static_cast<int64_t>(onsetSr * 0.5); // 500ms windows
+        const int64_t numWindows = onsetLen / windowSamples;
 
         std::vector<double> windowEnergies;
         windowEnergies.reserve(static_cast<size_t>(numWindows));
@@ -203,7 +413,7 @@ AnalysisResult AudioAnalysisService::analyzeFile(const QString& filePath,
         for (int64_t w = 0; w < numWindows; ++w) {
             double sum = 0.0;
             for (int64_t i = 0; i < windowSamples; ++i) {
-                double s = mono[static_cast<size_t>(w * windowSamples + i)];
+                double s = onsetData[w * windowSamples + i];
                 sum += s * s;
             }
             double rms = std::sqrt(sum / static_cast<double>(windowSamples));
@@ -212,108 +422,106 @@ AnalysisResult AudioAnalysisService::analyzeFile(const QString& filePath,
         }
 
         double threshold = peakRMS * 0.3;
-        r.introDuration = 0.0;
-        r.outroDuration = 0.0;
+        c.introDuration = 0.0;
+        c.outroDuration = 0.0;
 
         // Find intro end
         for (size_t i = 0; i < windowEnergies.size(); ++i) {
             if (windowEnergies[i] >= threshold) {
-                r.introDuration = static_cast<double>(i) * 0.5;
+                c.introDuration = static_cast<double>(i) * 0.5;
                 break;
             }
         }
         // Find outro start
         for (size_t i = windowEnergies.size(); i > 0; --i) {
             if (windowEnergies[i - 1] >= threshold) {
-                r.outroDuration = r.durationSeconds
+                c.outroDuration = durationSeconds
                     - static_cast<double>(i) * 0.5;
-                if (r.outroDuration < 0.0) r.outroDuration = 0.0;
+                if (c.outroDuration < 0.0) c.outroDuration = 0.0;
                 break;
             }
         }
+        publish(Cues, c);
+    };
+
+    auto runFingerprint = [&]() {
+        if (!(stages & Fingerprint) || isCancelled()) return;
+        AnalysisResult fp;
+        QElapsedTimer stageTimer;
+        stageTimer.start();
+        fp.fingerprint = AudioFingerprint::compute(onsetData, onsetLen, onsetSr);
+        qDebug() << "[ANALYSIS] ANALYSIS_FINGERPRINT landmarks=" << fp.fingerprint.landmarks
+                 << "sampled=" << fp.fingerprint.hashes.size()
+                 << "ms=" << stageTimer.elapsed();
+        publish(Fingerprint, fp);
+    };
+
+    if (parallelStages_) {
+        // Tempo and key are the two heavy stages; give each its own core
+        // and run the light ones here meanwhile.
+        auto tempoTask = std::async(std::launch::async, runTempo);
+        auto keyTask   = std::async(std::launch::async, runSpectralAndKey);
+        runLoudness();
+        runCues();
+        runFingerprint();
+        tempoTask.get();
+        keyTask.get();
+    } else {
+        // Progressive order: loudness/peak, BPM, key, then the rest.
+        runLoudness();
+        runTempo();
+        runSpectralAndKey();
+        runCues();
+        runFingerprint();
     }
 
-    r.transitionDifficulty = computeTransitionDifficulty(
-        r.bpm, r.energy, r.dynamicRangeLU, r.introDuration);
-    qDebug() << "[ANALYSIS] ANALYSIS_TRANSITION_DIFFICULTY"
-             << r.transitionDifficulty;
+    if (isCancelled()) return cancelledResult();
+
+    // ── 6. Derived features (read every stage above) ──
+
+    if (stages & Derived) {
+        AnalysisResult d;
+        d.danceability = computeDanceability(r.bpm, r.energy, r.beatGridConfidence);
+        d.acousticness = computeAcousticness(r.spectralCentroid, r.dynamicRangeLU,
+                                              r.energy);
+        d.instrumentalness = computeInstrumentalness(mono.data(), maxFrames, sr);
+        d.liveness = computeLiveness(onsetData, onsetLen, onsetSr);
+
+        qDebug() << "[ANALYSIS] ANALYSIS_FEATURES"
+                 << "danceability=" << d.danceability
+                 << "acousticness=" << d.acousticness
+                 << "instrumentalness=" << d.instrumentalness
+                 << "liveness=" << d.liveness;
+
+        d.transitionDifficulty = computeTransitionDifficulty(
+            r.bpm, r.energy, r.dynamicRangeLU, r.introDuration);
+        qDebug() << "[ANALYSIS] ANALYSIS_TRANSITION_DIFFICULTY"
+                 << d.transitionDifficulty;
+        publish(Derived, d);
+    }
 
     r.valid = true;
+    r.analysisMs = static_cast<double>(wallTimer.nsecsElapsed()) / 1.0e6;
     qDebug() << "[ANALYSIS] ANALYSIS_COMPLETE" << filePath
              << "bpm=" << r.bpm
              << "lufs=" << r.loudnessLUFS
-             << "energy=" << r.energy;
+             << "energy=" << r.energy
+             << "ms=" << r.analysisMs;
 
     return r;
 }
 
 // ════════════════════════════════════════════════════════════════════
-//  BPM DETECTION — Onset envelope autocorrelation
+//  BPM DETECTION — FFT autocorrelation + comb over onset envelope
 // ════════════════════════════════════════════════════════════════════
 
-double AudioAnalysisService::detectBPM(const float* data, int64_t numSamples,
-                                        double sampleRate)
+double AudioAnalysisService::detectBPM(const BeatTracker::OnsetEnvelope& onsetEnv)
 {
-    // 1. Build onset strength envelope (half-wave rectified spectral flux proxy)
-    //    We use frame-by-frame RMS differences as a lightweight onset function.
-
-    const int hopSize   = 512;
-    const int frameSize = 1024;
-    const int64_t numHops = (numSamples - frameSize) / hopSize;
-    if (numHops < 2) return 0.0;
-
-    std::vector<float> onsetEnv(static_cast<size_t>(numHops), 0.0f);
-
-    // Compute RMS per frame
-    std::vector<float> rmsVec(static_cast<size_t>(numHops));
-    for (int64_t h = 0; h < numHops; ++h) {
-        double sum = 0.0;
-        const float* frame = data + h * hopSize;
-        for (int i = 0; i < frameSize; ++i) {
-            sum += static_cast<double>(frame[i]) * frame[i];
-        }
-        rmsVec[static_cast<size_t>(h)] = static_cast<float>(
-            std::sqrt(sum / frameSize));
-    }
-
-    // Onset = positive first-difference of RMS (half-wave rectified)
-    for (int64_t h = 1; h < numHops; ++h) {
-        float diff = rmsVec[static_cast<size_t>(h)]
-                   - rmsVec[static_cast<size_t>(h - 1)];
-        onsetEnv[static_cast<size_t>(h)] = std::max(0.0f, diff);
-    }
-
-    // 2. Autocorrelation of onset envelope
-    //    Search BPM range 60..200 → lag range in onset frames
-    const double onsetRate = sampleRate / hopSize;  // frames/sec in onset domain
-    const int lagMin = static_cast<int>(onsetRate * 60.0 / 200.0); // lag for 200 BPM
-    const int lagMax = static_cast<int>(onsetRate * 60.0 / 60.0);  // lag for 60 BPM
-    const int maxLag = std::min(lagMax, static_cast<int>(numHops / 2));
-
-    if (lagMin >= maxLag) return 0.0;
-
-    double bestCorr = 0.0;
-    int    bestLag  = lagMin;
-
-    for (int lag = lagMin; lag <= maxLag; ++lag) {
-        double corr = 0.0;
-        const int64_t limit = numHops - lag;
-        for (int64_t i = 0; i < limit; ++i) {
-            corr += static_cast<double>(onsetEnv[static_cast<size_t>(i)])
-                  * onsetEnv[static_cast<size_t>(i + lag)];
-        }
-        // Normalize
-        corr /= static_cast<double>(limit);
-
-        if (corr > bestCorr) {
-            bestCorr = corr;
-            bestLag  = lag;
-        }
-    }
-
-    if (bestLag <= 0) return 0.0;
-
-    double bpm = onsetRate * 60.0 / bestLag;
+    // Envelope + tempo search live in BeatTracker so the beat tracker
+    // works from exactly the same onset frames.
+    const BeatTracker::TempoEstimate est = BeatTracker::estimateTempo(onsetEnv);
+    double bpm = est.bpm;
+    if (bpm <= 0.0) return 0.0;
 
     // Normalize to 60-200 BPM range (halve or double if outside)
     while (bpm > 200.0 && bpm > 0.0) bpm /= 2.0;
@@ -2,6 +2,13 @@
 #include <QObject>
 #include <QString>
 #include "AnalysisResult.h"
+#include "AnalysisDecimator.h"
+#include "BeatTracker.h"
+
+#include <atomic>
+#include <functional>
+
+class AnalysisCache;
 
 // ── Real audio analysis service ────────────────────────────────────
 //
@@ -15,21 +22,64 @@ class AudioAnalysisService : public QObject
 public:
     explicit AudioAnalysisService(QObject* parent = nullptr);
 
+    // Called as each stage completes with the AnalysisStage bits done so
+    // far (0 = decoded, duration known) and a snapshot of the result.
+    // May be invoked from a stage worker thread.
+    using StageCallback = std::function<void(uint32_t doneStages,
+                                             const AnalysisResult& partial)>;
+
     // Run the full analysis pipeline on a file.
     // Blocking call — run from worker thread for large files.
     // genre hint is used by the BPM resolver for soft tempo-family bias.
+    // With a cache attached, stages whose version is unchanged are reused
+    // and only the stale ones (plus their dependents) are recomputed.
+    // `cancel` is polled between decode chunks and stages; a cancelled
+    // run returns valid=false and is not cached.
     AnalysisResult analyzeFile(const QString& filePath,
-                               const QString& genreHint = {});
+                               const QString& genreHint = {},
+                               const StageCallback& onStage = {},
+                               const std::atomic<bool>* cancel = nullptr);
+
+    // Run independent stages (tempo, key, loudness/cues) on separate
+    // threads.  Off by default: batch workers already fill every core.
+    void setParallelStages(bool on) { parallelStages_ = on; }
+
+    // Optional, not owned.  Thread-safe, so workers may share one cache.
+    void setCache(AnalysisCache* cache) { cache_ = cache; }
+
+    // Per-stage algorithm version mixed with the rate config that feeds it.
+    AnalysisStageVersions stageVersions() const;
+
+    // Adds every stage that consumes the output of a stage in `stages`.
+    static uint32_t withDependents(uint32_t stages);
 
     // Lightweight JUCE-based duration probe (seconds). Returns 0.0 on failure.
     // Does NOT run any DSP — just opens the file, reads frame count / sample rate.
     static double probeDurationSeconds(const QString& filePath);
 
+    // Analysis-rate front end.  Stages that only need low bandwidth run
+    // on decimated copies of the mono mixdown (see AnalysisDecimator.h).
+    void setRateConfig(const AnalysisRateConfig& cfg) { rateConfig_ = cfg; }
+    const AnalysisRateConfig& rateConfig() const { return rateConfig_; }
+
 private:
+    AnalysisRateConfig rateConfig_;
+    AnalysisCache*     cache_{nullptr};
+    bool               parallelStages_{false};
+
+    // Decode + run the AnalysisStage bits in `stages`; other stages keep
+    // their values from `seed`.
+    AnalysisResult runStages(const QString& filePath, const QString& genreHint,
+                             uint32_t stages, AnalysisResult seed,
+                             const StageCallback& onStage,
+                             const std::atomic<bool>* cancel);
+
     // ── Individual analysis stages (operate on mono mixdown buffer) ──
+    //    sampleRate is the rate of the buffer passed in, which may be a
+    //    decimated analysis rate rather than the file's native rate.
 
-    // Tempo detection via autocorrelation of onset envelope
-    double detectBPM(const float* data, int64_t numSamples, double sampleRate);
+    // Tempo detection — FFT autocorrelation + comb over the onset envelope
+    double detectBPM(const BeatTracker::OnsetEnvelope& onsetEnv);
 
     // Integrated loudness per ITU-R BS.1770 (simplified K-weighted)
     double detectLoudnessLUFS(const float* left, const float* right,
@@ -0,0 +1,374 @@
+#include "AudioFingerprint.h"
+#include "AnalysisDecimator.h"
+#include "engine/dsp/Fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+constexpr double kMinHz          = 200.0;
+constexpr int    kBandsPerOctave = 24;
+constexpr int    kBandCount      = 104;     // 200 Hz … ~4.1 kHz, 7 bits
+constexpr int    kBandRadius     = 3;       // peak neighbourhood, ± bands
+constexpr int    kFrameRadius    = 4;       // peak neighbourhood, ± frames
+constexpr int    kPeaksPerFrame  = 3;
+constexpr int    kFanOut         = 3;       // target peaks per anchor
+constexpr int    kTimeQuantum    = 2;       // frames per hashed time step
+constexpr int    kMaxFrameDelta  = 63 * kTimeQuantum;   // 6 bits, ~5.8 s
+constexpr int    kMaxBandDelta   = 31;      // 6 bits with sign offset
+constexpr int    kMinLandmarks   = 64;
+constexpr uint32_t kSampleMask   = 15;      // keep 1 in 16 hashes
+constexpr float  kProminence     = 1.386f;  // ln(4): 6 dB above frame mean
+constexpr double kSilenceRatio   = 1.0e-6;  // frame power vs loudest, -60 dB
+
+constexpr uint8_t kFpMagic0 = 'F';
+constexpr uint8_t kFpMagic1 = 'P';
+
+struct Peak
+{
+    int   frame{0};
+    int   band{0};
+    float strength{0.0f};           // log power above frame mean
+};
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool getVarint(const uint8_t* data, size_t size, size_t& pos, uint64_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= size) return false;
+        const uint8_t b = data[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// i-th MinHash permutation of a landmark hash (splitmix64 finalizer).
+inline uint32_t permute(uint32_t hash, int i)
+{
+    uint64_t z = ((static_cast<uint64_t>(i) << 32) | hash) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+}
+
+AudioFingerprint::Overlap overlapFrom(double shared, size_t sizeA, size_t sizeB)
+{
+    AudioFingerprint::Overlap o;
+    const double unionSize = static_cast<double>(sizeA + sizeB) - shared;
+    const double smaller   = static_cast<double>(std::min(sizeA, sizeB));
+    o.shared      = static_cast<int>(std::lround(shared));
+    o.jaccard     = unionSize > 0.0 ? shared / unionSize : 0.0;
+    o.containment = smaller > 0.0 ? std::min(1.0, shared / smaller) : 0.0;
+    return o;
+}
+
+} // namespace
+
+// ════════════════════════════════════════════════════════════════════
+//  COMPUTE
+// ════════════════════════════════════════════════════════════════════
+
+AudioFingerprint AudioFingerprint::compute(const float* mono, int64_t numSamples,
+                                           double sampleRate)
+{
+    AudioFingerprint fp;
+    fp.sketch.fill(std::numeric_limits<uint32_t>::max());
+    if (!mono || sampleRate <= 0.0) return fp;
+
+    // ~93 ms frames, ~46 ms hop at any rate, so frame deltas (part of the
+    // hash) mean the same time for 44.1 and 48 kHz sources.
+    const int fftSize = analysisFftSizeForRate(sampleRate, 4096);
+    const int hop     = analysisHopForRate(sampleRate, 2048);
+    if (numSamples < fftSize) return fp;
+    const int64_t numFrames = (numSamples - fftSize) / hop + 1;
+    if (numFrames < 2 * kFrameRadius + 2) return fp;
+
+    // ── 1. Log-frequency spectrogram ──
+    const int halfBins = fftSize / 2 + 1;
+    std::vector<int> binToBand(static_cast<size_t>(halfBins), -1);
+    std::vector<char> bandUsed(kBandCount, 0);
+    for (int k = 1; k < halfBins; ++k) {
+        const double freq = static_cast<double>(k) * sampleRate / fftSize;
+        if (freq < kMinHz || freq > 0.45 * sampleRate) continue;
+        const int band = static_cast<int>(std::floor(std::log2(freq / kMinHz) * kBandsPerOctave));
+        if (band < 0 || band >= kBandCount) continue;
+        binToBand[static_cast<size_t>(k)] = band;
+        bandUsed[static_cast<size_t>(band)] = 1;
+    }
+    int usedBands = 0;
+    for (char u : bandUsed) usedBands += u;
+    if (usedBands == 0) return fp;
+
+    std::vector<double> window(static_cast<size_t>(fftSize));
+    for (int i = 0; i < fftSize; ++i)
+        window[static_cast<size_t>(i)] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / (fftSize - 1)));
+
+    constexpr float kFloor = -std::numeric_limits<float>::infinity();
+    const size_t frames = static_cast<size_t>(numFrames);
+    std::vector<float>  spec(frames * kBandCount, kFloor);
+    std::vector<float>  frameMean(frames, 0.0f);
+    std::vector<double> framePower(frames, 0.0);
+    std::vector<double> power(kBandCount);
+    std::vector<double> fftBuf(static_cast<size_t>(fftSize) * 2);
+    const Fft fft(fftSize);
+
+    double loudest = 0.0;
+    for (size_t f = 0; f < frames; ++f) {
+        const float* x = mono + static_cast<int64_t>(f) * hop;
+        for (int i = 0; i < fftSize; ++i) {
+            fftBuf[2 * static_cast<size_t>(i)]     = x[i] * window[static_cast<size_t>(i)];
+            fftBuf[2 * static_cast<size_t>(i) + 1] = 0.0;
+        }
+        fft.forward(fftBuf.data());
+
+        std::fill(power.begin(), power.end(), 0.0);
+        double total = 0.0;
+        for (int k = 1; k < halfBins; ++k) {
+            const int band = binToBand[static_cast<size_t>(k)];
+            if (band < 0) continue;
+            const double re = fftBuf[2 * static_cast<size_t>(k)];
+            const double im = fftBuf[2 * static_cast<size_t>(k) + 1];
+            const double p  = re * re + im * im;
+            power[static_cast<size_t>(band)] = std::max(power[static_cast<size_t>(band)], p);
+            total += p;
+        }
+
+        float* row = &spec[f * kBandCount];
+        double sum = 0.0;
+        for (int b = 0; b < kBandCount; ++b) {
+            if (!bandUsed[static_cast<size_t>(b)]) continue;
+            row[b] = static_cast<float>(std::log(power[static_cast<size_t>(b)] + 1.0e-12));
+            sum += row[b];
+        }
+        frameMean[f]  = static_cast<float>(sum / usedBands);
+        framePower[f] = total;
+        loudest = std::max(loudest, total);
+    }
+    if (loudest <= 0.0) return fp;
+
+    // ── 2. Peaks: separable max filter, bands then frames ──
+    std::vector<float> bandMax(spec.size(), kFloor);
+    for (size_t f = 0; f < frames; ++f) {
+        const float* row = &spec[f * kBandCount];
+        float* out = &bandMax[f * kBandCount];
+        for (int b = 0; b < kBandCount; ++b) {
+            const int lo = std::max(0, b - kBandRadius);
+            const int hi = std::min(kBandCount - 1, b + kBandRadius);
+            out[b] = *std::max_element(row + lo, row + hi + 1);
+        }
+    }
+
+    std::vector<Peak> peaks;
+    peaks.reserve(frames * kPeaksPerFrame / 2);
+    std::vector<Peak> candidates;
+    const double silence = loudest * kSilenceRatio;
+    for (size_t f = 0; f < frames; ++f) {
+        if (framePower[f] < silence) continue;
+        const size_t lo = f >= static_cast<size_t>(kFrameRadius) ? f - kFrameRadius : 0;
+        const size_t hi = std::min(frames - 1, f + kFrameRadius);
+        const float* row = &spec[f * kBandCount];
+
+        candidates.clear();
+        for (int b = 0; b < kBandCount; ++b) {
+            const float s = row[b];
+            if (s == kFloor || s < frameMean[f] + kProminence) continue;
+            bool isMax = true;
+            for (size_t g = lo; g <= hi && isMax; ++g)
+                isMax = bandMax[g * kBandCount + static_cast<size_t>(b)] <= s;
+            if (isMax)
+                candidates.push_back({static_cast<int>(f), b, s - frameMean[f]});
+        }
+        if (static_cast<int>(candidates.size()) > kPeaksPerFrame) {
+            std::partial_sort(candidates.begin(), candidates.begin() + kPeaksPerFrame,
+                              candidates.end(), [](const Peak& a, const Peak& b) {
+                                  return a.strength > b.strength;
+                              });
+            candidates.resize(kPeaksPerFrame);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Peak& a, const Peak& b) {
+            return a.band < b.band;
+        });
+        peaks.insert(peaks.end(), candidates.begin(), candidates.end());
+    }
+
+    // ── 3. Landmarks: anchor + each pair of its next kFanOut peaks ──
+    //    hash = band(7) | Δband1(6) | Δband2(6) | Δt1(6) | Δt2(6).
+    //    Triplets are far more specific than peak pairs (unrelated tracks
+    //    share ~5× fewer); time steps of two frames absorb most of the
+    //    one-frame jitter a different lead-in or encoder delay causes.
+    std::vector<uint32_t> hashes;
+    hashes.reserve(peaks.size() * kFanOut);
+    for (size_t i = 0; i < peaks.size(); ++i) {
+        const Peak& a = peaks[i];
+        size_t targets[kFanOut];
+        int found = 0;
+        for (size_t j = i + 1; j < peaks.size() && found < kFanOut; ++j) {
+            const int dt = peaks[j].frame - a.frame;
+            if (dt > kMaxFrameDelta) break;
+            const int db = peaks[j].band - a.band;
+            if (dt < 1 || db < -kMaxBandDelta || db > kMaxBandDelta) continue;
+            targets[found++] = j;
+        }
+        for (int x = 0; x < found; ++x) {
+            for (int y = x + 1; y < found; ++y) {
+                const Peak& b = peaks[targets[x]];
+                const Peak& c = peaks[targets[y]];
+                hashes.push_back((static_cast<uint32_t>(a.band) << 24)
+                    | (static_cast<uint32_t>(b.band - a.band + kMaxBandDelta + 1) << 18)
+                    | (static_cast<uint32_t>(c.band - a.band + kMaxBandDelta + 1) << 12)
+                    | (static_cast<uint32_t>((b.frame - a.frame) / kTimeQuantum) << 6)
+                    |  static_cast<uint32_t>((c.frame - a.frame) / kTimeQuantum));
+            }
+        }
+    }
+
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    if (static_cast<int>(hashes.size()) < kMinLandmarks) return fp;
+
+    // Sketch over every landmark; keep a consistent sample for exact
+    // comparison (the same hashes survive in every track, so overlaps of
+    // samples estimate overlaps of the full sets).
+    fp.landmarks = static_cast<uint32_t>(hashes.size());
+    fp.sketch    = sketchOf(hashes);
+    hashes.erase(std::remove_if(hashes.begin(), hashes.end(), [](uint32_t h) {
+                     return (permute(h, kSketchSize) & kSampleMask) != 0;
+                 }), hashes.end());
+    fp.hashes = std::move(hashes);
+    return fp;
+}
+
+AudioFingerprint::Sketch AudioFingerprint::sketchOf(const std::vector<uint32_t>& sortedHashes)
+{
+    Sketch s;
+    s.fill(std::numeric_limits<uint32_t>::max());
+    for (int i = 0; i < kSketchSize; ++i) {
+        uint32_t m = std::numeric_limits<uint32_t>::max();
+        for (uint32_t h : sortedHashes) m = std::min(m, permute(h, i));
+        s[static_cast<size_t>(i)] = m;
+    }
+    return s;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  STORAGE
+// ════════════════════════════════════════════════════════════════════
+
+std::vector<uint8_t> AudioFingerprint::encode() const
+{
+    std::vector<uint8_t> out;
+    out.reserve(12 + hashes.size() * 4);
+    out.push_back(kFpMagic0);
+    out.push_back(kFpMagic1);
+    out.push_back(static_cast<uint8_t>(kVersion));
+    putVarint(out, landmarks);
+    putVarint(out, hashes.size());
+    uint32_t prev = 0;
+    for (uint32_t h : hashes) {
+        putVarint(out, h - prev);
+        prev = h;
+    }
+    return out;
+}
+
+bool AudioFingerprint::decode(const uint8_t* data, size_t size, AudioFingerprint& out)
+{
+    if (!data || size < 4) return false;
+    if (data[0] != kFpMagic0 || data[1] != kFpMagic1 || data[2] != kVersion)
+        return false;
+
+    size_t pos = 3;
+    uint64_t landmarks = 0;
+    uint64_t count = 0;
+    if (!getVarint(data, size, pos, landmarks) || !getVarint(data, size, pos, count))
+        return false;
+    if (landmarks > std::numeric_limits<uint32_t>::max() || count > landmarks) return false;
+    if (count > size) return false;     // every hash needs >= 1 byte
+
+    AudioFingerprint fp;
+    fp.landmarks = static_cast<uint32_t>(landmarks);
+    fp.hashes.reserve(static_cast<size_t>(count));
+    uint64_t h = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t delta = 0;
+        if (!getVarint(data, size, pos, delta)) return false;
+        h += delta;
+        if (h > std::numeric_limits<uint32_t>::max()) return false;
+        fp.hashes.push_back(static_cast<uint32_t>(h));
+    }
+    fp.sketch = out.sketch;            // stored separately (encodeSketch)
+    out = std::move(fp);
+    return true;
+}
+
+std::vector<uint8_t> AudioFingerprint::encodeSketch(const Sketch& sketch)
+{
+    std::vector<uint8_t> out;
+    out.reserve(kSketchSize * 4);
+    for (uint32_t v : sketch) {
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    return out;
+}
+
+bool AudioFingerprint::decodeSketch(const uint8_t* data, size_t size, Sketch& out)
+{
+    if (!data || size != kSketchSize * 4) return false;
+    for (size_t k = 0; k < kSketchSize; ++k) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i)
+            v |= static_cast<uint32_t>(data[k * 4 + static_cast<size_t>(i)]) << (8 * i);
+        out[k] = v;
+    }
+    return true;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  COMPARISON
+// ════════════════════════════════════════════════════════════════════
+
+AudioFingerprint::Overlap AudioFingerprint::compare(const AudioFingerprint& a,
+                                                    const AudioFingerprint& b)
+{
+    size_t shared = 0;
+    auto i = a.hashes.begin();
+    auto j = b.hashes.begin();
+    while (i != a.hashes.end() && j != b.hashes.end()) {
+        if (*i < *j)      ++i;
+        else if (*j < *i) ++j;
+        else { ++shared; ++i; ++j; }
+    }
+    Overlap o = overlapFrom(static_cast<double>(shared), a.hashes.size(), b.hashes.size());
+    // Scale the sampled count back to the full landmark sets.
+    o.shared = static_cast<int>(std::lround(
+        o.jaccard * static_cast<double>(a.landmarks + b.landmarks) / (1.0 + o.jaccard)));
+    return o;
+}
+
+AudioFingerprint::Overlap AudioFingerprint::estimate(const Sketch& a, size_t sizeA,
+                                                     const Sketch& b, size_t sizeB)
+{
+    int equal = 0;
+    for (size_t i = 0; i < kSketchSize; ++i)
+        equal += a[i] == b[i] ? 1 : 0;
+    // J = |A∩B| / |A∪B|  ⇒  |A∩B| = J (|A| + |B|) / (1 + J)
+    const double j = static_cast<double>(equal) / kSketchSize;
+    return overlapFrom(j * static_cast<double>(sizeA + sizeB) / (1.0 + j), sizeA, sizeB);
+}
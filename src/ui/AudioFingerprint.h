@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ── Acoustic fingerprint ───────────────────────────────────────────
+//
+// Spectral-peak landmarks, as in Wang's "industrial-strength" scheme:
+//
+//   1. Log-frequency spectrogram of the onset-rate mono buffer, 24 bands
+//      per octave from 200 Hz to ~4 kHz, ~21 frames/s
+//   2. Peaks — local maxima of a 7-band × 9-frame neighbourhood that
+//      stand out 6 dB from their frame, at most 3 per frame
+//   3. Landmarks — each peak with every pair of its next 3 peaks up to
+//      ~6 s later; hash = (band, two band deltas, two time deltas), 31 bits
+//
+// Landmark times are dropped: the fingerprint is the set of distinct
+// hashes, which survives cuts, edits and different lead-ins.  Two forms
+// are kept:
+//   • sketch  — 96 MinHash values over the whole set, the key of the
+//               library-wide LSH index (FingerprintIndex), ~0.05 error
+//   • hashes  — a consistent 1-in-16 sample of the set (the same hashes
+//               are kept in every track), for exact overlap checks
+// Re-encodes and trims of one master share roughly half or more of their
+// landmarks; a radio edit shares most of its own with the extended mix;
+// unrelated tracks share a few percent.
+
+struct AudioFingerprint
+{
+    // Bump whenever compute() output changes; stored with each row.
+    static constexpr uint32_t kVersion    = 1;
+    static constexpr int      kSketchSize = 96;
+
+    using Sketch = std::array<uint32_t, kSketchSize>;
+
+    uint32_t              landmarks{0}; // distinct landmark hashes
+    std::vector<uint32_t> hashes;       // sampled landmark hashes, ascending
+    Sketch                sketch{};     // MinHash of all landmarks
+
+    bool empty() const { return landmarks == 0; }
+
+    // Fingerprint of a mono buffer at any rate ≥ ~9 kHz (the analysis
+    // pipeline passes the onset-rate buffer).  Empty for silence or
+    // audio shorter than a few seconds.
+    static AudioFingerprint compute(const float* mono, int64_t numSamples,
+                                    double sampleRate);
+
+    static Sketch sketchOf(const std::vector<uint32_t>& sortedHashes);
+
+    // Compact binary forms.  encode(): 3-byte header + varint landmark
+    // and sample counts + varint deltas of the sample (~1 KB for a
+    // 5-minute track).  decode() leaves out.sketch alone.  The sketch is
+    // kSketchSize little-endian u32.
+    std::vector<uint8_t> encode() const;
+    static bool decode(const uint8_t* data, size_t size, AudioFingerprint& out);
+    static std::vector<uint8_t> encodeSketch(const Sketch& sketch);
+    static bool decodeSketch(const uint8_t* data, size_t size, Sketch& out);
+
+    // Overlap of the landmark sets, from the stored samples.
+    struct Overlap
+    {
+        int    shared{0};           // landmarks in common (estimated)
+        double jaccard{0.0};        // shared / union
+        double containment{0.0};    // shared / smaller set
+    };
+    static Overlap compare(const AudioFingerprint& a, const AudioFingerprint& b);
+
+    // Same, estimated from the sketches and set sizes alone.
+    static Overlap estimate(const Sketch& a, size_t sizeA,
+                            const Sketch& b, size_t sizeB);
+};
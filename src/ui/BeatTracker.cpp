@@ -0,0 +1,364 @@
+#include "BeatTracker.h"
+#include "AnalysisDecimator.h"
+#include "engine/dsp/Fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+constexpr double kTickSeconds = 1.0e-4;     // beat-grid storage resolution
+constexpr uint8_t kGridMagic0 = 'B';
+constexpr uint8_t kGridMagic1 = 'G';
+constexpr uint8_t kGridVersion = 1;
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool getVarint(const uint8_t* data, size_t size, size_t& pos, uint64_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= size) return false;
+        const uint8_t b = data[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// ════════════════════════════════════════════════════════════════════
+//  BeatGrid
+// ════════════════════════════════════════════════════════════════════
+
+std::vector<double> BeatGrid::downbeats() const
+{
+    std::vector<double> out;
+    if (beatsPerBar <= 0) return out;
+    for (size_t i = static_cast<size_t>(std::max(0, downbeatPhase));
+         i < beats.size(); i += static_cast<size_t>(beatsPerBar)) {
+        out.push_back(beats[i]);
+    }
+    return out;
+}
+
+std::vector<uint8_t> BeatGrid::encode() const
+{
+    std::vector<uint8_t> out;
+    out.reserve(10 + 10 + beats.size() * 2);
+    out.push_back(kGridMagic0);
+    out.push_back(kGridMagic1);
+    out.push_back(kGridVersion);
+    out.push_back(static_cast<uint8_t>(std::clamp(beatsPerBar, 1, 255)));
+    out.push_back(static_cast<uint8_t>(std::clamp(downbeatPhase, 0, 255)));
+    out.push_back(static_cast<uint8_t>(std::lround(std::clamp(confidence, 0.0, 1.0) * 255.0)));
+
+    const uint32_t bpmMilli = static_cast<uint32_t>(std::lround(std::max(0.0, bpm) * 1000.0));
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<uint8_t>(bpmMilli >> (8 * i)));
+
+    putVarint(out, beats.size());
+    uint64_t prev = 0;
+    for (double t : beats) {
+        const uint64_t ticks = static_cast<uint64_t>(std::llround(std::max(0.0, t) / kTickSeconds));
+        putVarint(out, ticks >= prev ? ticks - prev : 0);
+        prev = std::max(prev, ticks);
+    }
+    return out;
+}
+
+bool BeatGrid::decode(const uint8_t* data, size_t size, BeatGrid& out)
+{
+    if (!data || size < 11) return false;
+    if (data[0] != kGridMagic0 || data[1] != kGridMagic1 || data[2] != kGridVersion)
+        return false;
+
+    BeatGrid g;
+    g.beatsPerBar   = data[3];
+    g.downbeatPhase = data[4];
+    g.confidence    = data[5] / 255.0;
+    uint32_t bpmMilli = 0;
+    for (int i = 0; i < 4; ++i)
+        bpmMilli |= static_cast<uint32_t>(data[6 + i]) << (8 * i);
+    g.bpm = bpmMilli / 1000.0;
+
+    size_t pos = 10;
+    uint64_t count = 0;
+    if (!getVarint(data, size, pos, count)) return false;
+    if (count > size) return false;     // every beat needs >= 1 byte
+    g.beats.reserve(static_cast<size_t>(count));
+
+    uint64_t ticks = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t delta = 0;
+        if (!getVarint(data, size, pos, delta)) return false;
+        ticks += delta;
+        g.beats.push_back(static_cast<double>(ticks) * kTickSeconds);
+    }
+    out = std::move(g);
+    return true;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  Onset envelope
+// ════════════════════════════════════════════════════════════════════
+
+BeatTracker::OnsetEnvelope BeatTracker::onsetEnvelope(const float* data,
+                                                      int64_t numSamples,
+                                                      double sampleRate)
+{
+    OnsetEnvelope env;
+    if (!data || numSamples <= 0 || sampleRate <= 0.0) return env;
+
+    const int hopSize   = analysisHopForRate(sampleRate, 512);
+    const int frameSize = hopSize * 2;
+    const int64_t numHops = (numSamples - frameSize) / hopSize;
+    if (numHops < 2) return env;
+
+    std::vector<float> rms(static_cast<size_t>(numHops));
+    for (int64_t h = 0; h < numHops; ++h) {
+        double sum = 0.0;
+        const float* frame = data + h * hopSize;
+        for (int i = 0; i < frameSize; ++i)
+            sum += static_cast<double>(frame[i]) * frame[i];
+        rms[static_cast<size_t>(h)] = static_cast<float>(std::sqrt(sum / frameSize));
+    }
+
+    env.values.assign(static_cast<size_t>(numHops), 0.0f);
+    for (int64_t h = 1; h < numHops; ++h) {
+        const float diff = rms[static_cast<size_t>(h)] - rms[static_cast<size_t>(h - 1)];
+        env.values[static_cast<size_t>(h)] = std::max(0.0f, diff);
+    }
+    env.frameRate     = sampleRate / hopSize;
+    env.offsetSeconds = (frameSize * 0.5) / sampleRate;
+    return env;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  Tempo — FFT autocorrelation + comb filter
+// ════════════════════════════════════════════════════════════════════
+
+BeatTracker::TempoEstimate BeatTracker::estimateTempo(const OnsetEnvelope& env,
+                                                      double minBpm,
+                                                      double maxBpm)
+{
+    TempoEstimate est;
+    const int n = static_cast<int>(env.values.size());
+    if (n < 4 || env.frameRate <= 0.0 || minBpm <= 0.0 || maxBpm <= minBpm)
+        return est;
+
+    const int lagMin = static_cast<int>(env.frameRate * 60.0 / maxBpm);
+    const int lagMax = static_cast<int>(env.frameRate * 60.0 / minBpm);
+    const int maxLag = std::min(lagMax, n / 2);
+    if (lagMin < 1 || lagMin >= maxLag) return est;
+
+    // ── Autocorrelation: IFFT(|FFT(x)|²), zero-padded to avoid wrap ──
+    const Fft fft(2 * n);
+    const int size = fft.size();
+    std::vector<double> buf(static_cast<size_t>(size) * 2, 0.0);
+    for (int i = 0; i < n; ++i)
+        buf[2 * static_cast<size_t>(i)] = env.values[static_cast<size_t>(i)];
+    fft.forward(buf.data());
+    for (int k = 0; k < size; ++k) {
+        const double re = buf[2 * static_cast<size_t>(k)];
+        const double im = buf[2 * static_cast<size_t>(k) + 1];
+        buf[2 * static_cast<size_t>(k)]     = re * re + im * im;
+        buf[2 * static_cast<size_t>(k) + 1] = 0.0;
+    }
+    fft.inverse(buf.data());
+
+    // Unbiased (per-overlap) normalisation, same scale as the old
+    // time-domain loop's corr / (N − lag).
+    const int acfLen = n / 2 + 1;
+    std::vector<double> acf(static_cast<size_t>(acfLen), 0.0);
+    for (int lag = 0; lag < acfLen; ++lag)
+        acf[static_cast<size_t>(lag)] = buf[2 * static_cast<size_t>(lag)]
+                                      / size / static_cast<double>(n - lag);
+
+    // ── Comb filter over lag multiples (1/k weighting) ──
+    std::vector<double> comb(static_cast<size_t>(maxLag + 2), 0.0);
+    double combSum = 0.0;
+    int    combCount = 0;
+    int    bestLag = lagMin;
+    double bestScore = -std::numeric_limits<double>::max();
+    for (int lag = std::max(1, lagMin - 1); lag <= maxLag + 1 && lag < acfLen; ++lag) {
+        double s = 0.0, w = 0.0;
+        for (int k = 1; k <= 4 && k * lag < acfLen; ++k) {
+            // True period is fractional — let tooth k drift by ±k/2 lags
+            const int hw = k / 2;
+            double peak = 0.0;
+            for (int j = std::max(1, k * lag - hw); j <= k * lag + hw && j < acfLen; ++j)
+                peak = std::max(peak, acf[static_cast<size_t>(j)]);
+            s += peak / k;
+            w += 1.0 / k;
+        }
+        // Perceptual tempo prior: log-Gaussian around 120 BPM, σ = 1 octave.
+        // Without it a bar-level accent pulls the comb toward half tempo.
+        const double octaves = std::log2(env.frameRate * 60.0 / lag / 120.0);
+        const double prior = std::exp(-0.5 * octaves * octaves);
+        comb[static_cast<size_t>(lag)] = (w > 0.0) ? prior * s / w : 0.0;
+        if (lag < lagMin || lag > maxLag) continue;
+        combSum += comb[static_cast<size_t>(lag)];
+        ++combCount;
+        if (comb[static_cast<size_t>(lag)] > bestScore) {
+            bestScore = comb[static_cast<size_t>(lag)];
+            bestLag   = lag;
+        }
+    }
+    if (combCount == 0 || bestScore <= 0.0) return est;
+
+    // ── Parabolic interpolation for sub-frame lag ──
+    double lagFrac = bestLag;
+    if (bestLag > 1 && bestLag + 1 < static_cast<int>(comb.size())) {
+        const double a = comb[static_cast<size_t>(bestLag - 1)];
+        const double b = comb[static_cast<size_t>(bestLag)];
+        const double c = comb[static_cast<size_t>(bestLag + 1)];
+        const double denom = a - 2.0 * b + c;
+        if (denom < 0.0) {
+            const double delta = 0.5 * (a - c) / denom;
+            if (std::fabs(delta) < 1.0) lagFrac += delta;
+        }
+    }
+
+    est.bpm = env.frameRate * 60.0 / lagFrac;
+    const double mean = combSum / combCount;
+    est.confidence = std::clamp((bestScore - mean) / bestScore, 0.0, 1.0);
+    return est;
+}
+
+// ════════════════════════════════════════════════════════════════════
+//  Beat tracking — dynamic programming
+// ════════════════════════════════════════════════════════════════════
+
+BeatGrid BeatTracker::track(const OnsetEnvelope& env, double bpm)
+{
+    BeatGrid grid;
+    grid.bpm = bpm;
+
+    const int n = static_cast<int>(env.values.size());
+    if (bpm <= 0.0 || env.frameRate <= 0.0) return grid;
+    const double period = env.frameRate * 60.0 / bpm;
+    if (period < 2.0 || n < static_cast<int>(period * 4.0)) return grid;
+
+    // Normalise onset strength by its standard deviation
+    double mean = 0.0;
+    for (float v : env.values) mean += v;
+    mean /= n;
+    double var = 0.0;
+    for (float v : env.values) var += (v - mean) * (v - mean);
+    const double sd = std::sqrt(var / n);
+    if (sd <= 0.0) return grid;
+
+    std::vector<double> local(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+        local[static_cast<size_t>(i)] = env.values[static_cast<size_t>(i)] / sd;
+
+    // score[t] = local[t] + max_prev(score[prev] − α·log²((t−prev)/period))
+    constexpr double kTightness = 100.0;
+    const int searchLo = std::max(1, static_cast<int>(std::lround(period * 0.5)));
+    const int searchHi = static_cast<int>(std::lround(period * 2.0));
+
+    std::vector<double> penalty(static_cast<size_t>(searchHi + 1), 0.0);
+    for (int d = searchLo; d <= searchHi; ++d) {
+        const double r = std::log(d / period);
+        penalty[static_cast<size_t>(d)] = -kTightness * r * r;
+    }
+
+    std::vector<double> score(static_cast<size_t>(n));
+    std::vector<int>    backlink(static_cast<size_t>(n), -1);
+    for (int t = 0; t < n; ++t) {
+        double best = -std::numeric_limits<double>::max();
+        int    bestPrev = -1;
+        const int lo = std::max(0, t - searchHi);
+        const int hi = t - searchLo;
+        for (int p = lo; p <= hi; ++p) {
+            const double s = score[static_cast<size_t>(p)]
+                           + penalty[static_cast<size_t>(t - p)];
+            if (s > best) { best = s; bestPrev = p; }
+        }
+        if (bestPrev >= 0 && best > 0.0) {
+            score[static_cast<size_t>(t)]    = local[static_cast<size_t>(t)] + best;
+            backlink[static_cast<size_t>(t)] = bestPrev;
+        } else {
+            score[static_cast<size_t>(t)] = local[static_cast<size_t>(t)];
+        }
+    }
+
+    // Best end point within the final period, then backtrack
+    int end = n - 1;
+    {
+        double best = -std::numeric_limits<double>::max();
+        for (int t = std::max(0, n - static_cast<int>(period)); t < n; ++t) {
+            if (score[static_cast<size_t>(t)] > best) {
+                best = score[static_cast<size_t>(t)];
+                end  = t;
+            }
+        }
+    }
+    std::vector<int> frames;
+    for (int t = end; t >= 0; t = backlink[static_cast<size_t>(t)])
+        frames.push_back(t);
+    std::reverse(frames.begin(), frames.end());
+    if (frames.size() < 4) return grid;
+
+    grid.beats.reserve(frames.size());
+    double beatOnset = 0.0;
+    for (int f : frames) {
+        grid.beats.push_back(env.offsetSeconds + f / env.frameRate);
+        beatOnset += env.values[static_cast<size_t>(f)];
+    }
+    beatOnset /= static_cast<double>(frames.size());
+
+    // Tempo refinement: least-squares slope of beat time vs. beat index.
+    // Envelope frames quantise lag to ~12 ms; the regression over hundreds
+    // of beats resolves the period far more finely.
+    {
+        const double m = static_cast<double>(grid.beats.size());
+        const double meanIdx = (m - 1.0) * 0.5;
+        const double meanT = std::accumulate(grid.beats.begin(), grid.beats.end(), 0.0) / m;
+        double sxy = 0.0, sxx = 0.0;
+        for (size_t i = 0; i < grid.beats.size(); ++i) {
+            const double dx = static_cast<double>(i) - meanIdx;
+            sxy += dx * (grid.beats[i] - meanT);
+            sxx += dx * dx;
+        }
+        const double slope = (sxx > 0.0) ? sxy / sxx : 0.0;
+        if (slope > 0.0) {
+            const double refined = 60.0 / slope;
+            if (std::fabs(refined - bpm) < bpm * 0.04) grid.bpm = refined;
+        }
+    }
+
+    // Confidence: onset strength at beats relative to the track mean
+    grid.confidence = (mean > 0.0)
+        ? std::clamp((beatOnset / mean - 1.0) / 3.0, 0.0, 1.0)
+        : 0.0;
+
+    // Downbeat: bar slot with the strongest summed onset
+    double bestPhase = -1.0;
+    for (int phase = 0; phase < grid.beatsPerBar; ++phase) {
+        double sum = 0.0;
+        int    cnt = 0;
+        for (size_t i = static_cast<size_t>(phase); i < frames.size();
+             i += static_cast<size_t>(grid.beatsPerBar)) {
+            sum += env.values[static_cast<size_t>(frames[i])];
+            ++cnt;
+        }
+        const double avg = cnt > 0 ? sum / cnt : 0.0;
+        if (avg > bestPhase) {
+            bestPhase = avg;
+            grid.downbeatPhase = phase;
+        }
+    }
+    return grid;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ── Beat grid ──────────────────────────────────────────────────────
+//
+// Tracked beat positions plus bar phase.  Persisted alongside the
+// track (overlay DB beat_grid column) so decks can snap cues/loops
+// without re-analysis.
+
+struct BeatGrid
+{
+    double bpm{0.0};
+    int    beatsPerBar{4};
+    int    downbeatPhase{0};        // beats[phase + k·beatsPerBar] are downbeats
+    double confidence{0.0};         // [0..1] onset support at tracked beats
+    std::vector<double> beats;      // seconds from file start, ascending
+
+    bool empty() const { return beats.empty(); }
+    std::vector<double> downbeats() const;
+
+    // Compact binary form (track_overlay.beat_grid):
+    //   10-byte header — magic "BG", version, beats per bar, downbeat
+    //                    phase, confidence ×255, BPM ×1000 as LE u32
+    //   varint beat count, then varint deltas in 0.1 ms ticks
+    // ~2 bytes per beat, ~2 KB for a 7-minute track.
+    std::vector<uint8_t> encode() const;
+    static bool decode(const uint8_t* data, size_t size, BeatGrid& out);
+};
+
+// ── Tempo estimation + beat tracking ───────────────────────────────
+//
+//   1. Onset envelope — half-wave rectified RMS flux (~86 frames/s)
+//   2. Tempo — autocorrelation via FFT (Wiener–Khinchin), scored with
+//      a 4-tooth comb over lag multiples and a 120 BPM log-Gaussian
+//      prior, parabolic sub-frame refine
+//   3. Beats — dynamic-programming tracker (onset strength vs. tempo
+//      deviation penalty), then downbeat phase by strongest bar slot
+
+class BeatTracker
+{
+public:
+    struct OnsetEnvelope
+    {
+        std::vector<float> values;
+        double frameRate{0.0};      // envelope frames per second
+        double offsetSeconds{0.0};  // time of frame 0 (frame centre)
+    };
+
+    struct TempoEstimate
+    {
+        double bpm{0.0};            // unrounded, not octave-normalised
+        double confidence{0.0};     // [0..1] comb peak prominence
+    };
+
+    static OnsetEnvelope onsetEnvelope(const float* data, int64_t numSamples,
+                                       double sampleRate);
+
+    static TempoEstimate estimateTempo(const OnsetEnvelope& env,
+                                       double minBpm = 60.0,
+                                       double maxBpm = 200.0);
+
+    static BeatGrid track(const OnsetEnvelope& env, double bpm);
+};
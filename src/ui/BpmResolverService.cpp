@@ -1,4 +1,5 @@
 #include "BpmResolverService.h"
+#include "AnalysisDecimator.h"
 
 #include <QDebug>
 
@@ -97,8 +98,8 @@ double BpmResolverService::computeOnsetDensity(const float* data,
                                                 int64_t numSamples,
                                                 double sampleRate)
 {
-    const int hopSize   = 512;
-    const int frameSize = 1024;
+    const int hopSize   = analysisHopForRate(sampleRate, 512);
+    const int frameSize = hopSize * 2;
     const int64_t numHops = (numSamples - frameSize) / hopSize;
     if (numHops < 4) return 0.0;
 
@@ -160,8 +161,8 @@ double BpmResolverService::computeIOIPeakPeriod(const float* data,
                                                   int64_t numSamples,
                                                   double sampleRate)
 {
-    const int hopSize   = 512;
-    const int frameSize = 1024;
+    const int hopSize   = analysisHopForRate(sampleRate, 512);
+    const int frameSize = hopSize * 2;
     const int64_t numHops = (numSamples - frameSize) / hopSize;
     if (numHops < 4) return 0.0;
 
@@ -1554,6 +1554,11 @@ void DeckStrip::buildUi()
 
 void DeckStrip::wireSignals()
 {
+    // Waveform attaches when the engine reports the decode done, not by polling.
+    connect(bridge_, &EngineBridge::deckDecodeComplete, this, [this](int deckIndex) {
+        if (deckIndex == deckIndex_ && waveformFetchPending_)
+            fetchWaveformIfReady();
+    });
     connect(loadBtn_, &QPushButton::clicked, this, [this]() {
         emit loadRequested(deckIndex_);
     });
@@ -2096,18 +2101,37 @@ void DeckStrip::cycleDebugBandSolo()
     wf->cycleDebugBandSolo();
 }
 
-void DeckStrip::refreshFromSnapshot()
+WaveformPaintStats DeckStrip::takeWaveformPaintStats()
 {
-    const double ph = bridge_->deckPlayhead(deckIndex_);
-    const double dur = bridge_->deckLengthSeconds(deckIndex_);
-    const bool playing = bridge_->deckIsPlaying(deckIndex_);
-    const QString label = bridge_->deckTrackLabel(deckIndex_);
-    const double peakL = bridge_->deckPeakL(deckIndex_);
-    const double peakR = bridge_->deckPeakR(deckIndex_);
-    const QString currentPath = bridge_->deckFilePath(deckIndex_);
+    auto* wf = static_cast<WaveformOverview*>(waveformOverview_);
+    return wf ? wf->takePaintStats() : WaveformPaintStats{};
+}
 
-    const bool loaded = bridge_->deckHasTrack(deckIndex_);
-    const int lifecycle = bridge_->deckLifecycle(deckIndex_);
+void DeckStrip::refreshFromSnapshot()
+{
+    const ngks::DeckSnapshot& snap = bridge_->deckSnapshot(deckIndex_);
+    const double ph = snap.playheadSeconds;
+    const double dur = snap.lengthSeconds;
+    const bool playing = snap.transport == ngks::TransportState::Starting
+                      || snap.transport == ngks::TransportState::Playing;
+    const double peakL = static_cast<double>(snap.peakL);
+    const double peakR = static_cast<double>(snap.peakR);
+
+    const bool loaded = snap.hasTrack != 0;
+    const int lifecycle = static_cast<int>(snap.lifecycle);
+
+    // Labels and styles below only change with the track or the transport;
+    // the per-field versions say when, so steady frames skip them.
+    const bool trackChanged = !shownVersionsValid_ || snap.trackVersion != shownTrackVersion_;
+    const bool transportChanged = !shownVersionsValid_ || snap.transportVersion != shownTransportVersion_
+                                  || trackChanged;
+    const bool routingChanged = !shownVersionsValid_ || snap.routingVersion != shownRoutingVersion_;
+    shownVersionsValid_ = true;
+    shownTrackVersion_ = snap.trackVersion;
+    shownTransportVersion_ = snap.transportVersion;
+    shownRoutingVersion_ = snap.routingVersion;
+
+    const QString currentPath = trackChanged ? bridge_->deckFilePath(deckIndex_) : waveformTrackPath_;
 
     static uint8_t lastLoaded[4] = {2, 2, 2, 2};
     if (static_cast<uint8_t>(loaded) != lastLoaded[deckIndex_]) {
@@ -2155,12 +2179,15 @@ void DeckStrip::refreshFromSnapshot()
         waveformTrackPath_ = currentPath;
         waveformFetchPending_ = true;
         waveformFullyDecoded_ = false;
-        waveformFetchPolls_ = 0;
         auto* wf = static_cast<WaveformOverview*>(waveformOverview_);
         wf->clearWaveform();
         qInfo().noquote() << QStringLiteral("WAVEFORM_CACHE_KEY deck=%1 key=%2")
             .arg(deckIndex_).arg(currentPath);
 
+        // Cached pyramids (and short files) are complete already; anything
+        // else attaches on the bridge's deckDecodeComplete.
+        fetchWaveformIfReady();
+
         // ── BPM track-change detection ──
         const double engineBpm = bridge_->deckBpmFixed(deckIndex_);
         qInfo().noquote() << QStringLiteral("BPM_DECK_MATCH deck=%1 metaBpm=%2 engineBpm=%3 path=%4")
@@ -2170,83 +2197,20 @@ void DeckStrip::refreshFromSnapshot()
             .arg(currentPath);
     }
 
-    // ── Waveform data fetch (wait for FULL decode, not just preload) ──
-    if (waveformFetchPending_) {
-        const bool fullyDecoded = bridge_->isDeckFullyDecoded(deckIndex_);
-        qDebug().noquote() << QStringLiteral("DECK_DECODE_READY deck=%1 ready=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(fullyDecoded ? 1 : 0);
-        qWarning().noquote() << QStringLiteral("DS_DECODE_READY deck=%1 ready=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(fullyDecoded ? 1 : 0);
-        const QString nowPath = bridge_->deckFilePath(deckIndex_);
-
-        // Reject if track changed while we were waiting
-        if (nowPath != waveformTrackPath_) {
-            qInfo().noquote() << QStringLiteral("WAVEFORM_ATTACH_REJECT_STALE deck=%1 expected=%2 got=%3")
-                .arg(deckIndex_).arg(waveformTrackPath_).arg(nowPath);
-            waveformFetchPending_ = false;
-        } else if (fullyDecoded) {
-            auto t0 = std::chrono::steady_clock::now();
-            auto wfData = bridge_->getWaveformOverview(deckIndex_, 2048);
-            qWarning().noquote() << QStringLiteral("DS_WF_FETCH deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
-            qInfo().noquote() << QStringLiteral("DECK_WAVEFORM_FETCH deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
-            auto t1 = std::chrono::steady_clock::now();
-            const double genMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
-            if (!wfData.empty()) {
-                auto* wf = static_cast<WaveformOverview*>(waveformOverview_);
-                qWarning().noquote() << QStringLiteral("DS_WF_WIDGET_VALID deck=%1 valid=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wf ? 1 : 0);
-                qWarning().noquote() << QStringLiteral("DS_WF_SET_CALLED deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
-                
-                // DEBUG PROOF LOG
-                qWarning().noquote() << QStringLiteral("WF_BIND_CALL deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
-                wf->setWaveformData(wfData);
-                qInfo().noquote() << QStringLiteral("DECK_WAVEFORM_BOUND deck=%1 success=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(!wfData.empty() ? 1 : 0);
-                waveformFetchPending_ = false;
-                waveformFullyDecoded_ = true;
-                std::fprintf(stderr,
-                    "WAVE_MINMAX_BUILD_END deck=%d bins=%zu genMs=%.1f path=%s\n",
-                    deckIndex_, wfData.size(), genMs,
-                    waveformTrackPath_.toUtf8().constData());
-                std::fflush(stderr);
-                qInfo().noquote() << QStringLiteral("WAVEFORM_ATTACH deck=%1 bins=%2 path=%3")
-                    .arg(deckIndex_).arg(wfData.size()).arg(waveformTrackPath_);
-                qInfo().noquote() << QStringLiteral("WAVEFORM_DECK_MATCH deck=%1 path=%2")
-                    .arg(deckIndex_).arg(waveformTrackPath_);
-
-                // ── Stem overlay: band-energy analysis ──
-                if (kEnableStemOverlay) {
-                    auto bt0 = std::chrono::steady_clock::now();
-                    auto bandData = bridge_->getBandEnergyOverview(deckIndex_, 2048);
-                    auto bt1 = std::chrono::steady_clock::now();
-                    const double bandMs = std::chrono::duration<double, std::milli>(bt1 - bt0).count();
-                    if (!bandData.empty()) {
-                        wf->setBandEnergyData(bandData);
-                        std::fprintf(stderr,
-                            "STEM_OVERLAY_ANALYSIS_END deck=%d bands=%zu genMs=%.1f path=%s\n",
-                            deckIndex_, bandData.size(), bandMs,
-                            waveformTrackPath_.toUtf8().constData());
-                        std::fflush(stderr);
-                    }
-                }
-            }
-        } else if (++waveformFetchPolls_ > 600) {
-            // Give up after ~10 seconds (600 polls × 16ms)
-            qInfo().noquote() << QStringLiteral("WAVEFORM_CACHE_MISS deck=%1 timeout path=%2")
-                .arg(deckIndex_).arg(waveformTrackPath_);
-            waveformFetchPending_ = false;
-        }
-    }
-
     // Update track title — use metadata if available, else engine label
-    if (loaded) {
+    // (setTrackMetadata updates these itself when the library data arrives)
+    if (loaded && trackChanged) {
         if (!metaTitle_.isEmpty())
             trackTitleLabel_->setText(metaTitle_);
         else
-            trackTitleLabel_->setText(label);
+            trackTitleLabel_->setText(QString::fromUtf8(snap.currentTrackLabel));
 
         if (!metaArtist_.isEmpty())
             trackArtistLabel_->setText(metaArtist_);
     }
 
     // Update info row — BPM with track identity validation
-    if (loaded && currentPath != bpmTrackPath_) {
+    if (trackChanged && loaded && currentPath != bpmTrackPath_) {
         // Track changed since BPM was bound — reject stale BPM
         qInfo().noquote() << QStringLiteral("BPM_ATTACH_REJECT_STALE deck=%1 oldPath=%2 newPath=%3")
             .arg(deckIndex_).arg(bpmTrackPath_, currentPath);
@@ -2261,16 +2225,18 @@ void DeckStrip::refreshFromSnapshot()
         }
     }
 
-    if (!metaBpm_.isEmpty()) {
-        infoBpmLabel_->setText(metaBpm_);
-    } else if (loaded) {
-        infoBpmLabel_->setText(QStringLiteral("---"));
-    }
+    if (trackChanged) {
+        if (!metaBpm_.isEmpty()) {
+            infoBpmLabel_->setText(metaBpm_);
+        } else if (loaded) {
+            infoBpmLabel_->setText(QStringLiteral("---"));
+        }
 
-    if (!metaKey_.isEmpty())
-        infoKeyLabel_->setText(metaKey_);
-    else if (loaded)
-        infoKeyLabel_->setText(QStringLiteral("---"));
+        if (!metaKey_.isEmpty())
+            infoKeyLabel_->setText(metaKey_);
+        else if (loaded)
+            infoKeyLabel_->setText(QStringLiteral("---"));
+    }
 
     meterL_->setLevel(static_cast<float>(peakL));
     meterR_->setLevel(static_cast<float>(peakR));
@@ -2375,9 +2341,9 @@ void DeckStrip::refreshFromSnapshot()
     }
 
     // ── CUE (PFL) / MUTE button state sync ──
-    {
-        const bool muted = bridge_->deckIsMuted(deckIndex_);
-        const bool cueMon = bridge_->deckCueEnabled(deckIndex_);
+    if (routingChanged) {
+        const bool muted = snap.muted;
+        const bool cueMon = snap.cueEnabled;
         if (muteBtn_->isChecked() != muted) {
             QSignalBlocker b(muteBtn_);
             muteBtn_->setChecked(muted);
@@ -2388,6 +2354,9 @@ void DeckStrip::refreshFromSnapshot()
         }
     }
 
+    if (!transportChanged)
+        return;
+
     // ── Status label ──
     if (!loaded) {
         statusLabel_->setText(QStringLiteral("EMPTY"));
@@ -2430,6 +2399,75 @@ void DeckStrip::refreshFromSnapshot()
     }
 }
 
+// ═══════════════════════════════════════════════════════════════════
+// Waveform attach — needs the complete pyramid: built while the track
+// decodes, or at once from the waveform cache.  Tried when a new track
+// shows up in the snapshot and again on deckDecodeComplete.
+// ═══════════════════════════════════════════════════════════════════
+void DeckStrip::fetchWaveformIfReady()
+{
+    if (!waveformFetchPending_)
+        return;
+
+    const auto pyramid = bridge_->getWaveformPyramid(deckIndex_);
+    const bool fullyDecoded = pyramid && pyramid->isComplete();
+    qDebug().noquote() << QStringLiteral("DECK_DECODE_READY deck=%1 ready=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(fullyDecoded ? 1 : 0);
+    qWarning().noquote() << QStringLiteral("DS_DECODE_READY deck=%1 ready=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(fullyDecoded ? 1 : 0);
+    const QString nowPath = bridge_->deckFilePath(deckIndex_);
+
+    // Reject if track changed while we were waiting
+    if (nowPath != waveformTrackPath_) {
+        qInfo().noquote() << QStringLiteral("WAVEFORM_ATTACH_REJECT_STALE deck=%1 expected=%2 got=%3")
+            .arg(deckIndex_).arg(waveformTrackPath_).arg(nowPath);
+        waveformFetchPending_ = false;
+    } else if (fullyDecoded) {
+        auto t0 = std::chrono::steady_clock::now();
+        auto wfData = bridge_->getWaveformOverview(deckIndex_, 2048);
+        qWarning().noquote() << QStringLiteral("DS_WF_FETCH deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
+        qInfo().noquote() << QStringLiteral("DECK_WAVEFORM_FETCH deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
+        auto t1 = std::chrono::steady_clock::now();
+        const double genMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        if (!wfData.empty()) {
+            auto* wf = static_cast<WaveformOverview*>(waveformOverview_);
+            qWarning().noquote() << QStringLiteral("DS_WF_WIDGET_VALID deck=%1 valid=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wf ? 1 : 0);
+            qWarning().noquote() << QStringLiteral("DS_WF_SET_CALLED deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
+            
+            // DEBUG PROOF LOG
+            qWarning().noquote() << QStringLiteral("WF_BIND_CALL deck=%1 bins=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(wfData.size());
+            wf->setWaveformData(wfData);
+            wf->setWaveformPyramid(pyramid);
+            qInfo().noquote() << QStringLiteral("DECK_WAVEFORM_BOUND deck=%1 success=%2").arg(deckIndex_ == 0 ? 'A' : 'B').arg(!wfData.empty() ? 1 : 0);
+            waveformFetchPending_ = false;
+            waveformFullyDecoded_ = true;
+            std::fprintf(stderr,
+                "WAVE_MINMAX_BUILD_END deck=%d bins=%zu genMs=%.1f path=%s\n",
+                deckIndex_, wfData.size(), genMs,
+                waveformTrackPath_.toUtf8().constData());
+            std::fflush(stderr);
+            qInfo().noquote() << QStringLiteral("WAVEFORM_ATTACH deck=%1 bins=%2 path=%3")
+                .arg(deckIndex_).arg(wfData.size()).arg(waveformTrackPath_);
+            qInfo().noquote() << QStringLiteral("WAVEFORM_DECK_MATCH deck=%1 path=%2")
+                .arg(deckIndex_).arg(waveformTrackPath_);
+
+            // ── Stem overlay: band-energy analysis ──
+            if (kEnableStemOverlay) {
+                auto bt0 = std::chrono::steady_clock::now();
+                auto bandData = bridge_->getBandEnergyOverview(deckIndex_, 2048);
+                auto bt1 = std::chrono::steady_clock::now();
+                const double bandMs = std::chrono::duration<double, std::milli>(bt1 - bt0).count();
+                if (!bandData.empty()) {
+                    wf->setBandEnergyData(bandData);
+                    std::fprintf(stderr,
+                        "STEM_OVERLAY_ANALYSIS_END deck=%d bands=%zu genMs=%.1f path=%s\n",
+                        deckIndex_, bandData.size(), bandMs,
+                        waveformTrackPath_.toUtf8().constData());
+                    std::fflush(stderr);
+                }
+            }
+        }
+    }
+}
+
 // ═══════════════════════════════════════════════════════════════════
 // Fast playhead tick (~60fps) — lightweight position-only update.
 // Heavy state (meters, labels, waveform fetch) stays in the 250ms poll.
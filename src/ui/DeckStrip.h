@@ -14,6 +14,7 @@
 #include "WaveformState.h"
 #include "RotaryKnob.h"
 #include "DjAnalysisPanelWidget.h"
+#include "WaveformTileCache.h"
 
 class EngineBridge;
 class EqPanel;
@@ -151,6 +152,9 @@ public:
     /// Cycle debug band-solo mode (all → bass → mids → highs).
     void cycleDebugBandSolo();
 
+    /// Waveform paint cost since the previous call (for diagnostics).
+    WaveformPaintStats takeWaveformPaintStats();
+
     /// Set track metadata from library (title, artist, bpm, key, duration).
     void setTrackMetadata(const QString& title, const QString& artist,
                           const QString& bpm, const QString& key,
@@ -323,7 +327,6 @@ protected:
     bool cueMonActive_{false};
     bool waveformFetchPending_{false};
     bool waveformFullyDecoded_{false};
-    int  waveformFetchPolls_{0};
     QString waveformTrackPath_;  // path of track whose waveform is currently displayed
 
     // BPM track identity binding — reject stale BPM from prior loads
@@ -340,5 +343,13 @@ protected:
     QPushButton* waveModeBtn_{nullptr};
     bool prevPlaying_{false};  // edge detection for play/pause/stop transitions
 
+    // Snapshot versions last rendered (see DeckSnapshot)
+    bool     shownVersionsValid_{false};
+    uint32_t shownTrackVersion_{0};
+    uint32_t shownTransportVersion_{0};
+    uint32_t shownRoutingVersion_{0};
+
+    void fetchWaveformIfReady();
+
     void applyMixerDensity();
 };
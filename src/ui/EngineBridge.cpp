@@ -21,19 +21,40 @@
 #include <objbase.h>
 #endif
 
+namespace {
+constexpr int kFrameIntervalMs = 16;
+constexpr int kHousekeepingIntervalMs = 100;
+// Frames keep running this long after a command or engine event, so the
+// UI sees the engine act on it even when nothing ends up playing.
+constexpr auto kActivityHold = std::chrono::milliseconds(500);
+constexpr float kSilentMeter = 0.001f;
+}
+
 EngineBridge::EngineBridge(QObject* parent)
     : QObject(parent)
 {
-    meterTimer.setInterval(16);
+    meterTimer.setInterval(kFrameIntervalMs);
     connect(&meterTimer, &QTimer::timeout, this, &EngineBridge::pollSnapshot);
+    housekeepingTimer_.setInterval(kHousekeepingIntervalMs);
+    connect(&housekeepingTimer_, &QTimer::timeout, this, &EngineBridge::runHousekeeping);
+
+    pendingEvents_.reserve(64);
+    engine.events().setWakeup(&EngineBridge::onEngineEventWakeup, this);
 }
 
 EngineBridge::~EngineBridge()
 {
-    meterTimer.stop();
+    engine.events().setWakeup(nullptr, nullptr);
+    stopPolling();
     healthEngineInitialized.store(false, std::memory_order_relaxed);
 }
 
+void EngineBridge::enqueue(const ngks::Command& command)
+{
+    engine.enqueueCommand(command);
+    wakeFrames();
+}
+
 void EngineBridge::start()
 {
     if (engine.isDjMode() && engine.isDjDeviceLost()) {
@@ -44,19 +65,19 @@ void EngineBridge::start()
     }
     const auto seq = engine.nextSeq();
     qInfo().noquote() << QStringLiteral("DIAG: EngineBridge::start() => enqueue Play DECK_S seq=%1").arg(seq);
-    engine.enqueueCommand({ ngks::CommandType::Play, ngks::DECK_S, seq, 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Play, ngks::DECK_S, seq, 0, 0.0f, 0 });
 }
 
 void EngineBridge::stop()
 {
     const auto seq = engine.nextSeq();
     qInfo().noquote() << QStringLiteral("DIAG: EngineBridge::stop() => enqueue Stop DECK_S seq=%1").arg(seq);
-    engine.enqueueCommand({ ngks::CommandType::Stop, ngks::DECK_S, seq, 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Stop, ngks::DECK_S, seq, 0, 0.0f, 0 });
 }
 
 void EngineBridge::setMasterGain(double linear01)
 {
-    engine.enqueueCommand({ ngks::CommandType::SetMasterGain, ngks::DECK_S, engine.nextSeq(), 0,
+    enqueue({ ngks::CommandType::SetMasterGain, ngks::DECK_S, engine.nextSeq(), 0,
                             static_cast<float>(std::clamp(linear01, 0.0, 1.0)), 0 });
 }
 
@@ -68,7 +89,7 @@ void EngineBridge::setEqBandGain(int band, double gainDb)
     cmd.seq = engine.nextSeq();
     cmd.slotIndex = static_cast<uint8_t>(std::clamp(band, 0, 15));
     cmd.floatValue = static_cast<float>(std::clamp(gainDb, -12.0, 12.0));
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 void EngineBridge::setEqBypass(bool bypassed)
@@ -78,7 +99,7 @@ void EngineBridge::setEqBypass(bool bypassed)
     cmd.deck = ngks::DECK_S;
     cmd.seq = engine.nextSeq();
     cmd.boolValue = bypassed ? 1 : 0;
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 bool EngineBridge::startRtProbe(double toneHz, double toneDb)
@@ -102,9 +123,9 @@ bool EngineBridge::loadTrack(const QString& filePath)
     // Force deck lifecycle to Empty so LoadTrack command is accepted.
     // Stop (Playing→Stopped, rejected if already Stopped — OK) then
     // UnloadTrack (Stopped→Empty). Both harmless if deck is already Empty.
-    engine.enqueueCommand({ ngks::CommandType::Stop, ngks::DECK_S,
+    enqueue({ ngks::CommandType::Stop, ngks::DECK_S,
                             engine.nextSeq(), 0, 0.0f, 0 });
-    engine.enqueueCommand({ ngks::CommandType::UnloadTrack, ngks::DECK_S,
+    enqueue({ ngks::CommandType::UnloadTrack, ngks::DECK_S,
                             engine.nextSeq(), 0, 0.0f, 0 });
 
     double duration = 0.0;
@@ -123,7 +144,7 @@ bool EngineBridge::loadTrack(const QString& filePath)
 
 void EngineBridge::pause()
 {
-    engine.enqueueCommand({ ngks::CommandType::Pause, ngks::DECK_S, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Pause, ngks::DECK_S, engine.nextSeq(), 0, 0.0f, 0 });
 }
 
 void EngineBridge::seek(double seconds)
@@ -135,6 +156,7 @@ void EngineBridge::seek(double seconds)
         .arg(endOfTrackEmitted ? "T" : "F")
         .arg(loadedTrackPath_);
     engine.seekDeck(ngks::DECK_S, seconds);
+    wakeFrames();
 }
 
 // ── DJ deck-aware methods ──
@@ -145,8 +167,8 @@ bool EngineBridge::loadTrackToDeck(int deckIndex, const QString& filePath)
     qInfo().noquote() << QStringLiteral("DJ loadTrack(deckIndex=%1, path=%2)").arg(deckIndex).arg(filePath);
     const auto did = static_cast<ngks::DeckId>(deckIndex);
 
-    engine.enqueueCommand({ ngks::CommandType::Stop, did, engine.nextSeq(), 0, 0.0f, 0 });
-    engine.enqueueCommand({ ngks::CommandType::UnloadTrack, did, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Stop, did, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::UnloadTrack, did, engine.nextSeq(), 0, 0.0f, 0 });
 
     const auto tDispatch = std::chrono::steady_clock::now();
     ngks::audioTrace("TRACK_LOAD_DISPATCH", "deck=%d path=%s tid=%lu",
@@ -188,7 +210,7 @@ void EngineBridge::playDeck(int deckIndex)
         return;
     }
     const auto did = static_cast<ngks::DeckId>(deckIndex);
-    engine.enqueueCommand({ ngks::CommandType::Play, did, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Play, did, engine.nextSeq(), 0, 0.0f, 0 });
     qInfo().noquote() << QStringLiteral("DJ playDeck(deckIndex=%1)").arg(deckIndex);
 }
 
@@ -196,7 +218,7 @@ void EngineBridge::stopDeck(int deckIndex)
 {
     if (deckIndex < 0 || deckIndex >= ngks::MAX_DECKS) return;
     const auto did = static_cast<ngks::DeckId>(deckIndex);
-    engine.enqueueCommand({ ngks::CommandType::Stop, did, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Stop, did, engine.nextSeq(), 0, 0.0f, 0 });
     qInfo().noquote() << QStringLiteral("DJ stopDeck(deckIndex=%1)").arg(deckIndex);
 }
 
@@ -204,8 +226,8 @@ void EngineBridge::unloadDeck(int deckIndex)
 {
     if (deckIndex < 0 || deckIndex >= ngks::MAX_DECKS) return;
     const auto did = static_cast<ngks::DeckId>(deckIndex);
-    engine.enqueueCommand({ ngks::CommandType::Stop, did, engine.nextSeq(), 0, 0.0f, 0 });
-    engine.enqueueCommand({ ngks::CommandType::UnloadTrack, did, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Stop, did, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::UnloadTrack, did, engine.nextSeq(), 0, 0.0f, 0 });
     qInfo().noquote() << QStringLiteral("DJ unloadDeck(deckIndex=%1)").arg(deckIndex);
 }
 
@@ -213,7 +235,7 @@ void EngineBridge::pauseDeck(int deckIndex)
 {
     if (deckIndex < 0 || deckIndex >= ngks::MAX_DECKS) return;
     const auto did = static_cast<ngks::DeckId>(deckIndex);
-    engine.enqueueCommand({ ngks::CommandType::Pause, did, engine.nextSeq(), 0, 0.0f, 0 });
+    enqueue({ ngks::CommandType::Pause, did, engine.nextSeq(), 0, 0.0f, 0 });
     qInfo().noquote() << QStringLiteral("DJ pauseDeck(deckIndex=%1)").arg(deckIndex);
 }
 
@@ -221,6 +243,7 @@ void EngineBridge::seekDeck(int deckIndex, double seconds)
 {
     if (deckIndex < 0 || deckIndex >= ngks::MAX_DECKS) return;
     engine.seekDeck(static_cast<ngks::DeckId>(deckIndex), seconds);
+    wakeFrames();
     qInfo().noquote() << QStringLiteral("DJ seekDeck(deckIndex=%1, seconds=%2)")
         .arg(deckIndex).arg(seconds, 0, 'f', 3);
 }
@@ -234,12 +257,13 @@ void EngineBridge::setDeckGain(int deckIndex, double linearGain)
     cmd.deck = did;
     cmd.seq = engine.nextSeq();
     cmd.floatValue = static_cast<float>(std::clamp(linearGain, 0.0, 2.0));
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 void EngineBridge::setCrossfader(double position)
 {
     engine.updateCrossfader(static_cast<float>(std::clamp(position, 0.0, 1.0)));
+    wakeFrames();
 }
 
 void EngineBridge::setDeckEqBandGain(int deckIndex, int band, double gainDb)
@@ -251,7 +275,7 @@ void EngineBridge::setDeckEqBandGain(int deckIndex, int band, double gainDb)
     cmd.seq = engine.nextSeq();
     cmd.slotIndex = static_cast<uint8_t>(std::clamp(band, 0, 15));
     cmd.floatValue = static_cast<float>(std::clamp(gainDb, -6.0, 6.0));
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 void EngineBridge::setDeckEqBypass(int deckIndex, bool bypassed)
@@ -262,7 +286,7 @@ void EngineBridge::setDeckEqBypass(int deckIndex, bool bypassed)
     cmd.deck = static_cast<ngks::DeckId>(deckIndex);
     cmd.seq = engine.nextSeq();
     cmd.boolValue = bypassed ? 1 : 0;
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 void EngineBridge::setDeckMute(int deckIndex, bool muted)
@@ -273,7 +297,7 @@ void EngineBridge::setDeckMute(int deckIndex, bool muted)
     cmd.deck = static_cast<ngks::DeckId>(deckIndex);
     cmd.seq = engine.nextSeq();
     cmd.boolValue = muted ? 1 : 0;
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 void EngineBridge::setDeckCueMonitor(int deckIndex, bool enabled)
@@ -284,7 +308,7 @@ void EngineBridge::setDeckCueMonitor(int deckIndex, bool enabled)
     cmd.deck = static_cast<ngks::DeckId>(deckIndex);
     cmd.seq = engine.nextSeq();
     cmd.boolValue = enabled ? 1 : 0;
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 void EngineBridge::setDeckFilter(int deckIndex, double position)
@@ -295,7 +319,7 @@ void EngineBridge::setDeckFilter(int deckIndex, double position)
     cmd.deck = static_cast<ngks::DeckId>(deckIndex);
     cmd.seq = engine.nextSeq();
     cmd.floatValue = static_cast<float>(std::clamp(position, 0.0, 1.0));
-    engine.enqueueCommand(cmd);
+    enqueue(cmd);
 }
 
 void EngineBridge::setCueMix(double ratio)
@@ -457,6 +481,17 @@ std::vector<ngks::BandEnergy> EngineBridge::getBandEnergyOverview(int deckIndex,
     return engine.getBandEnergyOverview(static_cast<ngks::DeckId>(deckIndex), numBins);
 }
 
+std::shared_ptr<const ngks::WaveformPyramid> EngineBridge::getWaveformPyramid(int deckIndex) const
+{
+    if (deckIndex < 0 || deckIndex >= ngks::MAX_DECKS) return nullptr;
+    return engine.getWaveformPyramid(static_cast<ngks::DeckId>(deckIndex));
+}
+
+bool EngineBridge::tryGetSpectrum(ngks::SpectrumFrame& out)
+{
+    return engine.tryGetSpectrum(out);
+}
+
 bool EngineBridge::isDeckFullyDecoded(int deckIndex) const
 {
     if (deckIndex < 0 || deckIndex >= ngks::MAX_DECKS) return false;
@@ -711,13 +746,13 @@ bool EngineBridge::enterDjMode()
         ngks::audioTrace("DJ_GATE_BLOCK_AUDIO_OPEN",
             "fn=enterDjMode djDeviceLost=1 — audio open blocked until explicit recovery");
         qWarning().noquote() << QStringLiteral("DJ_GATE_BLOCK_AUDIO_OPEN: enterDjMode() blocked audio open — device-lost still active");
-        meterTimer.start(); // keep polling so UI sees device-lost flag
+        startPolling(); // keep polling so UI sees device-lost flag
         return false;
     }
 
     const auto snapshot = engine.getSnapshot();
     if ((snapshot.flags & ngks::SNAP_AUDIO_RUNNING) != 0u) {
-        meterTimer.start();
+        startPolling();
         return true;
     }
 
@@ -735,7 +770,7 @@ bool EngineBridge::enterDjMode()
         healthAudioDeviceReady.store(ok, std::memory_order_relaxed);
         QMetaObject::invokeMethod(this, [this, ok]() {
             if (ok) {
-                meterTimer.start();
+                startPolling();
             }
             emit audioHotReady(ok);
         }, Qt::QueuedConnection);
@@ -750,7 +785,7 @@ void EngineBridge::leaveDjMode()
 {
     engine.setDjMode(false);
     djDeviceLostEmitted_ = false;
-    meterTimer.stop();
+    stopPolling();
 }
 
 bool EngineBridge::isDjDeviceLost() const
@@ -801,7 +836,7 @@ bool EngineBridge::enterSimpleMode()
     const auto snapshot = engine.getSnapshot();
     if ((snapshot.flags & ngks::SNAP_AUDIO_RUNNING) != 0u) {
         qInfo().noquote() << QStringLiteral("DIAG: enterSimpleMode() audio already running");
-        meterTimer.start();
+        startPolling();
         return true;
     }
 
@@ -820,7 +855,7 @@ bool EngineBridge::enterSimpleMode()
         healthAudioDeviceReady.store(ok, std::memory_order_relaxed);
         QMetaObject::invokeMethod(this, [this, ok]() {
             if (ok) {
-                meterTimer.start();
+                startPolling();
             }
             emit audioHotReady(ok);
         }, Qt::QueuedConnection);
@@ -833,7 +868,7 @@ bool EngineBridge::enterSimpleMode()
 
 void EngineBridge::leaveSimpleMode()
 {
-    meterTimer.stop();
+    stopPolling();
 }
 
 void EngineBridge::notifyDeviceFailure(int code)
@@ -846,7 +881,7 @@ void EngineBridge::notifyDeviceFailure(int code)
 
 void EngineBridge::appExitTeardown()
 {
-    meterTimer.stop();
+    stopPolling();
     healthEngineInitialized.store(false, std::memory_order_relaxed);
     healthAudioDeviceReady.store(false, std::memory_order_relaxed);
 }
@@ -862,9 +897,126 @@ QString EngineBridge::engineStateMachineSummary()
         .arg(static_cast<int>(t));
 }
 
-void EngineBridge::pollSnapshot()
+void EngineBridge::startPolling()
+{
+    pollingEnabled_ = true;
+    if (!housekeepingTimer_.isActive()) {
+        housekeepingTimer_.start();
+    }
+    wakeFrames();
+}
+
+void EngineBridge::stopPolling()
 {
-    // ── DJ output validity enforcer (runs before snapshot read) ──
+    pollingEnabled_ = false;
+    housekeepingTimer_.stop();
+    meterTimer.stop();
+}
+
+void EngineBridge::wakeFrames()
+{
+    lastActivity_ = std::chrono::steady_clock::now();
+    if (pollingEnabled_ && !meterTimer.isActive()) {
+        meterTimer.start();
+    }
+}
+
+bool EngineBridge::framesLive(const ngks::EngineSnapshot& snapshot) const
+{
+    if (std::chrono::steady_clock::now() - lastActivity_ < kActivityHold) {
+        return true;
+    }
+    if (snapshot.masterPeakL > kSilentMeter || snapshot.masterPeakR > kSilentMeter) {
+        return true;
+    }
+    for (const auto& deck : snapshot.decks) {
+        if (deck.transport == ngks::TransportState::Starting
+            || deck.transport == ngks::TransportState::Playing
+            || deck.transport == ngks::TransportState::Stopping
+            || deck.peakL > kSilentMeter || deck.peakR > kSilentMeter) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const ngks::DeckSnapshot& EngineBridge::deckSnapshot(int deckIndex) const
+{
+    return snapshot_.decks[std::clamp(deckIndex, 0, ngks::MAX_DECKS - 1)];
+}
+
+void EngineBridge::onEngineEventWakeup(void* context)
+{
+    // Any engine thread except the audio thread (see EngineCore::events()).
+    auto* self = static_cast<EngineBridge*>(context);
+    QMetaObject::invokeMethod(self, [self]() { self->drainEngineEvents(); }, Qt::QueuedConnection);
+}
+
+void EngineBridge::drainEngineEvents()
+{
+    auto& events = engine.events();
+    events.rearm();
+    pendingEvents_.clear();
+    ngks::EngineEvent event;
+    while (events.pop(event)) {
+        pendingEvents_.push_back(event);
+    }
+    if (pendingEvents_.empty()) {
+        return;
+    }
+
+    // Handlers read deckSnapshot(): refresh it before any of them run.
+    snapshot_ = engine.getSnapshot();
+    wakeFrames();
+
+    for (const auto& e : pendingEvents_) {
+        const int deckIndex = static_cast<int>(e.deck);
+        switch (e.type) {
+        case ngks::EngineEventType::TransportChanged:
+            emit deckTransportChanged(deckIndex);
+            break;
+        case ngks::EngineEventType::LoadComplete:
+            emit deckLoadComplete(deckIndex);
+            break;
+        case ngks::EngineEventType::DecodeProgress:
+            emit deckDecodeProgress(deckIndex, static_cast<double>(e.fraction));
+            break;
+        case ngks::EngineEventType::DecodeComplete:
+            emit deckDecodeComplete(deckIndex);
+            break;
+        case ngks::EngineEventType::AnalysisResult:
+            emit analysisResultReady(deckIndex, e.value);
+            break;
+        case ngks::EngineEventType::DeviceLost:
+            if (!djDeviceLostEmitted_) {
+                djDeviceLostEmitted_ = true;
+                qWarning().noquote() << QStringLiteral("DJ_DEVICE_LOST: audio endpoint lost in DJ mode — all playback stopped");
+                emit djDeviceLost();
+            }
+            break;
+        case ngks::EngineEventType::DeviceRecovered:
+            djDeviceLostEmitted_ = false;
+            break;
+        }
+    }
+}
+
+void EngineBridge::updateHealth(const ngks::EngineSnapshot& snapshot)
+{
+    const bool audioReady = (snapshot.flags & ngks::SNAP_AUDIO_RUNNING) != 0u;
+    const bool renderOk = std::isfinite(snapshot.masterPeakL)
+        && std::isfinite(snapshot.masterPeakR)
+        && std::isfinite(snapshot.masterRmsL)
+        && std::isfinite(snapshot.masterRmsR);
+
+    healthAudioDeviceReady.store(audioReady, std::memory_order_relaxed);
+    healthLastRenderCycleOk.store(renderOk, std::memory_order_relaxed);
+    healthRenderCycleCounter.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void EngineBridge::runHousekeeping()
+{
+    // ── DJ output validity enforcer (internally throttled to ~300ms) ──
     engine.pollDjOutputEnforcer();
 
     // ── DJ auto-recovery probe (runs while device-lost is active) ──
@@ -879,7 +1031,7 @@ void EngineBridge::pollSnapshot()
                 if (autoResult.deckWasPlaying[d]) {
                     anyWasPlaying = true;
                     const auto did = static_cast<ngks::DeckId>(d);
-                    engine.enqueueCommand({ ngks::CommandType::Play, did, engine.nextSeq(), 0, 0.0f, 0 });
+                    enqueue({ ngks::CommandType::Play, did, engine.nextSeq(), 0, 0.0f, 0 });
                     ngks::audioTrace("DJ_AUTO_RESUME_PLAYBACK",
                         "deck=%u source=auto wasPlayingBeforeLoss=1", d);
                 } else {
@@ -894,7 +1046,28 @@ void EngineBridge::pollSnapshot()
         }
     }
 
-    const auto snapshot = engine.getSnapshot();
+    // ── Track registry log: append changed entries (throttled to ~1s) ──
+    engine.pollRegistryPersist();
+
+    // Events raised on the audio thread carry no wakeup; while frames run
+    // pollSnapshot drains them, otherwise this does.
+    drainEngineEvents();
+
+    if (!meterTimer.isActive()) {
+        const auto snapshot = engine.getSnapshot();
+        updateHealth(snapshot);
+        if (framesLive(snapshot)) {
+            wakeFrames();
+        }
+    }
+}
+
+void EngineBridge::pollSnapshot()
+{
+    drainEngineEvents();
+
+    snapshot_ = engine.getSnapshot();
+    const auto& snapshot = snapshot_;
 
     // ── DJ device-lost detection ──
     if ((snapshot.flags & ngks::SNAP_DJ_DEVICE_LOST) != 0u && !djDeviceLostEmitted_) {
@@ -930,15 +1103,7 @@ void EngineBridge::pollSnapshot()
     };
     const bool nowRunning = isActive(transportA) || isActive(transportB) || isActive(transportS);
 
-    const bool audioReady = (snapshot.flags & ngks::SNAP_AUDIO_RUNNING) != 0u;
-    const bool renderOk = std::isfinite(snapshot.masterPeakL)
-        && std::isfinite(snapshot.masterPeakR)
-        && std::isfinite(snapshot.masterRmsL)
-        && std::isfinite(snapshot.masterRmsR);
-
-    healthAudioDeviceReady.store(audioReady, std::memory_order_relaxed);
-    healthLastRenderCycleOk.store(renderOk, std::memory_order_relaxed);
-    healthRenderCycleCounter.fetch_add(1u, std::memory_order_relaxed);
+    updateHealth(snapshot);
 
     masterPeakLeftValue_  = std::clamp(static_cast<double>(snapshot.masterPeakL), 0.0, 1.2);
     masterPeakRightValue_ = std::clamp(static_cast<double>(snapshot.masterPeakR), 0.0, 1.2);
@@ -958,11 +1123,17 @@ void EngineBridge::pollSnapshot()
         emit runningChanged();
     }
 
-    // DJ mode: emit UNCONDITIONALLY so deck strips can update meters / playheads.
-    // DJ decks read their own snapshot data directly (deckPlayhead, deckPeakL, etc.)
+    // DJ mode: emit every frame so deck strips can update meters / playheads.
+    // DJ decks read their own snapshot data directly (deckSnapshot, deckPeakL, etc.)
     // and are NOT dependent on the simple-mode generation tracking below.
     emit djSnapshotUpdated();
 
+    // This frame already shows the settled state; stop until a command,
+    // an engine event or housekeeping finds something moving again.
+    if (!framesLive(snapshot)) {
+        meterTimer.stop();
+    }
+
     // ── Generation-gated snapshot acceptance (simple mode only) ──
     // Drop snapshot data if the engine hasn't processed the current
     // track load yet. trackLoadGen is threaded through the command
@@ -1047,5 +1218,5 @@ void EngineBridge::pollSnapshot()
         }
     }
 
-    // (djSnapshotUpdated already emitted above, unconditionally)
+    // (djSnapshotUpdated already emitted above)
 }
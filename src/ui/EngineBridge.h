@@ -1,7 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -177,9 +179,21 @@ public:
     /// Get broad frequency-band energy overview for a deck.
     std::vector<ngks::BandEnergy> getBandEnergyOverview(int deckIndex, int numBins);
 
+    /// Multi-resolution waveform for a deck; grows while the track decodes,
+    /// complete immediately when it came from the waveform cache.
+    std::shared_ptr<const ngks::WaveformPyramid> getWaveformPyramid(int deckIndex) const;
+
+    /// Newest master spectrum (log-frequency bars + peak hold); false when
+    /// no new frame was published since the previous call.
+    bool tryGetSpectrum(ngks::SpectrumFrame& out);
+
     /// Returns true when the full file decode (not just preload) is complete.
     bool isDeckFullyDecoded(int deckIndex) const;
 
+    /// Deck state as of the bridge's last snapshot refresh (each frame while
+    /// anything moves, and after every engine event).  UI thread only.
+    const ngks::DeckSnapshot& deckSnapshot(int deckIndex) const;
+
     /// Returns the file path currently loaded in a deck.
     QString deckFilePath(int deckIndex) const;
 
@@ -215,7 +229,13 @@ signals:
     void playheadChanged(double seconds);
     void durationChanged(double seconds);
     void endOfTrack();
-    void djSnapshotUpdated();  // emitted per poll so DJ page can refresh
+    void djSnapshotUpdated();  // emitted per frame while decks/meters move
+    // ── Engine events (pushed; one queued wakeup per burst) ──
+    void deckTransportChanged(int deckIndex);
+    void deckLoadComplete(int deckIndex);
+    void deckDecodeProgress(int deckIndex, double fraction);
+    void deckDecodeComplete(int deckIndex);
+    void analysisResultReady(int deckIndex, quint32 jobId);
     void deviceSwitchFinished(bool ok, const QString& activeDevice, long long elapsedMs);
     void audioHotReady(bool ok);
     void audioProfileApplied(bool ok);
@@ -264,9 +284,23 @@ private:
     bool ensureAudioHotLocked(const char* triggerTag);
     void handleDeviceFailureLocked(int errorCode, const char* detailTag);
     void pollSnapshot();
+    void runHousekeeping();
+    void drainEngineEvents();
+    static void onEngineEventWakeup(void* context);
+    void updateHealth(const ngks::EngineSnapshot& snapshot);
+    bool framesLive(const ngks::EngineSnapshot& snapshot) const;
+    void wakeFrames();
+    void startPolling();
+    void stopPolling();
+    void enqueue(const ngks::Command& command);
 
     EngineCore engine;
-    QTimer meterTimer;
+    QTimer meterTimer;                  // per-frame snapshot refresh, only while live
+    QTimer housekeepingTimer_;          // enforcer, auto-recovery, event safety net
+    bool pollingEnabled_{false};
+    std::chrono::steady_clock::time_point lastActivity_{};
+    ngks::EngineSnapshot snapshot_{};
+    std::vector<ngks::EngineEvent> pendingEvents_;
     double meterLeftValue = 0.0;
     double meterRightValue = 0.0;
     double masterPeakLeftValue_ = 0.0;
@@ -85,6 +85,7 @@ namespace TagFields {
     inline const QString ScanTimestamp = QStringLiteral("scanTimestamp");
     inline const QString ColorLabel    = QStringLiteral("colorLabel");
     inline const QString DjNotes       = QStringLiteral("djNotes");
+    inline const QString BeatGrid      = QStringLiteral("beatGrid");
 }
 
 // ── Ownership lookup ───────────────────────────────────────────────
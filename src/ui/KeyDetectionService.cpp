@@ -1,4 +1,6 @@
 #include "KeyDetectionService.h"
+#include "AnalysisDecimator.h"
+#include "engine/dsp/Fft.h"
 
 #include <QDebug>
 
@@ -16,50 +18,6 @@ static const char* kNoteNames[12] = {
     "C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"
 };
 
-// ════════════════════════════════════════════════════════════════════
-//  FFT — Radix-2 Cooley-Tukey (in-place)
-// ════════════════════════════════════════════════════════════════════
-//
-//  data = interleaved complex: [re0, im0, re1, im1, ...]
-//  n    = number of complex samples (must be power of 2)
-
-void KeyDetectionService::fftRadix2(double* data, int n)
-{
-    // Bit-reversal permutation
-    for (int i = 1, j = 0; i < n; ++i) {
-        int bit = n >> 1;
-        while (j & bit) { j ^= bit; bit >>= 1; }
-        j ^= bit;
-        if (i < j) {
-            std::swap(data[2 * i],     data[2 * j]);
-            std::swap(data[2 * i + 1], data[2 * j + 1]);
-        }
-    }
-
-    // Butterfly stages
-    for (int len = 2; len <= n; len <<= 1) {
-        double angle = -2.0 * M_PI / len;
-        double wRe = std::cos(angle);
-        double wIm = std::sin(angle);
-        for (int i = 0; i < n; i += len) {
-            double curRe = 1.0, curIm = 0.0;
-            for (int j = 0; j < len / 2; ++j) {
-                int a = i + j;
-                int b = i + j + len / 2;
-                double tRe = curRe * data[2 * b]     - curIm * data[2 * b + 1];
-                double tIm = curRe * data[2 * b + 1] + curIm * data[2 * b];
-                data[2 * b]     = data[2 * a]     - tRe;
-                data[2 * b + 1] = data[2 * a + 1] - tIm;
-                data[2 * a]     += tRe;
-                data[2 * a + 1] += tIm;
-                double next = curRe * wRe - curIm * wIm;
-                curIm       = curRe * wIm + curIm * wRe;
-                curRe       = next;
-            }
-        }
-    }
-}
-
 // ════════════════════════════════════════════════════════════════════
 //  LAYER 1 — Preprocess (high-pass, normalize)
 // ════════════════════════════════════════════════════════════════════
@@ -108,7 +66,8 @@ std::vector<float> KeyDetectionService::preprocessForKey(
 // ════════════════════════════════════════════════════════════════════
 //
 //  For each STFT frame:
-//    • FFT (radix-2, 4096 points)
+//    • FFT (radix-2, 4096 points at 44.1 kHz — scaled with the analysis
+//      rate so frames always span ~93 ms)
 //    • Map magnitude-spectrum bins → 12 pitch classes
 //    • Weight by harmonic-relevance band (200–1000 Hz emphasis)
 //    • Compute spectral flux for transient detection
@@ -121,8 +80,8 @@ KeyDetectionService::buildChromaFrames(const float* data,
                                        int64_t numSamples,
                                        double sampleRate)
 {
-    constexpr int kFFTSize = 4096;
-    constexpr int kHop     = 2048;
+    const int kFFTSize = analysisFftSizeForRate(sampleRate, 4096);
+    const int kHop     = kFFTSize / 2;
     const int64_t numFrames = (numSamples - kFFTSize) / kHop;
     if (numFrames < 1) return {};
 
@@ -164,6 +123,7 @@ KeyDetectionService::buildChromaFrames(const float* data,
 
     std::vector<double> prevMag(halfBins, 0.0);
     std::vector<double> fftBuf(kFFTSize * 2, 0.0);  // interleaved complex
+    const Fft fft(kFFTSize);                        // twiddles built once
 
     for (int64_t f = 0; f < numFrames; ++f) {
         const float* frameStart = data + f * kHop;
@@ -174,7 +134,7 @@ KeyDetectionService::buildChromaFrames(const float* data,
             fftBuf[2 * i + 1] = 0.0;
         }
 
-        fftRadix2(fftBuf.data(), kFFTSize);
+        fft.forward(fftBuf.data());
 
         // Compute magnitudes, chroma, energy, flux
         ChromaFrame cf;
@@ -1129,7 +1089,7 @@ KeyAnalysisResult KeyDetectionService::detect(const float* monoData,
 {
     KeyAnalysisResult result;
 
-    if (numSamples < 4096) {
+    if (numSamples < analysisFftSizeForRate(sampleRate, 4096)) {
         result.finalKey     = QStringLiteral("--");
         result.finalCamelot = QStringLiteral("--");
         return result;
@@ -1379,3 +1339,39 @@ KeyAnalysisResult KeyDetectionService::detect(const float* monoData,
 
     return result;
 }
+
+// ════════════════════════════════════════════════════════════════════
+//  Camelot → standard key notation (reverse wheel)
+// ════════════════════════════════════════════════════════════════════
+
+QString KeyDetectionService::standardKeyFromCamelot(const QString& camelot)
+{
+    // Camelot number → root note index (0=C .. 11=B)
+    // Major (B): 8B=C, 3B=C#, 10B=D, 5B=Eb, 12B=E, 7B=F, 2B=F#, 9B=G, 4B=Ab, 11B=A, 6B=Bb, 1B=B
+    // Minor (A): 5A=Cm, 12A=C#m, 7A=Dm, 2A=Ebm, 9A=Em, 4A=Fm, 11A=F#m, 6A=Gm, 1A=Abm, 8A=Am, 3A=Bbm, 10A=Bm
+    static const char* noteNames[12] = {
+        "C", "Db", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"
+    };
+    // camelotMajor[root] = camelotNum  →  invert to: camelotNum → root
+    // Forward: {8,3,10,5,12,7,2,9,4,11,6,1} for C..B
+    static const int majorNumToRoot[13] = {
+        -1, 11, 6, 1, 8, 3, 10, 5, 0, 7, 2, 9, 4
+    }; // index = camelot number (1-12), value = root note index
+    // Forward minor: {5,12,7,2,9,4,11,6,1,8,3,10} for Cm..Bm
+    static const int minorNumToRoot[13] = {
+        -1, 8, 3, 10, 5, 0, 7, 2, 9, 4, 11, 6, 1
+    };
+
+    if (camelot.length() < 2) return camelot;
+    QChar modeCh = camelot.at(camelot.length() - 1);
+    bool isMajor = (modeCh == QLatin1Char('B') || modeCh == QLatin1Char('b'));
+    int num = QStringView(camelot).left(camelot.length() - 1).toInt();
+    if (num < 1 || num > 12) return camelot;
+
+    int root = isMajor ? majorNumToRoot[num] : minorNumToRoot[num];
+    if (root < 0) return camelot;
+
+    QString key = QString::fromLatin1(noteNames[root]);
+    if (!isMajor) key += QLatin1Char('m');
+    return key;
+}
@@ -49,6 +49,10 @@ public:
                              double        sampleRate,
                              double        spectralCentroid = 0.0);
 
+    // "8A" → "Am", "10B" → "D".  Returns the input unchanged if it is
+    // not a valid Camelot code.
+    static QString standardKeyFromCamelot(const QString& camelot);
+
 private:
     // ── Layer 1 ──
     std::vector<float> preprocessForKey(const float* data, int64_t numSamples,
@@ -115,7 +119,4 @@ private:
     // ── Layer 8 ──
     static QString mapToCamelot(int root, bool major);
     static QString keyName(int root, bool major);
-
-    // ── FFT utility ──
-    static void fftRadix2(double* data, int n);
 };
@@ -2,6 +2,7 @@
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSet>
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
@@ -101,7 +102,8 @@ bool TagDatabaseService::ensureOverlaySchema()
         "  instrumentalness REAL DEFAULT -1,"
         "  liveness      REAL DEFAULT -1,"
         "  camelot_key   TEXT,"
-        "  scan_ts       TEXT"
+        "  scan_ts       TEXT,"
+        "  beat_grid     BLOB"
         ")"
     );
 
@@ -110,6 +112,20 @@ bool TagDatabaseService::ensureOverlaySchema()
         return false;
     }
 
+    // Columns added after the first release — older overlays get them
+    // appended in place so existing edits survive.
+    QSet<QString> existing;
+    if (q.exec(QStringLiteral("PRAGMA table_info(track_overlay)"))) {
+        while (q.next()) existing.insert(q.value(1).toString());
+    }
+    if (!existing.contains(QStringLiteral("beat_grid"))) {
+        if (!q.exec(QStringLiteral("ALTER TABLE track_overlay ADD COLUMN beat_grid BLOB"))) {
+            qDebug() << "[TAG_DB] MIGRATE_FAIL beat_grid" << q.lastError().text();
+            return false;
+        }
+        qDebug() << "[TAG_DB] MIGRATE_ADD_COLUMN beat_grid";
+    }
+
     qDebug() << "[TAG_DB] OVERLAY_SCHEMA_OK";
     return true;
 }
@@ -144,6 +160,7 @@ static const QHash<QString, QString>& fieldToOverlayCol()
         {QStringLiteral("liveness"),      QStringLiteral("liveness")},
         {QStringLiteral("camelot"),       QStringLiteral("camelot_key")},
         {QStringLiteral("scanTimestamp"), QStringLiteral("scan_ts")},
+        {QStringLiteral("beatGrid"),      QStringLiteral("beat_grid")},
     };
     return m;
 }
@@ -323,7 +340,11 @@ bool TagDatabaseService::saveBulk(const QString& filePath,
             qDebug() << "[TAG_DB] SAVE_FIELD_FAIL" << col << upd.lastError().text();
             return false;
         }
-        qDebug() << "[TAG_DB] FIELD_SAVE_TARGET" << it.key() << "->" << col << "val=" << it.value();
+        const bool isBlob = it.value().typeId() == QMetaType::QByteArray;
+        qDebug() << "[TAG_DB] FIELD_SAVE_TARGET" << it.key() << "->" << col << "val="
+                 << (isBlob ? QVariant(QStringLiteral("<%1 bytes>")
+                                           .arg(it.value().toByteArray().size()))
+                            : it.value());
     }
 
     qDebug() << "[TAG_DB] SAVE_OK" << canon << "fields=" << fields.size();
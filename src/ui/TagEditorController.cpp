@@ -3,7 +3,9 @@
 #include "TagWriterService.h"
 #include "AlbumArtService.h"
 #include "TagDatabaseService.h"
-#include "AudioAnalysisService.h"
+#include "AnalysisSession.h"
+#include "AnalysisCache.h"
+#include "KeyDetectionService.h"
 #include "FieldOwnership.h"
 #include <QCoreApplication>
 #include <QDebug>
@@ -13,7 +15,7 @@ TagEditorController::TagEditorController(QObject* parent)
     : QObject(parent)
 {
     dbService_ = new TagDatabaseService(this);
-    analysisService_ = new AudioAnalysisService(this);
+    analysisSession_ = new AnalysisSession(this);
 
     // Overlay DB: local to the app
     const QString overlayPath = QCoreApplication::applicationDirPath()
@@ -26,9 +28,66 @@ TagEditorController::TagEditorController(QObject* parent)
     if (!dbService_->init(overlayPath, libraryPath)) {
         qDebug() << "[TAG_EDITOR] DB_INIT_FAIL – overlay features degraded";
     }
+
+    // Analysis cache: re-analysing an unchanged file is a lookup
+    analysisCache_ = std::make_unique<AnalysisCache>();
+    const QString cachePath = QCoreApplication::applicationDirPath()
+                              + QStringLiteral("/../../../data/runtime/analysis_cache.bin");
+    if (analysisCache_->open(cachePath)) {
+        analysisSession_->setCache(analysisCache_.get());
+    } else {
+        qDebug() << "[TAG_EDITOR] ANALYSIS_CACHE_FAIL – analysing uncached";
+    }
+
+    connect(analysisSession_, &AnalysisSession::stageReady, this,
+            [this](quint64, uint32_t stages, const AnalysisResult& partial) {
+        if (current_.sourceFilePath != analysisPath_) return;
+
+        // Preview only: apply finished stages to a copy of the current data
+        TrackTagData preview = current_;
+        if (stages & AnalysisStage::Tempo) {
+            preview.bpm           = QString::number(partial.bpm, 'f', 1);
+            preview.rawBpm        = partial.rawBpm;
+            preview.resolvedBpm   = partial.resolvedBpm;
+            preview.bpmConfidence = partial.bpmConfidence;
+            preview.bpmFamily     = partial.bpmFamily;
+        }
+        if (stages & AnalysisStage::Loudness) {
+            preview.loudnessLUFS  = partial.loudnessLUFS;
+            preview.loudnessRange = partial.lra;
+        }
+        if (stages & AnalysisStage::Spectral) {
+            preview.energy = partial.energy;
+        }
+        if (stages & AnalysisStage::Cues) {
+            preview.cueIn  = QString::number(partial.cueInSeconds, 'f', 2);
+            preview.cueOut = QString::number(partial.cueOutSeconds, 'f', 2);
+        }
+        if (stages & AnalysisStage::Key) {
+            preview.camelotKey = partial.camelotKey;
+            preview.musicalKey = KeyDetectionService::standardKeyFromCamelot(partial.camelotKey);
+        }
+        if (stages & AnalysisStage::Derived) {
+            preview.danceability         = partial.danceability;
+            preview.acousticness         = partial.acousticness;
+            preview.instrumentalness     = partial.instrumentalness;
+            preview.liveness             = partial.liveness;
+            preview.transitionDifficulty = partial.transitionDifficulty;
+        }
+        emit analysisProgress(stages, preview);
+    });
+    connect(analysisSession_, &AnalysisSession::finished, this,
+            [this](quint64, const AnalysisResult& result) {
+        onAnalysisFinished(result);
+    });
 }
 
-TagEditorController::~TagEditorController() = default;
+TagEditorController::~TagEditorController()
+{
+    // Join analysis workers before the cache they write to goes away
+    delete analysisSession_;
+    analysisSession_ = nullptr;
+}
 
 // ── Merge helper: apply DB overlay onto file-loaded TrackTagData ───
 
@@ -159,6 +218,15 @@ void TagEditorController::mergeDbOverlay(const QHash<QString, QVariant>& dbField
     // DB_ONLY
     merge(TagFields::ColorLabel, current_.colorLabel);
     merge(TagFields::DjNotes, current_.djNotes);
+
+    // Beat grid is binary — kept as the encoded blob
+    {
+        auto it = dbFields.constFind(TagFields::BeatGrid);
+        if (it != dbFields.constEnd() && !it.value().toByteArray().isEmpty()) {
+            current_.beatGrid = it.value().toByteArray();
+            current_.setSource(TagFields::BeatGrid, FieldSource::Db);
+        }
+    }
 }
 
 // ── Load ───────────────────────────────────────────────────────────
@@ -166,6 +234,7 @@ void TagEditorController::mergeDbOverlay(const QHash<QString, QVariant>& dbField
 void TagEditorController::loadFile(const QString& path)
 {
     qDebug() << "[TAG_EDITOR] FILE_OPEN" << path;
+    cancelAnalysis();
 
     // 1. Read tags from file
     current_ = TagReaderService::loadTagsForFile(path);
@@ -397,11 +466,31 @@ void TagEditorController::runAnalysis()
     }
 
     qDebug() << "[TAG_EDITOR] ANALYSIS_TRIGGER" << current_.sourceFilePath;
+    analysisPath_ = current_.sourceFilePath;
+    analysisSession_->start(current_.sourceFilePath, current_.genre);
     emit analysisStarted();
+}
 
-    // Run analysis (blocking — called from UI thread for now)
-    AnalysisResult result = analysisService_->analyzeFile(current_.sourceFilePath,
-                                                            current_.genre);
+void TagEditorController::cancelAnalysis()
+{
+    if (!analysisSession_->isRunning()) return;
+    qDebug() << "[TAG_EDITOR] ANALYSIS_CANCEL" << analysisPath_;
+    analysisSession_->cancel();
+    analysisPath_.clear();
+    emit analysisCancelled();
+}
+
+bool TagEditorController::isAnalyzing() const
+{
+    return analysisSession_->isRunning();
+}
+
+void TagEditorController::onAnalysisFinished(const AnalysisResult& result)
+{
+    if (current_.sourceFilePath != analysisPath_) return;
+    analysisPath_.clear();
+    qDebug() << "[TAG_EDITOR] ANALYSIS_DONE ms=" << result.analysisMs
+             << "cached=" << Qt::hex << result.cachedStages;
 
     if (result.valid) {
         applyAnalysisResult(result);
@@ -420,6 +509,8 @@ void TagEditorController::runAnalysis()
         dbPayload.insert(TagFields::Liveness,         current_.liveness);
         dbPayload.insert(TagFields::Camelot,           current_.camelotKey);
         dbPayload.insert(TagFields::Key,               current_.musicalKey);
+        if (!current_.beatGrid.isEmpty())
+            dbPayload.insert(TagFields::BeatGrid,      current_.beatGrid);
 
         bool saveOk = dbService_->saveBulk(current_.sourceFilePath, dbPayload);
         qDebug() << "[ANALYSIS] ANALYSIS_SAVE_DB" << (saveOk ? "success" : "fail")
@@ -458,6 +549,7 @@ void TagEditorController::clearAnalysis()
     current_.instrumentalness  = -1.0;
     current_.liveness          = -1.0;
     current_.transitionDifficulty = -1.0;
+    current_.beatGrid.clear();
 
     // Clear from overlay DB
     QHash<QString, QVariant> dbPayload;
@@ -473,6 +565,7 @@ void TagEditorController::clearAnalysis()
     dbPayload.insert(TagFields::Acousticness,      QVariant());
     dbPayload.insert(TagFields::Instrumentalness,  QVariant());
     dbPayload.insert(TagFields::Liveness,          QVariant());
+    dbPayload.insert(TagFields::BeatGrid,          QVariant());
 
     bool ok = dbService_->saveBulk(current_.sourceFilePath, dbPayload);
     qInfo().noquote() << "[TAG_EDITOR] CLEAR_ANALYSIS_DB"
@@ -481,39 +574,6 @@ void TagEditorController::clearAnalysis()
     emit fileLoaded(current_);  // refresh UI to show cleared values
 }
 
-// Reverse Camelot wheel → standard key notation
-static QString camelotToStandardKey(const QString& camelot)
-{
-    // Camelot number → root note index (0=C .. 11=B)
-    // Major (B): 8B=C, 3B=C#, 10B=D, 5B=Eb, 12B=E, 7B=F, 2B=F#, 9B=G, 4B=Ab, 11B=A, 6B=Bb, 1B=B
-    // Minor (A): 5A=Cm, 12A=C#m, 7A=Dm, 2A=Ebm, 9A=Em, 4A=Fm, 11A=F#m, 6A=Gm, 1A=Abm, 8A=Am, 3A=Bbm, 10A=Bm
-    static const char* noteNames[12] = {
-        "C", "Db", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"
-    };
-    // camelotMajor[root] = camelotNum  →  invert to: camelotNum → root
-    // Forward: {8,3,10,5,12,7,2,9,4,11,6,1} for C..B
-    static const int majorNumToRoot[13] = {
-        -1, 11, 6, 1, 8, 3, 10, 5, 0, 7, 2, 9, 4
-    }; // index = camelot number (1-12), value = root note index
-    // Forward minor: {5,12,7,2,9,4,11,6,1,8,3,10} for Cm..Bm
-    static const int minorNumToRoot[13] = {
-        -1, 8, 3, 10, 5, 0, 7, 2, 9, 4, 11, 6, 1
-    };
-
-    if (camelot.length() < 2) return camelot;
-    QChar modeCh = camelot.at(camelot.length() - 1);
-    bool isMajor = (modeCh == QLatin1Char('B') || modeCh == QLatin1Char('b'));
-    int num = QStringView(camelot).left(camelot.length() - 1).toInt();
-    if (num < 1 || num > 12) return camelot;
-
-    int root = isMajor ? majorNumToRoot[num] : minorNumToRoot[num];
-    if (root < 0) return camelot;
-
-    QString key = QString::fromLatin1(noteNames[root]);
-    if (!isMajor) key += QLatin1Char('m');
-    return key;
-}
-
 void TagEditorController::applyAnalysisResult(const AnalysisResult& result)
 {
     // Apply analysis results to current TrackTagData
@@ -546,7 +606,7 @@ void TagEditorController::applyAnalysisResult(const AnalysisResult& result)
     // Key: derive standard key from Camelot and overwrite
     current_.camelotKey = result.camelotKey;
     current_.setSource(TagFields::Camelot, FieldSource::Db);
-    current_.musicalKey = camelotToStandardKey(result.camelotKey);
+    current_.musicalKey = KeyDetectionService::standardKeyFromCamelot(result.camelotKey);
     current_.setSource(TagFields::Key, FieldSource::Db);
 
     qInfo().noquote() << "[KEY_DETECT] KEY_RAW_SELECTED:"
@@ -595,10 +655,23 @@ void TagEditorController::applyAnalysisResult(const AnalysisResult& result)
 
     current_.transitionDifficulty = result.transitionDifficulty;
 
+    // Beat grid (DB_ONLY) — stored encoded; empty when tracking failed
+    {
+        const std::vector<uint8_t> blob = result.beatGrid.encode();
+        current_.beatGrid = result.beatGrid.empty()
+            ? QByteArray()
+            : QByteArray(reinterpret_cast<const char*>(blob.data()),
+                         static_cast<qsizetype>(blob.size()));
+        current_.setSource(TagFields::BeatGrid, FieldSource::Db);
+    }
+
     qDebug() << "[TAG_EDITOR] ANALYSIS_APPLIED"
              << "energy=" << current_.energy
              << "lufs=" << current_.loudnessLUFS
              << "bpm=" << current_.bpm
              << "key=" << current_.musicalKey
-             << "camelot=" << current_.camelotKey;
+             << "camelot=" << current_.camelotKey
+             << "beats=" << result.beatGrid.beats.size()
+             << "gridBytes=" << current_.beatGrid.size()
+             << "ms=" << result.analysisMs;
 }
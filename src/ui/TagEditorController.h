@@ -1,10 +1,12 @@
 #pragma once
 #include <QObject>
+#include <memory>
 #include "TrackTagData.h"
 #include "AnalysisResult.h"
 
 class TagDatabaseService;
-class AudioAnalysisService;
+class AnalysisSession;
+class AnalysisCache;
 
 class TagEditorController : public QObject
 {
@@ -26,8 +28,12 @@ public:
                       const QString& bpm, const QString& musicalKey,
                       const QString& comments);
 
+    // Asynchronous: progress arrives via analysisProgress(), the result
+    // via analysisFinished().  Loading another file cancels it.
     void runAnalysis();
+    void cancelAnalysis();
     void clearAnalysis();
+    bool isAnalyzing() const;
 
     const TrackTagData& data() const { return current_; }
     bool isDirty() const { return current_.dirty; }
@@ -41,17 +47,24 @@ signals:
     void dirtyChanged(bool dirty);
     void saveResult(bool success, const QString& message);
     void analysisStarted();
+    // `preview` is the current data with the finished AnalysisStage bits
+    // in `stages` applied; nothing is persisted until analysisFinished.
+    void analysisProgress(uint32_t stages, const TrackTagData& preview);
     void analysisFinished(const AnalysisResult& result);
+    void analysisCancelled();
 
 private:
     void setDirty(bool d);
     void mergeDbOverlay(const QHash<QString, QVariant>& dbFields);
     void saveDbFields();
     void applyAnalysisResult(const AnalysisResult& result);
+    void onAnalysisFinished(const AnalysisResult& result);
 
     TrackTagData current_;
     TrackTagData original_;
     ArtSource artSource_{ArtNone};
     TagDatabaseService* dbService_{nullptr};
-    AudioAnalysisService* analysisService_{nullptr};
+    std::unique_ptr<AnalysisCache> analysisCache_;
+    AnalysisSession* analysisSession_{nullptr};
+    QString analysisPath_;          // file the running session analyses
 };
@@ -174,6 +174,27 @@ TagEditorView::TagEditorView(QWidget* parent)
             "color:#5090c0; font-size:11px; font-weight:700;"
             " letter-spacing:0.5px; padding:0 14px;"));
     });
+    connect(controller_, &TagEditorController::analysisProgress,
+            this, [this](uint32_t stages, const TrackTagData& preview) {
+        // Stream each finished stage into the analysis panel
+        setExtraContext(preview.rating, preview.colorLabel, preview.labels,
+                        preview.energy, preview.loudnessLUFS, preview.loudnessRange,
+                        preview.cueIn, preview.cueOut,
+                        preview.danceability, preview.acousticness,
+                        preview.instrumentalness, preview.liveness,
+                        preview.camelotKey, preview.transitionDifficulty,
+                        preview.rawBpm, preview.resolvedBpm,
+                        preview.bpmConfidence, preview.bpmFamily);
+        int done = 0;
+        for (uint32_t s = stages; s != 0; s &= s - 1) ++done;
+        statusLabel_->setText(QStringLiteral("Analyzing... %1/%2")
+                                  .arg(done).arg(AnalysisStage::kCount));
+    });
+    connect(controller_, &TagEditorController::analysisCancelled, this, [this]() {
+        analyzeBtn_->setEnabled(controller_->hasFile());
+        clearAnalysisBtn_->setEnabled(controller_->hasFile());
+        analyzeBtn_->setText(QStringLiteral("Analyze"));
+    });
     connect(controller_, &TagEditorController::analysisFinished,
             this, [this](const AnalysisResult& result) {
         analyzeBtn_->setEnabled(controller_->hasFile());
@@ -0,0 +1,824 @@
+#include "TagParser.h"
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// ── File view ──────────────────────────────────────────────────────
+// Hands out pointers to file regions: a memory mapping where possible,
+// an owned read() buffer otherwise.  Pointers live as long as the view.
+
+class FileView
+{
+public:
+    explicit FileView(const QString& path) : file_(path)
+    {
+        if (file_.open(QIODevice::ReadOnly)) size_ = file_.size();
+    }
+
+    ~FileView()
+    {
+        for (uchar* p : maps_) file_.unmap(p);
+    }
+
+    qint64 size() const { return size_; }
+
+    // [off, off + len) clamped to the file; nullptr (len = 0) if empty.
+    const uchar* view(qint64 off, qint64& len)
+    {
+        if (off < 0 || off >= size_ || len <= 0) { len = 0; return nullptr; }
+        len = std::min(len, size_ - off);
+        if (uchar* p = file_.map(off, len)) {
+            maps_.push_back(p);
+            return p;
+        }
+        if (!file_.seek(off)) { len = 0; return nullptr; }
+        copies_.push_back(file_.read(len));
+        len = copies_.back().size();
+        return len > 0 ? reinterpret_cast<const uchar*>(copies_.back().constData()) : nullptr;
+    }
+
+private:
+    QFile file_;
+    qint64 size_{0};
+    std::vector<uchar*> maps_;
+    std::vector<QByteArray> copies_;    // QByteArray data stays put when the vector grows
+};
+
+// ── Byte helpers ───────────────────────────────────────────────────
+
+inline uint32_t be16(const uchar* p) { return (uint32_t(p[0]) << 8) | p[1]; }
+inline uint32_t be24(const uchar* p) { return (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2]; }
+inline uint32_t be32(const uchar* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+inline uint64_t be64(const uchar* p) { return (uint64_t(be32(p)) << 32) | be32(p + 4); }
+inline uint32_t le16(const uchar* p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8); }
+inline uint32_t le32(const uchar* p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+inline uint64_t le64(const uchar* p) { return uint64_t(le32(p)) | (uint64_t(le32(p + 4)) << 32); }
+inline uint32_t syncsafe32(const uchar* p)
+{
+    return (uint32_t(p[0] & 0x7F) << 21) | (uint32_t(p[1] & 0x7F) << 14)
+         | (uint32_t(p[2] & 0x7F) << 7)  |  uint32_t(p[3] & 0x7F);
+}
+inline bool tagIs(const uchar* p, const char* id, int n) { return std::memcmp(p, id, static_cast<size_t>(n)) == 0; }
+
+// ASCII case-insensitive compare of [p, p+n) against a NUL-terminated key.
+bool keyEquals(const uchar* p, qint64 n, const char* key)
+{
+    qint64 i = 0;
+    for (; i < n && key[i]; ++i) {
+        uchar a = p[i], b = static_cast<uchar>(key[i]);
+        if (a >= 'a' && a <= 'z') a = static_cast<uchar>(a - 32);
+        if (b >= 'a' && b <= 'z') b = static_cast<uchar>(b - 32);
+        if (a != b) return false;
+    }
+    return i == n && key[i] == '\0';
+}
+
+// ── Sink ───────────────────────────────────────────────────────────
+// First value wins for every field, whatever container it came from.
+
+struct Sink
+{
+    uint32_t    want;
+    ParsedTags& out;
+
+    bool wants(uint32_t f) const { return (want & f) && !(out.found & f); }
+    bool done() const { return (out.found & want) == want; }
+
+    QString* slot(uint32_t f)
+    {
+        switch (f) {
+        case TagField::Title:       return &out.title;
+        case TagField::Artist:      return &out.artist;
+        case TagField::Album:       return &out.album;
+        case TagField::AlbumArtist: return &out.albumArtist;
+        case TagField::Genre:       return &out.genre;
+        case TagField::Year:        return &out.year;
+        case TagField::TrackNumber: return &out.trackNumber;
+        case TagField::DiscNumber:  return &out.discNumber;
+        case TagField::Bpm:         return &out.bpm;
+        case TagField::Key:         return &out.musicalKey;
+        case TagField::Comment:     return &out.comments;
+        default:                    return nullptr;
+        }
+    }
+
+    void text(uint32_t f, QString v)
+    {
+        if (!wants(f)) return;
+        v.remove(QChar('\0'));
+        v = v.trimmed();
+        if (v.isEmpty()) return;
+        if (f == TagField::Genre) v = resolveGenre(v);
+        if (f == TagField::Length) {
+            bool ok = false;
+            const qint64 ms = v.toLongLong(&ok);
+            if (ok && ms > 0) length(ms);
+            return;
+        }
+        if (QString* s = slot(f)) {
+            *s = v;
+            out.found |= f;
+        }
+    }
+
+    void length(qint64 ms)
+    {
+        if (!wants(TagField::Length) || ms <= 0) return;
+        out.durationMs = ms;
+        out.found |= TagField::Length;
+    }
+
+    void picture(const uchar* p, qint64 n)
+    {
+        if (!wants(TagField::Picture) || n <= 0) return;
+        out.picture = QByteArray(reinterpret_cast<const char*>(p), static_cast<int>(n));
+        out.found |= TagField::Picture;
+    }
+
+    // "(13)", "13", "(13)Pop" → "Pop"
+    static QString resolveGenre(const QString& v)
+    {
+        QString s = v;
+        if (s.startsWith(QLatin1Char('('))) {
+            const int close = s.indexOf(QLatin1Char(')'));
+            if (close > 1) {
+                const QString rest = s.mid(close + 1).trimmed();
+                if (!rest.isEmpty()) return rest;
+                s = s.mid(1, close - 1);
+            }
+        }
+        bool ok = false;
+        const int idx = s.toInt(&ok);
+        if (ok) {
+            const QString name = TagParser::id3v1Genre(idx);
+            if (!name.isEmpty()) return name;
+        }
+        return v;
+    }
+};
+
+// ── ID3v2 ──────────────────────────────────────────────────────────
+
+QByteArray undoUnsync(const uchar* p, qint64 n)
+{
+    // 0xFF 0x00 → 0xFF
+    QByteArray out;
+    out.reserve(static_cast<int>(n));
+    for (qint64 i = 0; i < n; ++i) {
+        out.append(static_cast<char>(p[i]));
+        if (p[i] == 0xFF && i + 1 < n && p[i + 1] == 0x00) ++i;
+    }
+    return out;
+}
+
+// Length of a string in encoding `enc` up to (not incl.) its terminator.
+qint64 id3StringLength(uint8_t enc, const uchar* p, qint64 n)
+{
+    if (enc == 1 || enc == 2) {
+        for (qint64 i = 0; i + 1 < n; i += 2)
+            if (p[i] == 0 && p[i + 1] == 0) return i;
+        return n & ~qint64(1);
+    }
+    const void* z = std::memchr(p, 0, static_cast<size_t>(n));
+    return z ? static_cast<const uchar*>(z) - p : n;
+}
+
+qint64 id3TerminatorSize(uint8_t enc) { return (enc == 1 || enc == 2) ? 2 : 1; }
+
+QString decodeId3String(uint8_t enc, const uchar* p, qint64 n)
+{
+    n = id3StringLength(enc, p, n);
+    if (n <= 0) return {};
+    const char* c = reinterpret_cast<const char*>(p);
+    switch (enc) {
+    case 0: return QString::fromLatin1(c, static_cast<int>(n));
+    case 3: return QString::fromUtf8(c, static_cast<int>(n));
+    case 1:
+    case 2: {
+        bool bigEndian = (enc == 2);
+        if (enc == 1 && n >= 2) {
+            if (p[0] == 0xFF && p[1] == 0xFE)      { p += 2; n -= 2; }
+            else if (p[0] == 0xFE && p[1] == 0xFF) { p += 2; n -= 2; bigEndian = true; }
+        }
+        QString s(static_cast<int>(n / 2), Qt::Uninitialized);
+        QChar* d = s.data();
+        for (qint64 i = 0; i + 1 < n; i += 2)
+            *d++ = QChar(bigEndian ? char16_t(be16(p + i)) : char16_t(le16(p + i)));
+        return s;
+    }
+    default:
+        return {};
+    }
+}
+
+uint32_t id3FrameField(const uchar* id, int idLen)
+{
+    struct Map { const char* id; uint32_t field; };
+    static const Map v23[] = {
+        { "TIT2", TagField::Title },  { "TPE1", TagField::Artist },     { "TALB", TagField::Album },
+        { "TPE2", TagField::AlbumArtist }, { "TCON", TagField::Genre }, { "TYER", TagField::Year },
+        { "TDRC", TagField::Year },   { "TRCK", TagField::TrackNumber }, { "TPOS", TagField::DiscNumber },
+        { "TBPM", TagField::Bpm },    { "TKEY", TagField::Key },        { "COMM", TagField::Comment },
+        { "TLEN", TagField::Length }, { "APIC", TagField::Picture },
+    };
+    static const Map v22[] = {
+        { "TT2", TagField::Title },   { "TP1", TagField::Artist },      { "TAL", TagField::Album },
+        { "TP2", TagField::AlbumArtist }, { "TCO", TagField::Genre },   { "TYE", TagField::Year },
+        { "TRK", TagField::TrackNumber }, { "TPA", TagField::DiscNumber }, { "TBP", TagField::Bpm },
+        { "TKE", TagField::Key },     { "COM", TagField::Comment },     { "TLE", TagField::Length },
+        { "PIC", TagField::Picture },
+    };
+    if (idLen == 4) {
+        for (const Map& m : v23) if (tagIs(id, m.id, 4)) return m.field;
+    } else {
+        for (const Map& m : v22) if (tagIs(id, m.id, 3)) return m.field;
+    }
+    return 0;
+}
+
+void id3Frame(uint32_t field, int ver, const uchar* d, qint64 n, Sink& s)
+{
+    const uint8_t enc = d[0];
+    if (field == TagField::Comment) {
+        // enc, lang[3], description, text — only the unnamed comment
+        // (named ones are iTunNORM and friends).
+        if (n < 5) return;
+        const uchar* p = d + 4;
+        qint64 rest = n - 4;
+        const qint64 descLen = id3StringLength(enc, p, rest);
+        if (descLen != 0) return;
+        p += id3TerminatorSize(enc);
+        rest -= id3TerminatorSize(enc);
+        if (rest > 0) s.text(field, decodeId3String(enc, p, rest));
+        return;
+    }
+    if (field == TagField::Picture) {
+        const uchar* p = d + 1;
+        qint64 rest = n - 1;
+        if (ver == 2) {                 // PIC: format[3]
+            p += 3; rest -= 3;
+        } else {                        // APIC: MIME, NUL
+            const qint64 m = id3StringLength(0, p, rest);
+            p += m + 1; rest -= m + 1;
+        }
+        if (rest < 2) return;
+        p += 1; rest -= 1;              // picture type
+        const qint64 descLen = id3StringLength(enc, p, rest);
+        p += descLen + id3TerminatorSize(enc);
+        rest -= descLen + id3TerminatorSize(enc);
+        if (rest > 0) s.picture(p, rest);
+        return;
+    }
+    s.text(field, decodeId3String(enc, d + 1, n - 1));
+}
+
+// p points at "ID3"; n covers at least the whole tag.  Returns the tag
+// size including header and footer, 0 if not a tag.
+qint64 parseId3v2(const uchar* p, qint64 n, Sink& s)
+{
+    if (n < 10 || !tagIs(p, "ID3", 3)) return 0;
+    const int ver = p[3];
+    if (ver < 2 || ver > 4) return 0;
+    const uint8_t flags = p[5];
+    const qint64 tagSize = 10 + syncsafe32(p + 6) + ((ver == 4 && (flags & 0x10)) ? 10 : 0);
+    s.out.container = QStringLiteral("id3v2.%1").arg(ver);
+
+    const uchar* t = p + 10;
+    qint64 tn = std::min<qint64>(n, 10 + syncsafe32(p + 6)) - 10;
+    QByteArray whole;
+    if ((flags & 0x80) && ver < 4) {
+        whole = undoUnsync(t, tn);
+        t = reinterpret_cast<const uchar*>(whole.constData());
+        tn = whole.size();
+    }
+
+    qint64 pos = 0;
+    if ((flags & 0x40) && ver >= 3 && tn >= 4)
+        pos = (ver == 3) ? 4 + be32(t) : syncsafe32(t);
+
+    const int idLen  = (ver == 2) ? 3 : 4;
+    const int hdrLen = (ver == 2) ? 6 : 10;
+    while (pos + hdrLen <= tn && !s.done()) {
+        const uchar* h = t + pos;
+        if (h[0] == 0) break;                               // padding
+
+        qint64 size;
+        if (ver == 2)      size = be24(h + 3);
+        else if (ver == 3) size = be32(h + 4);
+        else {
+            // Some v2.4 writers store plain sizes; those have high bits set.
+            const bool plain = (h[4] | h[5] | h[6] | h[7]) & 0x80;
+            size = plain ? be32(h + 4) : syncsafe32(h + 4);
+        }
+        const uint32_t fflags = (ver >= 3) ? be16(h + 8) : 0;
+        pos += hdrLen;
+        if (size <= 0 || pos + size > tn) break;
+        const uchar* d = t + pos;
+        qint64 dn = size;
+        pos += size;
+
+        const uint32_t field = id3FrameField(h, idLen);
+        if (!field || !s.wants(field)) continue;
+
+        bool unsync = false;
+        if (ver == 3) {
+            if (fflags & 0x00C0) continue;                  // compressed / encrypted
+            if (fflags & 0x0020) { d += 1; dn -= 1; }       // group id
+        } else if (ver == 4) {
+            if (fflags & 0x000C) continue;                  // compressed / encrypted
+            if (fflags & 0x0040) { d += 1; dn -= 1; }       // group id
+            if (fflags & 0x0001) { d += 4; dn -= 4; }       // data length indicator
+            unsync = (fflags & 0x0002) || (flags & 0x80);
+        }
+        QByteArray frame;
+        if (unsync && dn > 0) {
+            frame = undoUnsync(d, dn);
+            d = reinterpret_cast<const uchar*>(frame.constData());
+            dn = frame.size();
+        }
+        if (dn > 1) id3Frame(field, ver, d, dn, s);
+    }
+    return tagSize;
+}
+
+void parseId3v1(FileView& f, Sink& s)
+{
+    if (f.size() < 128 || s.done()) return;
+    qint64 len = 128;
+    const uchar* p = f.view(f.size() - 128, len);
+    if (!p || len < 128 || !tagIs(p, "TAG", 3)) return;
+    if (s.out.container.isEmpty()) s.out.container = QStringLiteral("id3v1");
+
+    auto field = [&](uint32_t bit, int off, int n) {
+        if (s.wants(bit)) s.text(bit, decodeId3String(0, p + off, n));
+    };
+    field(TagField::Title,  3, 30);
+    field(TagField::Artist, 33, 30);
+    field(TagField::Album,  63, 30);
+    field(TagField::Year,   93, 4);
+    field(TagField::Comment, 97, (p[125] == 0 && p[126] != 0) ? 28 : 30);
+    if (p[125] == 0 && p[126] != 0 && s.wants(TagField::TrackNumber))
+        s.text(TagField::TrackNumber, QString::number(p[126]));
+    if (s.wants(TagField::Genre))
+        s.text(TagField::Genre, TagParser::id3v1Genre(p[127]));
+}
+
+// ── Vorbis comments (FLAC, Ogg) ────────────────────────────────────
+
+void parseFlacPicture(const uchar* p, qint64 n, Sink& s);
+
+void parseVorbisComment(const uchar* p, qint64 n, Sink& s)
+{
+    struct Map { const char* key; uint32_t field; };
+    static const Map keys[] = {
+        { "TITLE", TagField::Title },        { "ARTIST", TagField::Artist },
+        { "ALBUM", TagField::Album },        { "ALBUMARTIST", TagField::AlbumArtist },
+        { "ALBUM ARTIST", TagField::AlbumArtist }, { "GENRE", TagField::Genre },
+        { "DATE", TagField::Year },          { "YEAR", TagField::Year },
+        { "TRACKNUMBER", TagField::TrackNumber }, { "DISCNUMBER", TagField::DiscNumber },
+        { "BPM", TagField::Bpm },            { "TEMPO", TagField::Bpm },
+        { "INITIALKEY", TagField::Key },     { "KEY", TagField::Key },
+        { "COMMENT", TagField::Comment },    { "DESCRIPTION", TagField::Comment },
+    };
+
+    if (n < 8) return;
+    qint64 pos = 4 + le32(p);                       // vendor string
+    if (pos + 4 > n) return;
+    const uint32_t count = le32(p + pos);
+    pos += 4;
+    for (uint32_t i = 0; i < count && pos + 4 <= n && !s.done(); ++i) {
+        const qint64 len = le32(p + pos);
+        pos += 4;
+        if (len > n - pos) return;
+        const uchar* c = p + pos;
+        pos += len;
+
+        const uchar* eq = static_cast<const uchar*>(std::memchr(c, '=', static_cast<size_t>(len)));
+        if (!eq) continue;
+        const qint64 keyLen = eq - c;
+        const uchar* value = eq + 1;
+        const qint64 valueLen = len - keyLen - 1;
+
+        if (keyEquals(c, keyLen, "METADATA_BLOCK_PICTURE")) {
+            if (s.wants(TagField::Picture)) {
+                const QByteArray block = QByteArray::fromBase64(
+                    QByteArray::fromRawData(reinterpret_cast<const char*>(value), static_cast<int>(valueLen)));
+                parseFlacPicture(reinterpret_cast<const uchar*>(block.constData()), block.size(), s);
+            }
+            continue;
+        }
+        for (const Map& m : keys) {
+            if (!keyEquals(c, keyLen, m.key)) continue;
+            if (s.wants(m.field))
+                s.text(m.field, QString::fromUtf8(reinterpret_cast<const char*>(value), static_cast<int>(valueLen)));
+            break;
+        }
+    }
+}
+
+// ── FLAC ───────────────────────────────────────────────────────────
+
+void parseFlacPicture(const uchar* p, qint64 n, Sink& s)
+{
+    // type, MIME, description, width/height/depth/colours, data
+    if (n < 32) return;
+    qint64 pos = 4;
+    pos += 4 + be32(p + pos);                       // MIME
+    if (pos + 4 > n) return;
+    pos += 4 + be32(p + pos);                       // description
+    pos += 16;
+    if (pos + 4 > n) return;
+    const qint64 len = be32(p + pos);
+    pos += 4;
+    if (len <= n - pos) s.picture(p + pos, len);
+}
+
+void parseFlac(FileView& f, qint64 off, Sink& s)
+{
+    s.out.container = QStringLiteral("flac");
+    off += 4;                                       // "fLaC"
+    for (;;) {
+        qint64 hl = 4;
+        const uchar* h = f.view(off, hl);
+        if (!h || hl < 4) return;
+        const bool last = h[0] & 0x80;
+        const int type = h[0] & 0x7F;
+        const qint64 len = be24(h + 1);
+        off += 4;
+
+        const bool needed = (type == 0 && s.wants(TagField::Length))
+                         || (type == 4 && (s.want & ~s.out.found & (TagField::Text)))
+                         || (type == 6 && s.wants(TagField::Picture));
+        if (needed) {
+            qint64 bl = len;
+            const uchar* b = f.view(off, bl);
+            if (b && bl == len) {
+                if (type == 0 && len >= 18) {
+                    const uint32_t rate = (uint32_t(b[10]) << 12) | (uint32_t(b[11]) << 4) | (b[12] >> 4);
+                    const uint64_t samples = (uint64_t(b[13] & 0x0F) << 32) | be32(b + 14);
+                    if (rate > 0) s.length(static_cast<qint64>(samples * 1000 / rate));
+                } else if (type == 4) {
+                    parseVorbisComment(b, len, s);
+                } else if (type == 6) {
+                    parseFlacPicture(b, len, s);
+                }
+            }
+        }
+        off += len;
+        if (last || s.done()) return;
+    }
+}
+
+// ── Ogg (Vorbis, Opus) ─────────────────────────────────────────────
+
+void parseOgg(FileView& f, Sink& s)
+{
+    constexpr qint64 kMaxPacket = 16LL << 20;
+
+    // Packets 0 (identification) and 1 (comments) of the first stream.
+    // A packet inside one page is used in place; one spanning pages is
+    // joined into `joined`.
+    int packet = 0;
+    uint32_t serial = 0;
+    uint32_t rate = 0;
+    qint64 preSkip = 0;
+    bool opus = false;
+    QByteArray joined;
+    bool spanning = false;
+
+    auto finishPacket = [&](const uchar* p, qint64 n) {
+        if (packet == 0) {
+            if (n >= 16 && tagIs(p, "\x01vorbis", 7)) {
+                rate = le32(p + 12);
+                s.out.container = QStringLiteral("vorbis");
+            } else if (n >= 12 && tagIs(p, "OpusHead", 8)) {
+                opus = true;
+                rate = 48000;
+                preSkip = le16(p + 10);
+                s.out.container = QStringLiteral("opus");
+            }
+        } else if (packet == 1) {
+            if (!opus && n > 7 && tagIs(p, "\x03vorbis", 7))
+                parseVorbisComment(p + 7, n - 7, s);
+            else if (opus && n > 8 && tagIs(p, "OpusTags", 8))
+                parseVorbisComment(p + 8, n - 8, s);
+        }
+        ++packet;
+    };
+
+    qint64 off = 0;
+    while (packet < 2) {
+        qint64 hl = 27;
+        const uchar* h = f.view(off, hl);
+        if (!h || hl < 27 || !tagIs(h, "OggS", 4)) return;
+        const uint32_t pageSerial = le32(h + 14);
+        if (off == 0) serial = pageSerial;
+        const int segs = h[26];
+        qint64 ll = segs;
+        const uchar* lacing = f.view(off + 27, ll);
+        if (!lacing || ll < segs) return;
+        qint64 bodyLen = 0;
+        for (int i = 0; i < segs; ++i) bodyLen += lacing[i];
+        qint64 bl = bodyLen;
+        const uchar* body = bodyLen ? f.view(off + 27 + segs, bl) : nullptr;
+        if (bodyLen && (!body || bl < bodyLen)) return;
+        off += 27 + segs + bodyLen;
+        if (pageSerial != serial) continue;
+
+        qint64 pos = 0, start = 0;
+        for (int i = 0; i < segs && packet < 2; ++i) {
+            pos += lacing[i];
+            if (lacing[i] == 255) continue;         // packet continues
+            const uchar* p = body + start;
+            const qint64 n = pos - start;
+            if (spanning) {
+                joined.append(reinterpret_cast<const char*>(p), static_cast<int>(n));
+                finishPacket(reinterpret_cast<const uchar*>(joined.constData()), joined.size());
+                joined.clear();
+                spanning = false;
+            } else {
+                finishPacket(p, n);
+            }
+            start = pos;
+        }
+        if (packet < 2 && start < pos) {            // continues on the next page
+            const qint64 n = pos - start;
+            if (joined.size() + n > kMaxPacket) return;
+            joined.append(reinterpret_cast<const char*>(body + start), static_cast<int>(n));
+            spanning = true;
+        }
+    }
+
+    // Duration: granule position of the stream's last page.
+    if (s.wants(TagField::Length) && rate > 0) {
+        qint64 tl = std::min<qint64>(f.size(), 64 * 1024);
+        const qint64 tailOff = f.size() - tl;
+        const uchar* tail = f.view(tailOff, tl);
+        for (qint64 i = tl - 27; tail && i >= 0; --i) {
+            if (tail[i] != 'O' || !tagIs(tail + i, "OggS", 4) || le32(tail + i + 14) != serial) continue;
+            const int64_t granule = static_cast<int64_t>(le64(tail + i + 6));
+            if (granule > preSkip)
+                s.length((granule - preSkip) * 1000 / rate);
+            break;
+        }
+    }
+}
+
+// ── MP4 / M4A ──────────────────────────────────────────────────────
+
+struct Atom { const uchar* body; qint64 len; const uchar* type; };
+
+// Children of [p, p+n) one by one; false at the end or on a bad size.
+bool nextAtom(const uchar* p, qint64 n, qint64& pos, Atom& a)
+{
+    if (pos + 8 > n) return false;
+    qint64 size = be32(p + pos);
+    qint64 hdr = 8;
+    if (size == 1) {
+        if (pos + 16 > n) return false;
+        size = static_cast<qint64>(be64(p + pos + 8));
+        hdr = 16;
+    } else if (size == 0) {
+        size = n - pos;
+    }
+    if (size < hdr || size > n - pos) return false;
+    a.type = p + pos + 4;
+    a.body = p + pos + hdr;
+    a.len  = size - hdr;
+    pos += size;
+    return true;
+}
+
+void mp4Item(const Atom& item, Sink& s)
+{
+    struct Map { const char* type; uint32_t field; };
+    static const Map items[] = {
+        { "\xA9nam", TagField::Title },  { "\xA9" "ART", TagField::Artist }, { "\xA9" "alb", TagField::Album },
+        { "aART", TagField::AlbumArtist }, { "\xA9gen", TagField::Genre },  { "gnre", TagField::Genre },
+        { "\xA9" "day", TagField::Year }, { "trkn", TagField::TrackNumber }, { "disk", TagField::DiscNumber },
+        { "tmpo", TagField::Bpm },       { "\xA9" "cmt", TagField::Comment }, { "covr", TagField::Picture },
+    };
+
+    uint32_t field = 0;
+    bool freeform = tagIs(item.type, "----", 4);
+    if (!freeform) {
+        for (const Map& m : items) if (tagIs(item.type, m.type, 4)) { field = m.field; break; }
+        if (!field || !s.wants(field)) return;
+    }
+
+    qint64 pos = 0;
+    Atom a;
+    while (nextAtom(item.body, item.len, pos, a)) {
+        if (freeform && tagIs(a.type, "name", 4) && a.len > 4) {
+            // com.apple.iTunes:initialkey
+            const uchar* name = a.body + 4;
+            const qint64 nl = a.len - 4;
+            if (keyEquals(name, nl, "initialkey") || keyEquals(name, nl, "KEY")) field = TagField::Key;
+            else if (keyEquals(name, nl, "BPM")) field = TagField::Bpm;
+            if (field && !s.wants(field)) return;
+            continue;
+        }
+        if (!tagIs(a.type, "data", 4) || a.len < 8 || !field) continue;
+        const uint32_t kind = be32(a.body) & 0xFFFFFF;
+        const uchar* v = a.body + 8;
+        const qint64 vn = a.len - 8;
+
+        if (field == TagField::Picture) {
+            s.picture(v, vn);
+        } else if (field == TagField::TrackNumber || field == TagField::DiscNumber) {
+            if (vn >= 6 && be16(v + 2) > 0) {
+                const uint32_t no = be16(v + 2), total = be16(v + 4);
+                s.text(field, total ? QStringLiteral("%1/%2").arg(no).arg(total) : QString::number(no));
+            }
+        } else if (tagIs(item.type, "gnre", 4)) {
+            if (vn >= 2) s.text(field, TagParser::id3v1Genre(static_cast<int>(be16(v)) - 1));
+        } else if (kind == 21 || tagIs(item.type, "tmpo", 4)) {
+            // big-endian integer of 1..8 bytes
+            qint64 value = 0;
+            for (qint64 i = 0; i < vn && i < 8; ++i) value = (value << 8) | v[i];
+            if (value > 0) s.text(field, QString::number(value));
+        } else {
+            s.text(field, QString::fromUtf8(reinterpret_cast<const char*>(v), static_cast<int>(vn)));
+        }
+        return;
+    }
+}
+
+void parseMp4(FileView& f, Sink& s)
+{
+    s.out.container = QStringLiteral("mp4");
+
+    // Top level: find moov from the atom headers alone (mdat is not read).
+    qint64 off = 0;
+    qint64 moovOff = -1, moovLen = 0;
+    while (off + 8 <= f.size()) {
+        qint64 hl = 16;
+        const uchar* h = f.view(off, hl);
+        if (!h || hl < 8) return;
+        qint64 size = be32(h);
+        qint64 hdr = 8;
+        if (size == 1 && hl >= 16) { size = static_cast<qint64>(be64(h + 8)); hdr = 16; }
+        else if (size == 0) size = f.size() - off;
+        if (size < hdr) return;
+        if (tagIs(h + 4, "moov", 4)) { moovOff = off + hdr; moovLen = size - hdr; break; }
+        off += size;
+    }
+    if (moovOff < 0) return;
+
+    qint64 ml = moovLen;
+    const uchar* moov = f.view(moovOff, ml);
+    if (!moov || ml < moovLen) return;
+
+    qint64 pos = 0;
+    Atom a;
+    while (nextAtom(moov, moovLen, pos, a) && !s.done()) {
+        if (tagIs(a.type, "mvhd", 4) && s.wants(TagField::Length)) {
+            // Version 1 has 64-bit times: timescale at 20, duration at 24..32.
+            const bool v1 = a.len > 0 && a.body[0] == 1;
+            if (a.len < (v1 ? 32 : 20)) continue;
+            const qint64 scale = be32(a.body + (v1 ? 20 : 12));
+            const qint64 dur = v1 ? static_cast<qint64>(be64(a.body + 24)) : be32(a.body + 16);
+            if (scale > 0) s.length(dur * 1000 / scale);
+            continue;
+        }
+        if (!tagIs(a.type, "udta", 4)) continue;
+        qint64 upos = 0;
+        Atom u;
+        while (nextAtom(a.body, a.len, upos, u)) {
+            if (!tagIs(u.type, "meta", 4) || u.len < 12) continue;
+            // Full box (version + flags) in iTunes files, plain in QuickTime.
+            const qint64 skip = tagIs(u.body + 4, "hdlr", 4) ? 0 : 4;
+            qint64 mpos = 0;
+            Atom m;
+            while (nextAtom(u.body + skip, u.len - skip, mpos, m)) {
+                if (!tagIs(m.type, "ilst", 4)) continue;
+                qint64 ipos = 0;
+                Atom item;
+                while (nextAtom(m.body, m.len, ipos, item) && !s.done()) mp4Item(item, s);
+            }
+        }
+    }
+}
+
+// ── RIFF / WAV ─────────────────────────────────────────────────────
+
+void parseRiff(FileView& f, Sink& s)
+{
+    s.out.container = QStringLiteral("riff");
+    struct Map { const char* id; uint32_t field; };
+    static const Map info[] = {
+        { "INAM", TagField::Title },  { "IART", TagField::Artist },  { "IPRD", TagField::Album },
+        { "IGNR", TagField::Genre },  { "ICRD", TagField::Year },    { "ICMT", TagField::Comment },
+        { "ITRK", TagField::TrackNumber }, { "IPRT", TagField::TrackNumber },
+    };
+
+    qint64 byteRate = 0, dataSize = 0;
+    qint64 off = 12;
+    while (off + 8 <= f.size()) {
+        qint64 hl = 8;
+        const uchar* h = f.view(off, hl);
+        if (!h || hl < 8) break;
+        const qint64 len = le32(h + 4);
+        const qint64 body = off + 8;
+        off = body + len + (len & 1);
+
+        if (tagIs(h, "data", 4)) { dataSize = len; continue; }   // never read
+        const bool fmt  = tagIs(h, "fmt ", 4);
+        const bool list = tagIs(h, "LIST", 4);
+        const bool id3  = tagIs(h, "id3 ", 4) || tagIs(h, "ID3 ", 4);
+        if (!fmt && !list && !id3) continue;
+
+        qint64 bl = len;
+        const uchar* b = f.view(body, bl);
+        if (!b || bl < len) break;
+        if (fmt && len >= 12) {
+            byteRate = le32(b + 8);
+        } else if (id3) {
+            parseId3v2(b, len, s);
+            s.out.container = QStringLiteral("riff");
+        } else if (list && len >= 4 && tagIs(b, "INFO", 4)) {
+            qint64 pos = 4;
+            while (pos + 8 <= len) {
+                const uchar* c = b + pos;
+                const qint64 cl = le32(c + 4);
+                if (cl > len - pos - 8) break;
+                for (const Map& m : info) {
+                    if (tagIs(c, m.id, 4) && s.wants(m.field)) {
+                        s.text(m.field, decodeId3String(3, c + 8, cl));
+                        break;
+                    }
+                }
+                pos += 8 + cl + (cl & 1);
+            }
+        }
+    }
+    if (byteRate > 0 && dataSize > 0) s.length(dataSize * 1000 / byteRate);
+}
+
+} // namespace
+
+// ── Public API ─────────────────────────────────────────────────────
+
+QString TagParser::id3v1Genre(int index)
+{
+    static const char* const kGenres[] = {
+        "Blues", "Classic Rock", "Country", "Dance", "Disco", "Funk", "Grunge", "Hip-Hop",
+        "Jazz", "Metal", "New Age", "Oldies", "Other", "Pop", "R&B", "Rap",
+        "Reggae", "Rock", "Techno", "Industrial", "Alternative", "Ska", "Death Metal", "Pranks",
+        "Soundtrack", "Euro-Techno", "Ambient", "Trip-Hop", "Vocal", "Jazz+Funk", "Fusion", "Trance",
+        "Classical", "Instrumental", "Acid", "House", "Game", "Sound Clip", "Gospel", "Noise",
+        "AlternRock", "Bass", "Soul", "Punk", "Space", "Meditative", "Instrumental Pop", "Instrumental Rock",
+        "Ethnic", "Gothic", "Darkwave", "Techno-Industrial", "Electronic", "Pop-Folk", "Eurodance", "Dream",
+        "Southern Rock", "Comedy", "Cult", "Gangsta", "Top 40", "Christian Rap", "Pop/Funk", "Jungle",
+        "Native American", "Cabaret", "New Wave", "Psychedelic", "Rave", "Showtunes", "Trailer", "Lo-Fi",
+        "Tribal", "Acid Punk", "Acid Jazz", "Polka", "Retro", "Musical", "Rock & Roll", "Hard Rock",
+    };
+    constexpr int kCount = static_cast<int>(sizeof(kGenres) / sizeof(kGenres[0]));
+    return (index >= 0 && index < kCount) ? QString::fromLatin1(kGenres[index]) : QString();
+}
+
+bool TagParser::parseFile(const QString& filePath, uint32_t fields, ParsedTags& out)
+{
+    FileView f(filePath);
+    if (f.size() < 12) return false;
+    Sink s{fields, out};
+
+    qint64 hl = 12;
+    const uchar* head = f.view(0, hl);
+    if (!head || hl < 12) return false;
+
+    if (tagIs(head, "ID3", 3)) {
+        // Map exactly the tag (header + body + optional footer).
+        qint64 tl = 10 + syncsafe32(head + 6) + 10;
+        const uchar* tag = f.view(0, tl);
+        const qint64 tagSize = tag ? parseId3v2(tag, tl, s) : 0;
+        qint64 ml = 4;
+        const uchar* after = f.view(tagSize, ml);
+        if (after && ml == 4 && tagIs(after, "fLaC", 4)) {
+            parseFlac(f, tagSize, s);
+        } else {
+            parseId3v1(f, s);
+            if (!s.out.container.startsWith(QLatin1String("id3v2"))) s.out.container = QStringLiteral("id3v2");
+        }
+    } else if (tagIs(head, "fLaC", 4)) {
+        parseFlac(f, 0, s);
+    } else if (tagIs(head, "OggS", 4)) {
+        parseOgg(f, s);
+    } else if (tagIs(head + 4, "ftyp", 4)) {
+        parseMp4(f, s);
+    } else if (tagIs(head, "RIFF", 4) && tagIs(head + 8, "WAVE", 4)) {
+        parseRiff(f, s);
+    } else {
+        parseId3v1(f, s);
+    }
+    return (out.found & fields) != 0;
+}
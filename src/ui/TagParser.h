@@ -0,0 +1,72 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+
+// ── Tag fields ─────────────────────────────────────────────────────
+//
+// Bit flags selecting what TagParser extracts.  Frames / comments /
+// atoms for fields not asked for are skipped without being decoded.
+
+namespace TagField {
+    enum : uint32_t {
+        Title       = 1u << 0,
+        Artist      = 1u << 1,
+        Album       = 1u << 2,
+        AlbumArtist = 1u << 3,
+        Genre       = 1u << 4,
+        Year        = 1u << 5,
+        TrackNumber = 1u << 6,
+        DiscNumber  = 1u << 7,
+        Bpm         = 1u << 8,
+        Key         = 1u << 9,
+        Comment     = 1u << 10,
+        Length      = 1u << 11,     // durationMs
+        Picture     = 1u << 12,     // cover image bytes
+        Text        = (1u << 11) - 1,
+        All         = (1u << 13) - 1
+    };
+}
+
+struct ParsedTags
+{
+    QString title;
+    QString artist;
+    QString album;
+    QString albumArtist;
+    QString genre;              // ID3v1 / numeric genre refs resolved to names
+    QString year;
+    QString trackNumber;
+    QString discNumber;
+    QString bpm;
+    QString musicalKey;
+    QString comments;
+    qint64  durationMs{0};
+    QByteArray picture;         // encoded image (JPEG/PNG), front cover preferred
+
+    uint32_t found{0};          // TagField bits filled
+    QString  container;         // "id3v2.3", "flac", "vorbis", "opus", "mp4", "riff", "id3v1"
+};
+
+// ── TagParser ──────────────────────────────────────────────────────
+//
+// The one tag reader behind the library scan (readTrackTags) and the
+// tag editor (TagReaderService).  Handles ID3v2.2–2.4 (including
+// unsynchronisation, extended headers and v2.4 per-frame flags) with an
+// ID3v1 fallback, FLAC metadata blocks, Ogg Vorbis / Opus comments,
+// MP4 / M4A ilst atoms and RIFF/WAV INFO + embedded ID3.
+//
+// Only the header regions are touched: each is memory-mapped (read()
+// fallback where mapping is unsupported) and parsed in place; bytes are
+// copied only to undo unsynchronisation, to join an Ogg packet that
+// spans pages, and into the returned strings.
+
+class TagParser
+{
+public:
+    // Returns true if any requested field was found.
+    static bool parseFile(const QString& filePath, uint32_t fields, ParsedTags& out);
+
+    // Name for an ID3v1 genre index, empty if out of range.
+    static QString id3v1Genre(int index);
+};
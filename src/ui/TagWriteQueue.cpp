@@ -0,0 +1,135 @@
+#include "TagWriteQueue.h"
+
+#include <QMetaObject>
+#include <QtDebug>
+
+#include <algorithm>
+
+// ─────────────────────────────────────────────────────────────────────────────
+TagWriteQueue::TagWriteQueue(SyncPolicy policy, QObject* parent)
+    : QObject(parent), policy_(policy)
+{
+    thread_ = std::thread([this]() { workerLoop(); });
+}
+
+TagWriteQueue::~TagWriteQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Requests (GUI thread)
+// ─────────────────────────────────────────────────────────────────────────────
+void TagWriteQueue::enqueue(const TrackTagData& data)
+{
+    if (data.sourceFilePath.isEmpty()) return;
+
+    Job job;
+    job.data = data;
+    job.data.albumArt = QPixmap();      // QPixmap stays on this thread
+    if (data.hasAlbumArt) job.art = data.albumArt.toImage();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(jobs_.begin(), jobs_.end(), [&](const Job& j) {
+            return j.data.sourceFilePath == data.sourceFilePath;
+        });
+        if (it != jobs_.end()) {
+            *it = std::move(job);       // last edit wins, same slot
+            return;
+        }
+        if (batch_.queued == 0) batchTimer_.start();
+        ++batch_.queued;
+        jobs_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+void TagWriteQueue::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch_.queued -= static_cast<int>(jobs_.size());
+    jobs_.clear();
+}
+
+bool TagWriteQueue::isIdle() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.empty() && !busy_;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Worker thread
+// ─────────────────────────────────────────────────────────────────────────────
+void TagWriteQueue::workerLoop()
+{
+    std::vector<QString> unsynced;      // EndOfBatch: written, not yet on disk
+
+    auto syncAll = [&unsynced]() {
+        for (const QString& path : unsynced) {
+            if (!TagWriterService::syncToDisk(path))
+                qWarning() << "[TAG_WRITE] SYNC_FAIL" << path;
+        }
+        unsynced.clear();
+    };
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) break;   // stopping, queue drained
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+        }
+
+        const QString path = job.data.sourceFilePath;
+        const TagWriterService::WriteMode mode =
+            TagWriterService::writeTags(job.data, job.art, policy_ == SyncPolicy::EachFile);
+        if (mode != TagWriterService::WriteMode::Failed && policy_ == SyncPolicy::EndOfBatch)
+            unsynced.push_back(path);
+
+        Progress p;
+        bool drained = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++batch_.done;
+            if (mode == TagWriterService::WriteMode::Failed)    ++batch_.failed;
+            if (mode == TagWriterService::WriteMode::InPlace)   ++batch_.inPlace;
+            if (mode == TagWriterService::WriteMode::Rewritten) ++batch_.rewritten;
+            batch_.elapsedSeconds = static_cast<double>(batchTimer_.elapsed()) / 1000.0;
+            p = batch_;
+            drained = jobs_.empty();
+        }
+        QMetaObject::invokeMethod(this, [this, path, mode, p]() {
+            emit fileWritten(path, mode);
+            emit progress(p);
+        }, Qt::QueuedConnection);
+
+        if (!drained) continue;
+
+        syncAll();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!jobs_.empty()) continue;   // more arrived while syncing: same batch
+            batch_.elapsedSeconds = static_cast<double>(batchTimer_.elapsed()) / 1000.0;
+            p = batch_;
+            batch_ = Progress{};
+            busy_ = false;
+        }
+        qInfo().noquote() << QStringLiteral("[TAG_WRITE] batch files=%1 failed=%2 in_place=%3 rewritten=%4 seconds=%5")
+                                 .arg(p.done).arg(p.failed).arg(p.inPlace).arg(p.rewritten)
+                                 .arg(p.elapsedSeconds, 0, 'f', 2);
+        QMetaObject::invokeMethod(this, [this, p]() {
+            emit batchFinished(p);
+        }, Qt::QueuedConnection);
+    }
+
+    syncAll();
+}
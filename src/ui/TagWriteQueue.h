@@ -0,0 +1,83 @@
+#pragma once
+#include "TagWriterService.h"
+#include "TrackTagData.h"
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QString>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TagWriteQueue
+//
+// Writes tags for multi-file edits on a background thread, one file at a time
+// through TagWriterService.  A batch is everything enqueued until the queue
+// runs dry; progress() reports after each file and batchFinished() once the
+// batch is done.  Enqueueing a file that is still waiting replaces its
+// pending write, so repeated edits to one track cost a single write.
+//
+// Sync policy decides when written data is forced to disk:
+//   EachFile    — before moving on to the next file (slowest, nothing at risk)
+//   EndOfBatch  — once for every written file when the batch ends
+//   None        — left to the OS
+// Rewritten files are replaced atomically under every policy.
+// ─────────────────────────────────────────────────────────────────────────────
+class TagWriteQueue : public QObject
+{
+    Q_OBJECT
+public:
+    enum class SyncPolicy : uint8_t { EachFile, EndOfBatch, None };
+
+    struct Progress {
+        int    queued{0};       // files in this batch so far
+        int    done{0};         // written or failed
+        int    failed{0};
+        int    inPlace{0};
+        int    rewritten{0};
+        double elapsedSeconds{0.0};
+    };
+
+    explicit TagWriteQueue(SyncPolicy policy = SyncPolicy::EndOfBatch,
+                           QObject* parent = nullptr);
+    ~TagWriteQueue() override;
+
+    // GUI thread (album art is converted here, off the worker).
+    void enqueue(const TrackTagData& data);
+
+    // Drops writes not yet started; the file being written finishes.
+    // Destroying the queue instead finishes every queued write first.
+    void cancel();
+
+    bool isIdle() const;
+
+signals:
+    void fileWritten(const QString& path, TagWriterService::WriteMode mode);
+    void progress(const TagWriteQueue::Progress& p);
+    void batchFinished(const TagWriteQueue::Progress& p);
+
+private:
+    struct Job {
+        TrackTagData data;      // albumArt cleared; see art
+        QImage       art;
+    };
+
+    void workerLoop();
+
+    const SyncPolicy policy_;
+
+    mutable std::mutex      mutex_;
+    std::condition_variable wake_;
+    bool                    stop_{false};
+    bool                    busy_{false};
+    std::deque<Job>         jobs_;
+    Progress                batch_;
+    QElapsedTimer           batchTimer_;
+
+    std::thread             thread_;
+};
@@ -2,9 +2,19 @@
 #include <QFile>
 #include <QBuffer>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QImage>
+#include <QSaveFile>
+#include <QtDebug>
+#include <algorithm>
 #include <cstring>
 
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 // ── ID3v2 frame/tag building helpers ───────────────────────────────
 
 // Syncsafe-encode a 28-bit value into 4 bytes
@@ -82,14 +92,14 @@ static QByteArray buildCommentFrame(const QString& text)
 }
 
 // Build APIC frame (album art as front cover JPEG)
-static QByteArray buildApicFrame(const QPixmap& art)
+static QByteArray buildApicFrame(const QImage& art)
 {
     if (art.isNull()) return {};
 
     QByteArray jpegData;
     QBuffer buf(&jpegData);
     buf.open(QIODevice::WriteOnly);
-    art.toImage().save(&buf, "JPEG", 90);
+    art.save(&buf, "JPEG", 90);
     buf.close();
 
     if (jpegData.isEmpty()) return {};
@@ -149,32 +159,89 @@ static QByteArray collectPassthroughFrames(const QByteArray& tag, int ver)
     return result;
 }
 
+// ── Layout and durability ──────────────────────────────────────────
+
+// Padding given to a tag that has to grow: 4 KiB or an eighth of the frames
+// (room for a somewhat larger cover), rounded up so the audio starts on a
+// 4 KiB boundary.  Later edits then fit in place.
+static int paddingFor(int framesSize)
+{
+    constexpr int kMinPadding = 4096;
+    constexpr int kAlign      = 4096;
+    int padding = std::max(kMinPadding, framesSize / 8);
+    const int total = 10 + framesSize + padding;
+    padding += (kAlign - total % kAlign) % kAlign;
+    return padding;
+}
+
+static QByteArray buildHeader(quint32 bodySize)
+{
+    QByteArray header(10, '\0');
+    header[0] = 'I'; header[1] = 'D'; header[2] = '3';
+    header[3] = char(3); // version 2.3
+    header[4] = char(0); // revision
+    header[5] = char(0); // flags
+    const QByteArray szEnc = syncsafeEncode(bodySize);
+    header[6] = szEnc[0]; header[7] = szEnc[1];
+    header[8] = szEnc[2]; header[9] = szEnc[3];
+    return header;
+}
+
+static bool syncHandle(QFileDevice& f)
+{
+    if (!f.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(f.handle()) == 0;
+#else
+    return ::fsync(f.handle()) == 0;
+#endif
+}
+
 // ── Public API ─────────────────────────────────────────────────────
 
 bool TagWriterService::saveTagsToFile(const TrackTagData& data)
 {
-    if (data.sourceFilePath.isEmpty()) return false;
+    const QImage art = data.hasAlbumArt ? data.albumArt.toImage() : QImage();
+    return writeTags(data, art, true) != WriteMode::Failed;
+}
+
+bool TagWriterService::syncToDisk(const QString& path)
+{
+    // Windows flushes only through a handle with write access.
+    QFile f(path);
+    if (!f.open(QIODevice::ReadWrite)) return false;
+    return syncHandle(f);
+}
+
+TagWriterService::WriteMode TagWriterService::writeTags(const TrackTagData& data,
+                                                        const QImage& art, bool sync)
+{
+    if (data.sourceFilePath.isEmpty()) return WriteMode::Failed;
     if (!data.sourceFilePath.endsWith(QStringLiteral(".mp3"), Qt::CaseInsensitive))
-        return false;
+        return WriteMode::Failed;
 
-    // 1. Read entire original file
-    QFile srcFile(data.sourceFilePath);
-    if (!srcFile.open(QIODevice::ReadOnly))
-        return false;
-    const QByteArray original = srcFile.readAll();
-    srcFile.close();
+    QElapsedTimer timer;
+    timer.start();
 
-    if (original.isEmpty()) return false;
+    // 1. Read just the existing tag
+    QFile file(data.sourceFilePath);
+    if (!file.open(QIODevice::ReadWrite))
+        return WriteMode::Failed;
+    const qint64 fileSize = file.size();
+    if (fileSize <= 0) return WriteMode::Failed;
 
-    // 2. Locate audio data start (skip existing ID3v2 tag)
-    int audioStart = 0;
+    // 2. Locate audio data start (skip existing ID3v2 tag and its footer)
+    qint64 audioStart = 0;
     int originalVer = 3;
     QByteArray originalTagBody;
-    if (original.size() >= 10 && original[0] == 'I' && original[1] == 'D' && original[2] == '3') {
-        originalVer = static_cast<unsigned char>(original[3]);
-        const quint32 tagSz = syncsafeDecode(original, 6);
-        audioStart = 10 + static_cast<int>(tagSz);
-        originalTagBody = original.mid(10, static_cast<int>(tagSz));
+    const QByteArray head = file.read(10);
+    if (head.size() == 10 && head[0] == 'I' && head[1] == 'D' && head[2] == '3') {
+        originalVer = static_cast<unsigned char>(head[3]);
+        const bool footer = originalVer >= 4 && (static_cast<unsigned char>(head[5]) & 0x10);
+        const quint32 tagSz = syncsafeDecode(head, 6);
+        audioStart = 10 + static_cast<qint64>(tagSz) + (footer ? 10 : 0);
+        if (audioStart > fileSize) return WriteMode::Failed;
+        originalTagBody = file.read(tagSz);
     }
 
     // 3. Build new frames from TrackTagData
@@ -190,48 +257,62 @@ bool TagWriterService::saveTagsToFile(const TrackTagData& data)
     newFrames.append(buildTextFrame("TBPM", data.bpm));
     newFrames.append(buildTextFrame("TKEY", data.musicalKey));
     newFrames.append(buildCommentFrame(data.comments));
-    if (data.hasAlbumArt && !data.albumArt.isNull())
-        newFrames.append(buildApicFrame(data.albumArt));
+    if (data.hasAlbumArt && !art.isNull())
+        newFrames.append(buildApicFrame(art));
 
     // 4. Preserve unknown frames from original tag
     newFrames.append(collectPassthroughFrames(originalTagBody, originalVer));
 
-    // 5. Add 1024 bytes padding
-    const int padding = 1024;
-    const quint32 totalTagBody = static_cast<quint32>(newFrames.size()) + padding;
-
-    // 6. Build ID3v2.3 header
-    QByteArray header(10, '\0');
-    header[0] = 'I'; header[1] = 'D'; header[2] = '3';
-    header[3] = char(3); // version 2.3
-    header[4] = char(0); // revision
-    header[5] = char(0); // flags
-    const QByteArray szEnc = syncsafeEncode(totalTagBody);
-    header[6] = szEnc[0]; header[7] = szEnc[1];
-    header[8] = szEnc[2]; header[9] = szEnc[3];
-
-    // 7. Write to temp file then replace
-    const QString tmpPath = data.sourceFilePath + QStringLiteral(".ngks_tmp");
-    {
-        QFile tmp(tmpPath);
-        if (!tmp.open(QIODevice::WriteOnly))
-            return false;
-        tmp.write(header);
-        tmp.write(newFrames);
-        tmp.write(QByteArray(padding, '\0'));
-        if (audioStart < original.size())
-            tmp.write(original.mid(audioStart));
-        tmp.close();
+    // 5a. Fits in the old tag's space: overwrite it, padding takes the rest
+    const qint64 room = audioStart - 10;
+    if (audioStart > 0 && newFrames.size() <= room) {
+        QByteArray block = buildHeader(static_cast<quint32>(room));
+        block.append(newFrames);
+        block.append(QByteArray(static_cast<int>(room - newFrames.size()), '\0'));
+        if (!file.seek(0) || file.write(block) != block.size())
+            return WriteMode::Failed;
+        if (sync ? !syncHandle(file) : !file.flush())
+            return WriteMode::Failed;
+        qDebug() << "[TAG_WRITE] IN_PLACE" << data.sourceFilePath
+                 << "tag=" << block.size() << "padding=" << (room - newFrames.size())
+                 << "ms=" << timer.elapsed();
+        return WriteMode::InPlace;
     }
 
-    // 8. Replace original: remove original, rename temp
-    if (!QFile::remove(data.sourceFilePath)) {
-        QFile::remove(tmpPath);
-        return false;
+    // 5b. Grow: stream the audio behind a new tag into a replacement file
+    const int padding = paddingFor(static_cast<int>(newFrames.size()));
+    QSaveFile out(data.sourceFilePath);
+    if (!out.open(QIODevice::WriteOnly))
+        return WriteMode::Failed;
+    out.write(buildHeader(static_cast<quint32>(newFrames.size() + padding)));
+    out.write(newFrames);
+    out.write(QByteArray(padding, '\0'));
+
+    constexpr qint64 kChunk = 1 << 20;
+    QByteArray chunk(static_cast<int>(kChunk), Qt::Uninitialized);
+    if (!file.seek(audioStart)) {
+        out.cancelWriting();
+        return WriteMode::Failed;
+    }
+    for (qint64 left = fileSize - audioStart; left > 0;) {
+        const qint64 n = file.read(chunk.data(), std::min(left, kChunk));
+        if (n <= 0 || out.write(chunk.constData(), n) != n) {
+            out.cancelWriting();
+            return WriteMode::Failed;
+        }
+        left -= n;
     }
-    if (!QFile::rename(tmpPath, data.sourceFilePath)) {
-        return false;
+    file.close();   // the original is replaced on commit
+
+    if (sync && !syncHandle(out)) {
+        out.cancelWriting();
+        return WriteMode::Failed;
     }
+    if (!out.commit())
+        return WriteMode::Failed;
 
-    return true;
+    qDebug() << "[TAG_WRITE] REWRITE" << data.sourceFilePath
+             << "tag=" << (10 + newFrames.size() + padding) << "padding=" << padding
+             << "audio=" << (fileSize - audioStart) << "ms=" << timer.elapsed();
+    return WriteMode::Rewritten;
 }
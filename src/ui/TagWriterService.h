@@ -1,8 +1,27 @@
 #pragma once
 #include "TrackTagData.h"
+#include <QImage>
+#include <cstdint>
 
+// Writes ID3v2.3 tags into MP3 files.
+//
+// When the new tag fits in the space of the existing one (frames plus
+// padding) it is written over it in place: one write at the start of the
+// file, the audio is never touched.  Otherwise the file is streamed into a
+// replacement (QSaveFile) with padding to spare, so the next edits fit.
 class TagWriterService
 {
 public:
+    enum class WriteMode : uint8_t { Failed, InPlace, Rewritten };
+
+    // Synchronous, flushed to disk before it returns.  GUI thread.
     static bool saveTagsToFile(const TrackTagData& data);
+
+    // `art` stands in for data.albumArt (used when data.hasAlbumArt) so this
+    // can run off the GUI thread, where QPixmap may not be used.  With
+    // sync = false the data is left to the OS; see syncToDisk().
+    static WriteMode writeTags(const TrackTagData& data, const QImage& art, bool sync);
+
+    // Flushes an earlier unsynced write of `path` to disk.
+    static bool syncToDisk(const QString& path);
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include <QString>
+#include <QByteArray>
 #include <QPixmap>
 #include <QHash>
 #include "FieldOwnership.h"
@@ -43,6 +44,7 @@ struct TrackTagData
     double  liveness{-1.0};
     QString camelotKey;
     double  transitionDifficulty{-1.0};
+    QByteArray beatGrid;            // BeatGrid::encode() blob, empty if none
 
     // BPM resolver results
     double  rawBpm{0.0};
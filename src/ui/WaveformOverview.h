@@ -7,13 +7,17 @@
 #include <QLinearGradient>
 #include <QWheelEvent>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QImage>
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <memory>
 #include <thread>
 #include <vector>
 
 #include "WaveformState.h"
+#include "WaveformTileCache.h"
 #include "engine/runtime/graph/DeckNode.h"
 
 #ifndef NGKS_ENABLE_STEM_OVERLAY
@@ -104,6 +108,16 @@ public:
         update();
     }
 
+    // Multi-resolution source for the zoomed views (CUE_FOCUS / LIVE_SCROLL):
+    // the visible range is read at one bucket per pixel instead of
+    // stretching the whole-track bins.
+    void setWaveformPyramid(std::shared_ptr<const ngks::WaveformPyramid> pyramid)
+    {
+        pyramid_ = std::move(pyramid);
+        tiles_.clear();
+        update();
+    }
+
     void setPlayheadFraction(float frac)
     {
         frac = std::clamp(frac, 0.0f, 1.0f);
@@ -165,6 +179,9 @@ public:
         }
         bins_.clear();
         bandBins_.clear();
+        pyramid_.reset();
+        tiles_.clear();
+        miniStrip_ = QImage();
         hasData_ = false;
         hasBandData_ = false;
         waveformDataFrozen_ = false;
@@ -232,6 +249,19 @@ public:
     }
     int debugBandSolo() const { return debugBandSolo_; }
 
+    /// Paint cost for the diagnostics dialog; the max restarts on each call.
+    WaveformPaintStats takePaintStats()
+    {
+        WaveformPaintStats stats;
+        stats.lastMs = paintLastMs_;
+        stats.avgMs = paintAvgMs_;
+        stats.maxMs = paintMaxMs_;
+        stats.cachedTiles = tiles_.cachedTiles();
+        stats.tileMisses = tileMisses_;
+        paintMaxMs_ = 0.0;
+        return stats;
+    }
+
 protected:
     void wheelEvent(QWheelEvent* event) override
     {
@@ -250,14 +280,8 @@ protected:
 
     void paintEvent(QPaintEvent*) override
     {
-        static int paintLogTicker[2] = {0,0};
-        int dIdx = deckIndex_ & 1;
-        bool doLog = (paintLogTicker[dIdx]++ % 30 == 0);
-
-        if (doLog) {
-            std::fprintf(stderr, "WF_WIDGET_STATE deck=%c state=%d\n", (deckIndex_==0?'A':'B'), (int)viewState_);
-            std::fprintf(stderr, "WF_WIDGET_PATH deck=%c path='...'\n", (deckIndex_==0?'A':'B'));
-        }
+        QElapsedTimer paintTimer;
+        paintTimer.start();
 
         QPainter p(this);
         p.setRenderHint(QPainter::Antialiasing, false);
@@ -281,10 +305,6 @@ protected:
         }
 
         if (!hasData_ || bins_.empty()) {
-            if (doLog) {
-                std::fprintf(stderr, "WF_PAINT_EMPTY deck=%c reason='No data or empty bins'\n", (deckIndex_==0?'A':'B'));
-                std::fflush(stderr);
-            }
             QFont f = font();
             f.setPointSizeF(6.5);
             f.setBold(true);
@@ -293,12 +313,24 @@ protected:
             QColor tc = accent_; tc.setAlpha(30);
             p.setPen(tc);
             p.drawText(QRect(0, 0, w, mainH), Qt::AlignCenter, QStringLiteral("NO WAVEFORM"));
+            recordPaintTime(paintTimer);
             return;
         }
 
-        if (doLog) {
-            std::fprintf(stderr, "WF_PAINT_WAVE deck=%c bins=%zu\n", (deckIndex_==0?'A':'B'), bins_.size());
-            std::fflush(stderr);
+        const int usableW = w - 2;
+
+        // Zoomed views with a pyramid are drawn from pre-rendered tiles at a
+        // snapped frames-per-pixel; the visible span follows from that.
+        float zoomSpan = std::min(1.0f, liveWindowSec_ / trackDuration_);
+        double tileFpp = 0.0;
+        if (isZoomed && pyramid_ && pyramid_->totalFrames() > 0 && usableW > 0) {
+            const double total = static_cast<double>(pyramid_->totalFrames());
+            const double fpp = WaveformTileCache::snapFramesPerPixel(
+                static_cast<double>(liveWindowSec_) * pyramid_->sampleRate() / usableW);
+            if (fpp * usableW < total) {
+                tileFpp = fpp;
+                zoomSpan = static_cast<float>(fpp * usableW / total);
+            }
         }
 
         float viewStart = 0.0f;
@@ -311,7 +343,6 @@ protected:
             viewEnd   = 1.0f;
             break;
         case WaveViewState::CUE_FOCUS: {
-            const float zoomSpan = std::min(1.0f, liveWindowSec_ / trackDuration_);
             const float center = cueFocusTarget_;
             viewStart = center - zoomSpan * 0.5f;
             viewEnd   = center + zoomSpan * 0.5f;
@@ -326,7 +357,6 @@ protected:
             viewEnd   = 1.0f;
             break;
         case WaveViewState::LIVE_SCROLL: {
-            const float zoomSpan = std::min(1.0f, liveWindowSec_ / trackDuration_);
             constexpr float phScreenFrac = 0.30f;
             const float center = smoothAnchor_ + zoomSpan * (0.5f - phScreenFrac);
             viewStart = center - zoomSpan * 0.5f;
@@ -344,7 +374,7 @@ protected:
         }
 
         const float viewSpan = viewEnd - viewStart;
-        if (viewSpan < 0.001f) return;
+        if (viewSpan < 0.001f) { recordPaintTime(paintTimer); return; }
 
         {
             const int gridCount = isZoomed ? 8 : 12;
@@ -363,13 +393,23 @@ protected:
 
         const int numBins = static_cast<int>(bins_.size());
         const float invRef = 1.0f / peakRef_;
-        const int usableW = w - 2;
-        const int maxBarH = static_cast<int>((cy - 1) * 0.92f);
 
         const bool isLive = (viewState_ == WaveViewState::LIVE_SCROLL);
         const QColor waveBase = isLive ? QColor(0, 235, 170) : QColor(70, 165, 255);
-        QColor playedColor(waveBase.red(), waveBase.green(), waveBase.blue(), 160);
-        QColor aheadColor (waveBase.red(), waveBase.green(), waveBase.blue(), 220);
+
+        WaveformColumnStyle colStyle;
+        colStyle.cy = cy;
+        colStyle.maxBarH = static_cast<int>((cy - 1) * 0.92f);
+        colStyle.invRef = invRef;
+        colStyle.playedColor = QColor(waveBase.red(), waveBase.green(), waveBase.blue(), 160);
+        colStyle.aheadColor  = QColor(waveBase.red(), waveBase.green(), waveBase.blue(), 220);
+        colStyle.showBands = showBands;
+        colStyle.live = isLive;
+        colStyle.bandInvRef = 1.0f / bandPeakRef_;
+        colStyle.bandMaxBass = bandMaxBass_;
+        colStyle.bandMaxMids = bandMaxMids_;
+        colStyle.bandMaxHigh = bandMaxHigh_;
+        colStyle.debugBandSolo = debugBandSolo_;
 
         const float playheadInView = (playhead_ - viewStart) / viewSpan;
         const int playheadX = 1 + static_cast<int>(std::clamp(playheadInView, 0.0f, 1.0f) * usableW);
@@ -377,140 +417,110 @@ protected:
 
         p.setPen(Qt::NoPen);
 
-        const int binStart = std::max(0, static_cast<int>(viewStart * numBins));
-        const int binEnd   = std::min(numBins, static_cast<int>(std::ceil(viewEnd * numBins)));
-        const int visBins  = binEnd - binStart;
-        if (visBins <= 0) return;
-
-        constexpr float kBarWidthPx = 1.0f;
-        constexpr float kBarGapPx   = 0.35f;
-        constexpr float kStridePx   = kBarWidthPx + kBarGapPx;
-
-        const bool packed = (visBins > usableW);
-        const float stridePx = packed ? 1.0f : kStridePx;
-        const int barW = 1;
-
-        for (float fx = 0.0f; fx < static_cast<float>(usableW); fx += stridePx) {
-            const int px = static_cast<int>(fx);
-            const float frac = viewStart + (static_cast<float>(px) / usableW) * viewSpan;
-            int b = static_cast<int>(frac * numBins);
-            b = std::clamp(b, 0, numBins - 1);
-
-            const int x = 1 + px;
-            const auto& bin = bins_[static_cast<size_t>(b)];
-
-            float rmsNorm = std::min(1.0f, bin.rms * invRef);
-            if (b > 0 && b < numBins - 1) {
-                const float prev = std::min(1.0f, bins_[static_cast<size_t>(b - 1)].rms * invRef);
-                const float next = std::min(1.0f, bins_[static_cast<size_t>(b + 1)].rms * invRef);
-                rmsNorm = rmsNorm * 0.92f + (prev + next) * 0.5f * 0.08f;
+        if (showBands) {
+            p.setBrush(QColor(0x04, 0x06, 0x09));
+            p.drawRect(1, mainH, usableW, bandStripH);
+        }
+
+        if (tileFpp > 0.0) {
+            // ── Tiled: blit the tiles under the view, dim the played part ──
+            WaveformTileCache::Style tileStyle;
+            tileStyle.pyramid = pyramid_;
+            tileStyle.framesPerPixel = tileFpp;
+            tileStyle.mainH = mainH;
+            tileStyle.bandStripH = bandStripH;
+            tileStyle.columns = colStyle;
+            tiles_.setStyle(tileStyle);
+
+            constexpr int kTileW = WaveformTileCache::kTileWidth;
+            const int64_t originPx = static_cast<int64_t>(std::llround(
+                static_cast<double>(viewStart) * pyramid_->totalFrames() / tileFpp));
+            const int64_t firstTile = originPx / kTileW;
+            const int64_t lastTile  = (originPx + usableW - 1) / kTileW;
+
+            p.save();
+            p.setClipRect(1, 0, usableW, mainH + bandStripH);
+            for (int64_t t = firstTile; t <= lastTile; ++t) {
+                const QImage img = tiles_.tile(t);
+                if (img.isNull()) { ++tileMisses_; continue; }
+                p.drawImage(1 + static_cast<int>(t * kTileW - originPx), 0, img);
             }
-            rmsNorm = std::pow(rmsNorm, 0.92f);
-            const int rmsH = std::max(1, static_cast<int>(rmsNorm * maxBarH));
-
-            const bool played = (x < playheadX);
-            QColor barColor = played ? playedColor : aheadColor;
-
-            if (showBands && hasBandData_) {
-                const int bandNumBins = static_cast<int>(bandBins_.size());
-                const int bi = std::clamp(static_cast<int>(frac * bandNumBins), 0, bandNumBins - 1);
-                const auto& band = bandBins_[static_cast<size_t>(bi)];
-
-                const float eBass = band.low;
-                const float eMids = band.lowMid + band.highMid;
-                const float eHigh = band.high;
-
-                float nB = std::sqrt(eBass / bandMaxBass_);
-                float nM = std::sqrt(eMids / bandMaxMids_);
-                float nH = std::sqrt(eHigh / bandMaxHigh_);
-                if (nB < 0.08f) nB = 0.0f;
-                if (nM < 0.08f) nM = 0.0f;
-                if (nH < 0.08f) nH = 0.0f;
-
-                float vB = nB * 0.60f, vM = nM * 1.00f, vH = nH * 1.35f;
-
-                if (debugBandSolo_ == 1) { vM = 0; vH = 0; }
-                else if (debugBandSolo_ == 2) { vB = 0; vH = 0; }
-                else if (debugBandSolo_ == 3) { vB = 0; vM = 0; }
-
-                float b1 = vB, b2 = vM;
-                int dom = 0;
-                if (vM > b1) { b2 = b1; b1 = vM; dom = 1; }
-                if (vH > b1) { b2 = b1; b1 = vH; dom = 2; }
-                else if (vH > b2) { b2 = vH; }
-
-                if (b1 > 0.001f) {
-                    static const int kPalR[] = { 255,  80,   0 };
-                    static const int kPalG[] = {  80, 220, 210 };
-                    static const int kPalB[] = {  50,  90, 255 };
-
-                    const float ratio = b1 / (b2 + 0.001f);
-
-                    int colR, colG, colB;
-                    if (ratio >= 1.65f) {
-                        colR = kPalR[dom]; colG = kPalG[dom]; colB = kPalB[dom];
-                    } else {
-                        int sec = 0;
-                        if (dom == 0) sec = (vM >= vH) ? 1 : 2;
-                        else if (dom == 1) sec = (vB >= vH) ? 0 : 2;
-                        else sec = (vB >= vM) ? 0 : 1;
-                        colR = static_cast<int>(kPalR[dom] * 0.7f + kPalR[sec] * 0.3f);
-                        colG = static_cast<int>(kPalG[dom] * 0.7f + kPalG[sec] * 0.3f);
-                        colB = static_cast<int>(kPalB[dom] * 0.7f + kPalB[sec] * 0.3f);
-                    }
-
-                    const float colorStrength = 0.65f + 0.10f * rmsNorm;
-                    const float satBoost = isLive ? 1.25f : 1.18f;
-
-                    const float avg = (colR + colG + colB) / 3.0f;
-                    colR = std::clamp(static_cast<int>(avg + (colR - avg) * satBoost), 0, 255);
-                    colG = std::clamp(static_cast<int>(avg + (colG - avg) * satBoost), 0, 255);
-                    colB = std::clamp(static_cast<int>(avg + (colB - avg) * satBoost), 0, 255);
-
-                    const float keep = 1.0f - colorStrength;
-                    barColor = QColor(
-                        std::clamp(static_cast<int>(barColor.red()   * keep + colR * colorStrength), 0, 255),
-                        std::clamp(static_cast<int>(barColor.green() * keep + colG * colorStrength), 0, 255),
-                        std::clamp(static_cast<int>(barColor.blue()  * keep + colB * colorStrength), 0, 255),
-                        barColor.alpha());
-                }
+            p.restore();
+
+            // Playback moves right: keep the next tiles warm.
+            tiles_.prefetch(lastTile + 1, lastTile + 2);
+            if (!isLive) tiles_.prefetch(firstTile - 1, firstTile - 1);
+
+            if (playheadVisible && playheadX > 1) {
+                p.setBrush(QColor(bgColor_.red(), bgColor_.green(), bgColor_.blue(), 80));
+                p.drawRect(1, 0, playheadX - 1, mainH + bandStripH);
             }
+        } else {
+            // ── Direct: one column per pixel from the whole-track bins, or
+            //    from a pyramid query when the track fits the window ──
+            const bool fromPyramid = isZoomed && pyramid_ && pyramid_->totalFrames() > 0;
+            if (fromPyramid) {
+                const double total = static_cast<double>(pyramid_->totalFrames());
+                pyramid_->query(static_cast<int64_t>(viewStart * total),
+                                static_cast<int64_t>(viewEnd * total),
+                                std::max(1, usableW), &zoomBins_, showBands ? &zoomBands_ : nullptr);
+            }
+            const std::vector<ngks::WaveMinMax>& wave  = fromPyramid ? zoomBins_ : bins_;
+            const std::vector<ngks::BandEnergy>& bands = (fromPyramid && showBands) ? zoomBands_ : bandBins_;
+            const float srcStart = fromPyramid ? viewStart : 0.0f;
+            const float srcSpan  = fromPyramid ? viewSpan  : 1.0f;
+            const int srcBins = static_cast<int>(wave.size());
+            const int bandNumBins = static_cast<int>(bands.size());
+
+            const int binStart = std::max(0, static_cast<int>((viewStart - srcStart) / srcSpan * srcBins));
+            const int binEnd   = std::min(srcBins,
+                                          static_cast<int>(std::ceil((viewEnd - srcStart) / srcSpan * srcBins)));
+            const int visBins  = binEnd - binStart;
+
+            constexpr float kBarWidthPx = 1.0f;
+            constexpr float kBarGapPx   = 0.35f;
+            constexpr float kStridePx   = kBarWidthPx + kBarGapPx;
+
+            const bool packed = (visBins > usableW);
+            const float stridePx = packed ? 1.0f : kStridePx;
+
+            for (float fx = 0.0f; visBins > 0 && fx < static_cast<float>(usableW); fx += stridePx) {
+                const int px = static_cast<int>(fx);
+                const float frac = viewStart + (static_cast<float>(px) / usableW) * viewSpan;
+                const int b = std::clamp(static_cast<int>((frac - srcStart) / srcSpan * srcBins),
+                                         0, srcBins - 1);
+                const bool inner = (b > 0 && b < srcBins - 1);
+
+                const ngks::BandEnergy* band = nullptr;
+                if (showBands && bandNumBins > 0) {
+                    const int bi = std::clamp(static_cast<int>((frac - srcStart) / srcSpan * bandNumBins),
+                                              0, bandNumBins - 1);
+                    band = &bands[static_cast<size_t>(bi)];
+                }
 
-            const float peakHi = std::min(1.0f, std::abs(bin.hi) * invRef);
-            const float peakLo = std::min(1.0f, std::abs(bin.lo) * invRef);
-            const float peakMax = std::max(peakHi, peakLo);
-
-            if (showBands && hasBandData_ && rmsH > 3) {
-                const int innerH = std::max(1, rmsH / 3);
-                const int outerH = rmsH - innerH;
-
-                p.setBrush(barColor);
-                p.drawRect(x, cy - rmsH, barW, outerH);
-                p.drawRect(x, cy + innerH, barW, outerH);
-
-                const int lumaI = static_cast<int>(
-                    barColor.red() * 0.299f + barColor.green() * 0.587f + barColor.blue() * 0.114f);
-                QColor innerColor(
-                    (barColor.red()   + lumaI) / 2,
-                    (barColor.green() + lumaI) / 2,
-                    (barColor.blue()  + lumaI) / 2,
-                    barColor.alpha());
-                p.setBrush(innerColor);
-                p.drawRect(x, cy - innerH, barW, innerH * 2);
-            } else {
-                p.setBrush(barColor);
-                p.drawRect(x, cy - rmsH, barW, rmsH * 2);
+                const int x = 1 + px;
+                paintWaveformColumn(p, x, wave[static_cast<size_t>(b)],
+                                    inner ? &wave[static_cast<size_t>(b - 1)] : nullptr,
+                                    inner ? &wave[static_cast<size_t>(b + 1)] : nullptr,
+                                    band, x < playheadX, colStyle);
             }
 
-            if (peakMax > rmsNorm + 0.03f) {
-                const int peakH = static_cast<int>(peakMax * 1.10f * maxBarH);
-                QColor tipColor(230, 245, 255, played ? 170 : 240);
-                p.setBrush(tipColor);
-                p.drawRect(x, cy - peakH, barW, peakH - rmsH);
-                p.drawRect(x, cy + rmsH, barW, peakH - rmsH);
+            if (showBands) {
+                for (int x = 0; x < usableW; ++x) {
+                    const float binFrac = (static_cast<float>(x) / usableW) * viewSpan + viewStart;
+                    const int bi = static_cast<int>((binFrac - srcStart) / srcSpan * bandNumBins);
+                    if (bi < 0 || bi >= bandNumBins) continue;
+                    paintBandStripColumn(p, 1 + x, bands[static_cast<size_t>(bi)],
+                                         mainH, bandStripH, colStyle);
+                }
             }
         }
 
+        if (showBands) {
+            p.setPen(QPen(QColor(0x20, 0x25, 0x30), 1));
+            p.drawLine(1, mainH, w - 2, mainH);
+        }
+
         if (playheadVisible) {
             QColor phLine(0xff, 0xff, 0xff, 210);
             p.setPen(QPen(phLine, 2));
@@ -577,78 +587,6 @@ protected:
             p.drawText(w - stw - 4, 18, QLatin1String("STEMS"));
         }
 
-        if (showBands) {
-            const int bandY = mainH;
-            const int bandNumBins = static_cast<int>(bandBins_.size());
-            const float bandInvRef = 1.0f / bandPeakRef_;
-            const int bandUsableW = w - 2;
-
-            p.setPen(Qt::NoPen);
-            p.setBrush(QColor(0x04, 0x06, 0x09));
-            p.drawRect(1, bandY, bandUsableW, bandStripH);
-
-            static const QColor stripBassColor (255,  80,  50, 200);
-            static const QColor stripMidsColor ( 80, 220,  90, 180);
-            static const QColor stripHighColor (  0, 210, 255, 170);
-
-            for (int x = 0; x < bandUsableW; ++x) {
-                const float binFrac = (static_cast<float>(x) / bandUsableW) * viewSpan + viewStart;
-                const int bi = static_cast<int>(binFrac * bandNumBins);
-                if (bi < 0 || bi >= bandNumBins) continue;
-
-                const auto& band = bandBins_[static_cast<size_t>(bi)];
-                const float eBass = band.low;
-                const float eMids = band.lowMid + band.highMid;
-                const float eHigh = band.high;
-                const float totalE = (eBass + eMids + eHigh) * bandInvRef;
-                if (totalE < 0.01f) continue;
-
-                const float nB = std::sqrt(eBass / bandMaxBass_);
-                const float nM = std::sqrt(eMids / bandMaxMids_);
-                const float nH = std::sqrt(eHigh / bandMaxHigh_);
-                const float wB = nB * 0.60f;
-                const float wM = nM * 1.00f;
-                const float wH = nH * 1.35f;
-                const float nSum = wB + wM + wH;
-                if (nSum < 0.001f) continue;
-                const float bassFrac = wB / nSum;
-                const float midsFrac = wM / nSum;
-                (void)midsFrac;
-                const float highFrac = wH / nSum;
-                (void)highFrac;
-
-                const float energyScale = std::min(1.0f, std::sqrt(totalE));
-                const int totalH = std::max(1, static_cast<int>(bandStripH * energyScale));
-
-                int bassH = std::max(0, static_cast<int>(totalH * bassFrac));
-                int midsH = std::max(0, static_cast<int>(totalH * midsFrac));
-                int highH = std::max(0, totalH - bassH - midsH);
-
-                if (debugBandSolo_ == 1) { midsH = 0; highH = 0; }
-                else if (debugBandSolo_ == 2) { bassH = 0; highH = 0; }
-                else if (debugBandSolo_ == 3) { bassH = 0; midsH = 0; }
-
-                int yy = bandY + bandStripH;
-                if (bassH > 0) {
-                    p.setBrush(stripBassColor);
-                    p.drawRect(1 + x, yy - bassH, 1, bassH);
-                    yy -= bassH;
-                }
-                if (midsH > 0) {
-                    p.setBrush(stripMidsColor);
-                    p.drawRect(1 + x, yy - midsH, 1, midsH);
-                    yy -= midsH;
-                }
-                if (highH > 0) {
-                    p.setBrush(stripHighColor);
-                    p.drawRect(1 + x, yy - highH, 1, highH);
-                }
-            }
-
-            p.setPen(QPen(QColor(0x20, 0x25, 0x30), 1));
-            p.drawLine(1, bandY, w - 2, bandY);
-        }
-
         if (isZoomed && overviewH > 0) {
             const int oy = mainH + bandStripH;
             const int miniW = w - 2;
@@ -662,22 +600,29 @@ protected:
                 p.drawRect(1, oy - 2, w - 2, 2);
             }
 
-            p.setPen(Qt::NoPen);
-            p.setBrush(QColor(0x04, 0x06, 0x09));
-            p.drawRect(1, oy, w - 2, overviewH);
-
-            const int miniMax = std::max(1, (overviewH / 2));
-            const int miniCy = oy + overviewH / 2;
-            QColor miniC = accent_; miniC.setAlpha(140);
-            p.setBrush(miniC);
-            for (int x = 0; x < miniW; ++x) {
-                const int bIdx = static_cast<int>(static_cast<float>(x) / miniW * numBins);
-                if (bIdx < 0 || bIdx >= numBins) continue;
-                const auto& mb = bins_[static_cast<size_t>(bIdx)];
-                const float rmsN = std::min(1.0f, mb.rms * invRef);
-                const int bh = std::max(1, static_cast<int>(rmsN * miniMax));
-                p.drawRect(1 + x, miniCy - bh, 1, bh * 2);
+            // The mini strip only changes with the data or the size.
+            if (miniStrip_.width() != miniW || miniStrip_.height() != overviewH
+                || miniStripHash_ != dataHash_) {
+                miniStrip_ = QImage(std::max(1, miniW), overviewH, QImage::Format_ARGB32_Premultiplied);
+                miniStrip_.fill(QColor(0x04, 0x06, 0x09));
+                miniStripHash_ = dataHash_;
+
+                QPainter mp(&miniStrip_);
+                const int miniMax = std::max(1, (overviewH / 2));
+                const int miniCy = overviewH / 2;
+                QColor miniC = accent_; miniC.setAlpha(140);
+                mp.setPen(Qt::NoPen);
+                mp.setBrush(miniC);
+                for (int x = 0; x < miniW; ++x) {
+                    const int bIdx = static_cast<int>(static_cast<float>(x) / miniW * numBins);
+                    if (bIdx < 0 || bIdx >= numBins) continue;
+                    const auto& mb = bins_[static_cast<size_t>(bIdx)];
+                    const float rmsN = std::min(1.0f, mb.rms * invRef);
+                    const int bh = std::max(1, static_cast<int>(rmsN * miniMax));
+                    mp.drawRect(x, miniCy - bh, 1, bh * 2);
+                }
             }
+            p.drawImage(1, oy, miniStrip_);
 
             const int vpX1 = 1 + static_cast<int>(viewStart * miniW);
             const int vpX2 = 1 + static_cast<int>(viewEnd * miniW);
@@ -697,28 +642,18 @@ protected:
             p.drawLine(miniPhX, oy + 1, miniPhX, oy + overviewH - 2);
         }
 
-        if (++renderLogTick_ >= 120) {
-            renderLogTick_ = 0;
-            auto tid = static_cast<size_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
-
-            float visRmsMax = 0.0f, visPeakMax = 0.0f;
-            for (int i = 0; i < visBins; ++i) {
-                const int bIdx = binStart + i;
-                const auto& binL = bins_[static_cast<size_t>(bIdx)];
-                visRmsMax = std::max(visRmsMax, binL.rms);
-                visPeakMax = std::max(visPeakMax, std::max(std::abs(binL.lo), std::abs(binL.hi)));
-            }
-
-            std::fprintf(stderr,
-                "WAVE_RENDER deck=%d state=%s bins=%d visBins=%d "
-                "viewRange=[%.3f,%.3f] playhead=%.4f tid=%zu\n",
-                deckIndex_, waveViewStateName(viewState_),
-                numBins, visBins, viewStart, viewEnd, playhead_, tid);
-            std::fflush(stderr);
-        }
+        recordPaintTime(paintTimer);
     }
 
 private:
+    void recordPaintTime(const QElapsedTimer& timer)
+    {
+        const double ms = static_cast<double>(timer.nsecsElapsed()) / 1.0e6;
+        paintLastMs_ = ms;
+        paintAvgMs_ = (paintAvgMs_ <= 0.0) ? ms : paintAvgMs_ + (ms - paintAvgMs_) * 0.05;
+        paintMaxMs_ = std::max(paintMaxMs_, ms);
+    }
+
     QColor accent_;
     QColor bgColor_{0x06, 0x08, 0x0c};
     bool borderVisible_{true};
@@ -730,6 +665,9 @@ private:
     size_t dataHash_{0};
 
     std::vector<ngks::BandEnergy> bandBins_;
+    std::shared_ptr<const ngks::WaveformPyramid> pyramid_;
+    std::vector<ngks::WaveMinMax> zoomBins_;    // visible range, one per pixel
+    std::vector<ngks::BandEnergy> zoomBands_;
     float bandPeakRef_{1.0f};
     float bandMaxBass_{1.0f};
     float bandMaxMids_{1.0f};
@@ -746,5 +684,17 @@ private:
     float trackDuration_{120.0f};
     float liveWindowSec_{7.0f};
     int deckIndex_{0};
-    int renderLogTick_{0};
+
+    QImage miniStrip_;                          // zoomed views' whole-track strip
+    size_t miniStripHash_{0};
+
+    double paintLastMs_{0.0};
+    double paintAvgMs_{0.0};
+    double paintMaxMs_{0.0};
+    uint64_t tileMisses_{0};
+
+    // Last member: its worker must stop before the rest is torn down.
+    WaveformTileCache tiles_{[this]() {
+        QMetaObject::invokeMethod(this, [this]() { update(); }, Qt::QueuedConnection);
+    }};
 };
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "ui/WaveformTileCache.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+// ── Column painting ──────────────────────────────────────────────────────────
+
+void paintWaveformColumn(QPainter& p, int x, const ngks::WaveMinMax& bin,
+                         const ngks::WaveMinMax* prev, const ngks::WaveMinMax* next,
+                         const ngks::BandEnergy* band, bool played,
+                         const WaveformColumnStyle& style)
+{
+    constexpr int barW = 1;
+    const int cy = style.cy;
+    const int maxBarH = style.maxBarH;
+    const float invRef = style.invRef;
+
+    float rmsNorm = std::min(1.0f, bin.rms * invRef);
+    if (prev && next) {
+        const float prevN = std::min(1.0f, prev->rms * invRef);
+        const float nextN = std::min(1.0f, next->rms * invRef);
+        rmsNorm = rmsNorm * 0.92f + (prevN + nextN) * 0.5f * 0.08f;
+    }
+    rmsNorm = std::pow(rmsNorm, 0.92f);
+    const int rmsH = std::max(1, static_cast<int>(rmsNorm * maxBarH));
+
+    QColor barColor = played ? style.playedColor : style.aheadColor;
+
+    if (style.showBands && band) {
+        const float eBass = band->low;
+        const float eMids = band->lowMid + band->highMid;
+        const float eHigh = band->high;
+
+        float nB = std::sqrt(eBass / style.bandMaxBass);
+        float nM = std::sqrt(eMids / style.bandMaxMids);
+        float nH = std::sqrt(eHigh / style.bandMaxHigh);
+        if (nB < 0.08f) nB = 0.0f;
+        if (nM < 0.08f) nM = 0.0f;
+        if (nH < 0.08f) nH = 0.0f;
+
+        float vB = nB * 0.60f, vM = nM * 1.00f, vH = nH * 1.35f;
+
+        if (style.debugBandSolo == 1) { vM = 0; vH = 0; }
+        else if (style.debugBandSolo == 2) { vB = 0; vH = 0; }
+        else if (style.debugBandSolo == 3) { vB = 0; vM = 0; }
+
+        float b1 = vB, b2 = vM;
+        int dom = 0;
+        if (vM > b1) { b2 = b1; b1 = vM; dom = 1; }
+        if (vH > b1) { b2 = b1; b1 = vH; dom = 2; }
+        else if (vH > b2) { b2 = vH; }
+
+        if (b1 > 0.001f) {
+            static const int kPalR[] = { 255,  80,   0 };
+            static const int kPalG[] = {  80, 220, 210 };
+            static const int kPalB[] = {  50,  90, 255 };
+
+            const float ratio = b1 / (b2 + 0.001f);
+
+            int colR, colG, colB;
+            if (ratio >= 1.65f) {
+                colR = kPalR[dom]; colG = kPalG[dom]; colB = kPalB[dom];
+            } else {
+                int sec = 0;
+                if (dom == 0) sec = (vM >= vH) ? 1 : 2;
+                else if (dom == 1) sec = (vB >= vH) ? 0 : 2;
+                else sec = (vB >= vM) ? 0 : 1;
+                colR = static_cast<int>(kPalR[dom] * 0.7f + kPalR[sec] * 0.3f);
+                colG = static_cast<int>(kPalG[dom] * 0.7f + kPalG[sec] * 0.3f);
+                colB = static_cast<int>(kPalB[dom] * 0.7f + kPalB[sec] * 0.3f);
+            }
+
+            const float colorStrength = 0.65f + 0.10f * rmsNorm;
+            const float satBoost = style.live ? 1.25f : 1.18f;
+
+            const float avg = (colR + colG + colB) / 3.0f;
+            colR = std::clamp(static_cast<int>(avg + (colR - avg) * satBoost), 0, 255);
+            colG = std::clamp(static_cast<int>(avg + (colG - avg) * satBoost), 0, 255);
+            colB = std::clamp(static_cast<int>(avg + (colB - avg) * satBoost), 0, 255);
+
+            const float keep = 1.0f - colorStrength;
+            barColor = QColor(
+                std::clamp(static_cast<int>(barColor.red()   * keep + colR * colorStrength), 0, 255),
+                std::clamp(static_cast<int>(barColor.green() * keep + colG * colorStrength), 0, 255),
+                std::clamp(static_cast<int>(barColor.blue()  * keep + colB * colorStrength), 0, 255),
+                barColor.alpha());
+        }
+    }
+
+    const float peakHi = std::min(1.0f, std::abs(bin.hi) * invRef);
+    const float peakLo = std::min(1.0f, std::abs(bin.lo) * invRef);
+    const float peakMax = std::max(peakHi, peakLo);
+
+    if (style.showBands && band && rmsH > 3) {
+        const int innerH = std::max(1, rmsH / 3);
+        const int outerH = rmsH - innerH;
+
+        p.setBrush(barColor);
+        p.drawRect(x, cy - rmsH, barW, outerH);
+        p.drawRect(x, cy + innerH, barW, outerH);
+
+        const int lumaI = static_cast<int>(
+            barColor.red() * 0.299f + barColor.green() * 0.587f + barColor.blue() * 0.114f);
+        QColor innerColor(
+            (barColor.red()   + lumaI) / 2,
+            (barColor.green() + lumaI) / 2,
+            (barColor.blue()  + lumaI) / 2,
+            barColor.alpha());
+        p.setBrush(innerColor);
+        p.drawRect(x, cy - innerH, barW, innerH * 2);
+    } else {
+        p.setBrush(barColor);
+        p.drawRect(x, cy - rmsH, barW, rmsH * 2);
+    }
+
+    if (peakMax > rmsNorm + 0.03f) {
+        const int peakH = static_cast<int>(peakMax * 1.10f * maxBarH);
+        QColor tipColor(230, 245, 255, played ? 170 : 240);
+        p.setBrush(tipColor);
+        p.drawRect(x, cy - peakH, barW, peakH - rmsH);
+        p.drawRect(x, cy + rmsH, barW, peakH - rmsH);
+    }
+}
+
+void paintBandStripColumn(QPainter& p, int x, const ngks::BandEnergy& band,
+                          int bandY, int bandStripH, const WaveformColumnStyle& style)
+{
+    static const QColor stripBassColor (255,  80,  50, 200);
+    static const QColor stripMidsColor ( 80, 220,  90, 180);
+    static const QColor stripHighColor (  0, 210, 255, 170);
+
+    const float eBass = band.low;
+    const float eMids = band.lowMid + band.highMid;
+    const float eHigh = band.high;
+    const float totalE = (eBass + eMids + eHigh) * style.bandInvRef;
+    if (totalE < 0.01f) return;
+
+    const float wB = std::sqrt(eBass / style.bandMaxBass) * 0.60f;
+    const float wM = std::sqrt(eMids / style.bandMaxMids) * 1.00f;
+    const float wH = std::sqrt(eHigh / style.bandMaxHigh) * 1.35f;
+    const float nSum = wB + wM + wH;
+    if (nSum < 0.001f) return;
+    const float bassFrac = wB / nSum;
+    const float midsFrac = wM / nSum;
+
+    const float energyScale = std::min(1.0f, std::sqrt(totalE));
+    const int totalH = std::max(1, static_cast<int>(bandStripH * energyScale));
+
+    int bassH = std::max(0, static_cast<int>(totalH * bassFrac));
+    int midsH = std::max(0, static_cast<int>(totalH * midsFrac));
+    int highH = std::max(0, totalH - bassH - midsH);
+
+    if (style.debugBandSolo == 1) { midsH = 0; highH = 0; }
+    else if (style.debugBandSolo == 2) { bassH = 0; highH = 0; }
+    else if (style.debugBandSolo == 3) { bassH = 0; midsH = 0; }
+
+    int yy = bandY + bandStripH;
+    if (bassH > 0) {
+        p.setBrush(stripBassColor);
+        p.drawRect(x, yy - bassH, 1, bassH);
+        yy -= bassH;
+    }
+    if (midsH > 0) {
+        p.setBrush(stripMidsColor);
+        p.drawRect(x, yy - midsH, 1, midsH);
+        yy -= midsH;
+    }
+    if (highH > 0) {
+        p.setBrush(stripHighColor);
+        p.drawRect(x, yy - highH, 1, highH);
+    }
+}
+
+// ── WaveformTileCache ────────────────────────────────────────────────────────
+
+bool WaveformTileCache::Style::sameAs(const Style& o) const
+{
+    const WaveformColumnStyle& a = columns;
+    const WaveformColumnStyle& b = o.columns;
+    return pyramid == o.pyramid && framesPerPixel == o.framesPerPixel
+        && mainH == o.mainH && bandStripH == o.bandStripH
+        && a.cy == b.cy && a.maxBarH == b.maxBarH && a.invRef == b.invRef
+        && a.aheadColor == b.aheadColor && a.showBands == b.showBands && a.live == b.live
+        && a.bandInvRef == b.bandInvRef && a.bandMaxBass == b.bandMaxBass
+        && a.bandMaxMids == b.bandMaxMids && a.bandMaxHigh == b.bandMaxHigh
+        && a.debugBandSolo == b.debugBandSolo;
+}
+
+WaveformTileCache::WaveformTileCache(std::function<void()> onTileReady)
+    : onTileReady_(std::move(onTileReady))
+{
+    worker_ = std::thread([this]() { workerLoop(); });
+}
+
+WaveformTileCache::~WaveformTileCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void WaveformTileCache::setStyle(const Style& style)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (style_.sameAs(style)) return;
+    style_ = style;
+    ++generation_;
+    tiles_.clear();
+    queued_.clear();
+    queue_.clear();
+}
+
+void WaveformTileCache::clear()
+{
+    setStyle(Style{});
+}
+
+QImage WaveformTileCache::tile(int64_t index)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tiles_.find(index);
+    if (it != tiles_.end()) {
+        it->second.lastUse = ++useClock_;
+        return it->second.image;
+    }
+    request(index, true);
+    return {};
+}
+
+void WaveformTileCache::prefetch(int64_t first, int64_t last)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int64_t i = std::max<int64_t>(0, first); i <= last; ++i) {
+        if (tiles_.count(i) == 0) request(i, false);
+    }
+}
+
+int WaveformTileCache::cachedTiles() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(tiles_.size());
+}
+
+double WaveformTileCache::snapFramesPerPixel(double fpp)
+{
+    if (fpp <= 0.0) return 1.0;
+    return std::exp2(std::round(std::log2(fpp) * 4.0) / 4.0);
+}
+
+void WaveformTileCache::request(int64_t index, bool urgent)
+{
+    if (!style_.pyramid || index < 0) return;
+    if (!queued_.insert(index).second) {
+        if (!urgent) return;
+        // Already queued behind prefetches: move it to the front.
+        queue_.erase(std::remove(queue_.begin(), queue_.end(), index), queue_.end());
+    }
+    if (urgent) queue_.push_front(index);
+    else        queue_.push_back(index);
+    wake_.notify_one();
+}
+
+void WaveformTileCache::evict()
+{
+    while (static_cast<int>(tiles_.size()) > kMaxTiles) {
+        auto oldest = tiles_.begin();
+        for (auto it = tiles_.begin(); it != tiles_.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) oldest = it;
+        }
+        tiles_.erase(oldest);
+    }
+}
+
+void WaveformTileCache::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (stop_) return;
+
+        const int64_t index = queue_.front();
+        queue_.pop_front();
+        const Style style = style_;
+        const uint64_t generation = generation_;
+
+        lock.unlock();
+        QImage image = renderTile(style, index);
+        lock.lock();
+
+        if (generation != generation_) continue;   // zoom / data changed meanwhile
+        queued_.erase(index);
+        tiles_[index] = Entry{ std::move(image), ++useClock_ };
+        evict();
+
+        lock.unlock();
+        if (onTileReady_) onTileReady_();
+        lock.lock();
+    }
+}
+
+QImage WaveformTileCache::renderTile(const Style& style, int64_t index)
+{
+    const int height = style.mainH + style.bandStripH;
+    if (!style.pyramid || style.framesPerPixel <= 0.0 || height <= 0) return {};
+
+    QImage image(kTileWidth, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    // One bucket per pixel, plus a neighbour each side for the smoothing.
+    const double fpp = style.framesPerPixel;
+    const int64_t tilePx0 = index * kTileWidth;
+    const int64_t px0 = std::max<int64_t>(0, tilePx0 - 1);
+    const int64_t px1 = tilePx0 + kTileWidth + 1;
+    const int columns = static_cast<int>(px1 - px0);
+    const int64_t totalFrames = style.pyramid->totalFrames();
+
+    std::vector<ngks::WaveMinMax> wave;
+    std::vector<ngks::BandEnergy> bands;
+    const bool showBands = style.columns.showBands;
+    style.pyramid->query(static_cast<int64_t>(static_cast<double>(px0) * fpp),
+                         static_cast<int64_t>(static_cast<double>(px1) * fpp),
+                         columns, &wave, showBands ? &bands : nullptr);
+
+    QPainter p(&image);
+    p.setRenderHint(QPainter::Antialiasing, false);
+    p.setPen(Qt::NoPen);
+
+    for (int x = 0; x < kTileWidth; ++x) {
+        const int64_t globalPx = tilePx0 + x;
+        if (static_cast<double>(globalPx) * fpp >= static_cast<double>(totalFrames)) break;
+
+        const int c = static_cast<int>(globalPx - px0);
+        const ngks::WaveMinMax* prev = (c > 0) ? &wave[static_cast<size_t>(c - 1)] : nullptr;
+        const ngks::WaveMinMax* next = (c + 1 < columns) ? &wave[static_cast<size_t>(c + 1)] : nullptr;
+        const ngks::BandEnergy* band = showBands ? &bands[static_cast<size_t>(c)] : nullptr;
+
+        paintWaveformColumn(p, x, wave[static_cast<size_t>(c)], prev, next, band, false, style.columns);
+        if (band && style.bandStripH > 0)
+            paintBandStripColumn(p, x, *band, style.mainH, style.bandStripH, style.columns);
+    }
+    return image;
+}
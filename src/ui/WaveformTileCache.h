@@ -0,0 +1,136 @@
+#pragma once
+
+#include <QColor>
+#include <QImage>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "engine/runtime/graph/WaveformPyramid.h"
+
+class QPainter;
+
+// ═══════════════════════════════════════════════════════════════════
+// Waveform column painting — shared by the direct paint path in
+// WaveformOverview and the tile renderer below, so both draw the same
+// bars, band colours and stem strip.
+// ═══════════════════════════════════════════════════════════════════
+struct WaveformColumnStyle {
+    int   cy{0};              ///< centre line of the main area
+    int   maxBarH{0};
+    float invRef{1.0f};       ///< 1 / track peak
+    QColor playedColor;
+    QColor aheadColor;
+    bool  showBands{false};
+    bool  live{false};
+    float bandInvRef{1.0f};
+    float bandMaxBass{1.0f};
+    float bandMaxMids{1.0f};
+    float bandMaxHigh{1.0f};
+    int   debugBandSolo{0};
+};
+
+/// One bar at x.  prev/next are the neighbouring buckets for the RMS
+/// smoothing (null at the edges); band may be null when bands are off.
+void paintWaveformColumn(QPainter& p, int x, const ngks::WaveMinMax& bin,
+                         const ngks::WaveMinMax* prev, const ngks::WaveMinMax* next,
+                         const ngks::BandEnergy* band, bool played,
+                         const WaveformColumnStyle& style);
+
+/// One column of the stacked bass / mids / high strip below the bars.
+void paintBandStripColumn(QPainter& p, int x, const ngks::BandEnergy& band,
+                          int bandY, int bandStripH, const WaveformColumnStyle& style);
+
+/// Paint-time figures for the diagnostics dialog.
+struct WaveformPaintStats {
+    double lastMs{0.0};
+    double avgMs{0.0};        ///< exponential average
+    double maxMs{0.0};        ///< worst frame since the last reset
+    int    cachedTiles{0};
+    uint64_t tileMisses{0};   ///< visible tiles that were not ready yet
+};
+
+// ═══════════════════════════════════════════════════════════════════
+// WaveformTileCache — pre-rendered strips for the zoomed views.
+//
+// The zoomed track is cut into kTileWidth-pixel tiles at a fixed
+// frames-per-pixel.  Tiles are rendered from the pyramid on a worker
+// thread and kept in a small LRU, so a LIVE_SCROLL frame is a handful of
+// image blits instead of a bar loop over every column.  Tiles are drawn
+// in the "ahead" colours; the widget dims the played part on top.
+//
+// Zoom is snapped to quarter-octave steps (snapFramesPerPixel) so that
+// wheel zooming reuses a few tile sets instead of re-rendering on every
+// notch.
+// ═══════════════════════════════════════════════════════════════════
+class WaveformTileCache {
+public:
+    static constexpr int kTileWidth = 256;
+    static constexpr int kMaxTiles  = 48;
+
+    /// Everything a tile's pixels depend on; a change drops every tile.
+    struct Style {
+        std::shared_ptr<const ngks::WaveformPyramid> pyramid;
+        double framesPerPixel{0.0};
+        int    mainH{0};
+        int    bandStripH{0};     ///< 0 when bands are off
+        WaveformColumnStyle columns;
+
+        bool sameAs(const Style& o) const;
+    };
+
+    /// onTileReady runs on the worker thread after each finished tile.
+    explicit WaveformTileCache(std::function<void()> onTileReady);
+    ~WaveformTileCache();
+
+    WaveformTileCache(const WaveformTileCache&) = delete;
+    WaveformTileCache& operator=(const WaveformTileCache&) = delete;
+
+    void setStyle(const Style& style);
+    void clear();
+
+    /// Tile `index` (pixels [index*kTileWidth, (index+1)*kTileWidth) of the
+    /// track at the current zoom), or a null image after queueing it.
+    QImage tile(int64_t index);
+
+    /// Queues tiles in [first, last] behind any visible ones.
+    void prefetch(int64_t first, int64_t last);
+
+    int cachedTiles() const;
+
+    /// Nearest 2^(k/4) to fpp.
+    static double snapFramesPerPixel(double fpp);
+
+    static QImage renderTile(const Style& style, int64_t index);
+
+private:
+    struct Entry {
+        QImage   image;
+        uint64_t lastUse{0};
+    };
+
+    void request(int64_t index, bool urgent);     // caller holds mutex_
+    void evict();                                 // caller holds mutex_
+    void workerLoop();
+
+    std::function<void()> onTileReady_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    Style    style_;
+    uint64_t generation_{0};
+    uint64_t useClock_{0};
+    std::unordered_map<int64_t, Entry> tiles_;
+    std::unordered_set<int64_t> queued_;
+    std::deque<int64_t> queue_;
+    bool stop_{false};
+    std::thread worker_;
+};
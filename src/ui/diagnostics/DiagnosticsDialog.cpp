@@ -221,6 +221,11 @@ DiagnosticsDialog::DiagnosticsDialog(EngineBridge& engineBridge, QWidget* parent
     rtAudioLabel_->setWordWrap(true);
     layout->addWidget(rtAudioLabel_);
 
+    waveformPaintLabel_ = new QLabel(
+        QStringLiteral("Waveform Paint:\n  Deck A: N/A\n  Deck B: N/A"), this);
+    waveformPaintLabel_->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(waveformPaintLabel_);
+
     logTailBox_ = new QPlainTextEdit(this);
     logTailBox_->setReadOnly(true);
     layout->addWidget(logTailBox_);
@@ -327,6 +332,20 @@ void DiagnosticsDialog::setRtAudio(const UIEngineTelemetrySnapshot& telemetry)
                  boolToFlag(telemetry.rtWatchdogOk)));
 }
 
+void DiagnosticsDialog::setWaveformPaint(const WaveformPaintStats& deckA, const WaveformPaintStats& deckB)
+{
+    auto line = [](const WaveformPaintStats& s) {
+        return QStringLiteral("last=%1ms avg=%2ms max=%3ms tiles=%4 tileMisses=%5")
+            .arg(QString::number(s.lastMs, 'f', 2),
+                 QString::number(s.avgMs, 'f', 2),
+                 QString::number(s.maxMs, 'f', 2),
+                 QString::number(s.cachedTiles),
+                 QString::number(static_cast<qulonglong>(s.tileMisses)));
+    };
+    waveformPaintLabel_->setText(
+        QStringLiteral("Waveform Paint:\n  Deck A: %1\n  Deck B: %2").arg(line(deckA), line(deckB)));
+}
+
 void DiagnosticsDialog::copyReportToClipboard()
 {
     QString report;
@@ -336,6 +355,7 @@ void DiagnosticsDialog::copyReportToClipboard()
     report += telemetryLabel_->text() + '\n';
     report += foundationText_;
     report += '\n' + rtAudioLabel_->text();
+    report += '\n' + waveformPaintLabel_->text();
     if (QGuiApplication::clipboard() != nullptr)
         QGuiApplication::clipboard()->setText(report);
 }
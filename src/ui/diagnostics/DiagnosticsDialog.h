@@ -2,6 +2,7 @@
 
 #include "ui/diagnostics/RuntimeLogSupport.h"
 #include "ui/EngineBridge.h"
+#include "ui/WaveformTileCache.h"
 
 #include <QDialog>
 #include <QString>
@@ -35,6 +36,7 @@ public:
     void setTelemetry(const UIEngineTelemetrySnapshot& telemetry);
     void setFoundation(const UIFoundationSnapshot& foundation, const UISelfTestSnapshot* selfTests);
     void setRtAudio(const UIEngineTelemetrySnapshot& telemetry);
+    void setWaveformPaint(const WaveformPaintStats& deckA, const WaveformPaintStats& deckB);
     void refreshLogTail();
     void copyReportToClipboard();
 
@@ -47,6 +49,7 @@ private:
     QLabel*         telemetryLabel_{nullptr};
     QLabel*         foundationLabel_{nullptr};
     QLabel*         rtAudioLabel_{nullptr};
+    QLabel*         waveformPaintLabel_{nullptr};
     QPlainTextEdit* logTailBox_{nullptr};
     QString         foundationText_;
 };
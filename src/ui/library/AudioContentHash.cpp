@@ -0,0 +1,200 @@
+#include "ui/library/AudioContentHash.h"
+
+#include <QByteArray>
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// ── Byte helpers ──────────────────────────────────────────────────────────────
+inline quint32 be32(const uchar* p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3];
+}
+inline quint64 be64(const uchar* p) { return (quint64(be32(p)) << 32) | be32(p + 4); }
+inline quint32 le32(const uchar* p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+}
+inline quint64 le64(const uchar* p) { return quint64(le32(p)) | (quint64(le32(p + 4)) << 32); }
+inline quint32 syncsafe32(const uchar* p)
+{
+    return (quint32(p[0] & 0x7f) << 21) | (quint32(p[1] & 0x7f) << 14)
+         | (quint32(p[2] & 0x7f) << 7) | quint32(p[3] & 0x7f);
+}
+inline bool tagIs(const uchar* p, const char* id, int n) { return std::memcmp(p, id, static_cast<size_t>(n)) == 0; }
+
+void fnv1a64(quint64& h, const uchar* p, qint64 n)
+{
+    for (qint64 i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+}
+
+// Exactly n bytes at off, or false.
+bool readAt(QFile& f, qint64 off, qint64 n, uchar* out)
+{
+    return f.seek(off) && f.read(reinterpret_cast<char*>(out), n) == n;
+}
+
+// ── Payload range per container ───────────────────────────────────────────────
+struct Range {
+    qint64 begin{0};
+    qint64 end{0};
+};
+
+// Past every ID3v2 tag at the start (some taggers stack them).
+qint64 skipId3v2(QFile& f, qint64 size)
+{
+    qint64 pos = 0;
+    uchar h[10];
+    while (pos + 10 <= size && readAt(f, pos, 10, h) && tagIs(h, "ID3", 3)) {
+        const bool footer = (h[5] & 0x10) != 0;
+        pos += 10 + qint64(syncsafe32(h + 6)) + (footer ? 10 : 0);
+    }
+    return std::min(pos, size);
+}
+
+// Before ID3v1 and APEv2 trailers.
+qint64 trimTrailers(QFile& f, qint64 begin, qint64 end)
+{
+    uchar t[32];
+    for (int guard = 0; guard < 4 && end - begin > 128; ++guard) {
+        if (readAt(f, end - 128, 3, t) && tagIs(t, "TAG", 3)) {
+            end -= 128;
+            continue;
+        }
+        if (readAt(f, end - 32, 32, t) && tagIs(t, "APETAGEX", 8)) {
+            const bool hasHeader = (le32(t + 20) & 0x80000000u) != 0;
+            const qint64 tagSize = qint64(le32(t + 12)) + (hasHeader ? 32 : 0);
+            if (tagSize <= 0 || tagSize > end - begin) break;
+            end -= tagSize;
+            continue;
+        }
+        break;
+    }
+    return end;
+}
+
+// stream is the offset of "fLaC".
+Range flacRange(QFile& f, qint64 stream, qint64 size)
+{
+    qint64 pos = stream + 4;
+    uchar h[4];
+    while (pos + 4 <= size && readAt(f, pos, 4, h)) {
+        pos += 4 + ((qint64(h[1]) << 16) | (qint64(h[2]) << 8) | h[3]);
+        if (h[0] & 0x80) break;             // last metadata block
+    }
+    return { std::min(pos, size), size };
+}
+
+Range riffRange(QFile& f, qint64 size)
+{
+    qint64 pos = 12;
+    uchar h[8];
+    while (pos + 8 <= size && readAt(f, pos, 8, h)) {
+        const qint64 len = le32(h + 4);
+        if (tagIs(h, "data", 4)) return { pos + 8, std::min(size, pos + 8 + len) };
+        pos += 8 + len + (len & 1);
+    }
+    return { 12, size };
+}
+
+Range mp4Range(QFile& f, qint64 size)
+{
+    qint64 pos = 0;
+    uchar h[16];
+    while (pos + 8 <= size && readAt(f, pos, 8, h)) {
+        qint64 len = be32(h);
+        qint64 header = 8;
+        if (len == 1) {
+            if (!readAt(f, pos + 8, 8, h + 8)) break;
+            len = static_cast<qint64>(be64(h + 8));
+            header = 16;
+        } else if (len == 0) {
+            len = size - pos;
+        }
+        if (len < header) break;
+        if (tagIs(h + 4, "mdat", 4)) return { pos + header, std::min(size, pos + len) };
+        pos += len;
+    }
+    return { 0, size };
+}
+
+Range oggRange(QFile& f, qint64 size)
+{
+    // Header packets (identification, comments, setup) sit on pages with
+    // granule position 0; the first page past them carries audio.
+    qint64 pos = 0;
+    uchar h[27 + 255];
+    while (pos + 27 <= size && readAt(f, pos, 27, h) && tagIs(h, "OggS", 4)) {
+        const quint64 granule = le64(h + 6);
+        const int segments = h[26];
+        if (!readAt(f, pos + 27, segments, h + 27)) break;
+        if (granule != 0 && granule != ~quint64(0)) return { pos, size };
+        qint64 body = 0;
+        for (int s = 0; s < segments; ++s) body += h[27 + s];
+        pos += 27 + segments + body;
+    }
+    return { 0, size };
+}
+
+Range payloadRange(QFile& f, qint64 size)
+{
+    uchar magic[12] {};
+    const qint64 n = std::min<qint64>(size, 12);
+    if (!readAt(f, 0, n, magic)) return { 0, size };
+
+    if (n >= 4 && tagIs(magic, "fLaC", 4)) return flacRange(f, 0, size);
+    if (n >= 12 && tagIs(magic, "RIFF", 4) && tagIs(magic + 8, "WAVE", 4)) return riffRange(f, size);
+    if (n >= 8 && tagIs(magic + 4, "ftyp", 4)) return mp4Range(f, size);
+    if (n >= 4 && tagIs(magic, "OggS", 4)) return oggRange(f, size);
+
+    // MP3, raw AAC, WMA: strip tags at both ends.  Some taggers also put
+    // an ID3v2 tag in front of FLAC.
+    const qint64 begin = skipId3v2(f, size);
+    uchar m[4];
+    if (begin > 0 && begin + 4 <= size && readAt(f, begin, 4, m) && tagIs(m, "fLaC", 4))
+        return flacRange(f, begin, size);
+    return { begin, trimTrailers(f, begin, size) };
+}
+
+} // namespace
+
+// ── audioContentHash ──────────────────────────────────────────────────────────
+quint64 audioContentHash(const QString& filePath)
+{
+    using namespace AudioContentHash;
+
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly)) return 0;
+    const qint64 size = f.size();
+    if (size <= 0) return 0;
+
+    Range r = payloadRange(f, size);
+    if (r.begin < 0 || r.begin >= r.end || r.end > size) r = { 0, size };
+    const qint64 length = r.end - r.begin;
+
+    quint64 h = 14695981039346656037ull;
+    fnv1a64(h, reinterpret_cast<const uchar*>(&length), sizeof(length));
+
+    QByteArray buf;
+    if (length <= qint64(kSamples) * kSampleBytes) {
+        buf.resize(length);
+        if (!readAt(f, r.begin, length, reinterpret_cast<uchar*>(buf.data()))) return 0;
+        fnv1a64(h, reinterpret_cast<const uchar*>(buf.constData()), length);
+    } else {
+        buf.resize(kSampleBytes);
+        auto* p = reinterpret_cast<uchar*>(buf.data());
+        const qint64 span = length - kSampleBytes;
+        for (int i = 0; i < kSamples; ++i) {
+            const qint64 off = r.begin + span * i / (kSamples - 1);
+            if (!readAt(f, off, kSampleBytes, p)) return 0;
+            fnv1a64(h, p, kSampleBytes);
+        }
+    }
+    return h == 0 ? 1 : h;
+}
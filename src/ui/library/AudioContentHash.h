@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// ── Audio content hash ────────────────────────────────────────────────────────
+// Identity of a file's audio, independent of its path and of its tags.
+//
+// The audio payload is located per container (after an ID3v2 tag and before
+// ID3v1 / APEv2 trailers for MP3 and other raw streams; after the metadata
+// blocks for FLAC; the "data" chunk of RIFF/WAV; the "mdat" atom of MP4; from
+// the first audio page of Ogg) and kSamples evenly spaced kSampleBytes windows
+// of it are hashed together with its length.  That is a few small reads per
+// file however large it is, so the library scan computes it for every file.
+// It is both library_tracks.content_hash and the AnalysisCache key.
+//
+// Retagging, renaming and moving keep the hash.  Re-encoding changes it.  For
+// Ogg, a tag edit that changes the number of header pages renumbers the audio
+// pages and so changes the hash too.
+//
+// Returns 0 if the file cannot be read; never 0 otherwise.
+namespace AudioContentHash {
+    constexpr int kSamples     = 8;
+    constexpr int kSampleBytes = 4096;
+}
+
+quint64 audioContentHash(const QString& filePath);
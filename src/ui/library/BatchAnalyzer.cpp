@@ -0,0 +1,488 @@
+#include "ui/library/BatchAnalyzer.h"
+
+#include "ui/AudioAnalysisService.h"
+#include "ui/KeyDetectionService.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <QtDebug>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Helpers
+// ─────────────────────────────────────────────────────────────────────────────
+static inline QString qs(const char* s) { return QLatin1String(s); }
+
+namespace {
+
+// File identity recorded in the checkpoint.  A track is up to date when its
+// journal entry matches all three fields.
+struct FileStamp {
+    qint64 size{-1};
+    qint64 mtimeMs{-1};
+    int    version{0};
+    bool   failed{false};   // analysis error; not part of identity
+
+    bool operator==(const FileStamp& o) const
+    { return size == o.size && mtimeMs == o.mtimeMs && version == o.version; }
+};
+
+FileStamp stampOf(const QString& path)
+{
+    FileStamp s;
+    const QFileInfo fi(path);
+    if (!fi.exists()) return s;
+    s.size    = fi.size();
+    s.mtimeMs = fi.lastModified().toMSecsSinceEpoch();
+    s.version = BatchAnalyzer::kAnalyzerVersion;
+    return s;
+}
+
+// ── Checkpoint journal ───────────────────────────────────────────────────────
+// Text, append-only, one committed track per line:
+//   <version>\t<size>\t<mtimeMs>\t<OK|FAIL>\t<file_path>
+// Later lines win, so a re-analysed track simply appends a new entry.
+// A torn last line (crash mid-write) fails to parse and is ignored.
+QHash<QString, FileStamp> loadCheckpoint(const QString& path)
+{
+    QHash<QString, FileStamp> out;
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return out;
+
+    QTextStream in(&f);
+    in.setEncoding(QStringConverter::Utf8);
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) continue;
+        const QStringList parts = line.split(QLatin1Char('\t'));
+        if (parts.size() != 5) continue;
+        bool okV = false, okS = false, okM = false;
+        FileStamp s;
+        s.version = parts[0].toInt(&okV);
+        s.size    = parts[1].toLongLong(&okS);
+        s.mtimeMs = parts[2].toLongLong(&okM);
+        if (!okV || !okS || !okM || parts[4].isEmpty()) continue;
+        s.failed  = parts[3] == QLatin1String("FAIL");
+        out.insert(parts[4], s);
+    }
+    return out;
+}
+
+// Drops superseded entries so the journal does not grow without bound
+// across repeated forced runs.
+void compactCheckpoint(const QString& path)
+{
+    const QHash<QString, FileStamp> entries = loadCheckpoint(path);
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+    QTextStream out(&f);
+    out.setEncoding(QStringConverter::Utf8);
+    out << "# NGKs batch analysis checkpoint\n";
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        out << it.value().version << '\t' << it.value().size << '\t'
+            << it.value().mtimeMs << '\t' << (it.value().failed ? "FAIL" : "OK")
+            << '\t' << it.key() << '\n';
+    }
+    out.flush();
+    f.commit();
+}
+
+// Installed RAM in bytes, 0 if unknown.
+qint64 physicalMemoryBytes()
+{
+#ifdef Q_OS_WIN
+    MEMORYSTATUSEX status{};
+    status.dwLength = sizeof(status);
+    return GlobalMemoryStatusEx(&status) ? static_cast<qint64>(status.ullTotalPhys) : 0;
+#else
+    const long pages    = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGE_SIZE);
+    return pages > 0 && pageSize > 0 ? static_cast<qint64>(pages) * pageSize : 0;
+#endif
+}
+
+// A row imported with a full analysis (legacy pipeline) counts as done
+// unless the run is forced.
+bool hasAnalysisColumns(const TrackInfo& t)
+{
+    return !t.bpm.isEmpty() && !t.camelotKey.isEmpty() && t.loudnessLUFS != 0.0;
+}
+
+// ── Memory budget ────────────────────────────────────────────────────────────
+// Counting semaphore over bytes.  A track larger than the whole budget is
+// still admitted once nothing else is in flight, so it cannot deadlock.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(qint64 capacity) : capacity_(capacity) {}
+
+    bool acquire(qint64 bytes, const std::atomic<bool>& cancel)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] {
+            return cancel.load(std::memory_order_relaxed)
+                || used_ + bytes <= capacity_
+                || used_ == 0;
+        });
+        if (cancel.load(std::memory_order_relaxed)) return false;
+        used_ += bytes;
+        return true;
+    }
+
+    void release(qint64 bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            used_ -= bytes;
+        }
+        cv_.notify_all();
+    }
+
+    void wakeAll() { cv_.notify_all(); }
+
+private:
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    const qint64            capacity_;
+    qint64                  used_{0};
+};
+
+struct WorkItem {
+    qint64    trackId{-1};
+    QString   filePath;
+    QString   genre;
+    qint64    estBytes{0};
+    FileStamp stamp;
+};
+
+struct WorkResult {
+    size_t         index{0};     // into the work list
+    AnalysisResult result;
+};
+
+DjLibraryDatabase::AnalysisUpdate toUpdate(qint64 trackId, const AnalysisResult& r)
+{
+    DjLibraryDatabase::AnalysisUpdate u;
+    u.trackId      = trackId;
+    u.bpm          = QString::number(r.bpm, 'f', 1);
+    u.camelotKey   = r.camelotKey;
+    u.musicalKey   = KeyDetectionService::standardKeyFromCamelot(r.camelotKey);
+    u.energy       = r.energy;
+    u.loudnessLUFS = r.loudnessLUFS;
+    u.cueIn        = QString::number(r.cueInSeconds, 'f', 2);
+    u.cueOut       = QString::number(r.cueOutSeconds, 'f', 2);
+    u.danceability = r.danceability;
+    u.fingerprint  = r.fingerprint;
+    return u;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Memory estimate
+// ─────────────────────────────────────────────────────────────────────────────
+qint64 BatchAnalyzer::estimateTrackBytes(const TrackInfo& t, const AnalysisRateConfig& rates)
+{
+    // analyzeFile() decodes at most 10 minutes at the native rate into
+    // left, right and a mono mix, all three alive until the stages finish.
+    // The peak is the first decimation: its zero-padded copy of the mono
+    // mix plus the chroma-rate output, i.e. 4 + 1/M1 floats per native
+    // frame (4.5 at 48 kHz with the default 22.05 kHz chroma rate).  The
+    // onset-rate buffer and the stage STFTs come after the padded copy is
+    // gone and are smaller.  The library does not store the sample rate;
+    // 48 kHz covers 44.1 kHz files with ~9% to spare.
+    constexpr double kCapSeconds  = 600.0;
+    constexpr double kAssumedRate = 48000.0;
+    const int m1 = PolyphaseDecimator::factorFor(kAssumedRate, rates.chromaRateHz);
+    const double floatsPerFrame = 3.0 + (m1 > 1 ? 1.0 + 1.0 / m1 : 0.0);
+
+    double seconds = static_cast<double>(t.durationMs) / 1000.0;
+    if (seconds <= 0.0) {
+        // No duration yet — guess from size at ~128 kbps.
+        seconds = t.fileSize > 0 ? static_cast<double>(t.fileSize) / 16000.0
+                                 : kCapSeconds;
+    }
+    seconds = std::clamp(seconds, 1.0, kCapSeconds);
+    return static_cast<qint64>(seconds * kAssumedRate * floatsPerFrame * sizeof(float));
+}
+
+qint64 BatchAnalyzer::defaultMemoryBudget(int workers, const AnalysisRateConfig& rates)
+{
+    TrackInfo typical;
+    typical.durationMs = 7 * 60 * 1000;
+    const qint64 perTrack = estimateTrackBytes(typical, rates);
+
+    qint64 budget = perTrack * std::max(1, workers);
+    const qint64 ram = physicalMemoryBytes();
+    if (ram > 0) budget = std::min(budget, ram / 2);
+    return std::max(budget, perTrack);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Run
+// ─────────────────────────────────────────────────────────────────────────────
+bool BatchAnalyzer::run(DjLibraryDatabase& db, const QString& dbPath,
+                        const Config& cfg, const ProgressFn& onProgress)
+{
+    cancel_.store(false, std::memory_order_relaxed);
+    progress_ = Progress{};
+
+    if (!db.isOpen()) {
+        qWarning().noquote() << qs("[BATCH] db not open");
+        return false;
+    }
+
+    QElapsedTimer wall;
+    wall.start();
+
+    const QString checkpointPath = cfg.checkpointPath.isEmpty()
+        ? dbPath + qs(".analysis.checkpoint")
+        : cfg.checkpointPath;
+
+    // ── 1. Build work list ───────────────────────────────────────────────────
+    const std::vector<DjLibraryDatabase::Row> rows = db.allRows();
+    const QHash<QString, FileStamp> journal = cfg.force ? QHash<QString, FileStamp>{}
+                                                  : loadCheckpoint(checkpointPath);
+
+    // Legacy imports carry analysis columns but no journal entry; they are
+    // taken as analysed once they also have a fingerprint.
+    QSet<qint64> fingerprinted;
+    if (!cfg.force) {
+        for (qint64 id : db.fingerprintedTrackIds()) fingerprinted.insert(id);
+    }
+
+    std::vector<WorkItem> work;
+    work.reserve(rows.size());
+    int skipped = 0;
+    for (const auto& row : rows) {
+        const FileStamp stamp = stampOf(row.info.filePath);
+        if (stamp.size < 0) { ++skipped; continue; }            // missing file
+
+        if (!cfg.force) {
+            auto it = journal.constFind(row.info.filePath);
+            if (it != journal.constEnd() && it.value() == stamp && !it.value().failed) {
+                ++skipped;
+                continue;
+            }
+            if (it == journal.constEnd() && hasAnalysisColumns(row.info)
+                && fingerprinted.contains(row.trackId)) { ++skipped; continue; }
+        }
+
+        WorkItem w;
+        w.trackId  = row.trackId;
+        w.filePath = row.info.filePath;
+        w.genre    = row.info.genre;
+        w.estBytes = estimateTrackBytes(row.info, cfg.rateConfig);
+        w.stamp    = stamp;
+        work.push_back(std::move(w));
+    }
+
+    // Longest first: keeps every core busy until the end of the run.
+    std::stable_sort(work.begin(), work.end(), [](const WorkItem& a, const WorkItem& b) {
+        return a.estBytes > b.estBytes;
+    });
+
+    progress_.total   = static_cast<int>(rows.size());
+    progress_.queued  = static_cast<int>(work.size());
+    progress_.skipped = skipped;
+
+    qInfo().noquote() << qs("[BATCH] START total=") << progress_.total
+                      << qs("queued=") << progress_.queued
+                      << qs("skipped=") << progress_.skipped
+                      << qs("checkpoint=") << checkpointPath;
+
+    if (work.empty()) {
+        if (onProgress) onProgress(progress_);
+        return true;
+    }
+
+    // ── 2. Workers ───────────────────────────────────────────────────────────
+    int workerCount = cfg.workers > 0 ? cfg.workers
+                                      : static_cast<int>(std::thread::hardware_concurrency());
+    workerCount = std::clamp(workerCount, 1, static_cast<int>(work.size()));
+
+    const qint64 budgetBytes = cfg.memoryBudgetBytes > 0
+        ? cfg.memoryBudgetBytes
+        : defaultMemoryBudget(workerCount, cfg.rateConfig);
+    MemoryBudget budget(budgetBytes);
+    std::atomic<size_t> next{0};
+    std::atomic<int>    running{workerCount};
+
+    std::mutex              resultMutex;
+    std::condition_variable resultCv;
+    std::deque<WorkResult>  results;
+
+    auto workerFn = [&]() {
+        AudioAnalysisService service;
+        service.setRateConfig(cfg.rateConfig);
+        service.setCache(cfg.cache);
+
+        for (;;) {
+            if (cancel_.load(std::memory_order_relaxed)) break;
+            const size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= work.size()) break;
+
+            const WorkItem& w = work[i];
+            if (!budget.acquire(w.estBytes, cancel_)) break;
+            AnalysisResult r = service.analyzeFile(w.filePath, w.genre);
+            budget.release(w.estBytes);
+
+            {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                results.push_back(WorkResult{i, std::move(r)});
+            }
+            resultCv.notify_one();
+        }
+
+        running.fetch_sub(1, std::memory_order_relaxed);
+        resultCv.notify_one();
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(workerCount));
+    for (int t = 0; t < workerCount; ++t) threads.emplace_back(workerFn);
+
+    qInfo().noquote() << qs("[BATCH] WORKERS") << workerCount
+                      << qs("budgetMB=") << (budgetBytes >> 20);
+
+    // ── 3. Collect + commit on this thread ───────────────────────────────────
+    QFile journalFile(checkpointPath);
+    const bool journalOk = journalFile.open(QIODevice::WriteOnly | QIODevice::Append
+                                            | QIODevice::Text);
+    if (!journalOk) {
+        qWarning().noquote() << qs("[BATCH] checkpoint not writable — run will not be resumable:")
+                             << checkpointPath;
+    }
+
+    std::vector<WorkResult> pending;
+    pending.reserve(static_cast<size_t>(std::max(cfg.commitBatchSize, 1)));
+    QElapsedTimer sinceCommit;
+    sinceCommit.start();
+    bool commitOk = true;
+
+    auto commit = [&]() {
+        if (pending.empty()) return;
+
+        std::vector<DjLibraryDatabase::AnalysisUpdate> updates;
+        updates.reserve(pending.size());
+        for (const WorkResult& wr : pending) {
+            if (wr.result.valid)
+                updates.push_back(toUpdate(work[wr.index].trackId, wr.result));
+        }
+
+        QElapsedTimer t;
+        t.start();
+        if (!db.applyAnalysisBatch(updates)) {
+            // Leave these out of the journal so the next run retries them.
+            qWarning().noquote() << qs("[BATCH] COMMIT_FAIL rows=") << updates.size();
+            commitOk = false;
+        } else if (journalOk) {
+            // Journal only after the DB commit: the checkpoint never claims
+            // a track whose results were not persisted.
+            QTextStream out(&journalFile);
+            out.setEncoding(QStringConverter::Utf8);
+            for (const WorkResult& wr : pending) {
+                const WorkItem& w = work[wr.index];
+                out << w.stamp.version << '\t' << w.stamp.size << '\t'
+                    << w.stamp.mtimeMs << '\t'
+                    << (wr.result.valid ? "OK" : "FAIL") << '\t'
+                    << w.filePath << '\n';
+            }
+            out.flush();
+            journalFile.flush();
+        }
+
+        for (const WorkResult& wr : pending) {
+            ++progress_.done;
+            if (!wr.result.valid) {
+                ++progress_.failed;
+                qWarning().noquote() << qs("[BATCH] FAIL") << work[wr.index].filePath
+                                     << wr.result.errorMsg;
+            }
+        }
+
+        progress_.elapsedSeconds = wall.elapsed() / 1000.0;
+        progress_.tracksPerSec   = progress_.elapsedSeconds > 0.0
+            ? progress_.done / progress_.elapsedSeconds : 0.0;
+        const int remaining      = progress_.queued - progress_.done;
+        progress_.etaSeconds     = progress_.tracksPerSec > 0.0
+            ? remaining / progress_.tracksPerSec : 0.0;
+
+        qInfo().noquote() << qs("[BATCH] COMMIT rows=") << updates.size()
+                          << qs("ms=") << t.elapsed()
+                          << qs("done=") << progress_.done << '/' << progress_.queued
+                          << qs("failed=") << progress_.failed
+                          << qs("rate=") << QString::number(progress_.tracksPerSec, 'f', 2)
+                          << qs("eta_s=") << QString::number(progress_.etaSeconds, 'f', 0);
+
+        pending.clear();
+        sinceCommit.restart();
+        if (onProgress) onProgress(progress_);
+    };
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(resultMutex);
+            resultCv.wait_for(lock, std::chrono::milliseconds(250), [&] {
+                return !results.empty() || running.load(std::memory_order_relaxed) == 0;
+            });
+            while (!results.empty()) {
+                pending.push_back(std::move(results.front()));
+                results.pop_front();
+            }
+        }
+
+        const bool workersDone = running.load(std::memory_order_relaxed) == 0;
+        if (static_cast<int>(pending.size()) >= cfg.commitBatchSize
+            || sinceCommit.elapsed() >= cfg.commitIntervalMs
+            || workersDone) {
+            commit();
+        }
+
+        if (cancel_.load(std::memory_order_relaxed)) budget.wakeAll();
+        if (workersDone) {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (results.empty()) break;
+        }
+    }
+
+    for (auto& th : threads) th.join();
+    commit();   // anything pushed between the last drain and join
+    journalFile.close();
+
+    // Rewrite the journal without superseded lines once it grows large
+    // (~40k tracks is ~4 MB; repeated forced runs double it each time).
+    if (journalOk && QFileInfo(checkpointPath).size()
+                       > qint64(progress_.total + 1) * 256) {
+        compactCheckpoint(checkpointPath);
+    }
+
+    progress_.elapsedSeconds = wall.elapsed() / 1000.0;
+    qInfo().noquote() << qs("[BATCH] END done=") << progress_.done
+                      << qs("failed=") << progress_.failed
+                      << qs("skipped=") << progress_.skipped
+                      << qs("cancelled=") << cancel_.load()
+                      << qs("seconds=") << QString::number(progress_.elapsedSeconds, 'f', 1)
+                      << qs("rate=") << QString::number(progress_.tracksPerSec, 'f', 2);
+    return commitOk;
+}
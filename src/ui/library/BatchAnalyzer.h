@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ui/AnalysisDecimator.h"
+#include "ui/library/DjLibraryDatabase.h"
+
+#include <QString>
+
+#include <atomic>
+#include <functional>
+
+class AnalysisCache;
+
+// ─────────────────────────────────────────────────────────────────────────────
+// BatchAnalyzer
+//
+// Runs AudioAnalysisService over every track in DjLibraryDatabase on all
+// cores.  Worker threads only decode and analyse; results are handed back to
+// the calling thread, which owns the SQLite connection and writes them in
+// batched transactions.
+//
+// Admission is bounded by a decoded-audio memory budget (a 7-minute 48 kHz
+// track peaks at ~360 MB of float buffers while analysing; see
+// estimateTrackBytes), and tracks are scheduled longest-first so the tail of
+// the run does not wait on one long mix.  The default budget gives every
+// worker room for such a track, within half the installed RAM.
+//
+// Every committed track is appended to a checkpoint journal together with the
+// file's size/mtime and the analyzer version.  A re-run skips tracks whose
+// journal entry still matches, so an interrupted run resumes where it stopped
+// and a finished library costs one stat() per file.  Tracks that failed are
+// retried on every run; an unreadable file fails at open, so this is cheap.
+// ─────────────────────────────────────────────────────────────────────────────
+class BatchAnalyzer {
+public:
+    // Bump when analysis output changes enough that stored results are stale.
+    // 2: acoustic fingerprints (with a cache attached only that stage runs).
+    static constexpr int kAnalyzerVersion = 2;
+
+    struct Config {
+        int     workers{0};                       // 0 = hardware threads
+        qint64  memoryBudgetBytes{0};             // decoded audio across workers; 0 = default
+        int     commitBatchSize{64};              // rows per transaction
+        int     commitIntervalMs{5000};           // or this often, whichever first
+        QString checkpointPath;                   // empty = <db>.analysis.checkpoint
+        bool    force{false};                     // ignore checkpoint / existing data
+        AnalysisRateConfig rateConfig;
+        AnalysisCache* cache{nullptr};            // shared by all workers, optional
+    };
+
+    struct Progress {
+        int    total{0};          // rows in library
+        int    queued{0};         // needing analysis this run
+        int    skipped{0};        // up to date
+        int    done{0};           // finished this run (ok + failed)
+        int    failed{0};
+        double elapsedSeconds{0.0};
+        double tracksPerSec{0.0};
+        double etaSeconds{0.0};
+    };
+
+    using ProgressFn = std::function<void(const Progress&)>;
+
+    // Blocking.  Must be called on the thread that opened db.
+    // Returns false if the library could not be read or a commit failed.
+    bool run(DjLibraryDatabase& db, const QString& dbPath,
+             const Config& cfg, const ProgressFn& onProgress = {});
+
+    // Thread-safe.  Workers stop after their current track; everything
+    // already analysed is still committed and checkpointed.
+    void requestCancel() { cancel_.store(true, std::memory_order_relaxed); }
+
+    const Progress& lastProgress() const { return progress_; }
+
+    // Peak decoded-buffer bytes analyzeFile() needs for this track.
+    static qint64 estimateTrackBytes(const TrackInfo& t, const AnalysisRateConfig& rates);
+
+    // workers × a 7-minute track, capped at half the installed RAM
+    // (at least one such track).
+    static qint64 defaultMemoryBudget(int workers, const AnalysisRateConfig& rates);
+
+private:
+    std::atomic<bool> cancel_{false};
+    Progress          progress_;
+};
@@ -1,5 +1,12 @@
 #include "ui/library/DjLibraryDatabase.h"
 
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
@@ -7,11 +14,58 @@
 #include <QVariant>
 #include <QtDebug>
 
+#include <algorithm>
+#include <cstdint>
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Helpers
 // ─────────────────────────────────────────────────────────────────────────────
 static inline QString qs(const char* s) { return QLatin1String(s); }
 
+int DjLibraryDatabase::bpmToFixed(const QString& bpm)
+{
+    bool ok = false;
+    const double v = bpm.trimmed().toDouble(&ok);
+    if (!ok || v <= 0.0) return 0;
+    return static_cast<int>(v * 100.0 + 0.5);
+}
+
+bool DjLibraryDatabase::parseCamelot(const QString& key, int& number, int& mode)
+{
+    // "8A", "11b", " 3A " → (8, 0), (11, 1), (3, 0)
+    const QString k = key.trimmed().toUpper();
+    if (k.size() < 2) return false;
+    const QChar m = k.back();
+    if (m != QLatin1Char('A') && m != QLatin1Char('B')) return false;
+    bool ok = false;
+    const int n = k.left(k.size() - 1).toInt(&ok);
+    if (!ok || n < 1 || n > 12) return false;
+    number = n;
+    mode   = (m == QLatin1Char('B')) ? 1 : 0;
+    return true;
+}
+
+int DjLibraryDatabase::cueToMs(const QString& cue)
+{
+    // Seconds ("12.34") or minutes:seconds ("1:02.5")
+    const QString c = cue.trimmed();
+    if (c.isEmpty()) return -1;
+    bool ok = false;
+    const int colon = c.indexOf(QLatin1Char(':'));
+    double seconds = 0.0;
+    if (colon > 0) {
+        bool okM = false;
+        const int minutes = c.left(colon).toInt(&okM);
+        seconds = c.mid(colon + 1).toDouble(&ok);
+        if (!okM || !ok) return -1;
+        seconds += minutes * 60.0;
+    } else {
+        seconds = c.toDouble(&ok);
+        if (!ok) return -1;
+    }
+    return seconds < 0.0 ? -1 : static_cast<int>(seconds * 1000.0 + 0.5);
+}
+
 DjLibraryDatabase::~DjLibraryDatabase()
 {
     close();
@@ -31,6 +85,14 @@ bool DjLibraryDatabase::open(const QString& dbPath)
         return false;
     }
 
+    // INSERT OR REPLACE must fire the delete trigger that keeps the
+    // full-text index in step with the replaced row.
+    QSqlQuery(db_).exec(qs("PRAGMA recursive_triggers = ON;"));
+    // WAL lets the library query worker's connection read while this one
+    // writes; the busy timeout covers the brief checkpoint locks.
+    QSqlQuery(db_).exec(qs("PRAGMA journal_mode = WAL;"));
+    QSqlQuery(db_).exec(qs("PRAGMA busy_timeout = 2000;"));
+
     if (!createSchema()) {
         qWarning().noquote() << qs("DjLibraryDatabase::createSchema FAIL");
         db_.close();
@@ -39,6 +101,7 @@ bool DjLibraryDatabase::open(const QString& dbPath)
     }
 
     open_ = true;
+    path_ = dbPath;
     qInfo().noquote() << qs("DjLibraryDatabase: opened") << dbPath;
     return true;
 }
@@ -50,6 +113,9 @@ void DjLibraryDatabase::close()
     db_ = QSqlDatabase();
     QSqlDatabase::removeDatabase(connName_);
     open_ = false;
+    path_.clear();
+    fpIndex_.clear();
+    fpIndexValid_ = false;
 }
 
 bool DjLibraryDatabase::createSchema()
@@ -86,76 +152,619 @@ bool DjLibraryDatabase::createSchema()
         return false;
     }
 
+    // Library-level state (root folder, migration markers).
+    if (!q.exec(qs("CREATE TABLE IF NOT EXISTS library_meta ("
+                   "  key   TEXT PRIMARY KEY,"
+                   "  value TEXT NOT NULL DEFAULT ''"
+                   ");"))) {
+        qWarning().noquote() << qs("DjLibraryDatabase: CREATE TABLE library_meta failed") << q.lastError().text();
+        return false;
+    }
+
+    // Playlists: membership by track_id, so renames and moves (which keep
+    // the id) leave them intact.  Positions are gapped (kPlaylistGap) so a
+    // reorder rewrites one row; the primary key keeps items in order and
+    // the (playlist_id, track_id) index answers membership and dedup.
+    if (!q.exec(qs("CREATE TABLE IF NOT EXISTS playlists ("
+                   "  playlist_id INTEGER PRIMARY KEY,"
+                   "  name        TEXT    NOT NULL DEFAULT '',"
+                   "  created_ms  INTEGER NOT NULL DEFAULT 0"
+                   ");"))
+        || !q.exec(qs("CREATE TABLE IF NOT EXISTS playlist_items ("
+                      "  playlist_id INTEGER NOT NULL,"
+                      "  track_id    INTEGER NOT NULL,"
+                      "  position    INTEGER NOT NULL,"
+                      "  PRIMARY KEY (playlist_id, position)"
+                      ") WITHOUT ROWID;"))) {
+        qWarning().noquote() << qs("DjLibraryDatabase: CREATE TABLE playlists failed") << q.lastError().text();
+        return false;
+    }
+    q.exec(qs("CREATE UNIQUE INDEX IF NOT EXISTS idx_pl_items_track ON playlist_items(playlist_id, track_id);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_pl_items_by_track ON playlist_items(track_id);"));
+
+    // Acoustic fingerprints, one row per analysed track and kept apart from
+    // library_tracks so paged reads never drag the blobs along.  Rows of
+    // another AudioFingerprint::kVersion are ignored until re-analysed.
+    if (!q.exec(qs("CREATE TABLE IF NOT EXISTS track_fingerprints ("
+                   "  track_id  INTEGER PRIMARY KEY,"
+                   "  version   INTEGER NOT NULL,"
+                   "  landmarks INTEGER NOT NULL,"
+                   "  sketch    BLOB    NOT NULL,"
+                   "  sample    BLOB    NOT NULL"
+                   ");"))) {
+        qWarning().noquote() << qs("DjLibraryDatabase: CREATE TABLE track_fingerprints failed") << q.lastError().text();
+        return false;
+    }
+
     q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_display ON library_tracks(display_name COLLATE NOCASE);"));
     q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_artist  ON library_tracks(artist       COLLATE NOCASE);"));
     q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_album   ON library_tracks(album        COLLATE NOCASE);"));
     q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_path    ON library_tracks(file_path);"));
+    // Composite keys matching sortOrderClause, so keyset seeks are index ranges
+    // (track_id, the rowid, is implicitly the last column of every index).
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_artist_name ON library_tracks(artist COLLATE NOCASE, display_name COLLATE NOCASE);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_album_name  ON library_tracks(album  COLLATE NOCASE, display_name COLLATE NOCASE);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_duration    ON library_tracks(duration_ms);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_key         ON library_tracks(musical_key COLLATE NOCASE);"));
+
+    if (!migrateColumns()) return false;
+
+    // Typed analysis columns: BPM sort/range, harmonic mixing, energy and
+    // per-genre tempo browsing are index range scans.  Camelot leads the
+    // mixing index so each (key, tempo window) arm of queryCompatible is one
+    // seek plus a short BPM range; only the matches are sorted.
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_bpm         ON library_tracks(bpm_x100);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_camelot_bpm ON library_tracks(camelot_num, camelot_mode, bpm_x100);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_energy      ON library_tracks(energy);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_genre_bpm   ON library_tracks(genre COLLATE NOCASE, bpm_x100);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_path_key    ON library_tracks(path_key);"));
+    q.exec(qs("CREATE INDEX IF NOT EXISTS idx_lib_content_hash ON library_tracks(content_hash);"));
+
+    fts_ = createFullTextIndex();
     return true;
 }
 
+bool DjLibraryDatabase::migrateColumns()
+{
+    // Typed mirrors of the display strings, written alongside them:
+    //   bpm_x100      BPM × 100 (0 = unknown)
+    //   camelot_num   1..12 (0 = unknown),  camelot_mode  0 = A (minor), 1 = B (major)
+    //   cue_in_ms / cue_out_ms   milliseconds (-1 = unset)
+    // Sync bookkeeping (syncTracks):
+    //   file_mtime    ms since epoch (0 = unknown)
+    //   row_sig       rowSignature() of the TrackInfo last written (0 = never)
+    //   path_key      pathKey(file_path), indexed for per-path lookups
+    //   content_hash  audioContentHash() (0 = unknown), indexed for move detection
+    // Remaining TrackInfo fields, so the table alone restores the library:
+    //   loudness_range, acousticness, instrumentalness, liveness
+    QSqlQuery q(db_);
+    QSet<QString> existing;
+    if (q.exec(qs("PRAGMA table_info(library_tracks);"))) {
+        while (q.next()) existing.insert(q.value(1).toString());
+    }
+
+    const struct { const char* name; const char* decl; } columns[] = {
+        { "bpm_x100",     "INTEGER NOT NULL DEFAULT 0"  },
+        { "camelot_num",  "INTEGER NOT NULL DEFAULT 0"  },
+        { "camelot_mode", "INTEGER NOT NULL DEFAULT 0"  },
+        { "cue_in_ms",    "INTEGER NOT NULL DEFAULT -1" },
+        { "cue_out_ms",   "INTEGER NOT NULL DEFAULT -1" },
+        { "file_mtime",   "INTEGER NOT NULL DEFAULT 0"  },
+        { "row_sig",      "INTEGER NOT NULL DEFAULT 0"  },
+        { "path_key",     "TEXT    NOT NULL DEFAULT ''" },
+        { "content_hash", "INTEGER NOT NULL DEFAULT 0"  },
+        { "loudness_range",   "REAL NOT NULL DEFAULT 0"  },
+        { "acousticness",     "REAL NOT NULL DEFAULT -1" },
+        { "instrumentalness", "REAL NOT NULL DEFAULT -1" },
+        { "liveness",         "REAL NOT NULL DEFAULT -1" },
+    };
+    bool added = false;
+    for (const auto& c : columns) {
+        if (existing.contains(qs(c.name))) continue;
+        if (!q.exec(QStringLiteral("ALTER TABLE library_tracks ADD COLUMN %1 %2;")
+                        .arg(qs(c.name), qs(c.decl)))) {
+            qWarning().noquote() << qs("DjLibraryDatabase: ADD COLUMN failed") << c.name
+                                 << q.lastError().text();
+            return false;
+        }
+        added = true;
+    }
+    if (!added) return true;
+
+    // Backfill from the text columns with the same parsers the writers use.
+    struct Typed { qint64 id; int bpm, num, mode, cueIn, cueOut; QString pathKey; };
+    std::vector<Typed> rows;
+    if (q.exec(qs("SELECT track_id, bpm, camelot_key, cue_in, cue_out, file_path FROM library_tracks;"))) {
+        while (q.next()) {
+            Typed t{q.value(0).toLongLong(), bpmToFixed(q.value(1).toString()), 0, 0,
+                    cueToMs(q.value(3).toString()), cueToMs(q.value(4).toString()),
+                    pathKey(q.value(5).toString())};
+            parseCamelot(q.value(2).toString(), t.num, t.mode);
+            rows.push_back(t);
+        }
+    }
+
+    db_.transaction();
+    QSqlQuery up(db_);
+    up.prepare(qs(
+        "UPDATE library_tracks SET bpm_x100 = :bx, camelot_num = :kn, camelot_mode = :km,"
+        " cue_in_ms = :cim, cue_out_ms = :com, path_key = :pk WHERE track_id = :tid;"));
+    for (const Typed& t : rows) {
+        up.bindValue(qs(":bx"),  t.bpm);
+        up.bindValue(qs(":kn"),  t.num);
+        up.bindValue(qs(":km"),  t.mode);
+        up.bindValue(qs(":cim"), t.cueIn);
+        up.bindValue(qs(":com"), t.cueOut);
+        up.bindValue(qs(":pk"),  t.pathKey);
+        up.bindValue(qs(":tid"), t.id);
+        up.exec();
+    }
+    const bool ok = db_.commit();
+    qInfo().noquote() << qs("DjLibraryDatabase: columns migrated rows=")
+                      << rows.size() << qs("ok=") << ok;
+    return ok;
+}
+
+void DjLibraryDatabase::bindTyped(QSqlQuery& q, const QString& bpm, const QString& camelot,
+                                  const QString& cueIn, const QString& cueOut)
+{
+    int num = 0, mode = 0;
+    parseCamelot(camelot, num, mode);
+    q.bindValue(qs(":bx"),  bpmToFixed(bpm));
+    q.bindValue(qs(":kn"),  num);
+    q.bindValue(qs(":km"),  mode);
+    q.bindValue(qs(":cim"), cueToMs(cueIn));
+    q.bindValue(qs(":com"), cueToMs(cueOut));
+}
+
+bool DjLibraryDatabase::createFullTextIndex()
+{
+    // External-content FTS5 table over the "all fields" search columns.
+    // unicode61 with remove_diacritics folds case and accents on both the
+    // indexed text and the query; prefix indexes make 2–3 character
+    // as-you-type prefixes a single b-tree range.
+    QSqlQuery q(db_);
+    bool existed = false;
+    if (q.exec(qs("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'library_fts';")))
+        existed = q.next();
+
+    if (!q.exec(qs(
+            "CREATE VIRTUAL TABLE IF NOT EXISTS library_fts USING fts5("
+            "  display_name, title, artist, album, genre, bpm, musical_key, camelot_key,"
+            "  content = 'library_tracks', content_rowid = 'track_id',"
+            "  tokenize = 'unicode61 remove_diacritics 2', prefix = '2 3'"
+            ");"))) {
+        qWarning().noquote() << qs("DjLibraryDatabase: FTS5 unavailable, search uses LIKE")
+                             << q.lastError().text();
+        return false;
+    }
+
+    const char* triggers[] = {
+        "CREATE TRIGGER IF NOT EXISTS library_fts_ai AFTER INSERT ON library_tracks BEGIN"
+        "  INSERT INTO library_fts(rowid, display_name, title, artist, album, genre,"
+        "                          bpm, musical_key, camelot_key)"
+        "  VALUES (new.track_id, new.display_name, new.title, new.artist, new.album,"
+        "          new.genre, new.bpm, new.musical_key, new.camelot_key);"
+        " END;",
+        "CREATE TRIGGER IF NOT EXISTS library_fts_ad AFTER DELETE ON library_tracks BEGIN"
+        "  INSERT INTO library_fts(library_fts, rowid, display_name, title, artist, album,"
+        "                          genre, bpm, musical_key, camelot_key)"
+        "  VALUES ('delete', old.track_id, old.display_name, old.title, old.artist,"
+        "          old.album, old.genre, old.bpm, old.musical_key, old.camelot_key);"
+        " END;",
+        "CREATE TRIGGER IF NOT EXISTS library_fts_au AFTER UPDATE OF"
+        "  display_name, title, artist, album, genre, bpm, musical_key, camelot_key"
+        "  ON library_tracks BEGIN"
+        "  INSERT INTO library_fts(library_fts, rowid, display_name, title, artist, album,"
+        "                          genre, bpm, musical_key, camelot_key)"
+        "  VALUES ('delete', old.track_id, old.display_name, old.title, old.artist,"
+        "          old.album, old.genre, old.bpm, old.musical_key, old.camelot_key);"
+        "  INSERT INTO library_fts(rowid, display_name, title, artist, album, genre,"
+        "                          bpm, musical_key, camelot_key)"
+        "  VALUES (new.track_id, new.display_name, new.title, new.artist, new.album,"
+        "          new.genre, new.bpm, new.musical_key, new.camelot_key);"
+        " END;",
+    };
+    for (const char* sql : triggers) {
+        if (!q.exec(qs(sql))) {
+            qWarning().noquote() << qs("DjLibraryDatabase: FTS trigger failed") << q.lastError().text();
+            return false;
+        }
+    }
+
+    // Index rows that predate the FTS table.
+    if (!existed) {
+        if (!q.exec(qs("INSERT INTO library_fts(library_fts) VALUES ('rebuild');"))) {
+            qWarning().noquote() << qs("DjLibraryDatabase: FTS rebuild failed") << q.lastError().text();
+            return false;
+        }
+        qInfo().noquote() << qs("DjLibraryDatabase: full-text index built");
+    }
+    return true;
+}
+
+QString DjLibraryDatabase::ftsMatchExpression(const QString& search)
+{
+    // Every token must match (implicit AND), each as a prefix so partial
+    // words match while typing.  Splitting on the same classes unicode61
+    // treats as separators keeps query and index tokens aligned.
+    static const QRegularExpression kSeparators(
+        qs("[^\\p{L}\\p{N}]+"), QRegularExpression::UseUnicodePropertiesOption);
+    QStringList terms;
+    for (const QString& tok : search.split(kSeparators, Qt::SkipEmptyParts))
+        terms << QLatin1Char('"') + tok + qs("\"*");
+    return terms.join(QLatin1Char(' '));
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Write
 // ─────────────────────────────────────────────────────────────────────────────
-bool DjLibraryDatabase::bulkInsert(const std::vector<TrackInfo>& tracks)
+namespace {
+
+// Every full-row write binds the same columns through bindRow().
+const char* const kRowInsert =
+    "INSERT OR REPLACE INTO library_tracks "
+    "(track_id, file_path, display_name, title, artist, album, genre,"
+    " duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
+    " loudness_lufs, file_size, cue_in, cue_out, danceability,"
+    " year_tag, rating, comments, legacy_imported,"
+    " bpm_x100, camelot_num, camelot_mode, cue_in_ms, cue_out_ms,"
+    " file_mtime, row_sig, path_key,"
+    " loudness_range, acousticness, instrumentalness, liveness, content_hash)"
+    " VALUES "
+    "(:tid, :fp, :dn, :ti, :ar, :al, :ge,"
+    " :dm, :ds, :bp, :mk, :ck, :en,"
+    " :ll, :fs, :ci, :co, :da,"
+    " :yr, :rt, :cm, :li,"
+    " :bx, :kn, :km, :cim, :com,"
+    " :mt, :sg, :pk,"
+    " :lr, :ac, :in, :lv, :ch);";
+
+void fnv1a64(uint64_t& h, const void* data, size_t n)
 {
-    if (!open_) return false;
+    const auto* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+}
 
-    db_.transaction();
+template <typename T>
+void hashValue(uint64_t& h, const T& v) { fnv1a64(h, &v, sizeof(T)); }
 
-    QSqlQuery del(db_);
-    del.exec(qs("DELETE FROM library_tracks;"));
+void hashValue(uint64_t& h, const QString& s)
+{
+    const qint64 n = s.size();
+    fnv1a64(h, &n, sizeof(n));
+    fnv1a64(h, s.constData(), static_cast<size_t>(n) * sizeof(QChar));
+}
 
-    QSqlQuery ins(db_);
-    ins.prepare(qs(
-        "INSERT INTO library_tracks "
-        "(track_id, file_path, display_name, title, artist, album, genre,"
-        " duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
-        " loudness_lufs, file_size, cue_in, cue_out, danceability,"
-        " year_tag, rating, comments, legacy_imported)"
-        " VALUES "
-        "(:tid, :fp, :dn, :ti, :ar, :al, :ge,"
-        " :dm, :ds, :bp, :mk, :ck, :en,"
-        " :ll, :fs, :ci, :co, :da,"
-        " :yr, :rt, :cm, :li);"
-    ));
+} // namespace
+
+QString DjLibraryDatabase::pathKey(const QString& filePath)
+{
+    const QString p = QDir::cleanPath(QDir::fromNativeSeparators(filePath));
+#ifdef Q_OS_WIN
+    return p.toCaseFolded();
+#else
+    return p;
+#endif
+}
+
+qint64 DjLibraryDatabase::rowSignature(const TrackInfo& t)
+{
+    uint64_t h = 14695981039346656037ull;
+    hashValue(h, t.filePath);
+    hashValue(h, t.displayName);
+    hashValue(h, t.title);
+    hashValue(h, t.artist);
+    hashValue(h, t.album);
+    hashValue(h, t.genre);
+    hashValue(h, t.durationMs);
+    hashValue(h, t.durationStr);
+    hashValue(h, t.bpm);
+    hashValue(h, t.musicalKey);
+    hashValue(h, t.camelotKey);
+    hashValue(h, t.energy);
+    hashValue(h, t.loudnessLUFS);
+    hashValue(h, t.loudnessRange);
+    hashValue(h, t.fileSize);
+    hashValue(h, t.modifiedMs);
+    hashValue(h, t.contentHash);
+    hashValue(h, t.cueIn);
+    hashValue(h, t.cueOut);
+    hashValue(h, t.danceability);
+    hashValue(h, t.acousticness);
+    hashValue(h, t.instrumentalness);
+    hashValue(h, t.liveness);
+    hashValue(h, t.year);
+    hashValue(h, t.rating);
+    hashValue(h, t.comments);
+    hashValue(h, t.legacyImported);
+    // 0 marks rows never written by syncTracks
+    return h == 0 ? 1 : static_cast<qint64>(h);
+}
 
+void DjLibraryDatabase::bindRow(QSqlQuery& q, qint64 trackId, const TrackInfo& t, qint64 signature)
+{
     // Qt binds null QStrings as SQL NULL which violates NOT NULL constraints
     // even when the column has DEFAULT ''. Coerce null to empty string.
     auto nn = [](const QString& s) -> QString {
         return s.isNull() ? QLatin1String("") : s;
     };
 
-    for (int i = 0; i < static_cast<int>(tracks.size()); ++i) {
-        const TrackInfo& t = tracks[static_cast<size_t>(i)];
-        ins.bindValue(qs(":tid"), i);
-        ins.bindValue(qs(":fp"),  nn(t.filePath));
-        ins.bindValue(qs(":dn"),  nn(t.displayName));
-        ins.bindValue(qs(":ti"),  nn(t.title));
-        ins.bindValue(qs(":ar"),  nn(t.artist));
-        ins.bindValue(qs(":al"),  nn(t.album));
-        ins.bindValue(qs(":ge"),  nn(t.genre));
-        ins.bindValue(qs(":dm"),  static_cast<qint64>(t.durationMs));
-        ins.bindValue(qs(":ds"),  nn(t.durationStr));
-        ins.bindValue(qs(":bp"),  nn(t.bpm));
-        ins.bindValue(qs(":mk"),  nn(t.musicalKey));
-        ins.bindValue(qs(":ck"),  nn(t.camelotKey));
-        ins.bindValue(qs(":en"),  t.energy);
-        ins.bindValue(qs(":ll"),  t.loudnessLUFS);
-        ins.bindValue(qs(":fs"),  static_cast<qint64>(t.fileSize));
-        ins.bindValue(qs(":ci"),  nn(t.cueIn));
-        ins.bindValue(qs(":co"),  nn(t.cueOut));
-        ins.bindValue(qs(":da"),  t.danceability);
-        ins.bindValue(qs(":yr"),  t.year);
-        ins.bindValue(qs(":rt"),  t.rating);
-        ins.bindValue(qs(":cm"),  nn(t.comments));
-        ins.bindValue(qs(":li"),  t.legacyImported ? 1 : 0);
-        if (!ins.exec()) {
-            qWarning().noquote() << qs("DjLibraryDatabase::bulkInsert row") << i << ins.lastError().text();
+    q.bindValue(qs(":tid"), trackId);
+    q.bindValue(qs(":fp"),  nn(t.filePath));
+    q.bindValue(qs(":dn"),  nn(t.displayName));
+    q.bindValue(qs(":ti"),  nn(t.title));
+    q.bindValue(qs(":ar"),  nn(t.artist));
+    q.bindValue(qs(":al"),  nn(t.album));
+    q.bindValue(qs(":ge"),  nn(t.genre));
+    q.bindValue(qs(":dm"),  static_cast<qint64>(t.durationMs));
+    q.bindValue(qs(":ds"),  nn(t.durationStr));
+    q.bindValue(qs(":bp"),  nn(t.bpm));
+    q.bindValue(qs(":mk"),  nn(t.musicalKey));
+    q.bindValue(qs(":ck"),  nn(t.camelotKey));
+    q.bindValue(qs(":en"),  t.energy);
+    q.bindValue(qs(":ll"),  t.loudnessLUFS);
+    q.bindValue(qs(":fs"),  static_cast<qint64>(t.fileSize));
+    q.bindValue(qs(":ci"),  nn(t.cueIn));
+    q.bindValue(qs(":co"),  nn(t.cueOut));
+    q.bindValue(qs(":da"),  t.danceability);
+    q.bindValue(qs(":yr"),  t.year);
+    q.bindValue(qs(":rt"),  t.rating);
+    q.bindValue(qs(":cm"),  nn(t.comments));
+    q.bindValue(qs(":li"),  t.legacyImported ? 1 : 0);
+    bindTyped(q, t.bpm, t.camelotKey, t.cueIn, t.cueOut);
+    q.bindValue(qs(":mt"),  static_cast<qint64>(t.modifiedMs));
+    q.bindValue(qs(":sg"),  signature);
+    q.bindValue(qs(":pk"),  pathKey(t.filePath));
+    q.bindValue(qs(":lr"),  t.loudnessRange);
+    q.bindValue(qs(":ac"),  t.acousticness);
+    q.bindValue(qs(":in"),  t.instrumentalness);
+    q.bindValue(qs(":lv"),  t.liveness);
+    q.bindValue(qs(":ch"),  static_cast<qint64>(t.contentHash));
+}
+
+bool DjLibraryDatabase::syncTracks(const std::vector<TrackInfo>& tracks,
+                                   std::vector<qint64>& outIds, SyncStats* stats)
+{
+    return applyTracks(tracks, outIds, stats, true);
+}
+
+bool DjLibraryDatabase::mergeTracks(const std::vector<TrackInfo>& tracks,
+                                    std::vector<qint64>& outIds, SyncStats* stats)
+{
+    return applyTracks(tracks, outIds, stats, false);
+}
+
+bool DjLibraryDatabase::applyTracks(const std::vector<TrackInfo>& tracks,
+                                    std::vector<qint64>& outIds, SyncStats* stats,
+                                    bool removeMissing)
+{
+    outIds.assign(tracks.size(), -1);
+    if (!open_) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    SyncStats st;
+
+    // ── Stored rows, by normalized path ──────────────────────────────────
+    struct Stored {
+        qint64 id{-1};
+        qint64 sig{0};
+        qint64 size{0};
+        qint64 mtime{0};
+        qint64 hash{0};
+        bool   claimed{false};
+    };
+    std::vector<Stored> stored;
+    QHash<QString, QList<int>> byPath;
+    qint64 nextId = 0;
+    auto addStored = [&](const QSqlQuery& q) {
+        Stored r;
+        r.id    = q.value(0).toLongLong();
+        r.sig   = q.value(2).toLongLong();
+        r.size  = q.value(3).toLongLong();
+        r.mtime = q.value(4).toLongLong();
+        r.hash  = q.value(5).toLongLong();
+        nextId  = std::max(nextId, r.id + 1);
+        byPath[q.value(1).toString()].append(static_cast<int>(stored.size()));
+        stored.push_back(r);
+    };
+
+    if (removeMissing) {
+        // Whole table in one sequential read, no per-row queries.
+        QSqlQuery sel(db_);
+        sel.setForwardOnly(true);
+        if (!sel.exec(qs("SELECT track_id, path_key, row_sig, file_size, file_mtime, content_hash"
+                         " FROM library_tracks ORDER BY track_id;"))) {
+            qWarning().noquote() << qs("DjLibraryDatabase::syncTracks read FAIL") << sel.lastError().text();
+            return false;
         }
+        while (sel.next()) addStored(sel);
+    } else {
+        // Only the paths in this batch, through idx_lib_path_key.
+        QSqlQuery top(db_);
+        if (top.exec(qs("SELECT MAX(track_id) FROM library_tracks;")) && top.next()
+                && !top.value(0).isNull())
+            nextId = top.value(0).toLongLong() + 1;
+
+        QSqlQuery look(db_);
+        look.setForwardOnly(true);
+        look.prepare(qs("SELECT track_id, path_key, row_sig, file_size, file_mtime, content_hash"
+                        " FROM library_tracks WHERE path_key = :pk ORDER BY track_id;"));
+        QSet<QString> seen;
+        for (const TrackInfo& t : tracks) {
+            const QString key = pathKey(t.filePath);
+            if (seen.contains(key)) continue;
+            seen.insert(key);
+            look.bindValue(qs(":pk"), key);
+            if (!look.exec()) continue;
+            while (look.next()) addStored(look);
+        }
+    }
+
+    // ── Match incoming tracks ────────────────────────────────────────────
+    // By path first.  A track whose path is new is then taken as a moved or
+    // renamed file, keeping its id, if
+    //   - its audio content hash equals that of an unclaimed row (full
+    //     sync) or of a row whose file no longer exists (merge), or
+    //   - (full sync) its size and mtime equal those of an unclaimed row.
+    std::vector<int> match(tracks.size(), -1);
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        auto it = byPath.find(pathKey(tracks[i].filePath));
+        if (it == byPath.end() || it->isEmpty()) continue;
+        match[i] = it->takeFirst();
+        stored[static_cast<size_t>(match[i])].claimed = true;
+    }
+
+    std::vector<bool> moved(tracks.size(), false);
+    auto claimFrom = [&](size_t i, QList<int>& candidates) {
+        match[i] = candidates.takeFirst();
+        stored[static_cast<size_t>(match[i])].claimed = true;
+        moved[i] = true;
+    };
+
+    QHash<qint64, QList<int>> byHash;
+    if (removeMissing) {
+        for (int r = 0; r < static_cast<int>(stored.size()); ++r) {
+            const Stored& row = stored[static_cast<size_t>(r)];
+            if (!row.claimed && row.hash != 0) byHash[row.hash].append(r);
+        }
+    } else {
+        // Rows outside this batch with the same content, only if their file
+        // is gone: a second copy of a track is a track of its own.
+        QSqlQuery byContent(db_);
+        byContent.setForwardOnly(true);
+        byContent.prepare(qs("SELECT track_id, path_key, row_sig, file_size, file_mtime, content_hash,"
+                             "       file_path"
+                             " FROM library_tracks WHERE content_hash = :ch ORDER BY track_id;"));
+        QSet<qint64> looked;
+        QSet<qint64> known;
+        for (const Stored& row : stored) known.insert(row.id);
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            const qint64 hash = static_cast<qint64>(tracks[i].contentHash);
+            if (match[i] >= 0 || hash == 0 || looked.contains(hash)) continue;
+            looked.insert(hash);
+            byContent.bindValue(qs(":ch"), hash);
+            if (!byContent.exec()) continue;
+            while (byContent.next()) {
+                const qint64 id = byContent.value(0).toLongLong();
+                if (known.contains(id) || QFileInfo::exists(byContent.value(6).toString())) continue;
+                known.insert(id);
+                addStored(byContent);
+                byHash[hash].append(static_cast<int>(stored.size()) - 1);
+            }
+        }
+    }
+    if (!byHash.isEmpty()) {
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            if (match[i] >= 0 || tracks[i].contentHash == 0) continue;
+            auto it = byHash.find(static_cast<qint64>(tracks[i].contentHash));
+            if (it == byHash.end() || it->isEmpty()) continue;
+            claimFrom(i, *it);
+        }
+    }
+
+    QHash<QPair<qint64, qint64>, QList<int>> bySizeTime;
+    for (int r = 0; removeMissing && r < static_cast<int>(stored.size()); ++r) {
+        const Stored& row = stored[static_cast<size_t>(r)];
+        if (!row.claimed && row.mtime > 0 && row.size > 0)
+            bySizeTime[qMakePair(row.size, row.mtime)].append(r);
+    }
+    if (!bySizeTime.isEmpty()) {
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            const TrackInfo& t = tracks[i];
+            if (match[i] >= 0 || t.modifiedMs <= 0) continue;
+            auto it = bySizeTime.find(qMakePair(static_cast<qint64>(t.fileSize), t.modifiedMs));
+            if (it == bySizeTime.end() || it->isEmpty()) continue;
+            claimFrom(i, *it);
+        }
+    }
+
+    // ── Apply the difference in one transaction ──────────────────────────
+    db_.transaction();
+
+    QSqlQuery write(db_);
+    write.prepare(qs(kRowInsert));
+
+    // Analysis written by the batch analyzer lives only in this table; keep
+    // it for rows whose incoming TrackInfo carries no analysis of its own.
+    QSqlQuery carry(db_);
+    carry.prepare(qs(
+        "SELECT bpm, musical_key, camelot_key, energy, loudness_lufs,"
+        "       cue_in, cue_out, danceability"
+        " FROM library_tracks"
+        " WHERE track_id = :tid AND bpm <> '' AND camelot_key <> '';"));
+
+    QSqlQuery del(db_);
+    del.prepare(qs("DELETE FROM library_tracks WHERE track_id = :tid;"));
+    QSqlQuery delItems(db_);
+    delItems.prepare(qs("DELETE FROM playlist_items WHERE track_id = :tid;"));
+    QSqlQuery delPrint(db_);
+    delPrint.prepare(qs("DELETE FROM track_fingerprints WHERE track_id = :tid;"));
+
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const qint64 sig = rowSignature(tracks[i]);
+        qint64 id = -1;
+        if (match[i] >= 0) {
+            const Stored& row = stored[static_cast<size_t>(match[i])];
+            id = row.id;
+            outIds[i] = id;
+            if (row.sig == sig) { ++st.unchanged; continue; }
+            ++st.updated;
+            if (moved[i]) ++st.moved;
+        } else {
+            id = nextId++;
+            outIds[i] = id;
+            ++st.inserted;
+        }
+
+        TrackInfo t = tracks[i];
+        if (match[i] >= 0 && t.bpm.isEmpty() && t.camelotKey.isEmpty()) {
+            carry.bindValue(qs(":tid"), id);
+            if (carry.exec() && carry.next()) {
+                t.bpm          = carry.value(0).toString();
+                t.musicalKey   = carry.value(1).toString();
+                t.camelotKey   = carry.value(2).toString();
+                t.energy       = carry.value(3).toDouble();
+                t.loudnessLUFS = carry.value(4).toDouble();
+                t.cueIn        = carry.value(5).toString();
+                t.cueOut       = carry.value(6).toString();
+                t.danceability = carry.value(7).toDouble();
+            }
+            carry.finish();
+        }
+        // The signature is of the incoming track, so an unchanged rescan
+        // still matches after analysis was carried over.
+        bindRow(write, id, t, sig);
+        if (!write.exec()) {
+            qWarning().noquote() << qs("DjLibraryDatabase::syncTracks row") << id << write.lastError().text();
+        }
+    }
+
+    for (const Stored& row : stored) {
+        if (row.claimed || !removeMissing) continue;
+        del.bindValue(qs(":tid"), row.id);
+        if (del.exec()) ++st.deleted;
+        delItems.bindValue(qs(":tid"), row.id);
+        delItems.exec();
+        delPrint.bindValue(qs(":tid"), row.id);
+        delPrint.exec();
     }
 
     const bool ok = db_.commit();
-    qInfo().noquote() << qs("DjLibraryDatabase::bulkInsert inserted=") << tracks.size() << qs("ok=") << ok;
+    if (st.inserted || st.updated || st.deleted) ++dataVersion_;
+    st.ms = static_cast<double>(timer.nsecsElapsed()) / 1.0e6;
+    if (stats) *stats = st;
+
+    qInfo().noquote() << QStringLiteral("[LIB_SYNC] %9 tracks=%1 inserted=%2 updated=%3 moved=%4"
+                                        " deleted=%5 unchanged=%6 ms=%7 ok=%8")
+                             .arg(tracks.size()).arg(st.inserted).arg(st.updated).arg(st.moved)
+                             .arg(st.deleted).arg(st.unchanged)
+                             .arg(st.ms, 0, 'f', 1).arg(ok ? 1 : 0)
+                             .arg(removeMissing ? qs("sync") : qs("merge"));
     return ok;
 }
 
@@ -163,40 +772,9 @@ bool DjLibraryDatabase::upsertTrack(qint64 trackId, const TrackInfo& t)
 {
     if (!open_) return false;
     QSqlQuery q(db_);
-    q.prepare(qs(
-        "INSERT OR REPLACE INTO library_tracks "
-        "(track_id, file_path, display_name, title, artist, album, genre,"
-        " duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
-        " loudness_lufs, file_size, cue_in, cue_out, danceability,"
-        " year_tag, rating, comments, legacy_imported)"
-        " VALUES "
-        "(:tid, :fp, :dn, :ti, :ar, :al, :ge,"
-        " :dm, :ds, :bp, :mk, :ck, :en,"
-        " :ll, :fs, :ci, :co, :da,"
-        " :yr, :rt, :cm, :li);"
-    ));
-    q.bindValue(qs(":tid"), trackId);
-    q.bindValue(qs(":fp"),  t.filePath);
-    q.bindValue(qs(":dn"),  t.displayName);
-    q.bindValue(qs(":ti"),  t.title);
-    q.bindValue(qs(":ar"),  t.artist);
-    q.bindValue(qs(":al"),  t.album);
-    q.bindValue(qs(":ge"),  t.genre);
-    q.bindValue(qs(":dm"),  static_cast<qint64>(t.durationMs));
-    q.bindValue(qs(":ds"),  t.durationStr);
-    q.bindValue(qs(":bp"),  t.bpm);
-    q.bindValue(qs(":mk"),  t.musicalKey);
-    q.bindValue(qs(":ck"),  t.camelotKey);
-    q.bindValue(qs(":en"),  t.energy);
-    q.bindValue(qs(":ll"),  t.loudnessLUFS);
-    q.bindValue(qs(":fs"),  static_cast<qint64>(t.fileSize));
-    q.bindValue(qs(":ci"),  t.cueIn);
-    q.bindValue(qs(":co"),  t.cueOut);
-    q.bindValue(qs(":da"),  t.danceability);
-    q.bindValue(qs(":yr"),  t.year);
-    q.bindValue(qs(":rt"),  t.rating);
-    q.bindValue(qs(":cm"),  t.comments);
-    q.bindValue(qs(":li"),  t.legacyImported ? 1 : 0);
+    q.prepare(qs(kRowInsert));
+    bindRow(q, trackId, t, rowSignature(t));
+    ++dataVersion_;
     return q.exec();
 }
 
@@ -206,42 +784,170 @@ bool DjLibraryDatabase::deleteTrack(qint64 trackId)
     QSqlQuery q(db_);
     q.prepare(qs("DELETE FROM library_tracks WHERE track_id = :tid;"));
     q.bindValue(qs(":tid"), trackId);
+    ++dataVersion_;
+    if (!q.exec()) return false;
+    q.prepare(qs("DELETE FROM playlist_items WHERE track_id = :tid;"));
+    q.bindValue(qs(":tid"), trackId);
+    if (!q.exec()) return false;
+    q.prepare(qs("DELETE FROM track_fingerprints WHERE track_id = :tid;"));
+    q.bindValue(qs(":tid"), trackId);
     return q.exec();
 }
 
+bool DjLibraryDatabase::deleteTracks(const std::vector<qint64>& trackIds)
+{
+    if (!open_) return false;
+    if (trackIds.empty()) return true;
+
+    if (!db_.transaction()) {
+        qWarning().noquote() << qs("DjLibraryDatabase::deleteTracks BEGIN FAIL")
+                             << db_.lastError().text();
+        return false;
+    }
+    for (qint64 id : trackIds) {
+        if (!deleteTrack(id)) {
+            qWarning().noquote() << qs("DjLibraryDatabase::deleteTracks row") << id;
+            db_.rollback();
+            return false;
+        }
+    }
+    return db_.commit();
+}
+
+bool DjLibraryDatabase::applyAnalysisBatch(const std::vector<AnalysisUpdate>& updates)
+{
+    if (!open_) return false;
+    if (updates.empty()) return true;
+
+    if (!db_.transaction()) {
+        qWarning().noquote() << qs("DjLibraryDatabase::applyAnalysisBatch BEGIN FAIL")
+                             << db_.lastError().text();
+        return false;
+    }
+
+    QSqlQuery q(db_);
+    q.prepare(qs(
+        "UPDATE library_tracks SET"
+        " bpm = :bp, musical_key = :mk, camelot_key = :ck, energy = :en,"
+        " loudness_lufs = :ll, cue_in = :ci, cue_out = :co, danceability = :da,"
+        " bpm_x100 = :bx, camelot_num = :kn, camelot_mode = :km,"
+        " cue_in_ms = :cim, cue_out_ms = :com"
+        " WHERE track_id = :tid;"
+    ));
+
+    QSqlQuery fp(db_);
+    fp.prepare(qs(
+        "INSERT OR REPLACE INTO track_fingerprints (track_id, version, landmarks, sketch, sample)"
+        " VALUES (:tid, :v, :n, :sk, :sa);"
+    ));
+
+    auto nn = [](const QString& s) -> QString {
+        return s.isNull() ? QLatin1String("") : s;
+    };
+    auto blob = [](const std::vector<uint8_t>& b) {
+        return QByteArray(reinterpret_cast<const char*>(b.data()), static_cast<qsizetype>(b.size()));
+    };
+
+    for (const AnalysisUpdate& u : updates) {
+        q.bindValue(qs(":bp"),  nn(u.bpm));
+        q.bindValue(qs(":mk"),  nn(u.musicalKey));
+        q.bindValue(qs(":ck"),  nn(u.camelotKey));
+        q.bindValue(qs(":en"),  u.energy);
+        q.bindValue(qs(":ll"),  u.loudnessLUFS);
+        q.bindValue(qs(":ci"),  nn(u.cueIn));
+        q.bindValue(qs(":co"),  nn(u.cueOut));
+        q.bindValue(qs(":da"),  u.danceability);
+        bindTyped(q, u.bpm, u.camelotKey, u.cueIn, u.cueOut);
+        q.bindValue(qs(":tid"), u.trackId);
+        if (!q.exec()) {
+            qWarning().noquote() << qs("DjLibraryDatabase::applyAnalysisBatch row")
+                                 << u.trackId << q.lastError().text();
+            db_.rollback();
+            return false;
+        }
+
+        if (u.fingerprint.empty()) continue;
+        fp.bindValue(qs(":tid"), u.trackId);
+        fp.bindValue(qs(":v"),   static_cast<int>(AudioFingerprint::kVersion));
+        fp.bindValue(qs(":n"),   static_cast<qint64>(u.fingerprint.landmarks));
+        fp.bindValue(qs(":sk"),  blob(AudioFingerprint::encodeSketch(u.fingerprint.sketch)));
+        fp.bindValue(qs(":sa"),  blob(u.fingerprint.encode()));
+        if (!fp.exec()) {
+            qWarning().noquote() << qs("DjLibraryDatabase::applyAnalysisBatch fingerprint")
+                                 << u.trackId << fp.lastError().text();
+            db_.rollback();
+            return false;
+        }
+    }
+
+    ++dataVersion_;
+    return db_.commit();
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Private query helpers
 // ─────────────────────────────────────────────────────────────────────────────
-QString DjLibraryDatabase::sortOrderClause(int sortCol) const
+QStringList DjLibraryDatabase::sortKeyExprs(int sortCol)
 {
     switch (sortCol) {
-    case 1:  return qs("artist   COLLATE NOCASE ASC,  display_name COLLATE NOCASE ASC");
-    case 2:  return qs("album    COLLATE NOCASE ASC,  display_name COLLATE NOCASE ASC");
-    case 3:  return qs("duration_ms ASC");
-    case 4:  return qs("CAST(bpm AS REAL) ASC");
-    case 5:  return qs("musical_key COLLATE NOCASE ASC");
-    default: return qs("display_name COLLATE NOCASE ASC");
+    case 1:  return { qs("artist COLLATE NOCASE"), qs("display_name COLLATE NOCASE") };
+    case 2:  return { qs("album COLLATE NOCASE"),  qs("display_name COLLATE NOCASE") };
+    case 3:  return { qs("duration_ms") };
+    case 4:  return { qs("bpm_x100") };
+    case 5:  return { qs("musical_key COLLATE NOCASE") };
+    case kSortPlaylistOrder: return { qs("pl_pos") };
+    default: return { qs("display_name COLLATE NOCASE") };
     }
 }
 
+QString DjLibraryDatabase::sortOrderClause(int sortCol) const
+{
+    // track_id makes the order total, which keyset paging relies on.
+    QStringList parts;
+    for (const QString& e : sortKeyExprs(sortCol)) parts << e + qs(" ASC");
+    parts << qs("track_id ASC");
+    return parts.join(qs(", "));
+}
+
+QString DjLibraryDatabase::keyTupleExpr(int sortCol)
+{
+    QStringList parts = sortKeyExprs(sortCol);
+    parts << qs("track_id");
+    return QLatin1Char('(') + parts.join(qs(", ")) + QLatin1Char(')');
+}
+
+int DjLibraryDatabase::effectiveSortCol(int sortCol, qint64 playlistId)
+{
+    // Playlist order only exists inside a playlist; elsewhere it is by name.
+    return (sortCol == kSortPlaylistOrder && playlistId <= 0) ? 0 : sortCol;
+}
+
+QString DjLibraryDatabase::fromClause(qint64 playlistId)
+{
+    // A playlist is an indexed join on (playlist_id, position); the derived
+    // table renames its columns so track_id stays unambiguous and pl_pos is
+    // there to sort on.  SQLite flattens it into a plain join.
+    if (playlistId <= 0) return qs("library_tracks");
+    return qs("library_tracks JOIN ("
+              "  SELECT track_id AS pl_track, position AS pl_pos"
+              "  FROM playlist_items WHERE playlist_id = :plid"
+              ") ON track_id = pl_track");
+}
+
 QString DjLibraryDatabase::buildWhereClause(const QString& search,
                                              int searchMode,
-                                             const QStringList& playlistPaths,
+                                             qint64 playlistId,
                                              QStringList& outBindNames,
-                                             QVariantList& outBindValues) const
+                                             QVariantList& outBindValues,
+                                             QString* outFtsMatch) const
 {
     QStringList clauses;
 
-    // ── playlist filter ──
-    if (!playlistPaths.isEmpty()) {
-        QStringList holders;
-        for (int i = 0; i < playlistPaths.size(); ++i) {
-            const QString name = QStringLiteral(":pl%1").arg(i);
-            holders << name;
-            outBindNames << name;
-            outBindValues << playlistPaths[i];
-        }
-        clauses << QStringLiteral("file_path IN (%1)").arg(holders.join(QLatin1Char(',')));
+    // ── playlist ──
+    // Membership is the join in fromClause(); only its id is bound here.
+    if (playlistId > 0) {
+        outBindNames << qs(":plid");
+        outBindValues << playlistId;
     }
 
     // ── text search ──
@@ -267,15 +973,17 @@ QString DjLibraryDatabase::buildWhereClause(const QString& search,
                 const double lo = search.left(dash).trimmed().toDouble(&okLo);
                 const double hi = search.mid(dash + 1).trimmed().toDouble(&okHi);
                 if (okLo && okHi) {
-                    clauses << qs("CAST(bpm AS REAL) BETWEEN :blo AND :bhi");
+                    clauses << qs("bpm_x100 BETWEEN :blo AND :bhi");
                     outBindNames << qs(":blo") << qs(":bhi");
-                    outBindValues << lo << hi;
+                    outBindValues << qRound(lo * 100.0) << qRound(hi * 100.0);
                 }
             } else {
                 const double target = search.toDouble(&okLo);
                 if (okLo) {
-                    clauses << qs("ABS(CAST(bpm AS REAL) - :bt) < 1.0");
-                    outBindNames << qs(":bt"); outBindValues << target;
+                    // |bpm - target| < 1, as an index range
+                    clauses << qs("bpm_x100 > :blo AND bpm_x100 < :bhi");
+                    outBindNames << qs(":blo") << qs(":bhi");
+                    outBindValues << qRound((target - 1.0) * 100.0) << qRound((target + 1.0) * 100.0);
                 }
             }
             break;
@@ -315,7 +1023,17 @@ QString DjLibraryDatabase::buildWhereClause(const QString& search,
             }
             break;
         }
-        default: // all fields (mode 5)
+        default: { // all fields (mode 5)
+            const QString match = (fts_ && ftsEnabled_) ? ftsMatchExpression(search) : QString();
+            if (!match.isEmpty()) {
+                if (outFtsMatch) {
+                    *outFtsMatch = match;      // caller joins library_fts for ranking
+                } else {
+                    clauses << qs("track_id IN (SELECT rowid FROM library_fts WHERE library_fts MATCH :fq)");
+                    outBindNames << qs(":fq"); outBindValues << match;
+                }
+                break;
+            }
             clauses << qs(
                 "(display_name LIKE :sq ESCAPE '\\'"
                 " OR title LIKE :sq ESCAPE '\\'"
@@ -329,6 +1047,7 @@ QString DjLibraryDatabase::buildWhereClause(const QString& search,
             outBindNames << qs(":sq"); outBindValues << like;
             break;
         }
+        }
     }
 
     if (clauses.isEmpty()) return qs("1=1");
@@ -363,17 +1082,23 @@ DjLibraryDatabase::Row DjLibraryDatabase::rowFromQuery(const QSqlQuery& q)
     r.info.rating        = q.value(19).toInt();
     r.info.comments      = q.value(20).toString();
     r.info.legacyImported = q.value(21).toInt() != 0;
+    r.info.modifiedMs    = q.value(22).toLongLong();
+    r.info.loudnessRange = q.value(23).toDouble();
+    r.info.acousticness  = q.value(24).toDouble();
+    r.info.instrumentalness = q.value(25).toDouble();
+    r.info.liveness      = q.value(26).toDouble();
+    r.info.contentHash   = static_cast<quint64>(q.value(27).toLongLong());
     return r;
 }
 
 int DjLibraryDatabase::queryCount(const QString& search, int searchMode,
-                                   const QStringList& playlistPaths) const
+                                   qint64 playlistId) const
 {
     if (!open_) return 0;
     QStringList names; QVariantList vals;
-    const QString where = buildWhereClause(search.toLower(), searchMode, playlistPaths, names, vals);
+    const QString where = buildWhereClause(search.toLower(), searchMode, playlistId, names, vals);
     QSqlQuery q(db_);
-    q.prepare(QStringLiteral("SELECT COUNT(*) FROM library_tracks WHERE %1;").arg(where));
+    q.prepare(QStringLiteral("SELECT COUNT(*) FROM %1 WHERE %2;").arg(fromClause(playlistId), where));
     for (int i = 0; i < names.size(); ++i) q.bindValue(names[i], vals[i]);
     if (!q.exec() || !q.next()) return 0;
     return q.value(0).toInt();
@@ -381,25 +1106,43 @@ int DjLibraryDatabase::queryCount(const QString& search, int searchMode,
 
 std::vector<DjLibraryDatabase::Row>
 DjLibraryDatabase::queryPage(const QString& search, int searchMode,
-                              const QStringList& playlistPaths,
+                              qint64 playlistId,
                               int sortCol, int offset, int limit) const
 {
     std::vector<Row> result;
     if (!open_) return result;
 
+    // Relevance order needs the bm25 score, so the FTS match becomes a join
+    // instead of an IN filter.  Column weights favour title and artist.
+    sortCol = effectiveSortCol(sortCol, playlistId);
     QStringList names; QVariantList vals;
-    const QString where = buildWhereClause(search.toLower(), searchMode, playlistPaths, names, vals);
-    const QString order = sortOrderClause(sortCol);
+    QString ftsMatch;
+    const bool byRelevance = (sortCol == kSortRelevance);
+    const QString where = buildWhereClause(search.toLower(), searchMode, playlistId, names, vals,
+                                           byRelevance ? &ftsMatch : nullptr);
+    QString from  = fromClause(playlistId);
+    QString order = sortOrderClause(sortCol);
+    if (!ftsMatch.isEmpty()) {
+        from += qs(
+            " JOIN ("
+            "  SELECT rowid AS fts_id,"
+            "         bm25(library_fts, 4.0, 10.0, 8.0, 4.0, 2.0, 1.0, 1.0, 1.0) AS fts_rank"
+            "  FROM library_fts WHERE library_fts MATCH :fq"
+            ") ON track_id = fts_id");
+        order = qs("fts_rank ASC, display_name COLLATE NOCASE ASC");
+    }
 
     QSqlQuery q(db_);
     q.prepare(QStringLiteral(
         "SELECT track_id, file_path, display_name, title, artist, album, genre,"
         "       duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
         "       loudness_lufs, file_size, cue_in, cue_out, danceability,"
-        "       year_tag, rating, comments, legacy_imported"
-        " FROM library_tracks WHERE %1 ORDER BY %2 LIMIT :lim OFFSET :off;"
-    ).arg(where, order));
+        "       year_tag, rating, comments, legacy_imported,"
+        "       file_mtime, loudness_range, acousticness, instrumentalness, liveness, content_hash"
+        " FROM %1 WHERE %2 ORDER BY %3 LIMIT :lim OFFSET :off;"
+    ).arg(from, where, order));
 
+    if (!ftsMatch.isEmpty()) q.bindValue(qs(":fq"), ftsMatch);
     for (int i = 0; i < names.size(); ++i) q.bindValue(names[i], vals[i]);
     q.bindValue(qs(":lim"), limit);
     q.bindValue(qs(":off"), offset);
@@ -412,6 +1155,562 @@ DjLibraryDatabase::queryPage(const QString& search, int searchMode,
     return result;
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// Keyset paging
+// ─────────────────────────────────────────────────────────────────────────────
+bool DjLibraryDatabase::supportsKeyset(int sortCol)
+{
+    // bm25 rank is computed per query and has no index to seek on.
+    return sortCol != kSortRelevance;
+}
+
+std::vector<DjLibraryDatabase::SortKey>
+DjLibraryDatabase::queryAnchors(const QString& search, int searchMode,
+                                qint64 playlistId,
+                                int sortCol, int stride) const
+{
+    std::vector<SortKey> result;
+    if (!open_ || stride <= 0 || !supportsKeyset(sortCol)) return result;
+
+    sortCol = effectiveSortCol(sortCol, playlistId);
+    QStringList names; QVariantList vals;
+    const QString where = buildWhereClause(search.toLower(), searchMode, playlistId, names, vals);
+    const QStringList keys = sortKeyExprs(sortCol);
+
+    QStringList inner, outer;
+    for (int i = 0; i < keys.size(); ++i) {
+        inner << QStringLiteral("%1 AS k%2").arg(keys[i]).arg(i);
+        outer << QStringLiteral("k%1").arg(i);
+    }
+
+    // One pass over the sorted result; only the key columns of every
+    // stride-th row leave SQLite.
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    q.prepare(QStringLiteral(
+        "SELECT %1, track_id FROM ("
+        "  SELECT %2, track_id, row_number() OVER (ORDER BY %3) AS rn"
+        "  FROM %4 WHERE %5"
+        ") WHERE (rn - 1) % :stride = 0 ORDER BY rn;"
+    ).arg(outer.join(qs(", ")), inner.join(qs(", ")), sortOrderClause(sortCol),
+          fromClause(playlistId), where));
+    for (int i = 0; i < names.size(); ++i) q.bindValue(names[i], vals[i]);
+    q.bindValue(qs(":stride"), stride);
+
+    if (!q.exec()) {
+        qWarning().noquote() << qs("DjLibraryDatabase::queryAnchors FAIL") << q.lastError().text();
+        return result;
+    }
+    const int n = static_cast<int>(keys.size());
+    while (q.next()) {
+        SortKey k;
+        for (int i = 0; i < n; ++i) k.values << q.value(i);
+        k.trackId = q.value(n).toLongLong();
+        result.push_back(std::move(k));
+    }
+    return result;
+}
+
+std::vector<DjLibraryDatabase::Row>
+DjLibraryDatabase::queryPageFrom(const QString& search, int searchMode,
+                                 qint64 playlistId,
+                                 int sortCol, const SortKey& from, int limit) const
+{
+    std::vector<Row> result;
+    if (!open_ || !supportsKeyset(sortCol)) return result;
+
+    sortCol = effectiveSortCol(sortCol, playlistId);
+    QStringList names; QVariantList vals;
+    const QString where = buildWhereClause(search.toLower(), searchMode, playlistId, names, vals);
+
+    QStringList holders;
+    for (int i = 0; i < from.values.size(); ++i) holders << QStringLiteral(":kv%1").arg(i);
+    holders << qs(":kid");
+
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    q.prepare(QStringLiteral(
+        "SELECT track_id, file_path, display_name, title, artist, album, genre,"
+        "       duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
+        "       loudness_lufs, file_size, cue_in, cue_out, danceability,"
+        "       year_tag, rating, comments, legacy_imported,"
+        "       file_mtime, loudness_range, acousticness, instrumentalness, liveness, content_hash"
+        " FROM %1 WHERE (%2) AND %3 >= (%4) ORDER BY %5 LIMIT :lim;"
+    ).arg(fromClause(playlistId), where, keyTupleExpr(sortCol), holders.join(qs(", ")),
+          sortOrderClause(sortCol)));
+
+    for (int i = 0; i < names.size(); ++i) q.bindValue(names[i], vals[i]);
+    for (int i = 0; i < from.values.size(); ++i)
+        q.bindValue(QStringLiteral(":kv%1").arg(i), from.values[i]);
+    q.bindValue(qs(":kid"), from.trackId);
+    q.bindValue(qs(":lim"), limit);
+
+    if (!q.exec()) {
+        qWarning().noquote() << qs("DjLibraryDatabase::queryPageFrom FAIL") << q.lastError().text();
+        return result;
+    }
+    while (q.next()) result.push_back(rowFromQuery(q));
+    return result;
+}
+
+std::vector<DjLibraryDatabase::Row>
+DjLibraryDatabase::queryPageAt(const QString& search, int searchMode,
+                               qint64 playlistId,
+                               int sortCol, int pageIndex, int pageSize,
+                               std::vector<SortKey>& anchors) const
+{
+    // Page 0 and unseekable orders: plain LIMIT/OFFSET.
+    if (pageIndex == 0 || !supportsKeyset(sortCol)) {
+        return queryPage(search, searchMode, playlistId,
+                         sortCol, pageIndex * pageSize, pageSize);
+    }
+    if (anchors.empty())
+        anchors = queryAnchors(search, searchMode, playlistId, sortCol, pageSize);
+    if (pageIndex >= static_cast<int>(anchors.size())) return {};
+    return queryPageFrom(search, searchMode, playlistId, sortCol,
+                         anchors[static_cast<size_t>(pageIndex)], pageSize);
+}
+
+int DjLibraryDatabase::queryRowOf(const QString& search, int searchMode,
+                                  qint64 playlistId,
+                                  int sortCol, qint64 trackId) const
+{
+    if (!open_ || !supportsKeyset(sortCol)) return -1;
+
+    sortCol = effectiveSortCol(sortCol, playlistId);
+    QStringList names; QVariantList vals;
+    const QString where = buildWhereClause(search.toLower(), searchMode, playlistId, names, vals);
+    const QString tuple = keyTupleExpr(sortCol);
+
+    // Position = rows of the filtered set that sort before the track,
+    // provided the track itself passes the filter.
+    QSqlQuery q(db_);
+    q.prepare(QStringLiteral(
+        "SELECT CASE WHEN EXISTS (SELECT 1 FROM %4 WHERE (%1) AND track_id = :pid)"
+        "  THEN (SELECT COUNT(*) FROM %4 WHERE (%1) AND %2 <"
+        "        (SELECT %3 FROM %4 WHERE track_id = :pid))"
+        "  ELSE -1 END;"
+    ).arg(where, tuple, tuple.mid(1, tuple.size() - 2), fromClause(playlistId)));
+    for (int i = 0; i < names.size(); ++i) q.bindValue(names[i], vals[i]);
+    q.bindValue(qs(":pid"), trackId);
+    if (!q.exec() || !q.next()) return -1;
+    return q.value(0).toInt();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Playlists
+// ─────────────────────────────────────────────────────────────────────────────
+std::vector<DjLibraryDatabase::PlaylistInfo> DjLibraryDatabase::playlists() const
+{
+    std::vector<PlaylistInfo> result;
+    if (!open_) return result;
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    if (!q.exec(qs(
+        "SELECT p.playlist_id, p.name,"
+        "       (SELECT COUNT(*) FROM playlist_items i WHERE i.playlist_id = p.playlist_id)"
+        " FROM playlists p ORDER BY p.playlist_id;"))) {
+        qWarning().noquote() << qs("DjLibraryDatabase::playlists FAIL") << q.lastError().text();
+        return result;
+    }
+    while (q.next())
+        result.push_back({q.value(0).toLongLong(), q.value(1).toString(), q.value(2).toInt()});
+    return result;
+}
+
+qint64 DjLibraryDatabase::createPlaylist(const QString& name)
+{
+    if (!open_) return -1;
+    QSqlQuery q(db_);
+    q.prepare(qs("INSERT INTO playlists (name, created_ms) VALUES (:n, :c);"));
+    q.bindValue(qs(":n"), name.isNull() ? QLatin1String("") : name);
+    q.bindValue(qs(":c"), QDateTime::currentMSecsSinceEpoch());
+    if (!q.exec()) {
+        qWarning().noquote() << qs("DjLibraryDatabase::createPlaylist FAIL") << q.lastError().text();
+        return -1;
+    }
+    ++dataVersion_;
+    return q.lastInsertId().toLongLong();
+}
+
+bool DjLibraryDatabase::renamePlaylist(qint64 playlistId, const QString& name)
+{
+    if (!open_) return false;
+    QSqlQuery q(db_);
+    q.prepare(qs("UPDATE playlists SET name = :n WHERE playlist_id = :p;"));
+    q.bindValue(qs(":n"), name.isNull() ? QLatin1String("") : name);
+    q.bindValue(qs(":p"), playlistId);
+    return q.exec() && q.numRowsAffected() > 0;
+}
+
+bool DjLibraryDatabase::deletePlaylist(qint64 playlistId)
+{
+    if (!open_) return false;
+    db_.transaction();
+    QSqlQuery q(db_);
+    q.prepare(qs("DELETE FROM playlist_items WHERE playlist_id = :p;"));
+    q.bindValue(qs(":p"), playlistId);
+    q.exec();
+    q.prepare(qs("DELETE FROM playlists WHERE playlist_id = :p;"));
+    q.bindValue(qs(":p"), playlistId);
+    q.exec();
+    ++dataVersion_;
+    return db_.commit();
+}
+
+int DjLibraryDatabase::addToPlaylist(qint64 playlistId, const std::vector<qint64>& trackIds)
+{
+    if (!open_ || trackIds.empty()) return 0;
+
+    QSqlQuery last(db_);
+    last.prepare(qs("SELECT MAX(position) FROM playlist_items WHERE playlist_id = :p;"));
+    last.bindValue(qs(":p"), playlistId);
+    qint64 next = 0;
+    if (last.exec() && last.next() && !last.value(0).isNull())
+        next = last.value(0).toLongLong() + kPlaylistGap;
+
+    db_.transaction();
+    QSqlQuery ins(db_);
+    ins.prepare(qs("INSERT OR IGNORE INTO playlist_items (playlist_id, track_id, position)"
+                   " VALUES (:p, :t, :pos);"));
+    int added = 0;
+    for (qint64 trackId : trackIds) {
+        ins.bindValue(qs(":p"),   playlistId);
+        ins.bindValue(qs(":t"),   trackId);
+        ins.bindValue(qs(":pos"), next);
+        if (ins.exec() && ins.numRowsAffected() > 0) {
+            next += kPlaylistGap;
+            ++added;
+        }
+    }
+    db_.commit();
+    if (added) ++dataVersion_;
+    return added;
+}
+
+bool DjLibraryDatabase::removeFromPlaylist(qint64 playlistId, qint64 trackId)
+{
+    if (!open_) return false;
+    QSqlQuery q(db_);
+    q.prepare(qs("DELETE FROM playlist_items WHERE playlist_id = :p AND track_id = :t;"));
+    q.bindValue(qs(":p"), playlistId);
+    q.bindValue(qs(":t"), trackId);
+    if (!q.exec() || q.numRowsAffected() == 0) return false;
+    ++dataVersion_;
+    return true;
+}
+
+bool DjLibraryDatabase::movePlaylistItem(qint64 playlistId, qint64 trackId, qint64 beforeTrackId)
+{
+    if (!open_ || trackId == beforeTrackId) return false;
+
+    auto positionOf = [this, playlistId](qint64 tid, qint64& pos) {
+        QSqlQuery q(db_);
+        q.prepare(qs("SELECT position FROM playlist_items WHERE playlist_id = :p AND track_id = :t;"));
+        q.bindValue(qs(":p"), playlistId);
+        q.bindValue(qs(":t"), tid);
+        if (!q.exec() || !q.next()) return false;
+        pos = q.value(0).toLongLong();
+        return true;
+    };
+    // Nearest position below `below` (any, if below is unset), not
+    // counting the item being moved.  Walks the primary key backwards.
+    auto predecessor = [this, playlistId, trackId](const std::optional<qint64>& below, qint64& pos) {
+        QSqlQuery q(db_);
+        q.prepare(below ? qs("SELECT MAX(position) FROM playlist_items"
+                             " WHERE playlist_id = :p AND position < :b AND track_id <> :t;")
+                        : qs("SELECT MAX(position) FROM playlist_items"
+                             " WHERE playlist_id = :p AND track_id <> :t;"));
+        q.bindValue(qs(":p"), playlistId);
+        q.bindValue(qs(":t"), trackId);
+        if (below) q.bindValue(qs(":b"), *below);
+        if (!q.exec() || !q.next() || q.value(0).isNull()) return false;
+        pos = q.value(0).toLongLong();
+        return true;
+    };
+
+    qint64 current = 0;
+    if (!positionOf(trackId, current)) return false;
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        qint64 target = 0;
+        if (beforeTrackId > 0) {
+            qint64 hi = 0, lo = 0;
+            if (!positionOf(beforeTrackId, hi)) return false;
+            if (!predecessor(hi, lo)) {
+                target = hi - kPlaylistGap;             // new first item
+            } else if (hi - lo >= 2) {
+                target = lo + (hi - lo) / 2;
+            } else {
+                renumberPlaylist(playlistId);           // gap used up
+                continue;
+            }
+        } else {
+            qint64 lo = 0;
+            target = predecessor(std::nullopt, lo) ? lo + kPlaylistGap : 0;
+        }
+
+        QSqlQuery up(db_);
+        up.prepare(qs("UPDATE playlist_items SET position = :pos"
+                      " WHERE playlist_id = :p AND track_id = :t;"));
+        up.bindValue(qs(":pos"), target);
+        up.bindValue(qs(":p"),   playlistId);
+        up.bindValue(qs(":t"),   trackId);
+        if (!up.exec()) {
+            qWarning().noquote() << qs("DjLibraryDatabase::movePlaylistItem FAIL") << up.lastError().text();
+            return false;
+        }
+        ++dataVersion_;
+        return true;
+    }
+    return false;
+}
+
+bool DjLibraryDatabase::renumberPlaylist(qint64 playlistId)
+{
+    const std::vector<qint64> ids = playlistTrackIds(playlistId);
+    db_.transaction();
+    QSqlQuery q(db_);
+    q.prepare(qs("DELETE FROM playlist_items WHERE playlist_id = :p;"));
+    q.bindValue(qs(":p"), playlistId);
+    q.exec();
+    q.prepare(qs("INSERT INTO playlist_items (playlist_id, track_id, position) VALUES (:p, :t, :pos);"));
+    for (size_t i = 0; i < ids.size(); ++i) {
+        q.bindValue(qs(":p"),   playlistId);
+        q.bindValue(qs(":t"),   ids[i]);
+        q.bindValue(qs(":pos"), static_cast<qint64>(i) * kPlaylistGap);
+        q.exec();
+    }
+    const bool ok = db_.commit();
+    qInfo().noquote() << QStringLiteral("[PLAYLIST] renumbered id=%1 items=%2 ok=%3")
+                             .arg(playlistId).arg(ids.size()).arg(ok ? 1 : 0);
+    return ok;
+}
+
+std::vector<qint64> DjLibraryDatabase::playlistTrackIds(qint64 playlistId) const
+{
+    std::vector<qint64> result;
+    if (!open_) return result;
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    q.prepare(qs("SELECT track_id FROM playlist_items WHERE playlist_id = :p ORDER BY position;"));
+    q.bindValue(qs(":p"), playlistId);
+    if (!q.exec()) return result;
+    while (q.next()) result.push_back(q.value(0).toLongLong());
+    return result;
+}
+
+int DjLibraryDatabase::importPlaylists(const std::vector<Playlist>& playlists)
+{
+    if (!open_) return 0;
+    QSqlQuery find(db_);
+    find.prepare(qs("SELECT track_id FROM library_tracks WHERE path_key = :pk LIMIT 1;"));
+
+    int unmatched = 0;
+    for (const Playlist& pl : playlists) {
+        const qint64 id = createPlaylist(pl.name);
+        if (id < 0) continue;
+        std::vector<qint64> trackIds;
+        trackIds.reserve(static_cast<size_t>(pl.trackPaths.size()));
+        for (const QString& path : pl.trackPaths) {
+            find.bindValue(qs(":pk"), pathKey(path));
+            if (find.exec() && find.next()) trackIds.push_back(find.value(0).toLongLong());
+            else ++unmatched;
+        }
+        addToPlaylist(id, trackIds);
+    }
+    qInfo().noquote() << QStringLiteral("[PLAYLIST] imported playlists=%1 unmatched_paths=%2")
+                             .arg(playlists.size()).arg(unmatched);
+    return unmatched;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Harmonic mixing
+// ─────────────────────────────────────────────────────────────────────────────
+std::vector<DjLibraryDatabase::Row>
+DjLibraryDatabase::queryCompatible(const CompatibleFilter& f) const
+{
+    std::vector<Row> result;
+    if (!open_) return result;
+
+    const int target = bpmToFixed(QString::number(f.bpm, 'f', 2));
+    int num = 0, mode = 0;
+    if (target <= 0 || !parseCamelot(f.camelotKey, num, mode)) return result;
+
+    // Camelot neighbours: same key, ±1 on the wheel, relative major/minor.
+    const int prev = (num + 10) % 12 + 1;
+    const int next = num % 12 + 1;
+    const int keys[4][2] = { { num, mode }, { prev, mode }, { next, mode }, { num, 1 - mode } };
+
+    // Tempo windows: the track's own, plus half/double time when asked.
+    struct Window { int centre, lo, hi; };
+    std::vector<Window> windows;
+    auto addWindow = [&](double centre) {
+        windows.push_back({ static_cast<int>(centre + 0.5),
+                            static_cast<int>(centre * (1.0 - f.bpmTolerancePct / 100.0)),
+                            static_cast<int>(centre * (1.0 + f.bpmTolerancePct / 100.0) + 0.5) });
+    };
+    addWindow(target);
+    if (f.halfDoubleTempo) {
+        addWindow(target * 0.5);
+        addWindow(target * 2.0);
+    }
+
+    // One arm per (key, window): each is a single idx_lib_camelot_bpm range
+    // (camelot_num = ? AND camelot_mode = ? AND bpm_x100 BETWEEN ? AND ?).
+    // An OR over the keys and windows would only bind the key columns and
+    // scan each key's whole bucket.  dist is the distance to the centre of
+    // the arm's own window, so half/double-time matches rank by how close
+    // they are to their tempo, not last.
+    QStringList arms;
+    for (int k = 0; k < 4; ++k) {
+        for (size_t w = 0; w < windows.size(); ++w) {
+            arms << QStringLiteral(
+                "SELECT track_id, file_path, display_name, title, artist, album, genre,"
+                "       duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
+                "       loudness_lufs, file_size, cue_in, cue_out, danceability,"
+                "       year_tag, rating, comments, legacy_imported,"
+                "       file_mtime, loudness_range, acousticness, instrumentalness, liveness, content_hash,"
+                "       %1 AS same_key, ABS(bpm_x100 - :c%2) AS dist"
+                " FROM library_tracks"
+                " WHERE camelot_num = :kn%2 AND camelot_mode = :km%2"
+                "   AND bpm_x100 BETWEEN :bl%2 AND :bh%2 AND track_id <> :ex%2"
+            ).arg(k == 0 ? 1 : 0).arg(arms.size());
+        }
+    }
+
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    q.prepare(arms.join(qs(" UNION ALL "))
+              + qs(" ORDER BY same_key DESC, dist ASC, track_id ASC LIMIT :lim;"));
+
+    int arm = 0;
+    for (int k = 0; k < 4; ++k) {
+        for (const Window& w : windows) {
+            q.bindValue(QStringLiteral(":c%1").arg(arm),  w.centre);
+            q.bindValue(QStringLiteral(":kn%1").arg(arm), keys[k][0]);
+            q.bindValue(QStringLiteral(":km%1").arg(arm), keys[k][1]);
+            q.bindValue(QStringLiteral(":bl%1").arg(arm), w.lo);
+            q.bindValue(QStringLiteral(":bh%1").arg(arm), w.hi);
+            q.bindValue(QStringLiteral(":ex%1").arg(arm), f.excludeTrackId);
+            ++arm;
+        }
+    }
+    q.bindValue(qs(":lim"), f.limit);
+
+    if (!q.exec()) {
+        qWarning().noquote() << qs("DjLibraryDatabase::queryCompatible FAIL") << q.lastError().text();
+        return result;
+    }
+    // Windows overlap only at very wide tolerances; keep a track's best arm.
+    QSet<qint64> seen;
+    while (q.next()) {
+        if (seen.contains(q.value(0).toLongLong())) continue;
+        seen.insert(q.value(0).toLongLong());
+        result.push_back(rowFromQuery(q));
+    }
+    return result;
+}
+
+std::vector<DjLibraryDatabase::Row>
+DjLibraryDatabase::queryCompatibleWith(const QString& filePath, double bpmTolerancePct,
+                                       int limit, bool halfDoubleTempo) const
+{
+    if (!open_) return {};
+    QSqlQuery q(db_);
+    q.prepare(qs("SELECT track_id, bpm_x100, camelot_key FROM library_tracks"
+                 " WHERE file_path = :fp LIMIT 1;"));
+    q.bindValue(qs(":fp"), filePath);
+    if (!q.exec() || !q.next()) return {};
+
+    CompatibleFilter f;
+    f.excludeTrackId  = q.value(0).toLongLong();
+    f.bpm             = q.value(1).toInt() / 100.0;
+    f.camelotKey      = q.value(2).toString();
+    f.bpmTolerancePct = bpmTolerancePct;
+    f.halfDoubleTempo = halfDoubleTempo;
+    f.limit           = limit;
+    return queryCompatible(f);
+}
+
+std::vector<DjLibraryDatabase::Row> DjLibraryDatabase::allRows() const
+{
+    std::vector<Row> result;
+    if (!open_) return result;
+
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    if (!q.exec(qs(
+        "SELECT track_id, file_path, display_name, title, artist, album, genre,"
+        "       duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
+        "       loudness_lufs, file_size, cue_in, cue_out, danceability,"
+        "       year_tag, rating, comments, legacy_imported,"
+        "       file_mtime, loudness_range, acousticness, instrumentalness, liveness, content_hash"
+        " FROM library_tracks ORDER BY track_id;"))) {
+        qWarning().noquote() << qs("DjLibraryDatabase::allRows FAIL") << q.lastError().text();
+        return result;
+    }
+    while (q.next()) result.push_back(rowFromQuery(q));
+    return result;
+}
+
+bool DjLibraryDatabase::loadTracks(std::vector<TrackInfo>& tracks, std::vector<qint64>& ids) const
+{
+    tracks.clear();
+    ids.clear();
+    if (!open_) return false;
+
+    QSqlQuery count(db_);
+    if (count.exec(qs("SELECT COUNT(*) FROM library_tracks;")) && count.next()) {
+        const size_t n = static_cast<size_t>(count.value(0).toLongLong());
+        tracks.reserve(n);
+        ids.reserve(n);
+    }
+
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    if (!q.exec(qs(
+        "SELECT track_id, file_path, display_name, title, artist, album, genre,"
+        "       duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
+        "       loudness_lufs, file_size, cue_in, cue_out, danceability,"
+        "       year_tag, rating, comments, legacy_imported,"
+        "       file_mtime, loudness_range, acousticness, instrumentalness, liveness, content_hash"
+        " FROM library_tracks ORDER BY track_id;"))) {
+        qWarning().noquote() << qs("DjLibraryDatabase::loadTracks FAIL") << q.lastError().text();
+        return false;
+    }
+    while (q.next()) {
+        Row r = rowFromQuery(q);
+        ids.push_back(r.trackId);
+        tracks.push_back(std::move(r.info));
+    }
+    return true;
+}
+
+QString DjLibraryDatabase::metaValue(const QString& key) const
+{
+    if (!open_) return {};
+    QSqlQuery q(db_);
+    q.prepare(qs("SELECT value FROM library_meta WHERE key = :k;"));
+    q.bindValue(qs(":k"), key);
+    if (!q.exec() || !q.next()) return {};
+    return q.value(0).toString();
+}
+
+bool DjLibraryDatabase::setMetaValue(const QString& key, const QString& value)
+{
+    if (!open_) return false;
+    QSqlQuery q(db_);
+    q.prepare(qs("INSERT OR REPLACE INTO library_meta (key, value) VALUES (:k, :v);"));
+    q.bindValue(qs(":k"), key);
+    q.bindValue(qs(":v"), value.isNull() ? QLatin1String("") : value);
+    if (!q.exec()) {
+        qWarning().noquote() << qs("DjLibraryDatabase::setMetaValue FAIL") << key << q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 std::optional<TrackInfo> DjLibraryDatabase::trackById(qint64 trackId) const
 {
     if (!open_) return std::nullopt;
@@ -420,7 +1719,8 @@ std::optional<TrackInfo> DjLibraryDatabase::trackById(qint64 trackId) const
         "SELECT track_id, file_path, display_name, title, artist, album, genre,"
         "       duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
         "       loudness_lufs, file_size, cue_in, cue_out, danceability,"
-        "       year_tag, rating, comments, legacy_imported"
+        "       year_tag, rating, comments, legacy_imported,"
+        "       file_mtime, loudness_range, acousticness, instrumentalness, liveness, content_hash"
         " FROM library_tracks WHERE track_id = :tid LIMIT 1;"
     ));
     q.bindValue(qs(":tid"), trackId);
@@ -436,7 +1736,8 @@ std::optional<TrackInfo> DjLibraryDatabase::trackByPath(const QString& path) con
         "SELECT track_id, file_path, display_name, title, artist, album, genre,"
         "       duration_ms, duration_str, bpm, musical_key, camelot_key, energy,"
         "       loudness_lufs, file_size, cue_in, cue_out, danceability,"
-        "       year_tag, rating, comments, legacy_imported"
+        "       year_tag, rating, comments, legacy_imported,"
+        "       file_mtime, loudness_range, acousticness, instrumentalness, liveness, content_hash"
         " FROM library_tracks WHERE file_path = :fp LIMIT 1;"
     ));
     q.bindValue(qs(":fp"), path);
@@ -444,6 +1745,19 @@ std::optional<TrackInfo> DjLibraryDatabase::trackByPath(const QString& path) con
     return rowFromQuery(q).info;
 }
 
+std::vector<qint64> DjLibraryDatabase::trackIdsByContentHash(quint64 contentHash) const
+{
+    std::vector<qint64> ids;
+    if (!open_ || contentHash == 0) return ids;
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    q.prepare(qs("SELECT track_id FROM library_tracks WHERE content_hash = :ch ORDER BY track_id;"));
+    q.bindValue(qs(":ch"), static_cast<qint64>(contentHash));
+    if (!q.exec()) return ids;
+    while (q.next()) ids.push_back(q.value(0).toLongLong());
+    return ids;
+}
+
 int DjLibraryDatabase::totalCount() const
 {
     if (!open_) return 0;
@@ -451,3 +1765,137 @@ int DjLibraryDatabase::totalCount() const
     if (!q.exec(qs("SELECT COUNT(*) FROM library_tracks;")) || !q.next()) return 0;
     return q.value(0).toInt();
 }
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Acoustic fingerprints
+// ─────────────────────────────────────────────────────────────────────────────
+// Below this many sampled landmarks on either side the sample overlap is
+// noisier than the sketch estimate, which is kept instead.
+static constexpr size_t kMinExactSample = 32;
+
+const FingerprintIndex& DjLibraryDatabase::fingerprintIndex() const
+{
+    if (fpIndexValid_ && fpIndexVersion_ == dataVersion_) return fpIndex_;
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<FingerprintIndex::Entry> entries;
+    if (open_) {
+        QSqlQuery q(db_);
+        q.setForwardOnly(true);
+        q.prepare(qs("SELECT f.track_id, t.duration_ms, f.landmarks, f.sketch"
+                     " FROM track_fingerprints f"
+                     " JOIN library_tracks t ON t.track_id = f.track_id"
+                     " WHERE f.version = :v;"));
+        q.bindValue(qs(":v"), static_cast<int>(AudioFingerprint::kVersion));
+        if (q.exec()) {
+            while (q.next()) {
+                FingerprintIndex::Entry e;
+                e.trackId    = q.value(0).toLongLong();
+                e.durationMs = q.value(1).toLongLong();
+                e.landmarks  = static_cast<uint32_t>(q.value(2).toLongLong());
+                const QByteArray sk = q.value(3).toByteArray();
+                if (!AudioFingerprint::decodeSketch(reinterpret_cast<const uint8_t*>(sk.constData()),
+                                                    static_cast<size_t>(sk.size()), e.sketch))
+                    continue;
+                entries.push_back(e);
+            }
+        } else {
+            qWarning().noquote() << qs("DjLibraryDatabase::fingerprintIndex") << q.lastError().text();
+        }
+    }
+    fpIndex_.build(std::move(entries));
+    fpIndexVersion_ = dataVersion_;
+    fpIndexValid_   = true;
+
+    qInfo().noquote() << QStringLiteral("[LIB_FINGERPRINT] index tracks=%1 ms=%2")
+                             .arg(fpIndex_.size()).arg(timer.elapsed());
+    return fpIndex_;
+}
+
+std::vector<FingerprintIndex::Match>
+DjLibraryDatabase::querySimilar(qint64 trackId, double minContainment, int limit) const
+{
+    const FingerprintIndex& index = fingerprintIndex();
+    const FingerprintIndex::Entry* self = index.find(trackId);
+    if (!self) return {};
+
+    // Sketch estimates are good to about ±0.05, so cast a wider net and
+    // settle each candidate on the stored samples.
+    std::vector<FingerprintIndex::Match> matches = index.similarTo(trackId, minContainment * 0.5);
+
+    QSqlQuery q(db_);
+    q.prepare(qs("SELECT sample FROM track_fingerprints WHERE track_id = :tid AND version = :v;"));
+    auto loadSample = [&](qint64 id, AudioFingerprint& out) {
+        q.bindValue(qs(":tid"), id);
+        q.bindValue(qs(":v"), static_cast<int>(AudioFingerprint::kVersion));
+        if (!q.exec() || !q.next()) return false;
+        const QByteArray sa = q.value(0).toByteArray();
+        return AudioFingerprint::decode(reinterpret_cast<const uint8_t*>(sa.constData()),
+                                        static_cast<size_t>(sa.size()), out)
+            && out.hashes.size() >= kMinExactSample;
+    };
+
+    AudioFingerprint own;
+    if (loadSample(trackId, own)) {
+        for (FingerprintIndex::Match& m : matches) {
+            AudioFingerprint other;
+            const FingerprintIndex::Entry* e = index.find(m.trackId);
+            if (!e || !loadSample(m.trackId, other)) continue;
+            const AudioFingerprint::Overlap o = AudioFingerprint::compare(own, other);
+            m.jaccard     = o.jaccard;
+            m.containment = o.containment;
+            m.kind        = FingerprintIndex::classify(o.containment, *self, *e);
+        }
+    }
+
+    matches.erase(std::remove_if(matches.begin(), matches.end(),
+                                 [&](const FingerprintIndex::Match& m) {
+                                     return m.containment < minContainment;
+                                 }),
+                  matches.end());
+    std::sort(matches.begin(), matches.end(),
+              [](const FingerprintIndex::Match& a, const FingerprintIndex::Match& b) {
+                  return a.containment > b.containment
+                      || (a.containment == b.containment && a.trackId < b.trackId);
+              });
+    if (limit > 0 && matches.size() > static_cast<size_t>(limit))
+        matches.resize(static_cast<size_t>(limit));
+    return matches;
+}
+
+std::vector<FingerprintIndex::Group>
+DjLibraryDatabase::querySimilarGroups(Resemblance loosest, double minContainment) const
+{
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<FingerprintIndex::Group> groups =
+        fingerprintIndex().groups(loosest, minContainment);
+    qInfo().noquote() << QStringLiteral("[LIB_FINGERPRINT] groups=%1 loosest=%2 ms=%3")
+                             .arg(groups.size()).arg(static_cast<int>(loosest))
+                             .arg(timer.elapsed());
+    return groups;
+}
+
+int DjLibraryDatabase::fingerprintCount() const
+{
+    if (!open_) return 0;
+    QSqlQuery q(db_);
+    q.prepare(qs("SELECT COUNT(*) FROM track_fingerprints WHERE version = :v;"));
+    q.bindValue(qs(":v"), static_cast<int>(AudioFingerprint::kVersion));
+    if (!q.exec() || !q.next()) return 0;
+    return q.value(0).toInt();
+}
+
+std::vector<qint64> DjLibraryDatabase::fingerprintedTrackIds() const
+{
+    std::vector<qint64> ids;
+    if (!open_) return ids;
+    QSqlQuery q(db_);
+    q.setForwardOnly(true);
+    q.prepare(qs("SELECT track_id FROM track_fingerprints WHERE version = :v ORDER BY track_id;"));
+    q.bindValue(qs(":v"), static_cast<int>(AudioFingerprint::kVersion));
+    if (!q.exec()) return ids;
+    while (q.next()) ids.push_back(q.value(0).toLongLong());
+    return ids;
+}
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "ui/library/FingerprintIndex.h"
 #include "ui/library/LibraryPersistence.h"
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QString>
 #include <QStringList>
 
@@ -13,11 +15,30 @@
 // DjLibraryDatabase
 //
 // SQLite-backed store for the DJ library.  track_id is the integer primary key
-// assigned during bulkInsert (equal to the insertion index).  It is the sole
-// stable identifier for a track across the DB→model→view pipeline.
+// assigned when syncTracks first sees a file and kept for as long as the file
+// stays in the library (across restores, rescans and imports, and across
+// renames and moves, which are recognised by the audio content hash).  It is
+// the sole stable identifier for a track across the DB→model→view pipeline.
+// The table carries every TrackInfo field and is what startup restores the
+// library from (loadTracks); nothing is rebuilt from library.json.
 //
-// The display model (DjLibraryModel) always reads from SQLite with LIMIT/OFFSET
-// paging — the full dataset is never held in widget items or a shadow vector.
+// The display model (DjLibraryModel) always reads from SQLite in pages — keyset
+// seeks where the sort order allows, LIMIT/OFFSET otherwise — so the full
+// dataset is never held in widget items or a shadow vector.
+//
+// The "all fields" search runs against an FTS5 index (library_fts) that
+// triggers keep in step with library_tracks: every query token must match as
+// a word prefix, case and diacritics are folded.  Builds of SQLite without
+// FTS5 fall back to LIKE scans.
+//
+// bpm, camelot_key and the cue points are display strings; typed mirrors
+// (bpm_x100, camelot_num/camelot_mode, cue_in_ms/cue_out_ms) are written with
+// them and carry BPM ordering, range filters and harmonic-mixing queries on
+// indexes.
+//
+// Acoustic fingerprints written by the batch analyzer live in
+// track_fingerprints; duplicate and version queries run against an in-memory
+// FingerprintIndex over their sketches.
 // ─────────────────────────────────────────────────────────────────────────────
 class DjLibraryDatabase {
 public:
@@ -35,54 +56,294 @@ public:
     bool open(const QString& dbPath);
     void close();
     bool isOpen() const { return open_; }
+    const QString& path() const { return path_; }
 
     // ── Write ──────────────────────────────────────────────────────────────
-    // Replaces entire library: drops all rows and re-inserts.
-    // track_id for row i = i  (= allTracks_ index).
-    bool bulkInsert(const std::vector<TrackInfo>& tracks);
+    // Brings the table in line with `tracks` (the allTracks_ vector) by
+    // difference: rows are matched by normalized path, or — for a path not
+    // in the table — by the audio content hash, then by size + mtime, of an
+    // otherwise unmatched row (a moved file).  Matched rows keep their
+    // track_id (and with it their playlist entries) and are rewritten only if
+    // rowSignature() changed; new tracks get fresh ids; unmatched rows are
+    // deleted.  One transaction, prepared statements.  outIds[i] is the
+    // track_id of tracks[i].
+    // Tracks arriving without bpm/key keep the analysis columns previously
+    // stored for their row (batch analyzer results).
+    struct SyncStats {
+        int    inserted{0};
+        int    updated{0};     // includes moved
+        int    moved{0};
+        int    deleted{0};
+        int    unchanged{0};
+        double ms{0.0};
+    };
+    bool syncTracks(const std::vector<TrackInfo>& tracks,
+                    std::vector<qint64>& outIds,
+                    SyncStats* stats = nullptr);
+
+    // Same matching for a subset of the library (scanner batches, watched
+    // paths): inserts and updates only — rows not in `tracks` are left alone.
+    // A new path takes over the row of a track with the same content hash
+    // whose file no longer exists, so a moved folder streamed in by the
+    // scanner keeps its ids; size + mtime matching needs the full table and
+    // is left to syncTracks.
+    bool mergeTracks(const std::vector<TrackInfo>& tracks,
+                     std::vector<qint64>& outIds,
+                     SyncStats* stats = nullptr);
+
+    // Path as matched by syncTracks (clean, '/' separators, case-folded on
+    // Windows).
+    static QString pathKey(const QString& filePath);
+    // Stable 64-bit hash of every persisted TrackInfo field.
+    static qint64 rowSignature(const TrackInfo& t);
 
     // Upsert a single track (track_id must be valid).
     bool upsertTrack(qint64 trackId, const TrackInfo& info);
 
     // Remove by track_id.
     bool deleteTrack(qint64 trackId);
+    // Several at once, in one transaction.
+    bool deleteTracks(const std::vector<qint64>& trackIds);
+
+    // Analysis columns for one track, written by the batch analyzer.
+    struct AnalysisUpdate {
+        qint64  trackId{-1};
+        QString bpm;
+        QString musicalKey;
+        QString camelotKey;
+        double  energy{-1.0};
+        double  loudnessLUFS{0.0};
+        QString cueIn;
+        QString cueOut;
+        double  danceability{-1.0};
+        AudioFingerprint fingerprint;     // empty = keep the stored one
+    };
+
+    // Applies all updates in one transaction; rolls back on any failure.
+    bool applyAnalysisBatch(const std::vector<AnalysisUpdate>& updates);
 
     // ── Read ───────────────────────────────────────────────────────────────
     // Total number of rows matching the given filter (no paging).
     int queryCount(const QString& search, int searchMode,
-                   const QStringList& playlistPaths) const;
+                   qint64 playlistId) const;
 
     // Paged result: offset + limit rows matching filter + sort.
     // sortCol codes match the library sort combo:
-    //   0=name, 1=artist, 2=album, 3=duration, 4=bpm, 5=key
+    //   0=name, 1=artist, 2=album, 3=duration, 4=bpm, 5=key,
+    //   6=relevance (best full-text match first; name order without a search)
+    //   7=playlist order (name order outside a playlist)
+    // playlistId restricts the rows to one playlist (kNoPlaylist = all).
+    static constexpr int    kSortRelevance     = 6;
+    static constexpr int    kSortPlaylistOrder = 7;
+    static constexpr qint64 kNoPlaylist        = 0;
     std::vector<Row> queryPage(const QString& search, int searchMode,
-                               const QStringList& playlistPaths,
+                               qint64 playlistId,
                                int sortCol,
                                int offset, int limit) const;
 
+    // ── Keyset paging ──────────────────────────────────────────────────────
+    // Seek-method alternative to queryPage's OFFSET: a page starts at a
+    // sort-key tuple, so its cost is independent of its depth.  The order
+    // is sortOrderClause(sortCol) with track_id as the final tie-breaker.
+
+    // Sort-key values of one row (one per sortKeyExprs entry) + track_id.
+    struct SortKey {
+        QVariantList values;
+        qint64       trackId{-1};
+    };
+
+    // False for orders without a seekable key (relevance).
+    static bool supportsKeyset(int sortCol);
+
+    // Keys of rows 0, stride, 2·stride, … of the filtered order, in one
+    // scan.  anchors[p] starts page p when stride is the page size.
+    std::vector<SortKey> queryAnchors(const QString& search, int searchMode,
+                                      qint64 playlistId,
+                                      int sortCol, int stride) const;
+
+    // Up to limit rows from `from` (inclusive) onwards.
+    std::vector<Row> queryPageFrom(const QString& search, int searchMode,
+                                   qint64 playlistId,
+                                   int sortCol, const SortKey& from, int limit) const;
+
+    // Page pageIndex of pageSize rows: keyset seek from `anchors`, which is
+    // filled by queryAnchors on first use and may be kept by the caller for
+    // later pages of the same filter/sort.
+    std::vector<Row> queryPageAt(const QString& search, int searchMode,
+                                 qint64 playlistId,
+                                 int sortCol, int pageIndex, int pageSize,
+                                 std::vector<SortKey>& anchors) const;
+
+    // Row index of trackId in the filtered order, -1 if filtered out.
+    int queryRowOf(const QString& search, int searchMode,
+                   qint64 playlistId,
+                   int sortCol, qint64 trackId) const;
+
+    // Bumped by every write; lets readers key caches on table contents.
+    quint64 dataVersion() const { return dataVersion_; }
+
     // Lookup by primary key.
     std::optional<TrackInfo> trackById(qint64 trackId) const;
 
     // Lookup by exact file path.
     std::optional<TrackInfo> trackByPath(const QString& path) const;
 
+    // Rows whose audio content hash is contentHash (idx_lib_content_hash),
+    // in track_id order.  More than one for duplicate copies.
+    std::vector<qint64> trackIdsByContentHash(quint64 contentHash) const;
+
+    // ── Acoustic fingerprints ──────────────────────────────────────────────
+    // Duplicates (re-encodes, trims, copies with other tags), edits (radio
+    // edit vs. extended mix) and versions sharing audio, found from the
+    // fingerprints alone — tags and file names play no part.  The index is
+    // built from the stored sketches on first use and again after any write
+    // (dataVersion), about a second for 40k tracks; lookups are then
+    // milliseconds.
+    using Resemblance = FingerprintIndex::Resemblance;
+
+    // Tracks sharing audio with trackId, most similar first.  Candidates
+    // come from the index; each is then scored on the stored landmark
+    // samples.  Empty if trackId has no current fingerprint.
+    std::vector<FingerprintIndex::Match> querySimilar(
+        qint64 trackId,
+        double minContainment = FingerprintIndex::kRelatedContainment,
+        int limit = 50) const;
+
+    // Library-wide groups linked by resemblances no looser than `loosest`
+    // (Duplicate = duplicates only), largest first.
+    std::vector<FingerprintIndex::Group> querySimilarGroups(
+        Resemblance loosest = Resemblance::Version,
+        double minContainment = FingerprintIndex::kRelatedContainment) const;
+
+    // Tracks with a fingerprint of the current AudioFingerprint::kVersion.
+    int fingerprintCount() const;
+    std::vector<qint64> fingerprintedTrackIds() const;
+
+    // ── Playlists ──────────────────────────────────────────────────────────
+    // Membership is (playlist_id, track_id, position) rows; positions are
+    // spaced kPlaylistGap apart so a move takes the midpoint between its new
+    // neighbours and touches one row.  Only when a gap is used up is the
+    // playlist renumbered.  Deleting a track drops it from every playlist.
+    static constexpr qint64 kPlaylistGap = 1024;
+
+    struct PlaylistInfo {
+        qint64  id{-1};
+        QString name;
+        int     trackCount{0};
+    };
+    std::vector<PlaylistInfo> playlists() const;      // creation order
+
+    qint64 createPlaylist(const QString& name);       // new id, -1 on failure
+    bool   renamePlaylist(qint64 playlistId, const QString& name);
+    bool   deletePlaylist(qint64 playlistId);
+
+    // Appends in the given order; tracks already in the playlist are
+    // skipped.  Returns the number added.
+    int    addToPlaylist(qint64 playlistId, const std::vector<qint64>& trackIds);
+    bool   removeFromPlaylist(qint64 playlistId, qint64 trackId);
+
+    // Moves trackId in front of beforeTrackId, or to the end for -1.
+    bool   movePlaylistItem(qint64 playlistId, qint64 trackId, qint64 beforeTrackId);
+
+    // Track ids in playlist order.
+    std::vector<qint64> playlistTrackIds(qint64 playlistId) const;
+
+    // Creates each playlist and resolves its paths to track ids (the
+    // one-time playlists.json import).  Returns how many paths were not
+    // in the library.
+    int    importPlaylists(const std::vector<Playlist>& playlists);
+
+    // ── Harmonic mixing ────────────────────────────────────────────────────
+    // Tracks within ±bpmTolerancePct of bpm whose Camelot key mixes with
+    // camelotKey (same, ±1 on the wheel, relative major/minor).  Same-key
+    // matches first, then by distance to the nearest tempo window centre
+    // (bpm, or ½× / 2× bpm with halfDoubleTempo).
+    struct CompatibleFilter {
+        double  bpm{0.0};
+        QString camelotKey;
+        double  bpmTolerancePct{6.0};
+        bool    halfDoubleTempo{false};   // also match at ½× and 2× tempo
+        int     limit{200};
+        qint64  excludeTrackId{-1};
+    };
+    std::vector<Row> queryCompatible(const CompatibleFilter& f) const;
+
+    // Same, using the stored analysis of the track at filePath (e.g. the
+    // track loaded on deck A).  Empty if it is not in the library.
+    std::vector<Row> queryCompatibleWith(const QString& filePath,
+                                         double bpmTolerancePct = 6.0,
+                                         int limit = 200,
+                                         bool halfDoubleTempo = false) const;
+
+    // ── Typed analysis values ──────────────────────────────────────────────
+    // Parsers for the typed mirrors of the text columns.
+    static int  bpmToFixed(const QString& bpm);                   // BPM × 100, 0 = unknown
+    static bool parseCamelot(const QString& key, int& number, int& mode);  // mode 0=A, 1=B
+    static int  cueToMs(const QString& cue);                      // -1 = unset
+
     // Total rows in the table (no filter).
     int totalCount() const;
 
+    // Every row in track_id order (batch jobs; not for the view).
+    std::vector<Row> allRows() const;
+
+    // The whole library in track_id order, as syncTracks last wrote it:
+    // tracks[i] has track_id ids[i].  The startup path (warm start).
+    bool loadTracks(std::vector<TrackInfo>& tracks, std::vector<qint64>& ids) const;
+
+    // ── Library state ──────────────────────────────────────────────────────
+    // Small key/value store next to the tracks (library root folder, the
+    // one-time library.json migration marker).  Empty if unset.
+    QString metaValue(const QString& key) const;
+    bool    setMetaValue(const QString& key, const QString& value);
+
+    // True when the full-text index is available.
+    bool hasFullTextIndex() const { return fts_; }
+
+    // Benchmarks only: route "all fields" search through the LIKE scan.
+    void setFullTextSearchEnabled(bool on) { ftsEnabled_ = on; }
+
     // The DB connection name used internally.
     const QString& connectionName() const { return connName_; }
 
 private:
     bool createSchema();
+    bool createFullTextIndex();
+    bool migrateColumns();
+    bool applyTracks(const std::vector<TrackInfo>& tracks, std::vector<qint64>& outIds,
+                     SyncStats* stats, bool removeMissing);
+    static void bindTyped(QSqlQuery& q, const QString& bpm, const QString& camelot,
+                          const QString& cueIn, const QString& cueOut);
+    static void bindRow(QSqlQuery& q, qint64 trackId, const TrackInfo& t, qint64 signature);
+    // With outFtsMatch set, an "all fields" FTS match is returned there for
+    // the caller to join instead of being added as a filter clause.
     QString buildWhereClause(const QString& search, int searchMode,
-                             const QStringList& playlistPaths,
+                             qint64 playlistId,
                              QStringList& outBindNames,
-                             QVariantList& outBindValues) const;
+                             QVariantList& outBindValues,
+                             QString* outFtsMatch = nullptr) const;
+    static QString ftsMatchExpression(const QString& search);
+    static int     effectiveSortCol(int sortCol, qint64 playlistId);
+    static QString fromClause(qint64 playlistId);   // table + playlist join
+    bool           renumberPlaylist(qint64 playlistId);
     QString sortOrderClause(int sortCol) const;
+    static QStringList sortKeyExprs(int sortCol);
+    static QString keyTupleExpr(int sortCol);   // "(k0, …, track_id)"
 
     static Row rowFromQuery(const QSqlQuery& q);
 
+    // Rebuilt lazily when dataVersion_ has moved on.
+    const FingerprintIndex& fingerprintIndex() const;
+
     QSqlDatabase db_;
     QString      connName_;
+    QString      path_;
     bool         open_{false};
+    bool         fts_{false};
+    bool         ftsEnabled_{true};
+    quint64      dataVersion_{0};
+
+    mutable FingerprintIndex fpIndex_;
+    mutable quint64          fpIndexVersion_{0};
+    mutable bool             fpIndexValid_{false};
 };
@@ -1,12 +1,55 @@
 #include "ui/library/DjLibraryModel.h"
 
+#include <QElapsedTimer>
 #include <QMimeData>
+#include <QSet>
 #include <QUrl>
+#include <QtDebug>
+
+#include <algorithm>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Helpers
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+// Drop least-recently-used entries until the cache fits.  Caches are a few
+// dozen entries, so a linear scan beats maintaining a separate list.
+template <typename Hash>
+void evictOldest(Hash& cache, int maxEntries)
+{
+    while (cache.size() > maxEntries) {
+        auto oldest = cache.begin();
+        for (auto it = cache.begin(); it != cache.end(); ++it)
+            if (it->lastUse < oldest->lastUse) oldest = it;
+        cache.erase(oldest);
+    }
+}
+
+// Adds the UI-thread time of one model entry point to the stall stats.
+class UiTimer {
+public:
+    explicit UiTimer(const DjLibraryModel* m, void (DjLibraryModel::*note)(double) const)
+        : model_(m), note_(note) { t_.start(); }
+    ~UiTimer() { (model_->*note_)(static_cast<double>(t_.nsecsElapsed()) / 1.0e6); }
+private:
+    const DjLibraryModel* model_;
+    void (DjLibraryModel::*note_)(double) const;
+    QElapsedTimer t_;
+};
+
+} // namespace
 
 // ─────────────────────────────────────────────────────────────────────────────
 DjLibraryModel::DjLibraryModel(DjLibraryDatabase* db, QObject* parent)
     : QAbstractTableModel(parent), db_(db)
-{}
+{
+    countDebounce_.setSingleShot(true);
+    countDebounce_.setInterval(kCountDebounceMs);
+    connect(&countDebounce_, &QTimer::timeout, this, [this]() {
+        if (!countKnown_ && executor_) executor_->requestCount(filterId_, currentQuery());
+    });
+}
 
 // ─────────────────────────────────────────────────────────────────────────────
 // QAbstractTableModel interface
@@ -14,7 +57,7 @@ DjLibraryModel::DjLibraryModel(DjLibraryDatabase* db, QObject* parent)
 int DjLibraryModel::rowCount(const QModelIndex& parent) const
 {
     if (parent.isValid()) return 0;
-    return rows_.size();
+    return totalCount_;
 }
 
 int DjLibraryModel::columnCount(const QModelIndex& parent) const
@@ -25,14 +68,14 @@ int DjLibraryModel::columnCount(const QModelIndex& parent) const
 
 QVariant DjLibraryModel::data(const QModelIndex& index, int role) const
 {
-    if (!index.isValid() || index.row() >= rows_.size()) return {};
-
-    const Row& r = rows_[index.row()];
+    if (!index.isValid()) return {};
 
-    if (role == Qt::UserRole) return r.trackId;
+    if (role == Qt::UserRole || role == Qt::DisplayRole) {
+        const Row* r = rowAt(index.row(), false);   // blank until the page arrives
+        if (!r) return {};
+        if (role == Qt::UserRole) return r->trackId;
 
-    if (role == Qt::DisplayRole) {
-        const TrackInfo& t = r.info;
+        const TrackInfo& t = r->info;
         switch (index.column()) {
         case 0: return t.displayName.isEmpty() ? QStringLiteral("Unknown") : t.displayName;
         case 1: return t.artist.isEmpty()      ? QStringLiteral("-")       : t.artist;
@@ -69,30 +112,145 @@ QVariant DjLibraryModel::headerData(int section, Qt::Orientation orientation, in
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-// Incremental loading
+// Paging
 // ─────────────────────────────────────────────────────────────────────────────
-bool DjLibraryModel::canFetchMore(const QModelIndex& parent) const
+const DjLibraryModel::Row* DjLibraryModel::rowAt(int row, bool wait) const
+{
+    if (row < 0 || row >= totalCount_) return nullptr;
+    const std::vector<Row>* p = page(row / kPageSize, wait);
+    const size_t i = static_cast<size_t>(row % kPageSize);
+    if (!p || i >= p->size()) return nullptr;
+    return &(*p)[i];
+}
+
+const std::vector<DjLibraryModel::Row>* DjLibraryModel::page(int pageIndex, bool wait) const
+{
+    const PageKey key{viewId_, pageIndex};
+    auto it = pages_.find(key);
+    if (it != pages_.end()) {
+        it->lastUse = ++useClock_;
+        return &it->rows;
+    }
+
+    if (executor_ && !wait) {
+        if (!pending_.contains(key)) {
+            pending_.insert(key);
+            executor_->requestPage(viewId_, currentQuery(), pageIndex);
+        }
+        return nullptr;
+    }
+
+    if (!db_) return nullptr;
+    UiTimer timer(this, &DjLibraryModel::noteUiTime);
+    ++uiStats_.syncPageLoads;
+
+    auto ait = anchors_.find(viewId_);
+    if (ait == anchors_.end()) {
+        anchors_.insert(viewId_, CachedAnchors{});
+        ait = anchors_.find(viewId_);
+    }
+    ait->lastUse = ++useClock_;
+    std::vector<Row> rows = db_->queryPageAt(search_, searchMode_, playlistId_, sortCol_,
+                                             pageIndex, kPageSize, ait->keys);
+    evictOldest(anchors_, kMaxViews);
+
+    storePage(key, std::move(rows));
+    it = pages_.find(key);
+    return it == pages_.end() ? nullptr : &it->rows;
+}
+
+void DjLibraryModel::storePage(const PageKey& key, std::vector<Row> rows) const
+{
+    CachedPage fresh;
+    fresh.rows    = std::move(rows);
+    fresh.lastUse = ++useClock_;
+    pages_.insert(key, std::move(fresh));
+    evictOldest(pages_, kMaxPages);
+}
+
+LibraryQueryExecutor::Query DjLibraryModel::currentQuery() const
 {
-    if (parent.isValid()) return false;
-    return rows_.size() < totalCount_;
+    LibraryQueryExecutor::Query q;
+    q.search        = search_;
+    q.searchMode    = searchMode_;
+    q.playlistId    = playlistId_;
+    q.sortCol       = sortCol_;
+    return q;
 }
 
-void DjLibraryModel::fetchMore(const QModelIndex& parent)
+void DjLibraryModel::setRowCount(int count)
 {
-    if (parent.isValid() || !db_) return;
-    if (rows_.size() >= totalCount_) return;
+    if (count > totalCount_) {
+        beginInsertRows({}, totalCount_, count - 1);
+        totalCount_ = count;
+        endInsertRows();
+    } else if (count < totalCount_) {
+        beginRemoveRows({}, count, totalCount_ - 1);
+        totalCount_ = count;
+        endRemoveRows();
+    }
+}
+
+void DjLibraryModel::onPageReady(quint64 viewId, int pageIndex,
+                                 const std::vector<Row>& rows, double queryMs)
+{
+    UiTimer timer(this, &DjLibraryModel::noteUiTime);
+    const PageKey key{viewId, pageIndex};
+    pending_.remove(key);
+    storePage(key, rows);   // superseded views keep theirs for a quick return
+    if (viewId != viewId_) return;
+
+    const int first = pageIndex * kPageSize;
+    const int n     = static_cast<int>(rows.size());
+
+    // First page before the count: a short page is the exact count, a full
+    // one shows its rows while the debounced count catches up.
+    if (pageIndex == 0 && !countKnown_) {
+        if (n < kPageSize) {
+            countKnown_ = true;
+            countDebounce_.stop();
+            CachedCount c;
+            c.count   = n;
+            c.lastUse = ++useClock_;
+            counts_.insert(filterId_, c);
+            evictOldest(counts_, kMaxViews);
+            setRowCount(n);
+            qInfo().noquote() << QStringLiteral("[LIB_ASYNC] count=%1 (first page) query_ms=%2 ui_max_ms=%3")
+                                     .arg(n).arg(queryMs, 0, 'f', 1).arg(uiStats_.maxMs, 0, 'f', 2);
+            if (n > 0) emit dataChanged(index(0, 0), index(n - 1, kColumns - 1));
+            return;
+        }
+        setRowCount(std::max(totalCount_, n));
+    }
+
+    const int last = std::min(first + n, totalCount_) - 1;
+    if (last >= first)
+        emit dataChanged(index(first, 0), index(last, kColumns - 1));
+}
 
-    const int offset = rows_.size();
-    const int toFetch = qMin(kPageSize, totalCount_ - offset);
-    if (toFetch <= 0) return;
+void DjLibraryModel::onCountReady(quint64 filterId, int count, double queryMs)
+{
+    UiTimer timer(this, &DjLibraryModel::noteUiTime);
+    CachedCount c;
+    c.count   = count;
+    c.lastUse = ++useClock_;
+    counts_.insert(filterId, c);
+    evictOldest(counts_, kMaxViews);
+    if (filterId != filterId_ || countKnown_) return;
 
-    auto page = db_->queryPage(search_, searchMode_, playlistPaths_,
-                               sortCol_, offset, toFetch);
-    if (page.empty()) return;
+    countKnown_ = true;
+    setRowCount(count);
+    qInfo().noquote() << QStringLiteral("[LIB_ASYNC] count=%1 query_ms=%2 ui_max_ms=%3 ui_total_ms=%4 sync_pages=%5")
+                             .arg(count).arg(queryMs, 0, 'f', 1)
+                             .arg(uiStats_.maxMs, 0, 'f', 2).arg(uiStats_.totalMs, 0, 'f', 1)
+                             .arg(uiStats_.syncPageLoads);
+}
 
-    beginInsertRows({}, rows_.size(), rows_.size() + static_cast<int>(page.size()) - 1);
-    for (auto& r : page) rows_.append({r.trackId, std::move(r.info)});
-    endInsertRows();
+void DjLibraryModel::noteUiTime(double ms) const
+{
+    ++uiStats_.events;
+    uiStats_.totalMs += ms;
+    uiStats_.maxMs    = std::max(uiStats_.maxMs, ms);
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -120,8 +278,7 @@ QMimeData* DjLibraryModel::mimeData(const QModelIndexList& indexes) const
             const qint64 tid  = trackIdAt(row);
             if (tid < 0) continue;
 
-            const QString filePath = (row >= 0 && row < rows_.size())
-                                     ? rows_[row].info.filePath : QString();
+            const QString filePath = trackInfoAt(row).filePath;
 
             auto* mime = new QMimeData();
             mime->setData(QString(kMimeType), QByteArray::number(tid));
@@ -148,20 +305,64 @@ void DjLibraryModel::setSortCol(int col)
     sortCol_ = col;
 }
 
-void DjLibraryModel::setPlaylistPaths(const QStringList& paths)
+void DjLibraryModel::setPlaylistId(qint64 playlistId)
+{
+    playlistId_ = playlistId;
+}
+
+// The worker opens its own connection to the DB file, so it can only start
+// once the DB is open; the window hands the model its DB before opening it.
+void DjLibraryModel::ensureExecutor()
 {
-    playlistPaths_ = paths;
+    if (executor_ || !db_ || !db_->isOpen() || db_->path().isEmpty()) return;
+    executor_ = new LibraryQueryExecutor(db_->path(), kPageSize, this);
+    connect(executor_, &LibraryQueryExecutor::pageReady, this, &DjLibraryModel::onPageReady);
+    connect(executor_, &LibraryQueryExecutor::countReady, this, &DjLibraryModel::onCountReady);
 }
 
 void DjLibraryModel::reload()
 {
+    UiTimer timer(this, &DjLibraryModel::noteUiTime);
+    ensureExecutor();
     beginResetModel();
-    rows_.clear();
-    totalCount_ = db_ ? db_->queryCount(search_, searchMode_, playlistPaths_) : 0;
-    endResetModel();
 
-    // Immediately populate the first page so the view isn't blank on load
-    if (totalCount_ > 0) fetchMore({});
+    // Identify the view.  The DB version retires every cache entry built
+    // before the last write.
+    const QString filterKey = QStringLiteral("%1\x1f%2\x1f%3\x1f%4")
+                                  .arg(db_ ? db_->dataVersion() : 0)
+                                  .arg(searchMode_)
+                                  .arg(playlistId_)
+                                  .arg(search_);
+    filterId_ = qHash(filterKey, 0x4e474b53u);
+    viewId_   = qHash(QString::number(sortCol_) + QChar(0x1f) + filterKey, 0x4e474b53u);
+    if (executor_) executor_->setCurrentView(viewId_);
+    pending_.clear();
+
+    // Row count depends on the filter only, so re-sorting reuses it.
+    auto it = counts_.find(filterId_);
+    if (it != counts_.end()) {
+        it->lastUse = ++useClock_;
+        totalCount_ = it->count;
+        countKnown_ = true;
+        countDebounce_.stop();
+    } else if (executor_) {
+        // Page 0 now, the count once typing pauses.
+        totalCount_ = 0;
+        countKnown_ = false;
+        countDebounce_.start();
+        pending_.insert(PageKey{viewId_, 0});
+        executor_->requestPage(viewId_, currentQuery(), 0);
+    } else {
+        CachedCount c;
+        c.count   = db_ ? db_->queryCount(search_, searchMode_, playlistId_) : 0;
+        c.lastUse = ++useClock_;
+        counts_.insert(filterId_, c);
+        evictOldest(counts_, kMaxViews);
+        totalCount_ = c.count;
+        countKnown_ = true;
+    }
+
+    endResetModel();
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -169,20 +370,27 @@ void DjLibraryModel::reload()
 // ─────────────────────────────────────────────────────────────────────────────
 qint64 DjLibraryModel::trackIdAt(int row) const
 {
-    if (row < 0 || row >= rows_.size()) return -1;
-    return rows_[row].trackId;
+    const Row* r = rowAt(row, true);
+    return r ? r->trackId : -1;
 }
 
 const TrackInfo& DjLibraryModel::trackInfoAt(int row) const
 {
     static const TrackInfo kEmpty{};
-    if (row < 0 || row >= rows_.size()) return kEmpty;
-    return rows_[row].info;
+    const Row* r = rowAt(row, true);
+    return r ? r->info : kEmpty;
 }
 
 int DjLibraryModel::rowOfTrackId(qint64 id) const
 {
-    for (int i = 0; i < rows_.size(); ++i)
-        if (rows_[i].trackId == id) return i;
-    return -1;
+    // Pages already in memory first, then ask SQLite for the position.
+    for (auto it = pages_.cbegin(); it != pages_.cend(); ++it) {
+        if (it.key().first != viewId_) continue;
+        const std::vector<Row>& rows = it->rows;
+        for (size_t i = 0; i < rows.size(); ++i)
+            if (rows[i].trackId == id)
+                return it.key().second * kPageSize + static_cast<int>(i);
+    }
+    if (!db_) return -1;
+    return db_->queryRowOf(search_, searchMode_, playlistId_, sortCol_, id);
 }
@@ -1,17 +1,39 @@
 #pragma once
 
 #include "ui/library/DjLibraryDatabase.h"
+#include "ui/library/LibraryQueryExecutor.h"
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QMimeData>
+#include <QPair>
+#include <QSet>
 #include <QStringList>
-#include <QVector>
+#include <QTimer>
+
+#include <vector>
 
 // ─────────────────────────────────────────────────────────────────────────────
 // DjLibraryModel
 //
-// QAbstractTableModel backed by DjLibraryDatabase.  Uses fetchMore() / canFetchMore()
-// so QTableView only causes DB reads in kPageSize-row increments as the user scrolls.
+// QAbstractTableModel backed by DjLibraryDatabase.  rowCount() is the full
+// filtered count; rows are materialised a kPageSize page at a time when the view
+// first asks for them, so a scrollbar jump to any depth costs one page read.
+//
+// Pages are read by keyset seek from per-view anchors (the sort key of every
+// page's first row, built in one scan the first time the view leaves page 0)
+// and held in a bounded LRU cache keyed by (filter, sort, page).  Returning to
+// a recent filter or sort order reuses its count, anchors and pages; any DB
+// write changes DjLibraryDatabase::dataVersion() and so retires them.
+// Relevance order has no seekable key and pages by OFFSET instead.
+//
+// Queries run on a LibraryQueryExecutor thread: reload() only switches view
+// ids, a page the view paints before it has arrived shows blank and fills in
+// via dataChanged, and the count query is debounced so typing a search only
+// counts the final text (a short first page gives the count for free).  The
+// accessors used for navigation (trackIdAt, trackInfoAt, drag) still read a
+// missing page synchronously.  UI-thread time spent in the model is recorded
+// in uiStats() and logged as [LIB_ASYNC].
 //
 // Columns: 0=Name 1=Artist 2=Album 3=Duration 4=BPM 5=Key
 // Qt::UserRole on any column → track_id (qint64).
@@ -24,8 +46,19 @@
 class DjLibraryModel : public QAbstractTableModel {
     Q_OBJECT
 public:
-    static constexpr int kPageSize = 200;
-    static constexpr int kColumns  = 6;
+    static constexpr int kPageSize      = 200;
+    static constexpr int kColumns       = 6;
+    static constexpr int kMaxPages      = 64;   // LRU page cache (rows = × kPageSize)
+    static constexpr int kMaxViews      = 8;    // cached anchor sets / counts
+    static constexpr int kCountDebounceMs = 120;
+
+    // Time the UI thread spent inside the model since construction.
+    struct UiStats {
+        int    events{0};        // reload / result deliveries / sync reads
+        int    syncPageLoads{0}; // pages read on the UI thread
+        double totalMs{0.0};
+        double maxMs{0.0};
+    };
 
     static constexpr QLatin1String kMimeType    { "application/x-ngks-track-id" };
     static constexpr QLatin1String kMimeTypeUri  { "text/uri-list" };
@@ -39,10 +72,6 @@ public:
     QVariant headerData (int section, Qt::Orientation orientation,
                          int role = Qt::DisplayRole) const override;
 
-    // ── Incremental loading ────────────────────────────────────────────────
-    bool canFetchMore(const QModelIndex& parent) const override;
-    void fetchMore   (const QModelIndex& parent) override;
-
     // ── Drag ──────────────────────────────────────────────────────────────
     Qt::ItemFlags  flags   (const QModelIndex& index) const override;
     QStringList    mimeTypes() const override;
@@ -52,36 +81,78 @@ public:
     // Call reload() after changing filter/sort.
     void setSearch      (const QString& text, int mode);
     void setSortCol     (int col);
-    void setPlaylistPaths(const QStringList& paths);
+    void setPlaylistId  (qint64 playlistId);      // kNoPlaylist = all tracks
 
-    // Clears cached rows, re-queries count, fetches first page.
+    // Switches to the current filter/sort; count, anchors and pages come
+    // from the cache when this view was shown recently.
     void reload();
 
     // ── Accessors ─────────────────────────────────────────────────────────
     qint64           trackIdAt  (int row) const;
     const TrackInfo& trackInfoAt(int row) const;
 
-    // Total rows matching current filter in the DB (may exceed rowCount()).
+    // Total rows matching current filter in the DB (== rowCount()).
     int totalFilteredCount() const { return totalCount_; }
 
-    // Row index of a trackId in the loaded set (-1 if not loaded yet).
+    // Row index of a trackId in the current filter/sort (-1 if filtered out).
     int rowOfTrackId(qint64 id) const;
 
+    const UiStats& uiStats() const { return uiStats_; }
+
 private:
-    struct Row {
-        qint64    trackId{-1};
-        TrackInfo info;
+    using Row = DjLibraryDatabase::Row;
+
+    using PageKey = QPair<quint64, int>;        // (view id, page index)
+
+    struct CachedPage {
+        std::vector<Row> rows;
+        quint64          lastUse{0};
     };
 
-    DjLibraryDatabase* db_{nullptr};
+    struct CachedAnchors {
+        std::vector<DjLibraryDatabase::SortKey> keys;
+        quint64          lastUse{0};
+    };
+
+    struct CachedCount {
+        int              count{0};
+        quint64          lastUse{0};
+    };
+
+    // Row at index.  A missing page is read synchronously when `wait` (or
+    // without a worker), otherwise requested from the worker → nullptr.
+    const Row* rowAt(int row, bool wait) const;
+    const std::vector<Row>* page(int pageIndex, bool wait) const;
+    void storePage(const PageKey& key, std::vector<Row> rows) const;
+
+    void ensureExecutor();
+    LibraryQueryExecutor::Query currentQuery() const;
+    void setRowCount(int count);
+    void onPageReady(quint64 viewId, int pageIndex, const std::vector<Row>& rows, double queryMs);
+    void onCountReady(quint64 filterId, int count, double queryMs);
+    void noteUiTime(double ms) const;
+
+    DjLibraryDatabase*    db_{nullptr};
+    LibraryQueryExecutor* executor_{nullptr};
+    QTimer                countDebounce_;
 
     // Current filter state
     QString     search_;
     int         searchMode_{5};
     int         sortCol_{0};
-    QStringList playlistPaths_;
-
-    // Loaded data
-    QVector<Row> rows_;
-    int          totalCount_{0};
+    qint64      playlistId_{0};
+
+    // Current view: filter + sort + DB version, hashed
+    quint64 viewId_{0};
+    quint64 filterId_{0};                       // same, minus sort
+    int     totalCount_{0};
+    bool    countKnown_{true};                  // false while the count is in flight
+
+    // Caches (filled lazily from const accessors)
+    mutable QHash<PageKey, CachedPage>    pages_;
+    mutable QHash<quint64, CachedAnchors> anchors_;
+    mutable QHash<quint64, CachedCount>   counts_;
+    mutable QSet<PageKey>                 pending_;   // requested from the worker
+    mutable quint64                       useClock_{0};
+    mutable UiStats                       uiStats_;
 };
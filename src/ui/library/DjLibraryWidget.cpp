@@ -82,12 +82,12 @@ void DjLibraryWidget::setViewStyleSheet(const QString& ss)
 // Data control
 // ─────────────────────────────────────────────────────────────────────────────
 void DjLibraryWidget::applyFilter(const QString& search, int searchMode,
-                                   const QStringList& playlistPaths, int sortCol)
+                                   qint64 playlistId, int sortCol)
 {
     if (!model_) return;
     model_->setSearch(search, searchMode);
     model_->setSortCol(sortCol);
-    model_->setPlaylistPaths(playlistPaths);
+    model_->setPlaylistId(playlistId);
     model_->reload();
 }
 
@@ -127,14 +127,7 @@ void DjLibraryWidget::scrollToTrackId(qint64 id)
 {
     if (!model_) return;
 
-    int row = model_->rowOfTrackId(id);
-
-    // If not loaded yet, keep fetching until we have it or exhaust pages
-    while (row < 0 && model_->canFetchMore({})) {
-        model_->fetchMore({});
-        row = model_->rowOfTrackId(id);
-    }
-
+    const int row = model_->rowOfTrackId(id);
     if (row < 0) return;
     const QModelIndex idx = model_->index(row, 0);
     view_->scrollTo(idx, QAbstractItemView::PositionAtCenter);
@@ -154,21 +147,13 @@ qint64 DjLibraryWidget::firstVisibleTrackId() const
 qint64 DjLibraryWidget::trackIdAt(int row) const
 {
     if (!model_ || row < 0) return -1;
-    while (model_->rowCount({}) <= row && model_->canFetchMore({}))
-        model_->fetchMore({});
-    if (row >= model_->rowCount({})) return -1;
     return model_->trackIdAt(row);
 }
 
 int DjLibraryWidget::rowOfTrackId(qint64 id) const
 {
     if (!model_) return -1;
-    int row = model_->rowOfTrackId(id);
-    while (row < 0 && model_->canFetchMore({})) {
-        model_->fetchMore({});
-        row = model_->rowOfTrackId(id);
-    }
-    return row;
+    return model_->rowOfTrackId(id);
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
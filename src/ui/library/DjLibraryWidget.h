@@ -49,29 +49,29 @@ public:
     // ── Data control ──────────────────────────────────────────────────────
     // Re-queries DB with new filter / sort params and repopulates view.
     void applyFilter(const QString& search, int searchMode,
-                     const QStringList& playlistPaths, int sortCol);
+                     qint64 playlistId, int sortCol);
 
     // Total rows matching the current filter in the DB.
     int totalFilteredCount() const;
 
-    // Rows currently loaded (first page(s)).
+    // Rows addressable in the view (equals totalFilteredCount()).
     int visibleRowCount() const;
 
     // ── Selection ─────────────────────────────────────────────────────────
     qint64 currentTrackId() const;
     void   setCurrentTrackId(qint64 id);
 
-    // If the row for id is not yet loaded, fetch pages until it is or give up.
+    // Scrolls to id's row; its page is loaded on demand.
     void   scrollToTrackId(qint64 id);
 
     // track_id of the first visible row, or -1.
     qint64 firstVisibleTrackId() const;
 
     // ── Navigation helpers ────────────────────────────────────────────────
-    // Returns track_id at row (fetches pages as needed). Returns -1 if out of range.
+    // Returns track_id at row (loads its page as needed). Returns -1 if out of range.
     qint64 trackIdAt(int row) const;
 
-    // Returns row of track_id in the loaded pages, fetching more if needed.
+    // Returns row of track_id in the current filter/sort.
     // Returns -1 if not found.
     int    rowOfTrackId(qint64 id) const;
 
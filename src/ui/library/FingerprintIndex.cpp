@@ -0,0 +1,219 @@
+#include "ui/library/FingerprintIndex.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+namespace {
+
+uint64_t mix64(uint64_t z)
+{
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Union-find over entry indices; each root carries the loosest
+// resemblance that joined its set.
+struct Components {
+    explicit Components(size_t n) : parent(n), kind(n, 0)
+    {
+        std::iota(parent.begin(), parent.end(), size_t{0});
+    }
+
+    size_t root(size_t i)
+    {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void join(size_t a, size_t b, uint8_t k)
+    {
+        a = root(a);
+        b = root(b);
+        if (a != b) parent[b] = a;
+        kind[a] = std::max({kind[a], kind[b], k});
+    }
+
+    std::vector<size_t>  parent;
+    std::vector<uint8_t> kind;
+};
+
+} // namespace
+
+uint64_t FingerprintIndex::bandKey(const AudioFingerprint::Sketch& sketch, int band)
+{
+    uint64_t h = mix64(static_cast<uint64_t>(band));
+    for (int r = 0; r < kRowsPerBand; ++r)
+        h = mix64(h ^ sketch[static_cast<size_t>(band * kRowsPerBand + r)]);
+    return h;
+}
+
+bool FingerprintIndex::sameBand(const Entry& a, const Entry& b, int band)
+{
+    for (int r = 0; r < kRowsPerBand; ++r) {
+        const size_t i = static_cast<size_t>(band * kRowsPerBand + r);
+        if (a.sketch[i] != b.sketch[i]) return false;
+    }
+    return true;
+}
+
+void FingerprintIndex::build(std::vector<Entry> entries)
+{
+    clear();
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const Entry& e) { return e.landmarks == 0; }),
+                  entries.end());
+    entries_ = std::move(entries);
+
+    byId_.reserve(entries_.size());
+    keys_.reserve(entries_.size() * kBandCount);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        byId_[entries_[i].trackId] = i;
+        for (int band = 0; band < kBandCount; ++band) {
+            keys_.push_back({bandKey(entries_[i].sketch, band),
+                             static_cast<uint32_t>(i), static_cast<uint32_t>(band)});
+        }
+    }
+    std::sort(keys_.begin(), keys_.end(), [](const Key& a, const Key& b) {
+        return a.key < b.key || (a.key == b.key && a.entry < b.entry);
+    });
+}
+
+void FingerprintIndex::clear()
+{
+    entries_.clear();
+    keys_.clear();
+    byId_.clear();
+}
+
+const FingerprintIndex::Entry* FingerprintIndex::find(qint64 trackId) const
+{
+    const auto it = byId_.find(trackId);
+    return it == byId_.end() ? nullptr : &entries_[it->second];
+}
+
+FingerprintIndex::Resemblance FingerprintIndex::classify(double containment,
+                                                         const Entry& a, const Entry& b)
+{
+    if (containment < kSameAudioContainment) return Resemblance::Version;
+
+    // Same audio; a similar length makes it the same cut.  Without
+    // durations, compare landmark counts instead (they scale with length).
+    bool sameLength = false;
+    if (a.durationMs > 0 && b.durationMs > 0) {
+        const qint64 longer = std::max(a.durationMs, b.durationMs);
+        const qint64 slack  = std::max(kSameLengthMinMs,
+                                       static_cast<qint64>(longer * kSameLengthTolerance));
+        sameLength = std::llabs(a.durationMs - b.durationMs) <= slack;
+    } else {
+        const double ratio = static_cast<double>(std::min(a.landmarks, b.landmarks))
+                           / std::max<uint32_t>(1, std::max(a.landmarks, b.landmarks));
+        sameLength = ratio >= 0.85;
+    }
+    return sameLength ? Resemblance::Duplicate : Resemblance::Edit;
+}
+
+std::vector<FingerprintIndex::Match> FingerprintIndex::similarTo(qint64 trackId,
+                                                                 double minContainment) const
+{
+    std::vector<Match> out;
+    const auto it = byId_.find(trackId);
+    if (it == byId_.end()) return out;
+    const size_t self = it->second;
+    const Entry& e = entries_[self];
+
+    std::vector<uint32_t> candidates;
+    for (int band = 0; band < kBandCount; ++band) {
+        const uint64_t key = bandKey(e.sketch, band);
+        auto lo = std::lower_bound(keys_.begin(), keys_.end(), key,
+                                   [](const Key& k, uint64_t v) { return k.key < v; });
+        auto hi = lo;
+        while (hi != keys_.end() && hi->key == key) ++hi;
+        if (hi - lo > kMaxBucket) continue;
+        for (auto k = lo; k != hi; ++k) {
+            if (k->entry != self) candidates.push_back(k->entry);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (uint32_t c : candidates) {
+        const Entry& other = entries_[c];
+        const AudioFingerprint::Overlap o =
+            AudioFingerprint::estimate(e.sketch, e.landmarks, other.sketch, other.landmarks);
+        if (o.containment < minContainment) continue;
+        out.push_back({other.trackId, classify(o.containment, e, other),
+                       o.jaccard, o.containment});
+    }
+    std::sort(out.begin(), out.end(), [](const Match& a, const Match& b) {
+        return a.containment > b.containment
+            || (a.containment == b.containment && a.trackId < b.trackId);
+    });
+    return out;
+}
+
+std::vector<FingerprintIndex::Group> FingerprintIndex::groups(Resemblance loosest,
+                                                              double minContainment) const
+{
+    Components comp(entries_.size());
+    std::vector<char> linked(entries_.size(), 0);
+
+    for (size_t runStart = 0; runStart < keys_.size();) {
+        size_t runEnd = runStart + 1;
+        while (runEnd < keys_.size() && keys_[runEnd].key == keys_[runStart].key) ++runEnd;
+        if (runEnd - runStart > static_cast<size_t>(kMaxBucket)) {
+            runStart = runEnd;
+            continue;
+        }
+
+        const int band = static_cast<int>(keys_[runStart].band);
+        for (size_t p = runStart; p < runEnd; ++p) {
+            const Entry& a = entries_[keys_[p].entry];
+            for (size_t q = p + 1; q < runEnd; ++q) {
+                const Entry& b = entries_[keys_[q].entry];
+                if (keys_[q].band != static_cast<uint32_t>(band)) continue;  // key collision
+
+                // Score each pair once: in the first band both share.
+                bool earlier = false;
+                for (int prev = 0; prev < band && !earlier; ++prev)
+                    earlier = sameBand(a, b, prev);
+                if (earlier) continue;
+
+                const AudioFingerprint::Overlap o =
+                    AudioFingerprint::estimate(a.sketch, a.landmarks, b.sketch, b.landmarks);
+                if (o.containment < minContainment) continue;
+                const Resemblance kind = classify(o.containment, a, b);
+                if (kind > loosest) continue;
+
+                comp.join(keys_[p].entry, keys_[q].entry, static_cast<uint8_t>(kind));
+                linked[keys_[p].entry] = 1;
+                linked[keys_[q].entry] = 1;
+            }
+        }
+        runStart = runEnd;
+    }
+
+    std::unordered_map<size_t, size_t> slotOfRoot;
+    std::vector<Group> out;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if (!linked[i]) continue;
+        const size_t root = comp.root(i);
+        auto [it, inserted] = slotOfRoot.emplace(root, out.size());
+        if (inserted) {
+            out.emplace_back();
+            out.back().kind = static_cast<Resemblance>(comp.kind[root]);
+        }
+        out[it->second].trackIds.push_back(entries_[i].trackId);
+    }
+    for (Group& g : out) std::sort(g.trackIds.begin(), g.trackIds.end());
+    std::sort(out.begin(), out.end(), [](const Group& a, const Group& b) {
+        return a.trackIds.size() > b.trackIds.size()
+            || (a.trackIds.size() == b.trackIds.size() && a.trackIds.front() < b.trackIds.front());
+    });
+    return out;
+}
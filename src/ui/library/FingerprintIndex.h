@@ -0,0 +1,102 @@
+#pragma once
+
+#include "ui/AudioFingerprint.h"
+
+#include <QtGlobal>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FingerprintIndex
+//
+// Locality-sensitive hash index over the MinHash sketches of AudioFingerprint.
+// The 96 sketch values are cut into kBandCount bands of kRowsPerBand; two
+// tracks become candidates when any band matches exactly, which for landmark
+// Jaccard similarity J happens with probability 1 − (1 − J²)^48: ~99% at
+// J = 0.3 (a re-encode), ~38% at J = 0.1, ~2% at J = 0.02 (unrelated).
+// Candidates are scored from their sketches alone, so neither a lookup nor a
+// library-wide grouping pass touches the stored landmark samples.
+//
+// build() sorts one (band key, track) pair per band and track; groups() walks
+// the sorted runs once and takes each candidate pair in the first band it
+// collides in, so a 40k-track library groups in about a second.
+// ─────────────────────────────────────────────────────────────────────────────
+class FingerprintIndex {
+public:
+    static constexpr int kRowsPerBand = 2;
+    static constexpr int kBandCount   = AudioFingerprint::kSketchSize / kRowsPerBand;
+
+    // A run of one band key longer than this is a landmark pattern shared
+    // by a large part of the library (a stock sample, near-silent intros),
+    // not evidence of shared audio; it is skipped.
+    static constexpr int kMaxBucket = 1024;
+
+    // Containment is the share of the shorter track's landmarks found in
+    // the other.  Unrelated tracks reach a few percent by chance; from
+    // kRelatedContainment they share audio, from kSameAudioContainment it
+    // is the same audio, and a length difference within the tolerance
+    // makes it the same cut.
+    static constexpr double kRelatedContainment   = 0.2;
+    static constexpr double kSameAudioContainment = 0.35;
+    static constexpr double kSameLengthTolerance  = 0.03;   // of the longer
+    static constexpr qint64 kSameLengthMinMs      = 4000;
+
+    enum class Resemblance : uint8_t {
+        Duplicate = 0,      // same recording: re-encode, trim, other tags
+        Edit      = 1,      // same audio, different cut: radio edit, extended mix
+        Version   = 2,      // substantial shared audio: remix, alternate mix
+    };
+
+    struct Entry {
+        qint64   trackId{-1};
+        qint64   durationMs{0};             // 0 = unknown
+        uint32_t landmarks{0};
+        AudioFingerprint::Sketch sketch{};
+    };
+
+    struct Match {
+        qint64      trackId{-1};
+        Resemblance kind{Resemblance::Version};
+        double      jaccard{0.0};
+        double      containment{0.0};
+    };
+
+    struct Group {
+        std::vector<qint64> trackIds;       // ascending
+        Resemblance         kind{Resemblance::Duplicate};   // loosest link
+    };
+
+    // Replaces the index.  Entries without landmarks are dropped.
+    void build(std::vector<Entry> entries);
+    void clear();
+
+    size_t size() const { return entries_.size(); }
+    const Entry* find(qint64 trackId) const;
+
+    // Tracks resembling trackId with estimated containment ≥ minContainment,
+    // most similar first.
+    std::vector<Match> similarTo(qint64 trackId, double minContainment) const;
+
+    // Connected groups of tracks linked by resemblances no looser than
+    // `loosest` with estimated containment ≥ minContainment.  Largest
+    // groups first.
+    std::vector<Group> groups(Resemblance loosest, double minContainment) const;
+
+    static Resemblance classify(double containment, const Entry& a, const Entry& b);
+
+private:
+    struct Key {
+        uint64_t key{0};
+        uint32_t entry{0};
+        uint32_t band{0};
+    };
+
+    static uint64_t bandKey(const AudioFingerprint::Sketch& sketch, int band);
+    static bool     sameBand(const Entry& a, const Entry& b, int band);
+
+    std::vector<Entry>                 entries_;
+    std::vector<Key>                   keys_;      // sorted by key
+    std::unordered_map<qint64, size_t> byId_;
+};
@@ -64,6 +64,8 @@ void LibraryBrowserWidget::buildMainPanel()
     sortCombo_->addItem(QStringLiteral("Sort: Duration"), 3);
     sortCombo_->addItem(QStringLiteral("Sort: BPM"),      4);
     sortCombo_->addItem(QStringLiteral("Sort: Key"),      5);
+    sortCombo_->addItem(QStringLiteral("Sort: Relevance"), DjLibraryDatabase::kSortRelevance);
+    sortCombo_->addItem(QStringLiteral("Sort: Playlist Order"), DjLibraryDatabase::kSortPlaylistOrder);
     sortCombo_->setMinimumHeight(34);
     sortCombo_->setStyleSheet(QStringLiteral(
         "QComboBox { background: #16213e; color: #e0e0e0; border: 1px solid #0f3460;"
@@ -224,9 +226,9 @@ void LibraryBrowserWidget::setDatabase(DjLibraryDatabase* db)
     view_->setDatabase(db);
 }
 
-void LibraryBrowserWidget::setPlaylistFilter(const QStringList& paths)
+void LibraryBrowserWidget::setPlaylistFilter(qint64 playlistId)
 {
-    playlistFilter_ = paths;
+    playlistFilter_ = playlistId;
 }
 
 void LibraryBrowserWidget::refresh()
@@ -38,9 +38,9 @@ public:
     // Must be called before the first filter refresh.
     void setDatabase(DjLibraryDatabase* db);
 
-    // Set the active playlist-path filter (empty list = show all tracks).
-    // Call refresh() after changing the filter.
-    void setPlaylistFilter(const QStringList& paths);
+    // Set the active playlist (DjLibraryDatabase::kNoPlaylist = show all
+    // tracks).  Call refresh() after changing the filter.
+    void setPlaylistFilter(qint64 playlistId);
 
     // Re-apply the current filter.  Call after setPlaylistFilter() or whenever
     // external state (e.g. active playlist) changes.
@@ -78,5 +78,5 @@ private:
     QComboBox*       searchModeCombo_{nullptr};  ///< MainPanel only
     QComboBox*       sortCombo_{nullptr};
     QLabel*          countLabel_{nullptr};        ///< PlayerPanel only
-    QStringList      playlistFilter_;
+    qint64           playlistFilter_{0};
 };
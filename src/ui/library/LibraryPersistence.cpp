@@ -40,6 +40,7 @@ bool saveLibraryJson(const std::vector<TrackInfo>& tracks, const QString& folder
         obj.insert(QStringLiteral("bpm"),         t.bpm);
         obj.insert(QStringLiteral("musicalKey"),  t.musicalKey);
         obj.insert(QStringLiteral("fileSize"),    t.fileSize);
+        if (t.modifiedMs > 0)           obj.insert(QStringLiteral("modifiedMs"),        t.modifiedMs);
         if (!t.genre.isEmpty())         obj.insert(QStringLiteral("genre"),             t.genre);
         if (!t.camelotKey.isEmpty())    obj.insert(QStringLiteral("camelotKey"),        t.camelotKey);
         if (t.energy >= 0)              obj.insert(QStringLiteral("energy"),            t.energy);
@@ -98,6 +99,7 @@ bool loadLibraryJson(std::vector<TrackInfo>& outTracks, QString& outFolderPath)
         t.bpm                = obj.value(QStringLiteral("bpm")).toString();
         t.musicalKey         = obj.value(QStringLiteral("musicalKey")).toString();
         t.fileSize           = obj.value(QStringLiteral("fileSize")).toInteger(0);
+        t.modifiedMs         = obj.value(QStringLiteral("modifiedMs")).toInteger(0);
         t.genre              = obj.value(QStringLiteral("genre")).toString();
         t.camelotKey         = obj.value(QStringLiteral("camelotKey")).toString();
         t.energy             = obj.value(QStringLiteral("energy")).toDouble(-1.0);
@@ -17,6 +17,8 @@ struct TrackInfo {
     QString bpm;
     QString musicalKey;
     qint64  fileSize{0};
+    qint64  modifiedMs{0};          // file mtime, ms since epoch (0 = unknown)
+    quint64 contentHash{0};         // audioContentHash() of the file (0 = unknown)
     // Legacy DB fields
     QString genre;
     QString camelotKey;
@@ -46,9 +48,13 @@ QString formatDurationMs(qint64 ms);
 QString formatFileSize(qint64 bytes);
 
 // ── Library JSON persistence ──────────────────────────────────────────────────
+// The library itself lives in DjLibraryDatabase; library.json is an export
+// kept in step with it and is read only to migrate an older install.
 bool saveLibraryJson(const std::vector<TrackInfo>& tracks, const QString& folderPath);
 bool loadLibraryJson(std::vector<TrackInfo>& outTracks, QString& outFolderPath);
 
 // ── Playlist persistence ──────────────────────────────────────────────────────
+// Playlists live in DjLibraryDatabase (membership by track id);
+// playlists.json is read once to import an older install.
 bool savePlaylists(const std::vector<Playlist>& playlists);
 bool loadPlaylists(std::vector<Playlist>& out);
@@ -0,0 +1,129 @@
+#include "ui/library/LibraryQueryExecutor.h"
+
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QtDebug>
+
+#include <algorithm>
+
+// ─────────────────────────────────────────────────────────────────────────────
+LibraryQueryExecutor::LibraryQueryExecutor(const QString& dbPath, int pageSize, QObject* parent)
+    : QObject(parent), dbPath_(dbPath), pageSize_(pageSize)
+{
+    thread_ = std::thread([this]() { workerLoop(); });
+}
+
+LibraryQueryExecutor::~LibraryQueryExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        count_.reset();
+        pages_.clear();
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Requests (UI thread)
+// ─────────────────────────────────────────────────────────────────────────────
+void LibraryQueryExecutor::setCurrentView(quint64 viewId)
+{
+    currentView_.store(viewId, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    pages_.erase(std::remove_if(pages_.begin(), pages_.end(),
+                                [viewId](const PageJob& j) { return j.viewId != viewId; }),
+                 pages_.end());
+}
+
+void LibraryQueryExecutor::requestCount(quint64 filterId, const Query& q)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_ = CountJob{filterId, q};
+    }
+    wake_.notify_one();
+}
+
+void LibraryQueryExecutor::requestPage(quint64 viewId, const Query& q, int pageIndex)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Re-requesting a queued page moves it to the front of the line.
+        pages_.erase(std::remove_if(pages_.begin(), pages_.end(),
+                                    [&](const PageJob& j) {
+                                        return j.viewId == viewId && j.page == pageIndex;
+                                    }),
+                     pages_.end());
+        pages_.push_back(PageJob{viewId, q, pageIndex});
+    }
+    wake_.notify_one();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Worker thread
+// ─────────────────────────────────────────────────────────────────────────────
+void LibraryQueryExecutor::workerLoop()
+{
+    // The connection must be created and used on this thread.
+    DjLibraryDatabase db;
+    if (!db.open(dbPath_)) {
+        qWarning().noquote() << QStringLiteral("[LIB_ASYNC] worker DB open FAIL") << dbPath_;
+        return;
+    }
+
+    // Anchors of the view being paged; rebuilt when the view changes.
+    quint64 anchorView = 0;
+    std::vector<DjLibraryDatabase::SortKey> anchors;
+
+    for (;;) {
+        std::optional<PageJob>  page;
+        std::optional<CountJob> count;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stop_ || count_ || !pages_.empty(); });
+            if (stop_) break;
+            // Visible rows first; the count only sizes the scrollbar.
+            if (!pages_.empty()) {
+                page = std::move(pages_.back());
+                pages_.pop_back();
+            } else {
+                count = std::move(count_);
+                count_.reset();
+            }
+        }
+
+        QElapsedTimer t;
+        t.start();
+
+        if (page) {
+            if (page->viewId != currentView_.load(std::memory_order_relaxed)) continue;
+            if (page->viewId != anchorView) {
+                anchorView = page->viewId;
+                anchors.clear();
+            }
+            std::vector<DjLibraryDatabase::Row> rows =
+                db.queryPageAt(page->q.search, page->q.searchMode, page->q.playlistId,
+                               page->q.sortCol, page->page, pageSize_, anchors);
+            const double ms = static_cast<double>(t.nsecsElapsed()) / 1.0e6;
+            if (page->viewId != currentView_.load(std::memory_order_relaxed)) continue;
+
+            const quint64 viewId = page->viewId;
+            const int     index  = page->page;
+            QMetaObject::invokeMethod(this, [this, viewId, index, rows = std::move(rows), ms]() {
+                emit pageReady(viewId, index, rows, ms);
+            }, Qt::QueuedConnection);
+        } else if (count) {
+            const int n = db.queryCount(count->q.search, count->q.searchMode,
+                                        count->q.playlistId);
+            const double ms = static_cast<double>(t.nsecsElapsed()) / 1.0e6;
+            const quint64 filterId = count->filterId;
+            QMetaObject::invokeMethod(this, [this, filterId, n, ms]() {
+                emit countReady(filterId, n, ms);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    db.close();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ui/library/DjLibraryDatabase.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LibraryQueryExecutor
+//
+// Runs DjLibraryModel's count and page queries on a dedicated thread with its
+// own SQLite connection (the database is in WAL mode, so it reads alongside
+// the UI thread's writer).  Results come back as queued signals on the thread
+// that owns the executor.
+//
+// Requests are tagged with the model's view id.  Switching view supersedes
+// everything queued for the old one; a statement already running finishes but
+// its result is dropped.  Page requests are served newest first, so the rows
+// the user is looking at now load before ones scrolled past.
+// ─────────────────────────────────────────────────────────────────────────────
+class LibraryQueryExecutor : public QObject {
+    Q_OBJECT
+public:
+    struct Query {
+        QString     search;
+        int         searchMode{5};
+        qint64      playlistId{0};     // DjLibraryDatabase::kNoPlaylist = all
+        int         sortCol{0};
+    };
+
+    // Opens a second connection to dbPath on the worker thread.
+    LibraryQueryExecutor(const QString& dbPath, int pageSize, QObject* parent = nullptr);
+    ~LibraryQueryExecutor() override;
+
+    // Drops queued work for any other view.  Call before requesting pages.
+    void setCurrentView(quint64 viewId);
+
+    // filterId keys the count (it does not depend on sort order).
+    // A newer count request replaces an unstarted older one.
+    void requestCount(quint64 filterId, const Query& q);
+    void requestPage(quint64 viewId, const Query& q, int pageIndex);
+
+signals:
+    void countReady(quint64 filterId, int count, double queryMs);
+    void pageReady(quint64 viewId, int pageIndex,
+                   const std::vector<DjLibraryDatabase::Row>& rows, double queryMs);
+
+private:
+    struct CountJob { quint64 filterId{0}; Query q; };
+    struct PageJob  { quint64 viewId{0};   Query q; int page{0}; };
+
+    void workerLoop();
+
+    const QString dbPath_;
+    const int     pageSize_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    stop_{false};
+    std::optional<CountJob> count_;
+    std::vector<PageJob>    pages_;          // served back to front
+    std::atomic<quint64>    currentView_{0};
+
+    std::thread             thread_;
+};
@@ -1,10 +1,23 @@
 #pragma once
 
 #include "ui/library/LibraryPersistence.h"
+#include <QStringList>
 #include <vector>
 
-// ── ID3 tag reader ────────────────────────────────────────────────────────────
-void readId3Tags(TrackInfo& track);
+class QFileInfo;
+
+// ── Tag reader ────────────────────────────────────────────────────────────────
+// Fills empty fields of `track` from its tags (any format TagParser reads).
+void readTrackTags(TrackInfo& track);
+
+// ── Single file ───────────────────────────────────────────────────────────────
+// Path, size, mtime, filename-derived artist/title, then readTrackTags and
+// the audio content hash.
+TrackInfo trackFromFile(const QFileInfo& fi);
+
+// Name filters of the audio files the library picks up.
+const QStringList& audioFileFilters();
 
 // ── Folder scanner ────────────────────────────────────────────────────────────
+// Full scan through ParallelFolderScanner (no manifest, no callbacks).
 std::vector<TrackInfo> scanFolderForTracks(const QString& folderPath);
@@ -0,0 +1,181 @@
+#include "ui/library/LibrarySearchBench.h"
+#include "ui/library/DjLibraryDatabase.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QtDebug>
+
+#include <algorithm>
+#include <random>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Synthetic library
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+std::vector<TrackInfo> syntheticTracks(int rows)
+{
+    static const char* kArtists[] = {
+        "Röyksopp", "Sigur Rós", "Beyoncé", "Motörhead", "Daft Punk", "Deadmau5",
+        "Amelie Lens", "Charlotte de Witte", "Peggy Gou", "Kölsch", "Âme",
+        "Bicep", "Four Tet", "Jamie xx", "Solomun", "Tale Of Us", "Adam Beyer",
+        "Nina Kraviz", "Dixon", "Maceo Plex", "Lane 8", "Joris Voorn",
+    };
+    static const char* kWords[] = {
+        "love", "night", "dream", "fire", "light", "deep", "summer", "city",
+        "heart", "echo", "dance", "shadow", "ocean", "gold", "rain", "signal",
+        "circuit", "velvet", "sunrise", "pulse", "café", "señorita", "über",
+    };
+    static const char* kGenres[] = {
+        "Techno", "Deep House", "Tech House", "Progressive House", "Trance",
+        "Drum & Bass", "Melodic Techno", "Minimal", "Electro", "Ambient",
+    };
+    static const char* kKeys[] = {
+        "A Minor", "C Major", "E Minor", "G Major", "D Minor", "F Major",
+        "B Minor", "D Major", "F# Minor", "A Major", "C# Minor", "E Major",
+    };
+    static const char* kCamelot[] = {
+        "8A", "8B", "9A", "9B", "7A", "7B", "10A", "10B", "11A", "11B", "12A", "12B",
+    };
+
+    auto pick = [](std::mt19937& rng, const auto& arr) {
+        const size_t n = sizeof(arr) / sizeof(arr[0]);
+        return QString::fromUtf8(arr[std::uniform_int_distribution<size_t>(0, n - 1)(rng)]);
+    };
+
+    std::mt19937 rng(0x5EA2C4u);   // fixed seed: identical DB every run
+    std::vector<TrackInfo> tracks;
+    tracks.reserve(static_cast<size_t>(rows));
+    for (int i = 0; i < rows; ++i) {
+        TrackInfo t;
+        const int words = 1 + static_cast<int>(rng() % 3);
+        QStringList title;
+        for (int w = 0; w < words; ++w) title << pick(rng, kWords);
+        title[0][0] = title[0][0].toUpper();
+
+        t.artist      = pick(rng, kArtists);
+        t.title       = title.join(QLatin1Char(' '));
+        t.album       = pick(rng, kWords) + QStringLiteral(" EP");
+        t.genre       = pick(rng, kGenres);
+        t.displayName = t.artist + QStringLiteral(" - ") + t.title;
+        t.filePath    = QStringLiteral("D:/Music/bench/%1/%2.mp3").arg(i % 997).arg(i);
+        t.durationMs  = 150000 + static_cast<qint64>(rng() % 360000);
+        t.durationStr = formatDurationMs(t.durationMs);
+        t.bpm         = QString::number(90.0 + (rng() % 900) / 10.0, 'f', 1);
+        const size_t k = rng() % 12;
+        t.musicalKey  = QString::fromUtf8(kKeys[k]);
+        t.camelotKey  = QString::fromUtf8(kCamelot[k]);
+        t.fileSize    = 4000000 + static_cast<qint64>(rng() % 12000000);
+        t.contentHash = (static_cast<quint64>(rng()) << 32) | rng();
+        tracks.push_back(std::move(t));
+    }
+    return tracks;
+}
+
+// One as-you-type keystroke: count + first page, median of `repeats`.
+double timeKeystroke(const DjLibraryDatabase& db, const QString& query, int& hits)
+{
+    constexpr int kRepeats = 7;
+    std::vector<double> ms;
+    ms.reserve(kRepeats);
+    for (int r = 0; r < kRepeats; ++r) {
+        QElapsedTimer t;
+        t.start();
+        hits = db.queryCount(query, 5, DjLibraryDatabase::kNoPlaylist);
+        db.queryPage(query, 5, DjLibraryDatabase::kNoPlaylist, 0, 0, 200);
+        ms.push_back(static_cast<double>(t.nsecsElapsed()) / 1.0e6);
+    }
+    std::nth_element(ms.begin(), ms.begin() + kRepeats / 2, ms.end());
+    return ms[kRepeats / 2];
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Run
+// ─────────────────────────────────────────────────────────────────────────────
+bool LibrarySearchBench::run(const QString& dbPath, int rows, Report& out)
+{
+    out = Report{};
+    out.rows = rows;
+    QFile::remove(dbPath);
+
+    DjLibraryDatabase db;
+    if (!db.open(dbPath)) return false;
+    out.fts = db.hasFullTextIndex();
+
+    {
+        const std::vector<TrackInfo> tracks = syntheticTracks(rows);
+        std::vector<qint64> ids;
+        QElapsedTimer t;
+        t.start();
+        if (!db.syncTracks(tracks, ids)) return false;
+        out.populateMs = static_cast<double>(t.nsecsElapsed()) / 1.0e6;
+
+        // A rescan that finds nothing new: read + compare only.
+        DjLibraryDatabase::SyncStats stats;
+        if (!db.syncTracks(tracks, ids, &stats)) return false;
+        out.resyncMs = stats.ms;
+
+        // The whole library moved to another drive (new mtimes on copy):
+        // every row has to be found again by content hash.
+        std::vector<TrackInfo> moved = tracks;
+        for (TrackInfo& t : moved) {
+            t.filePath.replace(QStringLiteral("D:/Music/"), QStringLiteral("E:/Moved/"));
+            t.modifiedMs = 1;
+        }
+        if (!db.syncTracks(moved, ids, &stats)) return false;
+        out.relinkMs = stats.ms;
+        out.relinked = stats.moved;
+        qInfo().noquote() << QStringLiteral("[SEARCH_BENCH] relink rows=%1 moved=%2 inserted=%3 %4ms")
+                                 .arg(rows).arg(stats.moved).arg(stats.inserted)
+                                 .arg(stats.ms, 0, 'f', 1);
+    }
+
+    // Prefix growth of a typical search, multi-token, folded accents,
+    // BPM / Camelot lookups and a miss.
+    const QStringList queries = {
+        QStringLiteral("r"), QStringLiteral("ro"), QStringLiteral("roy"),
+        QStringLiteral("royksopp"), QStringLiteral("sigur ros"),
+        QStringLiteral("deep house love"), QStringLiteral("cafe"),
+        QStringLiteral("128"), QStringLiteral("8a"), QStringLiteral("zzzz"),
+    };
+
+    for (const QString& query : queries) {
+        Sample s;
+        s.query = query;
+        db.setFullTextSearchEnabled(true);
+        s.ftsMs = timeKeystroke(db, query, s.ftsHits);
+        db.setFullTextSearchEnabled(false);
+        s.likeMs = timeKeystroke(db, query, s.likeHits);
+        out.samples.push_back(s);
+
+        qInfo().noquote() << QStringLiteral("[SEARCH_BENCH] q=\"%1\" fts=%2ms (%3 hits) like=%4ms (%5 hits)")
+                                 .arg(query)
+                                 .arg(s.ftsMs, 0, 'f', 2).arg(s.ftsHits)
+                                 .arg(s.likeMs, 0, 'f', 2).arg(s.likeHits);
+    }
+    db.setFullTextSearchEnabled(true);
+
+    // "What mixes with the 8A @ 124 track on deck A?"
+    {
+        DjLibraryDatabase::CompatibleFilter f;
+        f.bpm = 124.0;
+        f.camelotKey = QStringLiteral("8A");
+        f.halfDoubleTempo = true;
+        constexpr int kRepeats = 7;
+        std::vector<double> ms;
+        for (int r = 0; r < kRepeats; ++r) {
+            QElapsedTimer t;
+            t.start();
+            out.compatibleHits = static_cast<int>(db.queryCompatible(f).size());
+            ms.push_back(static_cast<double>(t.nsecsElapsed()) / 1.0e6);
+        }
+        std::nth_element(ms.begin(), ms.begin() + kRepeats / 2, ms.end());
+        out.compatibleMs = ms[kRepeats / 2];
+        qInfo().noquote() << QStringLiteral("[SEARCH_BENCH] compatible 8A@124 %1ms (%2 hits)")
+                                 .arg(out.compatibleMs, 0, 'f', 2).arg(out.compatibleHits);
+    }
+    return true;
+}
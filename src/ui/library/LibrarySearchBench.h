@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QString>
+
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LibrarySearchBench
+//
+// Builds a synthetic library of `rows` tracks in a scratch SQLite file,
+// times an unchanged re-sync of it and a re-sync after the whole library
+// moved (every row re-linked by content hash), and times the as-you-type "all fields"
+// search (queryCount + first page, the pair DjLibraryModel::reload issues
+// per keystroke) through the full-text index and through the legacy LIKE
+// scan.  Vocabulary includes accented
+// names so diacritic folding is exercised.  Also times the harmonic-mixing
+// lookup (queryCompatible) against the typed bpm/Camelot index.
+// ─────────────────────────────────────────────────────────────────────────────
+class LibrarySearchBench {
+public:
+    struct Sample {
+        QString query;
+        int     ftsHits{0};
+        int     likeHits{0};
+        double  ftsMs{0.0};     // median over repeats
+        double  likeMs{0.0};
+    };
+
+    struct Report {
+        int    rows{0};
+        double populateMs{0.0};
+        double resyncMs{0.0};       // syncTracks of the unchanged library
+        double relinkMs{0.0};       // syncTracks after every path changed
+        int    relinked{0};         // rows that kept their id (should be rows)
+        bool   fts{false};      // index available in this SQLite build
+        double compatibleMs{0.0};   // queryCompatible, median over repeats
+        int    compatibleHits{0};
+        std::vector<Sample> samples;
+    };
+
+    // Overwrites dbPath.  Returns false if the database could not be built.
+    static bool run(const QString& dbPath, int rows, Report& out);
+};
@@ -0,0 +1,341 @@
+#include "ui/library/LibraryWatchService.h"
+
+#include "ui/library/LibraryScanner.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QPair>
+#include <QSocketNotifier>
+#include <QtDebug>
+
+#include <chrono>
+#include <utility>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Helpers
+// ─────────────────────────────────────────────────────────────────────────────
+static inline QString qs(const char* s) { return QLatin1String(s); }
+
+bool LibraryWatchService::isAudioFile(const QString& path)
+{
+    return QDir::match(audioFileFilters(), QFileInfo(path).fileName());
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+LibraryWatchService::LibraryWatchService(QObject* parent)
+    : QObject(parent)
+{
+    debounce_.setSingleShot(true);
+    connect(&debounce_, &QTimer::timeout, this, [this]() { flush(); });
+}
+
+LibraryWatchService::~LibraryWatchService()
+{
+    stop();
+}
+
+void LibraryWatchService::watch(const QStringList& roots, const Config& cfg)
+{
+    stop();
+    cfg_ = cfg;
+    for (const QString& r : roots) {
+        if (!r.isEmpty() && QFileInfo(r).isDir())
+            roots_ << QDir::cleanPath(r);
+    }
+    if (roots_.isEmpty()) return;
+
+    const bool inotify = cfg_.mode == Mode::Auto && startInotify();
+    if (!inotify) startPolling();
+
+    qInfo().noquote() << QStringLiteral("[WATCH] START roots=%1 backend=%2 dirs=%3")
+                             .arg(roots_.join(QLatin1Char(';')))
+                             .arg(inotify ? qs("inotify") : qs("polling"))
+                             .arg(watchDirs_.size());
+}
+
+void LibraryWatchService::stop()
+{
+    stopInotify();
+    stopPolling();
+    debounce_.stop();
+    firstPending_.invalidate();
+    pendingUpdated_.clear();
+    pendingRemoved_.clear();
+    pendingDirs_.clear();
+    pendingResync_ = false;
+    roots_.clear();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// inotify
+// ─────────────────────────────────────────────────────────────────────────────
+bool LibraryWatchService::startInotify()
+{
+#ifdef Q_OS_LINUX
+    inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0) {
+        qWarning().noquote() << qs("[WATCH] inotify_init1 failed, polling instead");
+        return false;
+    }
+    for (const QString& root : roots_) {
+        if (!addWatchTree(root)) {
+            stopInotify();
+            return false;
+        }
+    }
+    notifier_ = new QSocketNotifier(inotifyFd_, QSocketNotifier::Read, this);
+    connect(notifier_, &QSocketNotifier::activated, this, [this]() { onInotifyReadable(); });
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LibraryWatchService::stopInotify()
+{
+#ifdef Q_OS_LINUX
+    delete notifier_;
+    notifier_ = nullptr;
+    if (inotifyFd_ >= 0) ::close(inotifyFd_);     // drops every watch
+    inotifyFd_ = -1;
+    watchDirs_.clear();
+#endif
+}
+
+bool LibraryWatchService::addWatchTree(const QString& dir)
+{
+#ifdef Q_OS_LINUX
+    constexpr uint32_t kMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE
+                             | IN_DELETE | IN_DELETE_SELF | IN_ATTRIB | IN_ONLYDIR;
+    auto add = [this](const QString& d) {
+        const int wd = ::inotify_add_watch(inotifyFd_, QFile::encodeName(d).constData(), kMask);
+        if (wd < 0) {
+            // ENOSPC: fs.inotify.max_user_watches exhausted.
+            qWarning().noquote() << QStringLiteral("[WATCH] inotify_add_watch failed errno=%1 dir=%2")
+                                        .arg(errno).arg(d);
+            return errno != ENOSPC;
+        }
+        watchDirs_.insert(wd, d);
+        return true;
+    };
+
+    if (!add(dir)) return false;
+    QDirIterator it(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        if (!add(it.next())) return false;
+    }
+    return true;
+#else
+    Q_UNUSED(dir);
+    return false;
+#endif
+}
+
+void LibraryWatchService::onInotifyReadable()
+{
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buf[16384];
+    for (;;) {
+        const ssize_t n = ::read(inotifyFd_, buf, sizeof(buf));
+        if (n <= 0) break;      // EAGAIN: drained
+
+        for (const char* p = buf; p < buf + n; ) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                // Events were lost, removals included: relist everything.
+                pendingResync_ = true;
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {
+                watchDirs_.remove(ev->wd);
+                continue;
+            }
+            const QString dir = watchDirs_.value(ev->wd);
+            if (dir.isEmpty() || ev->len == 0) continue;
+            const QString path = dir + QLatin1Char('/') + QFile::decodeName(ev->name);
+
+            if (ev->mask & IN_ISDIR) {
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    if (!addWatchTree(path)) {
+                        qWarning().noquote() << qs("[WATCH] out of inotify watches, polling instead");
+                        const QStringList roots = roots_;
+                        const Config cfg = cfg_;
+                        QMetaObject::invokeMethod(this, [this, roots, cfg]() {
+                            Config polling = cfg;
+                            polling.mode = Mode::Polling;
+                            watch(roots, polling);
+                        }, Qt::QueuedConnection);
+                        return;
+                    }
+                    pendingDirs_.insert(path);
+                } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    noteRemoved(path);
+                }
+                continue;
+            }
+
+            if (!isAudioFile(path)) continue;
+            if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB))
+                noteUpdated(path);
+            else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+                noteRemoved(path);
+            // IN_CREATE alone: still being written; IN_CLOSE_WRITE follows.
+        }
+    }
+    schedule();
+#endif
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Polling fallback
+// ─────────────────────────────────────────────────────────────────────────────
+void LibraryWatchService::startPolling()
+{
+    pollStop_ = false;
+    pollThread_ = std::thread([this]() { pollLoop(); });
+}
+
+void LibraryWatchService::stopPolling()
+{
+    {
+        std::lock_guard<std::mutex> lock(pollMutex_);
+        pollStop_ = true;
+    }
+    pollWake_.notify_all();
+    if (pollThread_.joinable()) pollThread_.join();
+}
+
+void LibraryWatchService::pollLoop()
+{
+    using Stamp = QPair<qint64, qint64>;    // size, mtime
+    const QStringList roots = roots_;
+
+    auto snapshot = [&roots, this](QHash<QString, Stamp>& out) {
+        for (const QString& root : roots) {
+            QDirIterator it(root, audioFileFilters(), QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                it.next();
+                const QFileInfo fi = it.fileInfo();
+                out.insert(fi.filePath(),
+                           Stamp(fi.size(), fi.lastModified().toMSecsSinceEpoch()));
+                std::lock_guard<std::mutex> lock(pollMutex_);
+                if (pollStop_) return false;
+            }
+        }
+        return true;
+    };
+
+    QHash<QString, Stamp> state;
+    if (!snapshot(state)) return;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pollMutex_);
+            if (pollWake_.wait_for(lock, std::chrono::milliseconds(cfg_.pollIntervalMs),
+                                   [this] { return pollStop_; }))
+                return;
+        }
+
+        QHash<QString, Stamp> now;
+        if (!snapshot(now)) return;
+
+        QStringList updated, removed;
+        for (auto it = now.constBegin(); it != now.constEnd(); ++it) {
+            auto old = state.constFind(it.key());
+            if (old == state.constEnd() || old.value() != it.value()) updated << it.key();
+        }
+        for (auto it = state.constBegin(); it != state.constEnd(); ++it) {
+            if (!now.contains(it.key())) removed << it.key();
+        }
+        state = std::move(now);
+
+        if (updated.isEmpty() && removed.isEmpty()) continue;
+        QMetaObject::invokeMethod(this, [this, updated, removed]() {
+            for (const QString& p : updated) noteUpdated(p);
+            for (const QString& p : removed) noteRemoved(p);
+            schedule();
+        }, Qt::QueuedConnection);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Debounce + emit (owning thread)
+// ─────────────────────────────────────────────────────────────────────────────
+void LibraryWatchService::noteUpdated(const QString& path)
+{
+    pendingRemoved_.remove(path);
+    pendingUpdated_.insert(path);
+}
+
+void LibraryWatchService::noteRemoved(const QString& path)
+{
+    pendingUpdated_.remove(path);
+    pendingRemoved_.insert(path);
+}
+
+void LibraryWatchService::schedule()
+{
+    if (pendingUpdated_.isEmpty() && pendingRemoved_.isEmpty() && pendingDirs_.isEmpty()
+            && !pendingResync_)
+        return;
+    if (!firstPending_.isValid()) firstPending_.start();
+    if (firstPending_.elapsed() >= cfg_.maxLatencyMs) {
+        debounce_.stop();
+        flush();
+        return;
+    }
+    debounce_.start(cfg_.debounceMs);
+}
+
+void LibraryWatchService::flush()
+{
+    const qint64 latencyMs = firstPending_.isValid() ? firstPending_.elapsed() : 0;
+    firstPending_.invalidate();
+
+    if (pendingResync_) {
+        // The listing supersedes everything noted since the overflow.
+        pendingUpdated_.clear();
+        pendingRemoved_.clear();
+        pendingDirs_.clear();
+        pendingResync_ = false;
+
+        QStringList all;
+        for (const QString& root : std::as_const(roots_)) {
+            QDirIterator it(root, audioFileFilters(), QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) all << it.next();
+        }
+        qInfo().noquote() << QStringLiteral("[WATCH] RESYNC files=%1 latency_ms=%2")
+                                 .arg(all.size()).arg(latencyMs);
+        emit resynced(all);
+        return;
+    }
+
+    // Directories that appeared are listed now that the burst is over.
+    for (const QString& dir : std::as_const(pendingDirs_)) {
+        QDirIterator it(dir, audioFileFilters(), QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) noteUpdated(it.next());
+    }
+
+    const QStringList updated = pendingUpdated_.values();
+    const QStringList removed = pendingRemoved_.values();
+    pendingUpdated_.clear();
+    pendingRemoved_.clear();
+    pendingDirs_.clear();
+
+    if (updated.isEmpty() && removed.isEmpty()) return;
+    qInfo().noquote() << QStringLiteral("[WATCH] FLUSH updated=%1 removed=%2 latency_ms=%3")
+                             .arg(updated.size()).arg(removed.size()).arg(latencyMs);
+    emit changed(updated, removed);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class QSocketNotifier;
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LibraryWatchService
+//
+// Watches the library roots after the initial scan and reports which audio
+// files appeared, changed or went away, so only those paths go through tag
+// parsing and DjLibraryDatabase's incremental sync.
+//
+// On Linux this is inotify: one watch per directory (inotify is not
+// recursive; directories created later are added as they appear), read
+// through a QSocketNotifier on the owning thread, so an idle library costs
+// nothing.  Files are reported on IN_CLOSE_WRITE / IN_MOVED_TO, not IN_CREATE,
+// so a copy in progress is picked up once it is complete.  If inotify is
+// unavailable or runs out of watches, and on other platforms, a background
+// thread polls size/mtime of every audio file instead.  Network mounts do
+// not deliver inotify events for remote writers; use Mode::Polling there.
+//
+// Bursts (an album being copied) are debounced: changes are emitted once the
+// tree has been quiet for debounceMs, or after maxLatencyMs at the latest.
+// If the inotify queue overflows, events (removals among them) are lost;
+// the next flush then relists the roots and emits resynced() instead.
+// ─────────────────────────────────────────────────────────────────────────────
+class LibraryWatchService : public QObject {
+    Q_OBJECT
+public:
+    enum class Mode { Auto, Polling };
+
+    struct Config {
+        Mode mode{Mode::Auto};
+        int  debounceMs{1500};
+        int  maxLatencyMs{10000};
+        int  pollIntervalMs{60000};
+    };
+
+    explicit LibraryWatchService(QObject* parent = nullptr);
+    ~LibraryWatchService() override;
+
+    // Replaces the watched roots and (re)starts watching.  Empty stops.
+    void watch(const QStringList& roots, const Config& cfg = Config{});
+    void stop();
+
+    bool isWatching() const { return !roots_.isEmpty(); }
+    bool usingInotify() const { return inotifyFd_ >= 0; }
+    int  watchedDirectoryCount() const { return static_cast<int>(watchDirs_.size()); }
+
+signals:
+    // updatedFiles: audio files created or modified.
+    // removedPaths: files or directories gone; every library path equal to
+    // or below one of them is gone.
+    void changed(const QStringList& updatedFiles, const QStringList& removedPaths);
+    // After lost events: every audio file now below the roots.  Library
+    // paths below a root that are not listed are gone.
+    void resynced(const QStringList& allFiles);
+
+private:
+    bool startInotify();
+    void stopInotify();
+    bool addWatchTree(const QString& dir);
+    void onInotifyReadable();
+
+    void startPolling();
+    void stopPolling();
+    void pollLoop();
+
+    void noteUpdated(const QString& path);
+    void noteRemoved(const QString& path);
+    void schedule();
+    void flush();
+
+    static bool isAudioFile(const QString& path);
+
+    QStringList   roots_;
+    Config        cfg_;
+
+    // inotify
+    int                  inotifyFd_{-1};
+    QSocketNotifier*     notifier_{nullptr};
+    QHash<int, QString>  watchDirs_;            // wd → directory
+
+    // polling fallback
+    std::thread             pollThread_;
+    std::mutex              pollMutex_;
+    std::condition_variable pollWake_;
+    bool                    pollStop_{false};
+
+    // pending changes (owning thread)
+    QSet<QString>  pendingUpdated_;
+    QSet<QString>  pendingRemoved_;
+    QSet<QString>  pendingDirs_;                // new directories to list
+    bool           pendingResync_{false};       // inotify queue overflowed
+    QTimer         debounce_;
+    QElapsedTimer  firstPending_;
+};
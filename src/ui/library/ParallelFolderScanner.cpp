@@ -0,0 +1,215 @@
+#include "ui/library/ParallelFolderScanner.h"
+
+#include "ui/library/AudioContentHash.h"
+#include "ui/library/DjLibraryDatabase.h"
+#include "ui/library/LibraryScanner.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QtDebug>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Helpers
+// ─────────────────────────────────────────────────────────────────────────────
+static inline QString qs(const char* s) { return QLatin1String(s); }
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Run
+// ─────────────────────────────────────────────────────────────────────────────
+std::vector<TrackInfo> ParallelFolderScanner::run(const QString& folderPath,
+                                                  const std::vector<TrackInfo>& known,
+                                                  const Config& cfg,
+                                                  const BatchFn& onBatch,
+                                                  const ProgressFn& onProgress)
+{
+    cancel_.store(false, std::memory_order_relaxed);
+    progress_ = Progress{};
+
+    QElapsedTimer wall;
+    wall.start();
+
+    // ── 1. Manifest ──────────────────────────────────────────────────────────
+    QHash<QString, const TrackInfo*> manifest;
+    manifest.reserve(static_cast<qsizetype>(known.size()));
+    for (const TrackInfo& t : known) {
+        if (t.modifiedMs > 0)
+            manifest.insert(DjLibraryDatabase::pathKey(t.filePath), &t);
+    }
+
+    const int hw = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int workerCount = cfg.workers > 0 ? cfg.workers : std::min(16, 2 * hw);
+
+    // ── 2. Shared state ──────────────────────────────────────────────────────
+    // Every file found gets a slot in walk order.  The deques only grow, so
+    // a worker can fill its slot outside the lock; indexing them (which may
+    // race with a push_back) happens under it.
+    std::mutex              mutex;
+    std::condition_variable workCv;     // walker → workers
+    std::condition_variable doneCv;     // walker / workers → this thread
+    std::deque<TrackInfo>   slots;
+    std::deque<char>        filled;
+    struct Job {
+        size_t    index{0};
+        QFileInfo fi;
+        bool      hashOnly{false};      // unchanged, only the content hash is missing
+    };
+    std::deque<Job>         queue;
+    std::vector<size_t>     ready;      // filled, not yet handed to onBatch
+    int  inFlight = 0;                  // queued or being parsed
+    int  liveWorkers = workerCount;
+    bool walkDone = false;
+
+    auto walker = [&]() {
+        QDirIterator it(folderPath, audioFileFilters(), QDir::Files,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext() && !cancel_.load(std::memory_order_relaxed)) {
+            it.next();
+            const QFileInfo fi = it.fileInfo();
+
+            const TrackInfo* prev = manifest.value(DjLibraryDatabase::pathKey(fi.filePath()), nullptr);
+            const bool unchanged = prev && prev->fileSize == fi.size()
+                && prev->modifiedMs == fi.lastModified().toMSecsSinceEpoch();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            const size_t index = slots.size();
+            ++progress_.found;
+            if (unchanged && prev->contentHash != 0) {
+                slots.push_back(*prev);
+                filled.push_back(1);
+                ready.push_back(index);
+                ++progress_.unchanged;
+                doneCv.notify_one();
+            } else {
+                // Rows from before content hashing get theirs on the first
+                // rescan, without re-reading their tags.
+                if (unchanged) slots.push_back(*prev);
+                else slots.emplace_back();
+                filled.push_back(0);
+                queue.push_back(Job{index, fi, unchanged});
+                ++inFlight;
+                workCv.notify_one();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            walkDone = true;
+        }
+        workCv.notify_all();
+        doneCv.notify_one();
+    };
+
+    auto worker = [&]() {
+        for (;;) {
+            Job job;
+            TrackInfo* slot = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workCv.wait(lock, [&] {
+                    return !queue.empty() || walkDone || cancel_.load(std::memory_order_relaxed);
+                });
+                if (queue.empty() || cancel_.load(std::memory_order_relaxed)) break;
+                job = std::move(queue.front());
+                queue.pop_front();
+                slot = &slots[job.index];
+            }
+
+            if (job.hashOnly) slot->contentHash = audioContentHash(job.fi.filePath());
+            else *slot = trackFromFile(job.fi);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            filled[job.index] = 1;
+            ready.push_back(job.index);
+            --inFlight;
+            if (job.hashOnly) ++progress_.unchanged;
+            else ++progress_.parsed;
+            doneCv.notify_one();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        --liveWorkers;
+        doneCv.notify_one();
+    };
+
+    std::thread walkThread(walker);
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(workerCount));
+    for (int w = 0; w < workerCount; ++w) workers.emplace_back(worker);
+
+    qInfo().noquote() << qs("[SCAN] START root=") << folderPath
+                      << qs("workers=") << workerCount
+                      << qs("manifest=") << manifest.size();
+
+    // ── 3. Collect on this thread ────────────────────────────────────────────
+    std::vector<TrackInfo> batch;
+    batch.reserve(static_cast<size_t>(std::max(cfg.batchSize, 1)));
+    QElapsedTimer sinceBatch;
+    sinceBatch.start();
+    QElapsedTimer sinceProgress;
+    sinceProgress.start();
+
+    auto snapshotProgress = [&]() {
+        progress_.elapsedSeconds = static_cast<double>(wall.elapsed()) / 1000.0;
+        progress_.filesPerSec = progress_.elapsedSeconds > 0.0
+            ? (progress_.unchanged + progress_.parsed) / progress_.elapsedSeconds : 0.0;
+    };
+
+    for (;;) {
+        bool finished = false;
+        Progress snapshot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            doneCv.wait_for(lock, std::chrono::milliseconds(100), [&] {
+                return !ready.empty() || (walkDone && (inFlight == 0 || liveWorkers == 0));
+            });
+            for (size_t index : ready) batch.push_back(slots[index]);
+            ready.clear();
+            progress_.walkFinished = walkDone;
+            finished = walkDone && (inFlight == 0 || liveWorkers == 0);
+            snapshotProgress();
+            snapshot = progress_;
+        }
+
+        const bool flush = !batch.empty()
+            && (finished
+                || static_cast<int>(batch.size()) >= cfg.batchSize
+                || sinceBatch.elapsed() >= cfg.batchIntervalMs);
+        if (flush) {
+            if (onBatch) onBatch(batch);
+            batch.clear();
+            sinceBatch.restart();
+        }
+        if (onProgress && (flush || finished || sinceProgress.elapsed() >= 200)) {
+            onProgress(snapshot);
+            sinceProgress.restart();
+        }
+        if (finished) break;
+    }
+
+    walkThread.join();
+    for (auto& t : workers) t.join();
+
+    // ── 4. Result in walk order ──────────────────────────────────────────────
+    std::vector<TrackInfo> tracks;
+    tracks.reserve(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (filled[i]) tracks.push_back(std::move(slots[i]));
+    }
+
+    snapshotProgress();
+    qInfo().noquote() << QStringLiteral("[SCAN] %1 found=%2 unchanged=%3 parsed=%4 secs=%5 files_per_sec=%6")
+                             .arg(wasCancelled() ? qs("CANCELLED") : qs("DONE"))
+                             .arg(progress_.found).arg(progress_.unchanged).arg(progress_.parsed)
+                             .arg(progress_.elapsedSeconds, 0, 'f', 2)
+                             .arg(progress_.filesPerSec, 0, 'f', 0);
+    return tracks;
+}
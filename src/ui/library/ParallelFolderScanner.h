@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ui/library/LibraryPersistence.h"
+
+#include <QString>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ParallelFolderScanner
+//
+// Multi-threaded replacement for the old single-iterator folder scan.  One
+// thread walks the directory tree; a pool of workers opens and tag-parses the
+// files it finds (trackFromFile).  Walking and parsing overlap, and on
+// network shares many files are in flight at once, which is where the time
+// goes.
+//
+// The previous scan result is the manifest: a file whose normalized path,
+// size and mtime match an entry there is taken over as-is without being
+// opened, so a rescan of an unchanged library costs one directory listing.
+// (Entries from before content hashing only get the hash computed.)
+//
+// Results are handed to the calling thread in batches (onBatch) as they
+// complete, for streaming into DjLibraryDatabase::mergeTracks; the return
+// value is the full list in walk order.
+// ─────────────────────────────────────────────────────────────────────────────
+class ParallelFolderScanner {
+public:
+    struct Config {
+        int workers{0};             // tag-parsing threads; 0 = 2 × hardware
+                                    // threads (I/O bound), at most 16
+        int batchSize{256};         // tracks per onBatch
+        int batchIntervalMs{1000};  // or this often, whichever first
+    };
+
+    struct Progress {
+        int    found{0};            // audio files seen by the walk
+        int    unchanged{0};        // taken from the manifest
+        int    parsed{0};           // opened and tag-parsed
+        bool   walkFinished{false};
+        double elapsedSeconds{0.0};
+        double filesPerSec{0.0};    // (unchanged + parsed) / elapsed
+    };
+
+    using BatchFn    = std::function<void(const std::vector<TrackInfo>&)>;
+    using ProgressFn = std::function<void(const Progress&)>;
+
+    // Blocking; callbacks run on the calling thread.  `known` is the
+    // manifest (may be empty).  After a cancel the tracks found so far are
+    // returned and wasCancelled() is true.
+    std::vector<TrackInfo> run(const QString& folderPath,
+                               const std::vector<TrackInfo>& known,
+                               const Config& cfg,
+                               const BatchFn& onBatch = {},
+                               const ProgressFn& onProgress = {});
+
+    // Thread-safe.  The walk stops and workers finish their current file.
+    void requestCancel() { cancel_.store(true, std::memory_order_relaxed); }
+    bool wasCancelled() const { return cancel_.load(std::memory_order_relaxed); }
+
+    const Progress& lastProgress() const { return progress_; }
+
+private:
+    std::atomic<bool> cancel_{false};
+    Progress          progress_;
+};
@@ -15,16 +15,20 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QPlainTextEdit>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QScrollArea>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QGuiApplication>
+#include <QHash>
+#include <QMap>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QSaveFile>
+#include <QSet>
 #include <QShortcut>
 #include <QSignalBlocker>
 #include <QStringList>
@@ -48,6 +52,7 @@
 #include <QPainterPath>
 #include <QPen>
 #include <QElapsedTimer>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QDirIterator>
 #include <QSqlDatabase>
@@ -65,6 +70,7 @@
 #include <atomic>
 #include <functional>
 #include <map>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -79,13 +85,24 @@
 #include "ui/EqPanel.h"
 #include "ui/DeckStrip.h"
 #include "engine/DiagLog.h"
+#include "engine/runtime/graph/WaveformPyramid.h"
 
 #include "ui/diagnostics/RuntimeLogSupport.h"
 #include "ui/library/LibraryPersistence.h"
 #include "ui/library/DjLibraryDatabase.h"
+#include "ui/library/BatchAnalyzer.h"
+#include "ui/library/LibrarySearchBench.h"
+#include "ui/library/AudioContentHash.h"
+#include "ui/AnalysisCache.h"
+#include "ui/AnalysisComparator.h"
+#include "ui/TagParser.h"
+#include "ui/TagReaderService.h"
+#include "ui/TagWriteQueue.h"
 #include "ui/library/LibraryBrowserWidget.h"
 #include "ui/library/DjLibraryWidget.h"
 #include "ui/library/LibraryScanner.h"
+#include "ui/library/ParallelFolderScanner.h"
+#include "ui/library/LibraryWatchService.h"
 #include "ui/library/LegacyLibraryImport.h"
 #include "ui/audio/AudioProfileStore.h"
 #include "ui/diagnostics/DiagnosticsDialog.h"
@@ -101,6 +118,22 @@
 
 namespace {
 
+// ── Startup timing ──
+// Wall clock since main() entered; each phase logs its own duration and the
+// running total, so time-to-interactive reads off one grep for [STARTUP].
+QElapsedTimer& startupClock()
+{
+    static QElapsedTimer clock;
+    return clock;
+}
+
+void logStartupPhase(const char* phase, qint64 phaseMs)
+{
+    qInfo().noquote() << QStringLiteral("[STARTUP] phase=%1 ms=%2 total_ms=%3")
+        .arg(QLatin1String(phase)).arg(phaseMs)
+        .arg(startupClock().isValid() ? startupClock().elapsed() : -1);
+}
+
 class MainWindow : public QMainWindow {
 public:
     explicit MainWindow(EngineBridge& engineBridge)
@@ -159,147 +192,68 @@ public:
         rtProbeAutorun_ = (rtAutorun == QStringLiteral("1") || rtAutorun == QStringLiteral("true") || rtAutorun == QStringLiteral("yes"));
 
         // ── Open SQLite library database ──
+        QElapsedTimer phase;
+        phase.start();
         djDb_.open(runtimePath("data/runtime/ngks_library.db"));
+        logStartupPhase("db_open", phase.restart());
 
-        // ── Restore persisted library ──
-        {
-            QString restoredFolder;
-            std::vector<TrackInfo> restoredTracks;
-            if (loadLibraryJson(restoredTracks, restoredFolder)) {
-                allTracks_ = std::move(restoredTracks);
-                importedFolderPath_ = restoredFolder;
-
-                // Auto-merge legacy DB on restore if not already imported
-                bool anyLegacy = false;
-                for (const auto& t : allTracks_) {
-                    if (t.legacyImported) { anyLegacy = true; break; }
-                }
-                if (!anyLegacy) {
-                    const QString dbPath = findLegacyDbPath();
-                    if (!dbPath.isEmpty()) {
-                        const LegacyImportResult res = importLegacyDb(allTracks_, dbPath);
-                        if (res.matched > 0) {
-                            saveLibraryJson(allTracks_, importedFolderPath_);
-                            qInfo().noquote() << QStringLiteral("LEGACY_DB_AUTO_IMPORT matched=%1 total=%2")
-                                .arg(res.matched).arg(res.totalDbRows);
-                        }
-                    }
-                }
-
-                
-                  // Phase 3 Core DB Duration Patch: Load duration from dj_library_core.db directly
-                  {
-                      QString coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      }
-
-                      if (QFile::exists(coreDbPath)) {
-                          const QString connName = QStringLiteral("dj_core_duration_fix");
-                          {
-                              QSqlDatabase coreDb = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
-                              coreDb.setDatabaseName(coreDbPath);
-                              coreDb.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
-                              int matchCore = 0;
-                              if (coreDb.open()) {
-                                  std::map<QString, size_t> pathIndex;
-                                  for (size_t i = 0; i < allTracks_.size(); ++i) {
-                                      pathIndex[QDir::fromNativeSeparators(allTracks_[i].filePath).trimmed().toLower()] = i;
-                                  }
-                                  
-                                  QSqlQuery q(coreDb);
-                                  q.setForwardOnly(true);
-                                  if (q.exec(QStringLiteral("SELECT file_path, duration FROM tracks LIMIT 9999999"))) {
-                                      while (q.next()) {
-                                          QString fp = QDir::fromNativeSeparators(q.value(0).toString()).trimmed().toLower();
-                                          double dur = q.value(1).toDouble();
-                                          if (dur > 0) {
-                                              auto it = pathIndex.find(fp);
-                                              if (it != pathIndex.end()) {
-                                                  TrackInfo& t = allTracks_[it->second];
-                                                  if (t.durationMs <= 0 || t.durationStr == QStringLiteral("--:--") || t.durationStr.isEmpty()) {
-                                                      t.durationMs = static_cast<qint64>(dur * 1000.0);
-                                                      const int totalSec = static_cast<int>(dur);
-                                                      t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                                                      matchCore++;
-                                                  }
-                                              }
-                                          }
-                                      }
-                                      qInfo().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH matched=%1").arg(matchCore);
-                                  } else {
-                                      qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_QUERY ") << q.lastError().text();
-                                  }
-                                  coreDb.close();
-                              } else {
-                                  qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_OPEN ") << coreDb.lastError().text();
-                              }
-                          }
-                          QSqlDatabase::removeDatabase(connName);
-                      } else {
-                          qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH DB_NOT_FOUND ") << coreDbPath;
-                      }
-                  }
-                  
-
-                  // Fallback: For any tracks without duration, estimate it from MP3 filesize
-                  for (auto& t : allTracks_) {
-                      if (t.durationMs <= 0 && t.filePath.endsWith(QStringLiteral(".mp3"), Qt::CaseInsensitive)) {
-                          QFile fFallback(t.filePath);
-                          if (fFallback.open(QIODevice::ReadOnly)) {
-                              QByteArray hdr = fFallback.read(10);
-                              qint64 dataOff = 0;
-                              if (hdr.size() == 10 && hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3') {
-                                  dataOff = 10 + ((quint32(static_cast<unsigned char>(hdr[6])) << 21)
-                                               | (quint32(static_cast<unsigned char>(hdr[7])) << 14)
-                                               | (quint32(static_cast<unsigned char>(hdr[8])) << 7)
-                                               | quint32(static_cast<unsigned char>(hdr[9])));
-                              }
-                              fFallback.seek(dataOff);
-                              QByteArray buf = fFallback.read(8192);
-                              int bitrate = 0;
-                              for (int i = 0; i < buf.size() - 3; ++i) {
-                                  if ((static_cast<unsigned char>(buf[i]) == 0xFF) && ((static_cast<unsigned char>(buf[i+1]) & 0xE0) == 0xE0)) {
-                                      int bitrateIdx = (static_cast<unsigned char>(buf[i+2]) >> 4) & 0x0F;
-                                      int layer = (static_cast<unsigned char>(buf[i+1]) >> 1) & 0x03;
-                                      int ver = (static_cast<unsigned char>(buf[i+1]) >> 3) & 0x03;
-                                      static const int bitrates[2][3][16] = {
-                                          { {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,32,48,56,64,80,96,112,128,144,160,176,192,224,256,0} },
-                                          { {0,32,40,48,56,64,80,96,112,128,160,192,224,256,320,0}, {0,32,48,56,64,80,96,112,128,160,192,224,256,320,384,0}, {0,32,64,96,128,160,192,224,256,288,320,352,384,416,448,0} }
-                                      };
-                                      int mpegIdx = (ver == 3) ? 1 : 0;
-                                      int layerIdx = (layer == 1) ? 0 : ((layer == 2) ? 1 : 2);
-                                      bitrate = bitrates[mpegIdx][layerIdx][bitrateIdx];
-                                      break;
-                                  }
-                              }
-                              if (bitrate <= 0) bitrate = 256;
-                              t.durationMs = static_cast<qint64>(((fFallback.size() - dataOff) * 8.0) / (bitrate * 1000.0) * 1000.0);
-                              int totalSec = static_cast<int>(t.durationMs / 1000);
-                              t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                          }
-                      }
-                  }
-
-djDb_.bulkInsert(allTracks_);
-                refreshLibraryList();
-                rebuildPlayerQueue();
-                qInfo().noquote() << QStringLiteral("LIBRARY_RESTORED=%1").arg(allTracks_.size());
-            }
+        // ── Restore library ──
+        // The library table is the source of truth and is read straight back;
+        // library.json is only read once, to migrate an older install.
+        if (djDb_.metaValue(QStringLiteral("json_migrated")).isEmpty()) {
+            migrateLibraryJson();
+        } else {
+            djDb_.loadTracks(allTracks_, trackIds_);
+            rebuildTrackIndex();
+            importedFolderPath_ = djDb_.metaValue(QStringLiteral("library_folder"));
+        }
+        logStartupPhase("library_load", phase.restart());
+
+        if (libraryTree_) {
+            // First count from the query worker: the first page follows in
+            // the same round trip.
+            auto firstPage = std::make_shared<QMetaObject::Connection>();
+            *firstPage = QObject::connect(libraryTree_, &LibraryBrowserWidget::trackCountChanged, this,
+                                          [firstPage](int count) {
+                QObject::disconnect(*firstPage);
+                qInfo().noquote() << QStringLiteral("[STARTUP] phase=model_first_page rows=%1 total_ms=%2")
+                    .arg(count).arg(startupClock().elapsed());
+            });
+        }
+        if (!allTracks_.empty()) {
+            refreshLibraryList();
+            rebuildPlayerQueue();
+            qInfo().noquote() << QStringLiteral("LIBRARY_RESTORED=%1").arg(allTracks_.size());
         }
 
-        // ── Restore persisted playlists ──
-        loadPlaylists(playlists_);
+        // ── Live library watch ──
+        libraryWatch_ = new LibraryWatchService(this);
+        QObject::connect(libraryWatch_, &LibraryWatchService::changed, this,
+                         [this](const QStringList& updated, const QStringList& removed) {
+            applyWatchedChanges(updated, removed);
+        });
+        QObject::connect(libraryWatch_, &LibraryWatchService::resynced, this,
+                         [this](const QStringList& allFiles) {
+            resyncWatchedRoot(allFiles);
+        });
+
+        // ── Playlists: live in the library DB; playlists.json is imported once ──
+        if (djDb_.metaValue(QStringLiteral("playlists_migrated")).isEmpty()) {
+            std::vector<Playlist> legacy;
+            if (loadPlaylists(legacy) && !legacy.empty())
+                djDb_.importPlaylists(legacy);
+            djDb_.setMetaValue(QStringLiteral("playlists_migrated"), QStringLiteral("1"));
+        }
+        reloadPlaylists();
         qInfo().noquote() << QStringLiteral("PLAYLISTS_RESTORED=%1").arg(playlists_.size());
 
-        // ── Splash auto-transition (2 s) ──
-        QTimer::singleShot(2000, this, [this]() { stack_->setCurrentIndex(1); });
+        // ── Splash → landing on the first event-loop pass; the rest of the
+        //    library startup (legacy merge, duration patch, watch) runs after ──
+        QTimer::singleShot(0, this, [this]() {
+            stack_->setCurrentIndex(1);
+            logStartupPhase("interactive", 0);
+            QTimer::singleShot(0, this, [this]() { deferredLibraryStartup(); });
+        });
 
 
         // ── Refresh player library every time the player page becomes visible ──
@@ -319,6 +273,11 @@ djDb_.bulkInsert(allTracks_);
         }
     }
 
+    ~MainWindow() override
+    {
+        flushLibraryJson();
+    }
+
 private:
     // ── Page builders ──
     QWidget* buildSplashPage()
@@ -552,216 +511,45 @@ private:
             if (dir.isEmpty()) return;
             qInfo().noquote() << QStringLiteral("LIBRARY_SCAN_STARTED=%1").arg(dir);
 
-            allTracks_ = scanFolderForTracks(dir);
+            // The current library is the scan manifest: files whose size and
+            // mtime did not change are not reopened.  Parsed batches stream
+            // into the DB while the walk continues.
+            ParallelFolderScanner scanner;
+            QProgressDialog progress(QStringLiteral("Scanning %1").arg(dir),
+                                     QStringLiteral("Cancel"), 0, 0, this);
+            progress.setWindowModality(Qt::WindowModal);
+            progress.setMinimumDuration(500);
+            QObject::connect(&progress, &QProgressDialog::canceled, &progress,
+                             [&scanner]() { scanner.requestCancel(); });
+
+            std::vector<qint64> batchIds;
+            std::vector<TrackInfo> scanned = scanner.run(dir, allTracks_, ParallelFolderScanner::Config{},
+                [this, &batchIds](const std::vector<TrackInfo>& batch) {
+                    djDb_.mergeTracks(batch, batchIds);
+                },
+                [&progress](const ParallelFolderScanner::Progress& p) {
+                    progress.setLabelText(QStringLiteral("Scanning: %1 files (%2 unchanged), %3 files/s")
+                        .arg(p.found).arg(p.unchanged).arg(p.filesPerSec, 0, 'f', 0));
+                    QCoreApplication::processEvents();
+                });
+            if (scanner.wasCancelled()) {
+                // Drop the rows the partial scan streamed in.
+                syncLibraryDb();
+                qInfo().noquote() << QStringLiteral("LIBRARY_SCAN_CANCELLED found=%1")
+                    .arg(scanner.lastProgress().found);
+                return;
+            }
+            qInfo().noquote() << QStringLiteral("LIBRARY_SCAN_RATE files_per_sec=%1 unchanged=%2 parsed=%3")
+                .arg(scanner.lastProgress().filesPerSec, 0, 'f', 0)
+                .arg(scanner.lastProgress().unchanged).arg(scanner.lastProgress().parsed);
+
+            allTracks_ = std::move(scanned);
             importedFolderPath_ = dir;
             qInfo().noquote() << QStringLiteral("FILES_FOUND=%1").arg(allTracks_.size());
             qInfo().noquote() << QStringLiteral("TRACKS_INDEXED=%1").arg(allTracks_.size());
 
-            
-                  // Phase 3 Core DB Duration Patch: Load duration from dj_library_core.db directly
-                  {
-                      QString coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      }
-
-                      if (QFile::exists(coreDbPath)) {
-                          const QString connName = QStringLiteral("dj_core_duration_fix");
-                          {
-                              QSqlDatabase coreDb = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
-                              coreDb.setDatabaseName(coreDbPath);
-                              coreDb.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
-                              int matchCore = 0;
-                              if (coreDb.open()) {
-                                  std::map<QString, size_t> pathIndex;
-                                  for (size_t i = 0; i < allTracks_.size(); ++i) {
-                                      pathIndex[QDir::fromNativeSeparators(allTracks_[i].filePath).trimmed().toLower()] = i;
-                                  }
-                                  
-                                  QSqlQuery q(coreDb);
-                                  q.setForwardOnly(true);
-                                  if (q.exec(QStringLiteral("SELECT file_path, duration FROM tracks LIMIT 9999999"))) {
-                                      while (q.next()) {
-                                          QString fp = QDir::fromNativeSeparators(q.value(0).toString()).trimmed().toLower();
-                                          double dur = q.value(1).toDouble();
-                                          if (dur > 0) {
-                                              auto it = pathIndex.find(fp);
-                                              if (it != pathIndex.end()) {
-                                                  TrackInfo& t = allTracks_[it->second];
-                                                  if (t.durationMs <= 0 || t.durationStr == QStringLiteral("--:--") || t.durationStr.isEmpty()) {
-                                                      t.durationMs = static_cast<qint64>(dur * 1000.0);
-                                                      const int totalSec = static_cast<int>(dur);
-                                                      t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                                                      matchCore++;
-                                                  }
-                                              }
-                                          }
-                                      }
-                                      qInfo().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH matched=%1").arg(matchCore);
-                                  } else {
-                                      qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_QUERY ") << q.lastError().text();
-                                  }
-                                  coreDb.close();
-                              } else {
-                                  qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_OPEN ") << coreDb.lastError().text();
-                              }
-                          }
-                          QSqlDatabase::removeDatabase(connName);
-                      } else {
-                          qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH DB_NOT_FOUND ") << coreDbPath;
-                      }
-                  }
-                  
-
-                  // Fallback: For any tracks without duration, estimate it from MP3 filesize
-                  for (auto& t : allTracks_) {
-                      if (t.durationMs <= 0 && t.filePath.endsWith(QStringLiteral(".mp3"), Qt::CaseInsensitive)) {
-                          QFile fFallback(t.filePath);
-                          if (fFallback.open(QIODevice::ReadOnly)) {
-                              QByteArray hdr = fFallback.read(10);
-                              qint64 dataOff = 0;
-                              if (hdr.size() == 10 && hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3') {
-                                  dataOff = 10 + ((quint32(static_cast<unsigned char>(hdr[6])) << 21)
-                                               | (quint32(static_cast<unsigned char>(hdr[7])) << 14)
-                                               | (quint32(static_cast<unsigned char>(hdr[8])) << 7)
-                                               | quint32(static_cast<unsigned char>(hdr[9])));
-                              }
-                              fFallback.seek(dataOff);
-                              QByteArray buf = fFallback.read(8192);
-                              int bitrate = 0;
-                              for (int i = 0; i < buf.size() - 3; ++i) {
-                                  if ((static_cast<unsigned char>(buf[i]) == 0xFF) && ((static_cast<unsigned char>(buf[i+1]) & 0xE0) == 0xE0)) {
-                                      int bitrateIdx = (static_cast<unsigned char>(buf[i+2]) >> 4) & 0x0F;
-                                      int layer = (static_cast<unsigned char>(buf[i+1]) >> 1) & 0x03;
-                                      int ver = (static_cast<unsigned char>(buf[i+1]) >> 3) & 0x03;
-                                      static const int bitrates[2][3][16] = {
-                                          { {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,32,48,56,64,80,96,112,128,144,160,176,192,224,256,0} },
-                                          { {0,32,40,48,56,64,80,96,112,128,160,192,224,256,320,0}, {0,32,48,56,64,80,96,112,128,160,192,224,256,320,384,0}, {0,32,64,96,128,160,192,224,256,288,320,352,384,416,448,0} }
-                                      };
-                                      int mpegIdx = (ver == 3) ? 1 : 0;
-                                      int layerIdx = (layer == 1) ? 0 : ((layer == 2) ? 1 : 2);
-                                      bitrate = bitrates[mpegIdx][layerIdx][bitrateIdx];
-                                      break;
-                                  }
-                              }
-                              if (bitrate <= 0) bitrate = 256;
-                              t.durationMs = static_cast<qint64>(((fFallback.size() - dataOff) * 8.0) / (bitrate * 1000.0) * 1000.0);
-                              int totalSec = static_cast<int>(t.durationMs / 1000);
-                              t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                          }
-                      }
-                  }
-
-djDb_.bulkInsert(allTracks_);
-
-            
-                  // Phase 3 Core DB Duration Patch: Load duration from dj_library_core.db directly
-                  {
-                      QString coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      }
-
-                      if (QFile::exists(coreDbPath)) {
-                          const QString connName = QStringLiteral("dj_core_duration_fix");
-                          {
-                              QSqlDatabase coreDb = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
-                              coreDb.setDatabaseName(coreDbPath);
-                              coreDb.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
-                              int matchCore = 0;
-                              if (coreDb.open()) {
-                                  std::map<QString, size_t> pathIndex;
-                                  for (size_t i = 0; i < allTracks_.size(); ++i) {
-                                      pathIndex[QDir::fromNativeSeparators(allTracks_[i].filePath).trimmed().toLower()] = i;
-                                  }
-                                  
-                                  QSqlQuery q(coreDb);
-                                  q.setForwardOnly(true);
-                                  if (q.exec(QStringLiteral("SELECT file_path, duration FROM tracks LIMIT 9999999"))) {
-                                      while (q.next()) {
-                                          QString fp = QDir::fromNativeSeparators(q.value(0).toString()).trimmed().toLower();
-                                          double dur = q.value(1).toDouble();
-                                          if (dur > 0) {
-                                              auto it = pathIndex.find(fp);
-                                              if (it != pathIndex.end()) {
-                                                  TrackInfo& t = allTracks_[it->second];
-                                                  if (t.durationMs <= 0 || t.durationStr == QStringLiteral("--:--") || t.durationStr.isEmpty()) {
-                                                      t.durationMs = static_cast<qint64>(dur * 1000.0);
-                                                      const int totalSec = static_cast<int>(dur);
-                                                      t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                                                      matchCore++;
-                                                  }
-                                              }
-                                          }
-                                      }
-                                      qInfo().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH matched=%1").arg(matchCore);
-                                  } else {
-                                      qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_QUERY ") << q.lastError().text();
-                                  }
-                                  coreDb.close();
-                              } else {
-                                  qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_OPEN ") << coreDb.lastError().text();
-                              }
-                          }
-                          QSqlDatabase::removeDatabase(connName);
-                      } else {
-                          qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH DB_NOT_FOUND ") << coreDbPath;
-                      }
-                  }
-                  
-
-                  // Fallback: For any tracks without duration, estimate it from MP3 filesize
-                  for (auto& t : allTracks_) {
-                      if (t.durationMs <= 0 && t.filePath.endsWith(QStringLiteral(".mp3"), Qt::CaseInsensitive)) {
-                          QFile fFallback(t.filePath);
-                          if (fFallback.open(QIODevice::ReadOnly)) {
-                              QByteArray hdr = fFallback.read(10);
-                              qint64 dataOff = 0;
-                              if (hdr.size() == 10 && hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3') {
-                                  dataOff = 10 + ((quint32(static_cast<unsigned char>(hdr[6])) << 21)
-                                               | (quint32(static_cast<unsigned char>(hdr[7])) << 14)
-                                               | (quint32(static_cast<unsigned char>(hdr[8])) << 7)
-                                               | quint32(static_cast<unsigned char>(hdr[9])));
-                              }
-                              fFallback.seek(dataOff);
-                              QByteArray buf = fFallback.read(8192);
-                              int bitrate = 0;
-                              for (int i = 0; i < buf.size() - 3; ++i) {
-                                  if ((static_cast<unsigned char>(buf[i]) == 0xFF) && ((static_cast<unsigned char>(buf[i+1]) & 0xE0) == 0xE0)) {
-                                      int bitrateIdx = (static_cast<unsigned char>(buf[i+2]) >> 4) & 0x0F;
-                                      int layer = (static_cast<unsigned char>(buf[i+1]) >> 1) & 0x03;
-                                      int ver = (static_cast<unsigned char>(buf[i+1]) >> 3) & 0x03;
-                                      static const int bitrates[2][3][16] = {
-                                          { {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,32,48,56,64,80,96,112,128,144,160,176,192,224,256,0} },
-                                          { {0,32,40,48,56,64,80,96,112,128,160,192,224,256,320,0}, {0,32,48,56,64,80,96,112,128,160,192,224,256,320,384,0}, {0,32,64,96,128,160,192,224,256,288,320,352,384,416,448,0} }
-                                      };
-                                      int mpegIdx = (ver == 3) ? 1 : 0;
-                                      int layerIdx = (layer == 1) ? 0 : ((layer == 2) ? 1 : 2);
-                                      bitrate = bitrates[mpegIdx][layerIdx][bitrateIdx];
-                                      break;
-                                  }
-                              }
-                              if (bitrate <= 0) bitrate = 256;
-                              t.durationMs = static_cast<qint64>(((fFallback.size() - dataOff) * 8.0) / (bitrate * 1000.0) * 1000.0);
-                              int totalSec = static_cast<int>(t.durationMs / 1000);
-                              t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                          }
-                      }
-                  }
-
-djDb_.bulkInsert(allTracks_);
+            patchMissingDurations();
+            syncLibraryDb();
 
             // Clear detail panel before rebuild
             clearTrackDetail();
@@ -770,6 +558,7 @@ djDb_.bulkInsert(allTracks_);
             // Save library to disk (metadata already extracted during scan)
             saveLibraryJson(allTracks_, importedFolderPath_);
             qInfo().noquote() << QStringLiteral("LIBRARY_PERSISTED=POST_SCAN");
+            watchLibraryRoot();
         });
 
         // Import legacy DB
@@ -790,108 +579,8 @@ djDb_.bulkInsert(allTracks_);
             qInfo().noquote() << QStringLiteral("LEGACY_DB_IMPORT_DONE matched=%1 unmatched=%2 total=%3")
                 .arg(res.matched).arg(res.unmatched).arg(res.totalDbRows);
 
-            
-                  // Phase 3 Core DB Duration Patch: Load duration from dj_library_core.db directly
-                  {
-                      QString coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../data/dj_library_core.db");
-                      }
-                      if (!QFile::exists(coreDbPath)) {
-                          coreDbPath = QDir::currentPath() + QStringLiteral("/../../../data/dj_library_core.db");
-                      }
-
-                      if (QFile::exists(coreDbPath)) {
-                          const QString connName = QStringLiteral("dj_core_duration_fix");
-                          {
-                              QSqlDatabase coreDb = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
-                              coreDb.setDatabaseName(coreDbPath);
-                              coreDb.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
-                              int matchCore = 0;
-                              if (coreDb.open()) {
-                                  std::map<QString, size_t> pathIndex;
-                                  for (size_t i = 0; i < allTracks_.size(); ++i) {
-                                      pathIndex[QDir::fromNativeSeparators(allTracks_[i].filePath).trimmed().toLower()] = i;
-                                  }
-                                  
-                                  QSqlQuery q(coreDb);
-                                  q.setForwardOnly(true);
-                                  if (q.exec(QStringLiteral("SELECT file_path, duration FROM tracks LIMIT 9999999"))) {
-                                      while (q.next()) {
-                                          QString fp = QDir::fromNativeSeparators(q.value(0).toString()).trimmed().toLower();
-                                          double dur = q.value(1).toDouble();
-                                          if (dur > 0) {
-                                              auto it = pathIndex.find(fp);
-                                              if (it != pathIndex.end()) {
-                                                  TrackInfo& t = allTracks_[it->second];
-                                                  if (t.durationMs <= 0 || t.durationStr == QStringLiteral("--:--") || t.durationStr.isEmpty()) {
-                                                      t.durationMs = static_cast<qint64>(dur * 1000.0);
-                                                      const int totalSec = static_cast<int>(dur);
-                                                      t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                                                      matchCore++;
-                                                  }
-                                              }
-                                          }
-                                      }
-                                      qInfo().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH matched=%1").arg(matchCore);
-                                  } else {
-                                      qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_QUERY ") << q.lastError().text();
-                                  }
-                                  coreDb.close();
-                              } else {
-                                  qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_OPEN ") << coreDb.lastError().text();
-                              }
-                          }
-                          QSqlDatabase::removeDatabase(connName);
-                      } else {
-                          qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH DB_NOT_FOUND ") << coreDbPath;
-                      }
-                  }
-                  
-
-                  // Fallback: For any tracks without duration, estimate it from MP3 filesize
-                  for (auto& t : allTracks_) {
-                      if (t.durationMs <= 0 && t.filePath.endsWith(QStringLiteral(".mp3"), Qt::CaseInsensitive)) {
-                          QFile fFallback(t.filePath);
-                          if (fFallback.open(QIODevice::ReadOnly)) {
-                              QByteArray hdr = fFallback.read(10);
-                              qint64 dataOff = 0;
-                              if (hdr.size() == 10 && hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3') {
-                                  dataOff = 10 + ((quint32(static_cast<unsigned char>(hdr[6])) << 21)
-                                               | (quint32(static_cast<unsigned char>(hdr[7])) << 14)
-                                               | (quint32(static_cast<unsigned char>(hdr[8])) << 7)
-                                               | quint32(static_cast<unsigned char>(hdr[9])));
-                              }
-                              fFallback.seek(dataOff);
-                              QByteArray buf = fFallback.read(8192);
-                              int bitrate = 0;
-                              for (int i = 0; i < buf.size() - 3; ++i) {
-                                  if ((static_cast<unsigned char>(buf[i]) == 0xFF) && ((static_cast<unsigned char>(buf[i+1]) & 0xE0) == 0xE0)) {
-                                      int bitrateIdx = (static_cast<unsigned char>(buf[i+2]) >> 4) & 0x0F;
-                                      int layer = (static_cast<unsigned char>(buf[i+1]) >> 1) & 0x03;
-                                      int ver = (static_cast<unsigned char>(buf[i+1]) >> 3) & 0x03;
-                                      static const int bitrates[2][3][16] = {
-                                          { {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,32,48,56,64,80,96,112,128,144,160,176,192,224,256,0} },
-                                          { {0,32,40,48,56,64,80,96,112,128,160,192,224,256,320,0}, {0,32,48,56,64,80,96,112,128,160,192,224,256,320,384,0}, {0,32,64,96,128,160,192,224,256,288,320,352,384,416,448,0} }
-                                      };
-                                      int mpegIdx = (ver == 3) ? 1 : 0;
-                                      int layerIdx = (layer == 1) ? 0 : ((layer == 2) ? 1 : 2);
-                                      bitrate = bitrates[mpegIdx][layerIdx][bitrateIdx];
-                                      break;
-                                  }
-                              }
-                              if (bitrate <= 0) bitrate = 256;
-                              t.durationMs = static_cast<qint64>(((fFallback.size() - dataOff) * 8.0) / (bitrate * 1000.0) * 1000.0);
-                              int totalSec = static_cast<int>(t.durationMs / 1000);
-                              t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
-                          }
-                      }
-                  }
-
-djDb_.bulkInsert(allTracks_);
+            patchMissingDurations();
+            syncLibraryDb();
             refreshLibraryList();
             saveLibraryJson(allTracks_, importedFolderPath_);
             qInfo().noquote() << QStringLiteral("LIBRARY_PERSISTED=POST_LEGACY_IMPORT");
@@ -904,7 +593,7 @@ djDb_.bulkInsert(allTracks_);
         // Single-click → show detail
         QObject::connect(libraryTree_, &LibraryBrowserWidget::trackSelected, this,
             [this](qint64 trackId) {
-            const int trackIdx = static_cast<int>(trackId);
+            const int trackIdx = trackIndexForId(trackId);
             if (trackIdx < 0 || trackIdx >= static_cast<int>(allTracks_.size())) return;
             showTrackDetail(trackIdx);
         });
@@ -912,7 +601,7 @@ djDb_.bulkInsert(allTracks_);
         // Double-click track → play
         QObject::connect(libraryTree_, &LibraryBrowserWidget::trackActivated, this,
             [this](qint64 trackId) {
-            const int trackIdx = static_cast<int>(trackId);
+            const int trackIdx = trackIndexForId(trackId);
             if (trackIdx < 0 || trackIdx >= static_cast<int>(allTracks_.size())) return;
             currentTrackIndex_ = trackIdx;
             qInfo().noquote() << QStringLiteral("TRACK_SELECTED=%1").arg(allTracks_[trackIdx].displayName);
@@ -925,7 +614,7 @@ djDb_.bulkInsert(allTracks_);
         // ── Right-click context menu on library tree ──
         QObject::connect(libraryTree_, &LibraryBrowserWidget::contextMenuRequested, this,
             [this](qint64 trackId, QPoint globalPos) {
-            const int trackIdx = static_cast<int>(trackId);
+            const int trackIdx = trackIndexForId(trackId);
             if (trackIdx < 0 || trackIdx >= static_cast<int>(allTracks_.size())) return;
             libraryTree_->setCurrentTrackId(trackId);
             const TrackInfo& t = allTracks_[trackIdx];
@@ -970,9 +659,9 @@ djDb_.bulkInsert(allTracks_);
             auto* playlistMenu = menu.addMenu(QStringLiteral("Add to Playlist"));
             playlistMenu->setStyleSheet(menu.styleSheet());
             std::vector<QAction*> playlistActions;
-            for (size_t pi = 0; pi < playlists_.size(); ++pi) {
-                auto* a = playlistMenu->addAction(playlists_[pi].name);
-                a->setData(static_cast<int>(pi));
+            for (const auto& pl : playlists_) {
+                auto* a = playlistMenu->addAction(pl.name);
+                a->setData(pl.id);
                 playlistActions.push_back(a);
             }
             if (!playlists_.empty()) playlistMenu->addSeparator();
@@ -1002,7 +691,7 @@ djDb_.bulkInsert(allTracks_);
                 showTrackDetail(trackIdx);
                 qInfo().noquote() << QStringLiteral("CTX_TRACK_INFO=%1").arg(t.displayName);
             } else if (chosen == refreshMetaAction) {
-                readId3Tags(allTracks_[trackIdx]);
+                readTrackTags(allTracks_[trackIdx]);
                 updateTreeItemForTrack(trackIdx);
                 saveLibraryJson(allTracks_, importedFolderPath_);
                 qInfo().noquote() << QStringLiteral("CTX_REFRESH_META=%1").arg(allTracks_[trackIdx].displayName);
@@ -1016,6 +705,7 @@ djDb_.bulkInsert(allTracks_);
             } else if (chosen == removeAction) {
                 qInfo().noquote() << QStringLiteral("CTX_REMOVE=%1").arg(t.displayName);
                 allTracks_.erase(allTracks_.begin() + trackIdx);
+                syncLibraryDb();
                 saveLibraryJson(allTracks_, importedFolderPath_);
                 refreshLibraryList();
             } else if (chosen == deleteFromDiskAction) {
@@ -1043,6 +733,7 @@ djDb_.bulkInsert(allTracks_);
                     if (QFile::remove(path)) {
                         qInfo().noquote() << QStringLiteral("CTX_DELETE_DISK_OK=%1 PATH=%2").arg(name, path);
                         allTracks_.erase(allTracks_.begin() + trackIdx);
+                        syncLibraryDb();
                         saveLibraryJson(allTracks_, importedFolderPath_);
                         refreshLibraryList();
                     } else {
@@ -1059,24 +750,23 @@ djDb_.bulkInsert(allTracks_);
                     QStringLiteral("New Playlist"),
                     QStringLiteral("Playlist name:"),
                     QLineEdit::Normal, QString(), &ok);
-                if (ok && !name.trimmed().isEmpty()) {
-                    Playlist pl;
-                    pl.name = name.trimmed();
-                    pl.trackPaths.append(t.filePath);
-                    playlists_.push_back(std::move(pl));
-                    savePlaylists(playlists_);
+                const qint64 plId = (ok && !name.trimmed().isEmpty())
+                                    ? djDb_.createPlaylist(name.trimmed()) : -1;
+                if (plId >= 0) {
+                    djDb_.addToPlaylist(plId, {trackId});
+                    reloadPlaylists();
                     qInfo().noquote() << QStringLiteral("CTX_NEW_PLAYLIST=%1 TRACK=%2").arg(name.trimmed(), t.displayName);
                 }
             } else {
                 // Check if an existing playlist was selected
                 for (auto* pa : playlistActions) {
                     if (chosen == pa) {
-                        const int pi = pa->data().toInt();
-                        if (pi >= 0 && pi < static_cast<int>(playlists_.size())) {
-                            playlists_[pi].trackPaths.append(t.filePath);
-                            savePlaylists(playlists_);
+                        const qint64 plId = pa->data().toLongLong();
+                        if (djDb_.addToPlaylist(plId, {trackId}) > 0) {
+                            reloadPlaylists();
+                            if (plId == activePlaylistId_) refreshLibraryList();
                             qInfo().noquote() << QStringLiteral("CTX_ADD_TO_PLAYLIST=%1 TRACK=%2")
-                                .arg(playlists_[pi].name, t.displayName);
+                                .arg(pa->text(), t.displayName);
                         }
                         break;
                     }
@@ -1109,7 +799,7 @@ djDb_.bulkInsert(allTracks_);
         // ── Now Playing button — scroll to current track ──
         QObject::connect(nowPlayingBtn, &QPushButton::clicked, this, [this]() {
             if (currentTrackIndex_ < 0 || currentTrackIndex_ >= static_cast<int>(allTracks_.size())) return;
-            libraryTree_->scrollToTrackId(static_cast<qint64>(currentTrackIndex_));
+            libraryTree_->scrollToTrackId(trackIdForIndex(currentTrackIndex_));
             qInfo().noquote() << QStringLiteral("NOW_PLAYING_SCROLL=%1").arg(allTracks_[currentTrackIndex_].displayName);
         });
 
@@ -1122,20 +812,20 @@ djDb_.bulkInsert(allTracks_);
 
             // "Show All Library" — clears playlist filter
             auto* showAllAction = menu.addAction(QStringLiteral("Show All Library"));
-            showAllAction->setEnabled(activePlaylistIndex_ >= 0);
+            showAllAction->setEnabled(activePlaylistId_ != DjLibraryDatabase::kNoPlaylist);
 
             menu.addSeparator();
 
             // List existing playlists
             std::vector<QAction*> plActions;
-            for (size_t pi = 0; pi < playlists_.size(); ++pi) {
+            for (const auto& pl : playlists_) {
                 const QString label = QStringLiteral("%1 (%2)")
-                    .arg(playlists_[pi].name)
-                    .arg(playlists_[pi].trackPaths.size());
+                    .arg(pl.name)
+                    .arg(pl.trackCount);
                 auto* a = menu.addAction(label);
                 a->setCheckable(true);
-                a->setChecked(static_cast<int>(pi) == activePlaylistIndex_);
-                a->setData(static_cast<int>(pi));
+                a->setChecked(pl.id == activePlaylistId_);
+                a->setData(pl.id);
                 plActions.push_back(a);
             }
 
@@ -1152,7 +842,7 @@ djDb_.bulkInsert(allTracks_);
             if (!chosen) return;
 
             if (chosen == showAllAction) {
-                activePlaylistIndex_ = -1;
+                activePlaylistId_ = DjLibraryDatabase::kNoPlaylist;
                 playlistsBtn->setText(QStringLiteral("Playlists"));
                 refreshLibraryList();
                 qInfo().noquote() << QStringLiteral("PLAYLIST_FILTER=ALL");
@@ -1162,11 +852,8 @@ djDb_.bulkInsert(allTracks_);
                     QStringLiteral("New Playlist"),
                     QStringLiteral("Playlist name:"),
                     QLineEdit::Normal, QString(), &ok);
-                if (ok && !name.trimmed().isEmpty()) {
-                    Playlist pl;
-                    pl.name = name.trimmed();
-                    playlists_.push_back(std::move(pl));
-                    savePlaylists(playlists_);
+                if (ok && !name.trimmed().isEmpty() && djDb_.createPlaylist(name.trimmed()) >= 0) {
+                    reloadPlaylists();
                     qInfo().noquote() << QStringLiteral("PLAYLIST_CREATED=%1").arg(name.trimmed());
                 }
             } else if (chosen == deletePlAction) {
@@ -1174,24 +861,21 @@ djDb_.bulkInsert(allTracks_);
                 QMenu delMenu(playlistsBtn);
                 delMenu.setStyleSheet(menu.styleSheet());
                 std::vector<QAction*> delActions;
-                for (size_t pi = 0; pi < playlists_.size(); ++pi) {
-                    auto* a = delMenu.addAction(playlists_[pi].name);
-                    a->setData(static_cast<int>(pi));
+                for (const auto& pl : playlists_) {
+                    auto* a = delMenu.addAction(pl.name);
+                    a->setData(pl.id);
                     delActions.push_back(a);
                 }
                 auto* delChosen = delMenu.exec(QCursor::pos());
                 if (delChosen) {
-                    const int di = delChosen->data().toInt();
-                    if (di >= 0 && di < static_cast<int>(playlists_.size())) {
-                        const QString deletedName = playlists_[di].name;
-                        playlists_.erase(playlists_.begin() + di);
-                        savePlaylists(playlists_);
-                        if (activePlaylistIndex_ == di) {
-                            activePlaylistIndex_ = -1;
+                    const qint64 delId = delChosen->data().toLongLong();
+                    if (djDb_.deletePlaylist(delId)) {
+                        const QString deletedName = delChosen->text();
+                        reloadPlaylists();
+                        if (activePlaylistId_ == delId) {
+                            activePlaylistId_ = DjLibraryDatabase::kNoPlaylist;
                             playlistsBtn->setText(QStringLiteral("Playlists"));
                             refreshLibraryList();
-                        } else if (activePlaylistIndex_ > di) {
-                            --activePlaylistIndex_;
                         }
                         qInfo().noquote() << QStringLiteral("PLAYLIST_DELETED=%1").arg(deletedName);
                     }
@@ -1200,12 +884,14 @@ djDb_.bulkInsert(allTracks_);
                 // Check if an existing playlist was selected to filter
                 for (auto* pa : plActions) {
                     if (chosen == pa) {
-                        const int pi = pa->data().toInt();
-                        if (pi >= 0 && pi < static_cast<int>(playlists_.size())) {
-                            activePlaylistIndex_ = pi;
-                            playlistsBtn->setText(QStringLiteral("Playlists: %1").arg(playlists_[pi].name));
+                        const qint64 plId = pa->data().toLongLong();
+                        for (const auto& pl : playlists_) {
+                            if (pl.id != plId) continue;
+                            activePlaylistId_ = plId;
+                            playlistsBtn->setText(QStringLiteral("Playlists: %1").arg(pl.name));
                             refreshLibraryList();
-                            qInfo().noquote() << QStringLiteral("PLAYLIST_FILTER=%1").arg(playlists_[pi].name);
+                            qInfo().noquote() << QStringLiteral("PLAYLIST_FILTER=%1").arg(pl.name);
+                            break;
                         }
                         break;
                     }
@@ -1523,6 +1209,12 @@ djDb_.bulkInsert(allTracks_);
             if (freshLevel > 0.0f || bridge_.running())
                 visualizer_->setAudioLevel(freshLevel);
 
+            // Real bars from the master-bus spectrum tap
+            ngks::SpectrumFrame spectrum;
+            if (bridge_.tryGetSpectrum(spectrum))
+                visualizer_->setSpectrum(spectrum.bars.data(), spectrum.peaks.data(),
+                                         ngks::SpectrumFrame::kBarCount);
+
             // Title pulse envelope: fast attack, slow decay — all in JUCE data path
             if (bridge_.running()) {
                 constexpr double kDecay = 0.88;
@@ -1910,7 +1602,7 @@ djDb_.bulkInsert(allTracks_);
 
         // Library tree → double-click to play
         QObject::connect(playerLibraryTree_, &DjLibraryWidget::trackActivated, this, [this](qint64 trackId) {
-            const int idx = static_cast<int>(trackId);
+            const int idx = trackIndexForId(trackId);
             if (idx >= 0 && idx < static_cast<int>(allTracks_.size())) {
                 currentTrackIndex_ = idx;
                 loadAndPlayTrack(idx);
@@ -2240,13 +1932,13 @@ djDb_.bulkInsert(allTracks_);
         // ── DeckStrip drag-to-deck: load track by track_id ──
         QObject::connect(djDeckA_, &DeckStrip::loadTrackRequested, this,
             [this](int /*deckIndex*/, qint64 trackId) {   
-            const int idx = static_cast<int>(trackId);    
+            const int idx = trackIndexForId(trackId);    
             if (idx >= 0 && idx < static_cast<int>(allTracks_.size()))
                 loadAndPlayTrack(idx);
         });
         QObject::connect(djDeckB_, &DeckStrip::loadTrackRequested, this,
             [this](int /*deckIndex*/, qint64 trackId) {   
-            const int idx = static_cast<int>(trackId);    
+            const int idx = trackIndexForId(trackId);    
             if (idx >= 0 && idx < static_cast<int>(allTracks_.size()))
                 loadAndPlayTrack(idx);
         });
@@ -2262,7 +1954,7 @@ djDb_.bulkInsert(allTracks_);
         });
         QObject::connect(djDeckB_, &DeckStrip::loadTrackRequested, this,
             [this](int /*deckIndex*/, qint64 trackId) {
-            const int idx = static_cast<int>(trackId);
+            const int idx = trackIndexForId(trackId);
             if (idx >= 0 && idx < static_cast<int>(allTracks_.size()))
                 loadAndPlayTrack(idx);
         });
@@ -2385,27 +2077,408 @@ djDb_.bulkInsert(allTracks_);
     void refreshDjLibraryHighlights() { /* library not initialized */ }
 
     // ── Library helpers ──
+    // Differential sync of allTracks_ into the library table.  track_ids
+    // survive rescans, so everything holding one (views, drags) stays valid;
+    // they are mapped back to allTracks_ indices here.
+    void syncLibraryDb()
+    {
+        DjLibraryDatabase::SyncStats stats;
+        djDb_.syncTracks(allTracks_, trackIds_, &stats);
+        djDb_.setMetaValue(QStringLiteral("library_folder"), importedFolderPath_);
+        rebuildTrackIndex();
+        qInfo().noquote() << QStringLiteral("LIBRARY_SYNCED=%1 ms=%2 +%3 ~%4 -%5")
+            .arg(allTracks_.size()).arg(stats.ms, 0, 'f', 1)
+            .arg(stats.inserted).arg(stats.updated).arg(stats.deleted);
+    }
+
+    void rebuildTrackIndex()
+    {
+        trackIndexById_.clear();
+        trackIndexById_.reserve(static_cast<qsizetype>(trackIds_.size()));
+        for (int i = 0; i < static_cast<int>(trackIds_.size()); ++i)
+            trackIndexById_.insert(trackIds_[static_cast<size_t>(i)], i);
+    }
+
+    // One-time move of library.json into the library table.  Without a JSON
+    // file (fresh install, or it was deleted) whatever the table holds is
+    // the library.
+    void migrateLibraryJson()
+    {
+        QString restoredFolder;
+        std::vector<TrackInfo> restoredTracks;
+        if (loadLibraryJson(restoredTracks, restoredFolder)) {
+            allTracks_ = std::move(restoredTracks);
+            importedFolderPath_ = restoredFolder;
+            patchMissingDurations();
+            syncLibraryDb();
+        } else {
+            djDb_.loadTracks(allTracks_, trackIds_);
+            rebuildTrackIndex();
+            djDb_.setMetaValue(QStringLiteral("library_folder"), importedFolderPath_);
+        }
+        djDb_.setMetaValue(QStringLiteral("json_migrated"),
+                           QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+        qInfo().noquote() << QStringLiteral("LIBRARY_JSON_MIGRATED tracks=%1").arg(allTracks_.size());
+    }
+
+    // Startup work the library view does not need: runs once the landing
+    // page is up.
+    void deferredLibraryStartup()
+    {
+        QElapsedTimer phase;
+        phase.start();
+        bool changed = false;
+
+        // Auto-merge legacy DB if not already imported
+        const bool anyLegacy = std::any_of(allTracks_.begin(), allTracks_.end(),
+                                           [](const TrackInfo& t) { return t.legacyImported; });
+        if (!allTracks_.empty() && !anyLegacy) {
+            const QString dbPath = findLegacyDbPath();
+            if (!dbPath.isEmpty()) {
+                const LegacyImportResult res = importLegacyDb(allTracks_, dbPath);
+                if (res.matched > 0) {
+                    changed = true;
+                    qInfo().noquote() << QStringLiteral("LEGACY_DB_AUTO_IMPORT matched=%1 total=%2")
+                        .arg(res.matched).arg(res.totalDbRows);
+                }
+            }
+        }
+        if (patchMissingDurations() > 0) changed = true;
+
+        if (changed) {
+            syncLibraryDb();
+            saveLibraryJson(allTracks_, importedFolderPath_);
+            refreshLibraryList();
+            rebuildPlayerQueue();
+        }
+        watchLibraryRoot();
+        logStartupPhase("deferred_library", phase.elapsed());
+    }
+
+    // Durations the tags did not give: from dj_library_core.db where it has
+    // the file, else estimated from the first MP3 frame's bitrate.  Returns
+    // the number of tracks filled in.
+    int patchMissingDurations()
+    {
+        const bool anyMissing = std::any_of(allTracks_.begin(), allTracks_.end(),
+            [](const TrackInfo& t) {
+                return t.durationMs <= 0 || t.durationStr.isEmpty() || t.durationStr == QStringLiteral("--:--");
+            });
+        if (!anyMissing) return 0;
+
+        int patched = 0;
+        {
+            QString coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../../../data/dj_library_core.db");
+            if (!QFile::exists(coreDbPath)) {
+                coreDbPath = QDir::currentPath() + QStringLiteral("/data/dj_library_core.db");
+            }
+            if (!QFile::exists(coreDbPath)) {
+                coreDbPath = QCoreApplication::applicationDirPath() + QStringLiteral("/../data/dj_library_core.db");
+            }
+            if (!QFile::exists(coreDbPath)) {
+                coreDbPath = QDir::currentPath() + QStringLiteral("/../../../data/dj_library_core.db");
+            }
+
+            if (QFile::exists(coreDbPath)) {
+                const QString connName = QStringLiteral("dj_core_duration_fix");
+                {
+                    QSqlDatabase coreDb = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+                    coreDb.setDatabaseName(coreDbPath);
+                    coreDb.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+                    int matchCore = 0;
+                    if (coreDb.open()) {
+                        std::map<QString, size_t> pathIndex;
+                        for (size_t i = 0; i < allTracks_.size(); ++i) {
+                            pathIndex[QDir::fromNativeSeparators(allTracks_[i].filePath).trimmed().toLower()] = i;
+                        }
+
+                        QSqlQuery q(coreDb);
+                        q.setForwardOnly(true);
+                        if (q.exec(QStringLiteral("SELECT file_path, duration FROM tracks LIMIT 9999999"))) {
+                            while (q.next()) {
+                                QString fp = QDir::fromNativeSeparators(q.value(0).toString()).trimmed().toLower();
+                                double dur = q.value(1).toDouble();
+                                if (dur > 0) {
+                                    auto it = pathIndex.find(fp);
+                                    if (it != pathIndex.end()) {
+                                        TrackInfo& t = allTracks_[it->second];
+                                        if (t.durationMs <= 0 || t.durationStr == QStringLiteral("--:--") || t.durationStr.isEmpty()) {
+                                            t.durationMs = static_cast<qint64>(dur * 1000.0);
+                                            const int totalSec = static_cast<int>(dur);
+                                            t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
+                                            matchCore++;
+                                            ++patched;
+                                        }
+                                    }
+                                }
+                            }
+                            qInfo().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH matched=%1").arg(matchCore);
+                        } else {
+                            qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_QUERY ") << q.lastError().text();
+                        }
+                        coreDb.close();
+                    } else {
+                        qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH FAILED_OPEN ") << coreDb.lastError().text();
+                    }
+                }
+                QSqlDatabase::removeDatabase(connName);
+            } else {
+                qWarning().noquote() << QStringLiteral("CORE_DB_DURATION_PATCH DB_NOT_FOUND ") << coreDbPath;
+            }
+        }
+
+
+        // Fallback: For any tracks without duration, estimate it from MP3 filesize
+        for (auto& t : allTracks_) {
+            if (t.durationMs <= 0 && t.filePath.endsWith(QStringLiteral(".mp3"), Qt::CaseInsensitive)) {
+                QFile fFallback(t.filePath);
+                if (fFallback.open(QIODevice::ReadOnly)) {
+                    QByteArray hdr = fFallback.read(10);
+                    qint64 dataOff = 0;
+                    if (hdr.size() == 10 && hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3') {
+                        dataOff = 10 + ((quint32(static_cast<unsigned char>(hdr[6])) << 21)
+                                     | (quint32(static_cast<unsigned char>(hdr[7])) << 14)
+                                     | (quint32(static_cast<unsigned char>(hdr[8])) << 7)
+                                     | quint32(static_cast<unsigned char>(hdr[9])));
+                    }
+                    fFallback.seek(dataOff);
+                    QByteArray buf = fFallback.read(8192);
+                    int bitrate = 0;
+                    for (int i = 0; i < buf.size() - 3; ++i) {
+                        if ((static_cast<unsigned char>(buf[i]) == 0xFF) && ((static_cast<unsigned char>(buf[i+1]) & 0xE0) == 0xE0)) {
+                            int bitrateIdx = (static_cast<unsigned char>(buf[i+2]) >> 4) & 0x0F;
+                            int layer = (static_cast<unsigned char>(buf[i+1]) >> 1) & 0x03;
+                            int ver = (static_cast<unsigned char>(buf[i+1]) >> 3) & 0x03;
+                            static const int bitrates[2][3][16] = {
+                                { {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}, {0,32,48,56,64,80,96,112,128,144,160,176,192,224,256,0} },
+                                { {0,32,40,48,56,64,80,96,112,128,160,192,224,256,320,0}, {0,32,48,56,64,80,96,112,128,160,192,224,256,320,384,0}, {0,32,64,96,128,160,192,224,256,288,320,352,384,416,448,0} }
+                            };
+                            int mpegIdx = (ver == 3) ? 1 : 0;
+                            int layerIdx = (layer == 1) ? 0 : ((layer == 2) ? 1 : 2);
+                            bitrate = bitrates[mpegIdx][layerIdx][bitrateIdx];
+                            break;
+                        }
+                    }
+                    if (bitrate <= 0) bitrate = 256;
+                    t.durationMs = static_cast<qint64>(((fFallback.size() - dataOff) * 8.0) / (bitrate * 1000.0) * 1000.0);
+                    int totalSec = static_cast<int>(t.durationMs / 1000);
+                    t.durationStr = QStringLiteral("%1:%2").arg(totalSec / 60).arg(totalSec % 60, 2, 10, QLatin1Char('0'));
+                    ++patched;
+                }
+            }
+        }
+        return patched;
+    }
+
+    void watchLibraryRoot()
+    {
+        if (!libraryWatch_) return;
+        if (importedFolderPath_.isEmpty()) libraryWatch_->stop();
+        else libraryWatch_->watch({ importedFolderPath_ });
+    }
+
+    // Files the watch service saw change: re-parse only those (skipping any
+    // whose size/mtime still match, e.g. after a full relist) and merge them
+    // into the library table, then delete the rows of removed ones.  The
+    // rest of the table is not read.  Merging first lets a file moved within
+    // the folder keep its track_id (mergeTracks claims the row of the
+    // vanished path by content hash); that row is then not deleted.
+    // fullSync: diff the whole table with syncLibraryDb() instead.
+    void applyWatchedChanges(const QStringList& updated, const QStringList& removed,
+                             bool fullSync = false)
+    {
+        const QString currentPath = (currentTrackIndex_ >= 0
+                && currentTrackIndex_ < static_cast<int>(allTracks_.size()))
+            ? allTracks_[static_cast<size_t>(currentTrackIndex_)].filePath : QString();
+
+        QHash<QString, int> indexByKey;
+        indexByKey.reserve(static_cast<qsizetype>(allTracks_.size()));
+        for (int i = 0; i < static_cast<int>(allTracks_.size()); ++i)
+            indexByKey.insert(DjLibraryDatabase::pathKey(allTracks_[static_cast<size_t>(i)].filePath), i);
+
+        int added = 0, changed = 0, dropped = 0;
+        std::vector<int> touched;               // allTracks_ indices to merge
+        for (const QString& path : updated) {
+            const QFileInfo fi(path);
+            if (!fi.isFile()) continue;
+            const QString key = DjLibraryDatabase::pathKey(path);
+            auto it = indexByKey.constFind(key);
+            if (it != indexByKey.constEnd()) {
+                TrackInfo& old = allTracks_[static_cast<size_t>(it.value())];
+                if (old.modifiedMs > 0 && old.fileSize == fi.size()
+                        && old.modifiedMs == fi.lastModified().toMSecsSinceEpoch())
+                    continue;
+                TrackInfo fresh = trackFromFile(fi);
+                if (old.legacyImported) {
+                    // Legacy analysis is not in the file; keep it.
+                    fresh.genre = fresh.genre.isEmpty() ? old.genre : fresh.genre;
+                    fresh.camelotKey = old.camelotKey;
+                    fresh.energy = old.energy;
+                    fresh.loudnessLUFS = old.loudnessLUFS;
+                    fresh.loudnessRange = old.loudnessRange;
+                    fresh.cueIn = old.cueIn;
+                    fresh.cueOut = old.cueOut;
+                    fresh.danceability = old.danceability;
+                    fresh.acousticness = old.acousticness;
+                    fresh.instrumentalness = old.instrumentalness;
+                    fresh.liveness = old.liveness;
+                    fresh.rating = old.rating;
+                    fresh.comments = old.comments;
+                    fresh.legacyImported = true;
+                }
+                old = std::move(fresh);
+                touched.push_back(it.value());
+                ++changed;
+            } else {
+                indexByKey.insert(key, static_cast<int>(allTracks_.size()));
+                touched.push_back(static_cast<int>(allTracks_.size()));
+                allTracks_.push_back(trackFromFile(fi));
+                ++added;
+            }
+        }
+
+        // Ids run parallel to allTracks_; new tracks get theirs from the merge.
+        // A failed merge falls back to the full sync.
+        bool idsInStep = !fullSync
+                && trackIds_.size() + static_cast<size_t>(added) == allTracks_.size();
+        trackIds_.resize(allTracks_.size(), -1);
+        QSet<qint64> mergedIds;
+        if (idsInStep && !touched.empty()) {
+            std::vector<TrackInfo> batch;
+            batch.reserve(touched.size());
+            for (int i : touched) batch.push_back(allTracks_[static_cast<size_t>(i)]);
+            std::vector<qint64> ids;
+            idsInStep = djDb_.mergeTracks(batch, ids);
+            for (size_t j = 0; idsInStep && j < touched.size(); ++j) {
+                trackIds_[static_cast<size_t>(touched[j])] = ids[j];
+                mergedIds.insert(ids[j]);
+            }
+        }
+
+        if (!removed.isEmpty()) {
+            QStringList keys;
+            for (const QString& r : removed) keys << DjLibraryDatabase::pathKey(r);
+            auto isGone = [&keys](const TrackInfo& t) {
+                const QString k = DjLibraryDatabase::pathKey(t.filePath);
+                for (const QString& gone : keys) {
+                    if (k == gone || k.startsWith(gone + QLatin1Char('/'))) return true;
+                }
+                return false;
+            };
+            std::vector<qint64> goneIds;
+            size_t out = 0;
+            for (size_t i = 0; i < allTracks_.size(); ++i) {
+                if (isGone(allTracks_[i])) {
+                    if (trackIds_[i] >= 0 && !mergedIds.contains(trackIds_[i]))
+                        goneIds.push_back(trackIds_[i]);
+                    continue;
+                }
+                if (out != i) {
+                    allTracks_[out] = std::move(allTracks_[i]);
+                    trackIds_[out] = trackIds_[i];
+                }
+                ++out;
+            }
+            dropped = static_cast<int>(allTracks_.size() - out);
+            allTracks_.resize(out);
+            trackIds_.resize(out);
+            if (idsInStep) djDb_.deleteTracks(goneIds);
+        }
+
+        if (added == 0 && changed == 0 && dropped == 0) return;
+
+        currentTrackIndex_ = -1;
+        for (int i = 0; !currentPath.isEmpty() && i < static_cast<int>(allTracks_.size()); ++i) {
+            if (allTracks_[static_cast<size_t>(i)].filePath == currentPath) { currentTrackIndex_ = i; break; }
+        }
+
+        if (idsInStep) rebuildTrackIndex();
+        else syncLibraryDb();
+        scheduleLibraryJsonSave();
+        refreshLibraryList();
+        rebuildPlayerQueue();
+        qInfo().noquote() << QStringLiteral("LIBRARY_WATCH_APPLIED added=%1 changed=%2 removed=%3")
+            .arg(added).arg(changed).arg(dropped);
+    }
+
+    // The watch service lost events (inotify queue overflow) and relisted
+    // the library folder: tracks below it that are not listed were removed
+    // meanwhile.  Listed files whose size/mtime match are skipped as usual.
+    void resyncWatchedRoot(const QStringList& allFiles)
+    {
+        if (importedFolderPath_.isEmpty()) return;
+        const QString rootKey = DjLibraryDatabase::pathKey(importedFolderPath_) + QLatin1Char('/');
+
+        QSet<QString> listed;
+        listed.reserve(allFiles.size());
+        for (const QString& f : allFiles) listed.insert(DjLibraryDatabase::pathKey(f));
+
+        QStringList gone;
+        for (const TrackInfo& t : allTracks_) {
+            const QString k = DjLibraryDatabase::pathKey(t.filePath);
+            if (k.startsWith(rootKey) && !listed.contains(k)) gone << t.filePath;
+        }
+        qInfo().noquote() << QStringLiteral("LIBRARY_WATCH_RESYNC listed=%1 gone=%2")
+            .arg(allFiles.size()).arg(gone.size());
+        applyWatchedChanges(allFiles, gone, true);
+    }
+
+    // library.json is an export only read by the one-time migration, so the
+    // watch path does not rewrite it on every flush: it is written once
+    // changes settle, and on exit.
+    void scheduleLibraryJsonSave()
+    {
+        if (!libraryJsonTimer_) {
+            libraryJsonTimer_ = new QTimer(this);
+            libraryJsonTimer_->setSingleShot(true);
+            libraryJsonTimer_->setInterval(30000);
+            QObject::connect(libraryJsonTimer_, &QTimer::timeout, this, [this]() {
+                flushLibraryJson();
+            });
+        }
+        libraryJsonDirty_ = true;
+        libraryJsonTimer_->start();
+    }
+
+    void flushLibraryJson()
+    {
+        if (!libraryJsonDirty_) return;
+        libraryJsonDirty_ = false;
+        if (libraryJsonTimer_) libraryJsonTimer_->stop();
+        saveLibraryJson(allTracks_, importedFolderPath_);
+    }
+
+    int trackIndexForId(qint64 trackId) const
+    {
+        return trackIndexById_.value(trackId, -1);
+    }
+
+    qint64 trackIdForIndex(int trackIndex) const
+    {
+        if (trackIndex < 0 || trackIndex >= static_cast<int>(trackIds_.size())) return -1;
+        return trackIds_[static_cast<size_t>(trackIndex)];
+    }
+
     void refreshLibraryList()
     {
         if (!libraryTree_) return;
-        QStringList playlistPaths;
-        if (activePlaylistIndex_ >= 0
-                && activePlaylistIndex_ < static_cast<int>(playlists_.size())) {
-            for (const QString& p : playlists_[activePlaylistIndex_].trackPaths)
-                playlistPaths << p;
-        }
-        libraryTree_->setPlaylistFilter(playlistPaths);
+        libraryTree_->setPlaylistFilter(activePlaylistId_);
         libraryTree_->refresh();
     }
 
+    void reloadPlaylists()
+    {
+        playlists_ = djDb_.playlists();
+    }
+
     void updateTreeItemForTrack(int trackIndex)
     {
         if (trackIndex < 0 || trackIndex >= static_cast<int>(allTracks_.size())) return;
-        djDb_.upsertTrack(static_cast<qint64>(trackIndex), allTracks_[trackIndex]);
+        djDb_.upsertTrack(trackIdForIndex(trackIndex), allTracks_[trackIndex]);
         // Re-apply filter so the updated row appears with fresh data
         refreshLibraryList();
         // If this track is currently selected in the detail panel, refresh the detail
-        if (libraryTree_ && libraryTree_->currentTrackId() == static_cast<qint64>(trackIndex))
+        if (libraryTree_ && libraryTree_->currentTrackId() == trackIdForIndex(trackIndex))
             showTrackDetail(trackIndex);
     }
 
@@ -2744,7 +2817,7 @@ djDb_.bulkInsert(allTracks_);
         if (!playerLibraryTree_) return;
         const QString search = playerSearchBar_ ? playerSearchBar_->text().trimmed() : QString();
         const int sortCol    = playerSortCombo_ ? playerSortCombo_->currentIndex() : 0;
-        playerLibraryTree_->applyFilter(search, 5, {}, sortCol);
+        playerLibraryTree_->applyFilter(search, 5, DjLibraryDatabase::kNoPlaylist, sortCol);
         const int count = playerLibraryTree_->totalFilteredCount();
         if (playerLibCountLabel_)
             playerLibCountLabel_->setText(QStringLiteral("%1 tracks").arg(count));
@@ -2757,8 +2830,8 @@ djDb_.bulkInsert(allTracks_);
     void highlightPlayerLibraryItem(int trackIndex)
     {
         if (!playerLibraryTree_ || trackIndex < 0) return;
-        playerLibraryTree_->setCurrentTrackId(static_cast<qint64>(trackIndex));
-        playerLibraryTree_->scrollToTrackId(static_cast<qint64>(trackIndex));
+        playerLibraryTree_->setCurrentTrackId(trackIdForIndex(trackIndex));
+        playerLibraryTree_->scrollToTrackId(trackIdForIndex(trackIndex));
     }
 
     void requestAudioProfilesRefresh(bool logMarker)
@@ -2913,12 +2986,20 @@ djDb_.bulkInsert(allTracks_);
         diagnosticsDialog_->setTelemetry(lastTelemetry_);
         diagnosticsDialog_->setFoundation(lastFoundation_, selfTestsRan_ ? &lastSelfTests_ : nullptr);
         diagnosticsDialog_->setRtAudio(lastTelemetry_);
+        refreshWaveformPaintStats();
         diagnosticsDialog_->refreshLogTail();
         diagnosticsDialog_->show();
         diagnosticsDialog_->raise();
         diagnosticsDialog_->activateWindow();
     }
 
+    void refreshWaveformPaintStats()
+    {
+        if (!diagnosticsDialog_ || !djDeckA_ || !djDeckB_) return;
+        diagnosticsDialog_->setWaveformPaint(djDeckA_->takeWaveformPaintStats(),
+                                             djDeckB_->takeWaveformPaintStats());
+    }
+
     void pollStatus()
     {
         UIStatus status {};
@@ -2990,12 +3071,14 @@ djDb_.bulkInsert(allTracks_);
             visualizer_->setAudioLevel(feedLevel);
         }
 
-        if (diagnosticsDialog_) {
+        // A hidden dialog is filled from last*_ by showDiagnostics().
+        if (diagnosticsDialog_ && diagnosticsDialog_->isVisible()) {
             diagnosticsDialog_->setStatus(status);
             diagnosticsDialog_->setHealth(health);
             diagnosticsDialog_->setTelemetry(telemetry);
             diagnosticsDialog_->setFoundation(foundation, selfTestsRan_ ? &lastSelfTests_ : nullptr);
             diagnosticsDialog_->setRtAudio(telemetry);
+            refreshWaveformPaintStats();
         }
 
         if (!statusTickLogged_) {
@@ -3162,9 +3245,14 @@ private:
     QComboBox* playerSortCombo_{nullptr};
     DjLibraryDatabase djDb_;
     std::vector<TrackInfo> allTracks_;
+    LibraryWatchService* libraryWatch_{nullptr};
+    QTimer* libraryJsonTimer_{nullptr};
+    bool libraryJsonDirty_{false};
+    std::vector<qint64> trackIds_;              // track_id of allTracks_[i]
+    QHash<qint64, int> trackIndexById_;         // track_id → allTracks_ index
     bool juceSimpleModeReady_{false};
-    std::vector<Playlist> playlists_;
-    int activePlaylistIndex_{-1}; // -1 = show all library
+    std::vector<DjLibraryDatabase::PlaylistInfo> playlists_;
+    qint64 activePlaylistId_{DjLibraryDatabase::kNoPlaylist};
     QString importedFolderPath_;
     int currentTrackIndex_{-1};
     bool seekSliderPressed_{false};
@@ -3244,6 +3332,7 @@ private:
 
 int main(int argc, char* argv[])
 {
+    startupClock().start();
     initializeUiRuntimeLog();
     installCrashCaptureHandlers();
 
@@ -3316,7 +3405,393 @@ int main(int argc, char* argv[])
     initPayload.insert(QStringLiteral("pid"), static_cast<qint64>(QCoreApplication::applicationPid()));
     writeJsonEvent(QStringLiteral("INFO"), QStringLiteral("app_init"), initPayload);
 
+    // ── Batch analysis: analyse the whole library headlessly, then exit ──
+    // Usage: native.exe --batch-analyze [--workers N] [--memory-mb MB] [--force]
+    // Safe to kill at any point; the next run resumes from the checkpoint.
+    // Without --memory-mb every worker gets room for a 7-minute track, within
+    // half the installed RAM.
+    {
+        const QStringList args = QCoreApplication::arguments();
+        if (args.contains(QStringLiteral("--batch-analyze"))) {
+            auto intArg = [&args](const char* flag, int fallback) {
+                const int idx = args.indexOf(QLatin1String(flag));
+                if (idx < 0 || idx + 1 >= args.size()) return fallback;
+                bool ok = false;
+                const int v = args.at(idx + 1).toInt(&ok);
+                return ok ? v : fallback;
+            };
+
+            BatchAnalyzer::Config cfg;
+            cfg.workers = intArg("--workers", 0);
+            cfg.memoryBudgetBytes = static_cast<qint64>(intArg("--memory-mb", 0)) << 20;   // 0 = default
+            cfg.force   = args.contains(QStringLiteral("--force"));
+
+            const QString dbPath = runtimePath("data/runtime/ngks_library.db");
+            DjLibraryDatabase db;
+            if (!db.open(dbPath)) {
+                writeLine(QStringLiteral("BatchAnalyze=FAIL reason=db_open path=%1").arg(dbPath));
+                return 3;
+            }
+
+            // Read-only while the GUI holds the cache: hits are reused,
+            // new results go to the library DB only.
+            AnalysisCache cache;
+            if (cache.open(runtimePath("data/runtime/analysis_cache.bin"))) {
+                cfg.cache = &cache;
+                if (!cache.isWritable())
+                    writeLine(QStringLiteral("BatchAnalyze cache=read-only (in use by another process)"));
+            }
+
+            BatchAnalyzer analyzer;
+            const bool ok = analyzer.run(db, dbPath, cfg, [](const BatchAnalyzer::Progress& p) {
+                std::fprintf(stdout, "[BATCH] %d/%d failed=%d %.2f tracks/s eta %.0fs\n",
+                             p.done, p.queued, p.failed, p.tracksPerSec, p.etaSeconds);
+                std::fflush(stdout);
+            });
+
+            const auto& p = analyzer.lastProgress();
+            writeLine(QStringLiteral("BatchAnalyze=%1 total=%2 analysed=%3 failed=%4 skipped=%5 seconds=%6")
+                          .arg(ok ? QStringLiteral("PASS") : QStringLiteral("FAIL"))
+                          .arg(p.total).arg(p.done).arg(p.failed).arg(p.skipped)
+                          .arg(p.elapsedSeconds, 0, 'f', 1));
+            return ok ? 0 : 1;
+        }
+    }
+
+    // ── Analysis-rate comparison: decimated vs native-rate, then exit ──
+    // Usage: native.exe --compare-analysis-rates <baseline.csv> <library dir>
+    //                   [--chroma-hz HZ] [--onset-hz HZ] [--proof-dir DIR]
+    // Scores the decimated front end against the baseline CSV and analyses
+    // every track again at the native rate; the NATIVE_CROSS_CHECK line
+    // gives the BPM deltas and key mismatches between the two.
+    {
+        const QStringList args = QCoreApplication::arguments();
+        const int idx = args.indexOf(QStringLiteral("--compare-analysis-rates"));
+        if (idx >= 0) {
+            if (idx + 2 >= args.size()) {
+                writeLine(QStringLiteral("CompareAnalysisRates=FAIL reason=usage"));
+                return 2;
+            }
+            auto argAfter = [&args](const char* flag) {
+                const int i = args.indexOf(QLatin1String(flag));
+                return i >= 0 && i + 1 < args.size() ? args.at(i + 1) : QString();
+            };
+
+            AnalysisRateConfig rate;
+            if (const QString v = argAfter("--chroma-hz"); !v.isEmpty()) rate.chromaRateHz = v.toDouble();
+            if (const QString v = argAfter("--onset-hz"); !v.isEmpty())  rate.onsetRateHz  = v.toDouble();
+            QString proofDir = argAfter("--proof-dir");
+            if (proofDir.isEmpty()) proofDir = runtimePath("data/runtime/analysis_rate_compare");
+
+            AnalysisComparator comparator;
+            comparator.setRateConfig(rate);
+            comparator.setNativeCrossCheck(true);
+            const bool ok = comparator.run(args.at(idx + 1), args.at(idx + 2), proofDir);
+
+            const ComparatorSummary& s = comparator.summary();
+            writeLine(QStringLiteral("CompareAnalysisRates=%1 tracks=%2 cross_checked=%3 bpm_mismatch=%4"
+                                     " key_mismatch=%5 bpm_delta_avg=%6 bpm_delta_max=%7"
+                                     " decimated_ms=%8 native_ms=%9")
+                          .arg(ok ? QStringLiteral("PASS") : QStringLiteral("FAIL"))
+                          .arg(s.total).arg(s.crossChecked)
+                          .arg(s.crossBpmMismatch).arg(s.crossKeyMismatch)
+                          .arg(s.crossBpmDeltaAvg, 0, 'f', 3).arg(s.crossBpmDeltaMax, 0, 'f', 3)
+                          .arg(s.avgAnalysisMs, 0, 'f', 1).arg(s.avgNativeAnalysisMs, 0, 'f', 1));
+            return ok ? 0 : 1;
+        }
+    }
+
+    // ── Near-duplicate groups from the acoustic fingerprints, then exit ──
+    // Usage: native.exe --similar-groups [--duplicates-only] [--min-containment X] [--csv path]
+    // Fingerprints are written by --batch-analyze.  The CSV has one row per
+    // track: group_id,kind,track_id,file_path.
+    {
+        const QStringList args = QCoreApplication::arguments();
+        if (args.contains(QStringLiteral("--similar-groups"))) {
+            auto argAfter = [&args](const char* flag) {
+                const int idx = args.indexOf(QLatin1String(flag));
+                return idx >= 0 && idx + 1 < args.size() ? args.at(idx + 1) : QString();
+            };
+
+            double minContainment = FingerprintIndex::kRelatedContainment;
+            if (const QString v = argAfter("--min-containment"); !v.isEmpty()) {
+                bool ok = false;
+                const double d = v.toDouble(&ok);
+                if (ok && d > 0.0 && d <= 1.0) minContainment = d;
+            }
+            const auto loosest = args.contains(QStringLiteral("--duplicates-only"))
+                ? FingerprintIndex::Resemblance::Duplicate
+                : FingerprintIndex::Resemblance::Version;
+
+            const QString dbPath = runtimePath("data/runtime/ngks_library.db");
+            DjLibraryDatabase db;
+            if (!db.open(dbPath)) {
+                writeLine(QStringLiteral("SimilarGroups=FAIL reason=db_open path=%1").arg(dbPath));
+                return 3;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            const auto groups = db.querySimilarGroups(loosest, minContainment);
+            const double seconds = timer.elapsed() / 1000.0;
+
+            static const char* const kKindNames[] = { "duplicate", "edit", "version" };
+            int grouped = 0;
+            for (const auto& g : groups) grouped += static_cast<int>(g.trackIds.size());
+
+            const QString csvPath = argAfter("--csv");
+            if (!csvPath.isEmpty()) {
+                QSaveFile csv(csvPath);
+                if (!csv.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                    writeLine(QStringLiteral("SimilarGroups=FAIL reason=csv_open path=%1").arg(csvPath));
+                    return 3;
+                }
+                csv.write("group_id,kind,track_id,file_path\n");
+                for (size_t gi = 0; gi < groups.size(); ++gi) {
+                    const auto& g = groups[gi];
+                    for (qint64 id : g.trackIds) {
+                        const auto info = db.trackById(id);
+                        QString path = info ? info->filePath : QString();
+                        path.replace(QLatin1Char('"'), QStringLiteral("\"\""));
+                        csv.write(QStringLiteral("%1,%2,%3,\"%4\"\n")
+                                      .arg(gi + 1)
+                                      .arg(QLatin1String(kKindNames[static_cast<int>(g.kind)]))
+                                      .arg(id).arg(path).toUtf8());
+                    }
+                }
+                if (!csv.commit()) {
+                    writeLine(QStringLiteral("SimilarGroups=FAIL reason=csv_write path=%1").arg(csvPath));
+                    return 3;
+                }
+            }
+
+            writeLine(QStringLiteral("SimilarGroups=PASS tracks=%1 fingerprinted=%2 groups=%3 grouped=%4 seconds=%5")
+                          .arg(db.totalCount()).arg(db.fingerprintCount())
+                          .arg(groups.size()).arg(grouped)
+                          .arg(seconds, 0, 'f', 2));
+            return 0;
+        }
+    }
+
+    // ── Waveform pyramid check: every level spans the track, then exit ──
+    // Usage: native.exe --check-waveform-pyramid [buckets]   (default 20000)
+    {
+        const QStringList args = QCoreApplication::arguments();
+        const int wpIdx = args.indexOf(QStringLiteral("--check-waveform-pyramid"));
+        if (wpIdx >= 0) {
+            qint64 maxBuckets = 20000;
+            if (wpIdx + 1 < args.size()) {
+                bool ok = false;
+                const qint64 v = args.at(wpIdx + 1).toLongLong(&ok);
+                if (ok && v > 0) maxBuckets = v;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            int64_t failedCount = 0;
+            const bool ok = ngks::WaveformPyramid::checkLevels(maxBuckets, &failedCount);
+            if (!ok) {
+                writeLine(QStringLiteral("CheckWaveformPyramid=FAIL buckets=%1").arg(failedCount));
+                return 1;
+            }
+            writeLine(QStringLiteral("CheckWaveformPyramid=PASS counts=1..%1 ms=%2")
+                          .arg(maxBuckets).arg(timer.elapsed()));
+            return 0;
+        }
+    }
+
+    // ── Search benchmark: synthetic library, FTS vs LIKE, then exit ──
+    // Usage: native.exe --bench-search [rows]        (default 250000)
+    {
+        const QStringList args = QCoreApplication::arguments();
+        const int bsIdx = args.indexOf(QStringLiteral("--bench-search"));
+        if (bsIdx >= 0) {
+            int rows = 250000;
+            if (bsIdx + 1 < args.size()) {
+                bool ok = false;
+                const int v = args.at(bsIdx + 1).toInt(&ok);
+                if (ok && v > 0) rows = v;
+            }
+
+            LibrarySearchBench::Report report;
+            const QString benchDb = runtimePath("data/runtime/bench_search.db");
+            if (!LibrarySearchBench::run(benchDb, rows, report)) {
+                writeLine(QStringLiteral("BenchSearch=FAIL reason=db_build path=%1").arg(benchDb));
+                return 3;
+            }
+
+            double worstFts = 0.0, worstLike = 0.0;
+            for (const auto& s : report.samples) {
+                worstFts  = std::max(worstFts, s.ftsMs);
+                worstLike = std::max(worstLike, s.likeMs);
+            }
+            writeLine(QStringLiteral("BenchSearch=PASS rows=%1 fts=%2 populate_ms=%3 resync_ms=%4 worst_fts_ms=%5 worst_like_ms=%6 compatible_ms=%7 relink_ms=%8 relinked=%9")
+                          .arg(report.rows)
+                          .arg(report.fts ? 1 : 0)
+                          .arg(report.populateMs, 0, 'f', 0)
+                          .arg(report.resyncMs, 0, 'f', 1)
+                          .arg(worstFts, 0, 'f', 2)
+                          .arg(worstLike, 0, 'f', 2)
+                          .arg(report.compatibleMs, 0, 'f', 2)
+                          .arg(report.relinkMs, 0, 'f', 1)
+                          .arg(report.relinked));
+            QFile::remove(benchDb);
+            return 0;
+        }
+    }
+
+    // ── Tag parser throughput ──
+    // Usage: native.exe --bench-tags <folder>
+    // Parses every text field plus length (no cover art) for each audio file below <folder>,
+    // then computes each file's audio content hash (the scan's move detection).
+    {
+        const QStringList args = QCoreApplication::arguments();
+        const int btIdx = args.indexOf(QStringLiteral("--bench-tags"));
+        if (btIdx >= 0) {
+            const QString folder = btIdx + 1 < args.size() ? args.at(btIdx + 1) : QString();
+            if (folder.isEmpty() || !QFileInfo(folder).isDir()) {
+                writeLine(QStringLiteral("BenchTags=FAIL reason=no_folder path=%1").arg(folder));
+                return 3;
+            }
+
+            QStringList files;
+            QDirIterator it(folder, audioFileFilters(), QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) files << it.next();
+
+            QElapsedTimer timer;
+            timer.start();
+            QMap<QString, int> containers;
+            int tagged = 0;
+            for (const QString& path : std::as_const(files)) {
+                ParsedTags tags;
+                if (TagParser::parseFile(path, TagField::Text | TagField::Length, tags))
+                    ++tagged;
+                ++containers[tags.container.isEmpty() ? QStringLiteral("none") : tags.container];
+            }
+            const double secs = static_cast<double>(timer.elapsed()) / 1000.0;
+
+            timer.restart();
+            QSet<quint64> hashes;
+            int hashed = 0;
+            for (const QString& path : std::as_const(files)) {
+                const quint64 h = audioContentHash(path);
+                if (h == 0) continue;
+                ++hashed;
+                hashes.insert(h);
+            }
+            const double hashSecs = static_cast<double>(timer.elapsed()) / 1000.0;
+
+            QStringList perContainer;
+            for (auto c = containers.constBegin(); c != containers.constEnd(); ++c)
+                perContainer << QStringLiteral("%1:%2").arg(c.key()).arg(c.value());
+            writeLine(QStringLiteral("BenchTags=PASS files=%1 tagged=%2 secs=%3 files_per_sec=%4 containers=%5")
+                          .arg(files.size())
+                          .arg(tagged)
+                          .arg(secs, 0, 'f', 2)
+                          .arg(secs > 0.0 ? files.size() / secs : 0.0, 0, 'f', 0)
+                          .arg(perContainer.join(QLatin1Char(','))));
+            writeLine(QStringLiteral("BenchContentHash=PASS files=%1 hashed=%2 distinct=%3 secs=%4 files_per_sec=%5")
+                          .arg(files.size())
+                          .arg(hashed)
+                          .arg(hashes.size())
+                          .arg(hashSecs, 0, 'f', 2)
+                          .arg(hashSecs > 0.0 ? hashed / hashSecs : 0.0, 0, 'f', 0));
+            return 0;
+        }
+    }
+
+    // ── Tag write throughput ──
+    // Usage: native.exe --bench-tag-writes <folder> [files]      (default 50)
+    // Copies up to [files] MP3s from <folder> into the runtime directory and
+    // edits the comment of every copy twice through TagWriteQueue: the first
+    // pass may have to grow the tags, the second should land in place.
+    {
+        const QStringList args = QCoreApplication::arguments();
+        const int bwIdx = args.indexOf(QStringLiteral("--bench-tag-writes"));
+        if (bwIdx >= 0) {
+            const QString folder = bwIdx + 1 < args.size() ? args.at(bwIdx + 1) : QString();
+            if (folder.isEmpty() || !QFileInfo(folder).isDir()) {
+                writeLine(QStringLiteral("BenchTagWrites=FAIL reason=no_folder path=%1").arg(folder));
+                return 3;
+            }
+            int limit = 50;
+            if (bwIdx + 2 < args.size()) {
+                bool ok = false;
+                const int v = args.at(bwIdx + 2).toInt(&ok);
+                if (ok && v > 0) limit = v;
+            }
+
+            const QString workDir = runtimePath("data/runtime/bench_tag_writes");
+            QDir(workDir).removeRecursively();
+            QDir().mkpath(workDir);
+            QStringList copies;
+            qint64 bytes = 0;
+            QDirIterator it(folder, {QStringLiteral("*.mp3")}, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext() && copies.size() < limit) {
+                const QString src = it.next();
+                const QString dst = QDir(workDir).filePath(QStringLiteral("%1.mp3").arg(copies.size()));
+                if (!QFile::copy(src, dst)) continue;
+                bytes += QFileInfo(dst).size();
+                copies << dst;
+            }
+
+            TagWriteQueue queue(TagWriteQueue::SyncPolicy::EndOfBatch);
+            auto runPass = [&](int pass) {
+                std::vector<TrackTagData> edits;
+                for (const QString& path : std::as_const(copies)) {
+                    edits.push_back(TagReaderService::loadTagsForFile(path));
+                    edits.back().comments = QStringLiteral("ngks tag write bench pass %1").arg(pass);
+                }
+
+                // The worker may drain the queue before the last enqueue;
+                // add up batches until every file is accounted for.
+                QEventLoop loop;
+                TagWriteQueue::Progress total;
+                QObject::connect(&queue, &TagWriteQueue::batchFinished, &loop,
+                                 [&](const TagWriteQueue::Progress& p) {
+                    total.done      += p.done;
+                    total.failed    += p.failed;
+                    total.inPlace   += p.inPlace;
+                    total.rewritten += p.rewritten;
+                    total.elapsedSeconds += p.elapsedSeconds;
+                    if (total.done >= static_cast<int>(edits.size())) loop.quit();
+                });
+                for (const TrackTagData& data : edits) queue.enqueue(data);
+                if (!edits.empty()) loop.exec();
+                return total;
+            };
+            const TagWriteQueue::Progress first  = runPass(1);
+            const TagWriteQueue::Progress second = runPass(2);
+
+            for (const auto* p : {&first, &second}) {
+                writeLine(QStringLiteral("BenchTagWrites=%1 pass=%2 files=%3 mb=%4 in_place=%5 rewritten=%6 failed=%7 secs=%8 files_per_sec=%9")
+                              .arg(p->failed == 0 ? QStringLiteral("PASS") : QStringLiteral("FAIL"))
+                              .arg(p == &first ? 1 : 2)
+                              .arg(p->done)
+                              .arg(static_cast<double>(bytes) / (1 << 20), 0, 'f', 1)
+                              .arg(p->inPlace).arg(p->rewritten).arg(p->failed)
+                              .arg(p->elapsedSeconds, 0, 'f', 2)
+                              .arg(p->elapsedSeconds > 0.0 ? p->done / p->elapsedSeconds : 0.0, 0, 'f', 0));
+            }
+            QDir(workDir).removeRecursively();
+            return first.failed == 0 && second.failed == 0 ? 0 : 1;
+        }
+    }
+
+    QElapsedTimer startupPhase;
+    startupPhase.start();
     EngineBridge engineBridge;
+    logStartupPhase("engine_init", startupPhase.restart());
+    {
+        // First audio device open, whenever it happens (it runs off the UI thread).
+        auto audioOpened = std::make_shared<QMetaObject::Connection>();
+        *audioOpened = QObject::connect(&engineBridge, &EngineBridge::audioHotReady,
+                                        [audioOpened](bool ok) {
+            QObject::disconnect(*audioOpened);
+            qInfo().noquote() << QStringLiteral("[STARTUP] phase=audio_open ok=%1 total_ms=%2")
+                .arg(ok ? 1 : 0).arg(startupClock().elapsed());
+        });
+    }
 
     // ── Dump previous ring buffer if crash left one ──
     // On startup, check if data/runtime/trace_ring_dump.txt exists from a previous frozen session
@@ -3354,7 +3829,9 @@ int main(int argc, char* argv[])
     });
     freezeDetectTimer.start();
 
+    startupPhase.restart();
     MainWindow window(engineBridge);
+    logStartupPhase("main_window", startupPhase.restart());
     window.show();
     writeJsonEvent(QStringLiteral("INFO"), QStringLiteral("window_show"), QJsonObject());
     window.autoShowDiagnosticsIfRequested();
@@ -50,6 +50,16 @@ void VisualizerWidget::setAudioLevel(float level)
     audioActiveTimer_.restart();
 }
 
+void VisualizerWidget::setSpectrum(const float* bars, const float* peaks, int count)
+{
+    spectrumCount_ = qBound(0, count, kSpectrumMax);
+    for (int i = 0; i < spectrumCount_; ++i) {
+        spectrumBars_[i]  = bars[i];
+        spectrumPeaks_[i] = peaks ? peaks[i] : bars[i];
+    }
+    spectrumTimer_.restart();
+}
+
 void VisualizerWidget::setTitleText(const QString& text) { titleText_  = text; }
 void VisualizerWidget::setTitlePulse(float envelope)     { titlePulse_ = qBound(0.0f, envelope, 1.0f); }
 void VisualizerWidget::setUpNextText(const QString& text) { upNextText_ = text; }
@@ -70,7 +80,26 @@ void VisualizerWidget::tick()
     const int n    = barCount();
     const float invN = 1.0f / n;
 
-    for (int i = 0; i < n; ++i) {
+    // Measured bars: resample the analyzer's bars onto this width.  Its
+    // frames already carry smoothing and peak hold.
+    const bool hasSpectrum = spectrumCount_ > 1 && spectrumTimer_.isValid()
+                             && spectrumTimer_.elapsed() < 250;
+    if (hasSpectrum) {
+        const float gain = 0.75f + 0.5f * sensitivity;
+        const float scale = static_cast<float>(spectrumCount_ - 1) / qMax(1, n - 1);
+        for (int i = 0; i < n; ++i) {
+            const float pos = i * scale;
+            const int   k   = qMin(static_cast<int>(pos), spectrumCount_ - 2);
+            const float t   = pos - k;
+            const float bar  = spectrumBars_[k]  * (1.0f - t) + spectrumBars_[k + 1]  * t;
+            const float peak = spectrumPeaks_[k] * (1.0f - t) + spectrumPeaks_[k + 1] * t;
+            barHeights_[i] = qBound(0.0f, bar * gain, 1.0f);
+            peakHold_[i]   = qBound(0.0f, peak * gain, 1.0f);
+            peakAge_[i]    = 0.0f;
+        }
+    }
+
+    for (int i = 0; i < n && !hasSpectrum; ++i) {
         float target;
         if (hasAudio && rawLevel > 0.001f) {
             const float freq   = i * invN;
@@ -26,6 +26,11 @@ public:
 
     void setAudioLevel(float level);
 
+    // Measured spectrum: `count` log-frequency bars and peak-hold markers in
+    // [0, 1], low to high.  While frames keep arriving the bars follow them;
+    // otherwise tick() falls back to the level-driven animation.
+    void setSpectrum(const float* bars, const float* peaks, int count);
+
     void setTitleText(const QString& text);
     void setTitlePulse(float envelope);
     void setUpNextText(const QString& text);
@@ -41,6 +46,7 @@ private:
     static constexpr int kMinBars       = 120;
     static constexpr int kMaxBars       = 256;
     static constexpr int kParticleCount = 40;
+    static constexpr int kSpectrumMax   = 256;
 
     static QColor bandColor(float freq, float energy);
 
@@ -66,4 +72,8 @@ private:
     Particle    particles_[40]{};
     QElapsedTimer elapsed_;
     QElapsedTimer audioActiveTimer_;
+    float       spectrumBars_[kSpectrumMax]{};
+    float       spectrumPeaks_[kSpectrumMax]{};
+    int         spectrumCount_{0};
+    QElapsedTimer spectrumTimer_;
 };
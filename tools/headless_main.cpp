@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <ctime>
@@ -16,6 +18,7 @@
 #include "engine/EngineCore.h"
 #include "engine/audio/AudioIO_Juce.h"
 #include "engine/runtime/MasterBus.h"
+#include "engine/runtime/library/TrackRegistry.h"
 #include "engine/runtime/offline/OfflineRenderConfig.h"
 #include "engine/runtime/offline/OfflineRenderer.h"
 
@@ -182,6 +185,10 @@ struct CliOptions {
     int requestedSampleRate = 0;
     int requestedBufferFrames = 0;
     int requestedChannelsOut = 0;
+    bool registryBench = false;
+    int benchWriters = 16;
+    int benchTracks = 100000;
+    int benchSeconds = 3;
 };
 
 struct AudioDeviceProfile {
@@ -884,6 +891,34 @@ bool parseCliOptions(int argc, char* argv[], CliOptions& options)
             continue;
         }
 
+        if (arg == "--bench_registry") {
+            options.registryBench = true;
+            continue;
+        }
+
+        if (arg == "--writers" || arg == "--tracks" || arg == "--bench_seconds") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            int value = 0;
+            try {
+                value = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (value <= 0) {
+                return false;
+            }
+            if (arg == "--writers") {
+                options.benchWriters = value;
+            } else if (arg == "--tracks") {
+                options.benchTracks = value;
+            } else {
+                options.benchSeconds = value;
+            }
+            continue;
+        }
+
         if (arg == "--telemetry_csv") {
             if (i + 1 >= argc) {
                 return false;
@@ -1308,6 +1343,120 @@ int runRtAudioProbe(const CliOptions& options)
     return pass ? 0 : 1;
 }
 
+// Contention benchmark for TrackRegistry: `writers` threads hammer
+// updateAnalysis on random tracks while readers call getAnalysis (the
+// applySetDeckTrack path) and one thread keeps taking exportEntries
+// snapshots (the store's compaction path).  Reports throughput, the worst
+// single read, and export time.
+int runRegistryBench(const CliOptions& options)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int kReaders = 4;
+
+    const uint64_t tracks = static_cast<uint64_t>(options.benchTracks);
+    ngks::TrackRegistry registry;
+
+    std::vector<ngks::RegistryEntrySnapshot> seed(static_cast<size_t>(tracks));
+    for (uint64_t i = 0; i < tracks; ++i) {
+        seed[static_cast<size_t>(i)].track.trackId = i + 1;
+        seed[static_cast<size_t>(i)].hasAnalysis = 1;
+    }
+    const auto importStart = Clock::now();
+    registry.importEntries(seed);
+    const double importMs = std::chrono::duration<double, std::milli>(Clock::now() - importStart).count();
+
+    std::atomic<bool> running { true };
+    std::atomic<uint64_t> writes { 0 };
+    std::atomic<uint64_t> reads { 0 };
+    std::atomic<uint64_t> readMisses { 0 };
+    std::atomic<int64_t> readMaxNs { 0 };
+    std::atomic<uint64_t> exports { 0 };
+    std::atomic<uint64_t> exportShort { 0 };
+    std::atomic<int64_t> exportTotalUs { 0 };
+
+    auto nextRandom = [](uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < options.benchWriters; ++w) {
+        threads.emplace_back([&, w]() {
+            uint64_t rng = 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(w + 1);
+            uint64_t local = 0;
+            ngks::AnalysisMeta analysis {};
+            while (running.load(std::memory_order_relaxed)) {
+                analysis.lastJobId = static_cast<uint32_t>(local);
+                analysis.bpmFixed = static_cast<int32_t>(local & 0xFFFF);
+                registry.updateAnalysis(nextRandom(rng) % tracks + 1, analysis);
+                ++local;
+            }
+            writes.fetch_add(local, std::memory_order_relaxed);
+        });
+    }
+    for (int r = 0; r < kReaders; ++r) {
+        threads.emplace_back([&, r]() {
+            uint64_t rng = 0xD1B54A32D192ED03ull * static_cast<uint64_t>(r + 1);
+            uint64_t local = 0;
+            uint64_t misses = 0;
+            int64_t worst = 0;
+            ngks::AnalysisMeta analysis {};
+            while (running.load(std::memory_order_relaxed)) {
+                const auto t0 = Clock::now();
+                const bool hit = registry.getAnalysis(nextRandom(rng) % tracks + 1, analysis);
+                const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+                worst = std::max(worst, ns);
+                misses += hit ? 0u : 1u;
+                ++local;
+            }
+            reads.fetch_add(local, std::memory_order_relaxed);
+            readMisses.fetch_add(misses, std::memory_order_relaxed);
+            int64_t seen = readMaxNs.load(std::memory_order_relaxed);
+            while (worst > seen && !readMaxNs.compare_exchange_weak(seen, worst)) {
+            }
+        });
+    }
+    threads.emplace_back([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            const auto t0 = Clock::now();
+            const auto snapshot = registry.exportEntries();
+            exportTotalUs.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count(),
+                                    std::memory_order_relaxed);
+            exports.fetch_add(1u, std::memory_order_relaxed);
+            if (snapshot.size() != tracks) {
+                exportShort.fetch_add(1u, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.benchSeconds));
+    running.store(false, std::memory_order_relaxed);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const double seconds = static_cast<double>(options.benchSeconds);
+    const uint64_t exportCount = std::max<uint64_t>(exports.load(), 1u);
+    std::cout << "RegistryBench writers=" << options.benchWriters
+              << " readers=" << kReaders
+              << " tracks=" << tracks
+              << " import_ms=" << importMs
+              << " writes_per_s=" << static_cast<uint64_t>(static_cast<double>(writes.load()) / seconds)
+              << " reads_per_s=" << static_cast<uint64_t>(static_cast<double>(reads.load()) / seconds)
+              << " read_max_us=" << (static_cast<double>(readMaxNs.load()) / 1000.0)
+              << " exports=" << exports.load()
+              << " export_avg_ms=" << (static_cast<double>(exportTotalUs.load()) / 1000.0 / static_cast<double>(exportCount))
+              << std::endl;
+
+    const bool pass = registry.count() == tracks && readMisses.load() == 0u && exportShort.load() == 0u;
+    std::cout << "RegistryBench=" << (pass ? "PASS" : "FAIL")
+              << " read_misses=" << readMisses.load()
+              << " short_exports=" << exportShort.load() << std::endl;
+    return pass ? 0 : 1;
+}
+
 int runAeSoak(const CliOptions& options)
 {
     std::cout << "RTAudioAE=BEGIN" << std::endl;
@@ -1605,6 +1754,10 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    if (options.registryBench) {
+        return runRegistryBench(options);
+    }
+
     if (options.listDevices) {
         return runListDevices();
     }